@@ -1,4 +1,4 @@
-from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple, Union
+from typing import Any, Callable, Dict, Iterator, List, Literal, Optional, Sequence, Tuple, Union
 
 # Exceptions
 class AddressInUseError(Exception): ...
@@ -16,11 +16,86 @@ class NotSupportedError(Exception): ...
 class OperationCancelledError(Exception): ...
 class PermissionDeniedError(Exception): ...
 
+def start_dispatcher(threads: int = 1) -> None:
+    """
+    Run signal callbacks on dedicated dispatcher threads instead of the thread emitting them.
+    """
+    ...
+
+def stop_dispatcher() -> None:
+    """
+    Deliver the callbacks already handed to the dispatcher threads, then stop and join them.
+    """
+    ...
+
+def set_watchdog(threshold: float, hook: Optional[Callable[[str, str, float], None]] = None) -> None:
+    """
+    Time signal callbacks and report those slower than a threshold.
+    """
+    ...
+
+def get_callback_stats() -> List[Dict[str, Any]]:
+    """
+    Get timing statistics for signal callbacks.
+    """
+    ...
+
+def reset_callback_stats() -> None:
+    """
+    Discard timing statistics for signal callbacks.
+    """
+    ...
+
+def record_callback_time(signal: str, callback: Callable[..., Any], elapsed: float) -> None:
+    """
+    Account for a callback invoked from Python on behalf of a signal.
+    """
+    ...
+
+def get_gil_stats() -> Dict[str, Dict[str, Any]]:
+    """
+    Get how long each place that takes the GIL from a foreign thread waited for it.
+    """
+    ...
+
+def reset_gil_stats() -> None:
+    """
+    Discard GIL wait statistics.
+    """
+    ...
+
+def cbor_encode(value: Any) -> bytes:
+    """
+    Encode a value as CBOR.
+    """
+    ...
+
+def cbor_decode(data: Union[bytes, bytearray, memoryview]) -> Any:
+    """
+    Decode a single CBOR-encoded value.
+    """
+    ...
+
 class Object:
     def __init__(self, *args: Any, **kwargs: Any) -> None: ...
-    def on(self, signal: str, callback: Callable[..., Any]) -> None:
+    def on(
+        self,
+        signal: str,
+        callback: Callable[..., Any],
+        *,
+        decode_json: bool = False,
+        lazy_json: bool = False,
+        dispatch_rpc: bool = False,
+        zero_copy: bool = False,
+        max_batch_size: int = 0,
+        max_batch_delay: float = 0.0,
+        queue_size: int = 0,
+        queue_policy: Literal["block", "drop-oldest", "drop-newest", "coalesce"] = "drop-oldest",
+    ) -> None:
         """
         Add a signal handler.
+        With a non-zero max_batch_size the callback receives a list of argument tuples per wakeup instead.
+        With a non-zero queue_size the callback runs on a shared worker thread, fed through a bounded queue.
         """
         ...
     def off(self, signal: str, callback: Callable[..., Any]) -> None:
@@ -28,6 +103,123 @@ class Object:
         Remove a signal handler.
         """
         ...
+    def off_all(self, signal: str) -> None:
+        """
+        Remove all handlers of a signal.
+        """
+        ...
+    def get_queue_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, int]:
+        """
+        Get statistics for a queued signal handler.
+        """
+        ...
+    def set_route(
+        self, signal: str, callback: Callable[..., Any], tag: str, handler: Optional[Callable[..., Any]]
+    ) -> None:
+        """
+        Route messages with the given tag to a separate handler.
+        """
+        ...
+    def set_route_fallback(self, signal: str, callback: Callable[..., Any], enabled: bool) -> None:
+        """
+        Choose whether unrouted messages reach the signal handler.
+        """
+        ...
+    def get_route_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, int]:
+        """
+        Get statistics for a routed signal handler.
+        """
+        ...
+    def set_priority_tags(self, signal: str, callback: Callable[..., Any], tags: Sequence[str]) -> None:
+        """
+        Let messages with the given tags overtake others queued for a signal handler.
+        """
+        ...
+    def set_log_sink(
+        self,
+        signal: str,
+        callback: Callable[..., Any],
+        *,
+        fd: int = -1,
+        path: Optional[str] = None,
+        max_bytes: int = 0,
+        backup_count: int = 0,
+        buffer_size: int = 0,
+        level: Literal["debug", "info", "warning", "error"] = "debug",
+    ) -> None:
+        """
+        Write log messages natively instead of passing them to a signal handler.
+        """
+        ...
+    def tail_log_sink(self, signal: str, callback: Callable[..., Any], count: int = 0) -> List[Tuple[str, str]]:
+        """
+        Get the most recent log messages kept by a log sink.
+        """
+        ...
+    def get_log_sink_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, int]:
+        """
+        Get statistics for a log sink.
+        """
+        ...
+    def set_tap(self, signal: str, callback: Callable[..., Any], path: Optional[str], size: int) -> None:
+        """
+        Mirror raw messages into a memory-mapped ring buffer file for other processes to read.
+        """
+        ...
+    def get_tap_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, int]:
+        """
+        Get statistics for a message tap.
+        """
+        ...
+    def set_recorder(self, signal: str, callback: Callable[..., Any], path: Optional[str]) -> None:
+        """
+        Record raw messages with timestamps to a file.
+        """
+        ...
+    def get_recorder_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, int]:
+        """
+        Get statistics for a message recorder.
+        """
+        ...
+    def set_limits(
+        self, signal: str, callback: Callable[..., Any], sample_every: int, max_rate: float, max_burst: float
+    ) -> None:
+        """
+        Sample or rate limit emissions before they reach a signal handler.
+        """
+        ...
+    def get_limit_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, int]:
+        """
+        Get statistics for a rate limited signal handler.
+        """
+        ...
+    def set_filter(
+        self, signal: str, callback: Callable[..., Any], key: Optional[str], values: Optional[List[str]]
+    ) -> None:
+        """
+        Only let messages with one of the given values for a top-level key reach a signal handler.
+        """
+        ...
+    def get_filter_stats(self, signal: str, callback: Callable[..., Any]) -> Dict[str, Any]:
+        """
+        Get statistics for a filtered signal handler.
+        """
+        ...
+    def open_stream(
+        self,
+        signal: str,
+        *,
+        decode_json: bool = False,
+        lazy_json: bool = False,
+        dispatch_rpc: bool = False,
+        zero_copy: bool = False,
+        queue_size: int = 0,
+        queue_policy: Literal["drop-oldest", "drop-newest", "coalesce"] = "drop-oldest",
+    ) -> "SignalStream":
+        """
+        Queue a signal's emissions for polling.
+        """
+        ...
 
 class Application(Object):
     @property
@@ -61,11 +253,36 @@ class Bus(Object):
         Attach to the bus.
         """
         ...
-    def post(self, message: str, data: Optional[Union[bytes, str]]) -> None:
+    def post(self, message: str, data: Optional[Union[str, bytes, bytearray, memoryview]]) -> None:
         """
         Post a JSON-encoded message to the bus.
         """
         ...
+    def post_many(
+        self, messages: List[str], datas: Optional[List[Optional[Union[str, bytes, bytearray, memoryview]]]] = None
+    ) -> None:
+        """
+        Post a batch of JSON-encoded messages to the bus.
+        """
+        ...
+
+class BytesView:
+    """
+    Read-only view of binary data owned by Telco, exposed through the buffer protocol.
+    Only available when built against the 3.11+ limited API.
+    """
+
+    def __len__(self) -> int: ...
+    def __bytes__(self) -> bytes:
+        """
+        Copy the data into a bytes object.
+        """
+        ...
+    def tobytes(self) -> bytes:
+        """
+        Copy the data into a bytes object.
+        """
+        ...
 
 class Cancellable(Object):
     def cancel(self) -> None:
@@ -423,7 +640,7 @@ class PortalService(Object):
         Device for in-process control.
         """
         ...
-    def broadcast(self, message: str, data: Optional[Union[str, bytes]] = None) -> None:
+    def broadcast(self, message: str, data: Optional[Union[str, bytes, bytearray, memoryview]] = None) -> None:
         """
         Broadcast a message to all control channels.
         """
@@ -438,12 +655,16 @@ class PortalService(Object):
         Kick out a specific connection.
         """
         ...
-    def narrowcast(self, tag: str, message: str, data: Optional[Union[str, bytes]] = None) -> None:
+    def narrowcast(
+        self, tag: str, message: str, data: Optional[Union[str, bytes, bytearray, memoryview]] = None
+    ) -> None:
         """
         Post a message to control channels with a specific tag.
         """
         ...
-    def post(self, connection_id: int, message: str, data: Optional[Union[str, bytes]] = None) -> None:
+    def post(
+        self, connection_id: int, message: str, data: Optional[Union[str, bytes, bytearray, memoryview]] = None
+    ) -> None:
         """
         Post a message to a specific control channel.
         """
@@ -532,11 +753,18 @@ class Script(Object):
         Load the script.
         """
         ...
-    def post(self, message: str, data: Optional[Union[str, bytes]] = None) -> None:
+    def post(self, message: str, data: Optional[Union[str, bytes, bytearray, memoryview]] = None) -> None:
         """
         Post a JSON-encoded message to the script.
         """
         ...
+    def post_many(
+        self, messages: List[str], datas: Optional[List[Optional[Union[str, bytes, bytearray, memoryview]]]] = None
+    ) -> None:
+        """
+        Post a batch of JSON-encoded messages to the script.
+        """
+        ...
     def unload(self) -> None:
         """
         Unload the script.
@@ -552,6 +780,26 @@ class Script(Object):
         Disable the Node.js compatible script debugger
         """
         ...
+    def begin_rpc(self, on_complete: Optional[Callable[[Any, Any], None]] = None) -> int:
+        """
+        Register a pending RPC request and return its ID.
+        """
+        ...
+    def wait_for_rpc(self, request_id: int) -> Tuple[Any, Optional[List[Any]]]:
+        """
+        Wait for the reply to a pending RPC request.
+        """
+        ...
+    def abort_rpcs(self) -> None:
+        """
+        Fail all pending RPC requests.
+        """
+        ...
+    def enumerate_pending_rpcs(self) -> List[int]:
+        """
+        Enumerate IDs of pending RPC requests.
+        """
+        ...
 
 class Session(Object):
     @property
@@ -622,6 +870,86 @@ class Session(Object):
         """
         ...
 
+class SignalStream:
+    def fileno(self) -> int:
+        """
+        Get a file descriptor that becomes readable when emissions are pending, or -1.
+        """
+        ...
+    def drain(self, max_count: int = 0) -> List[Tuple[Any, ...]]:
+        """
+        Take pending emissions as a list of argument tuples.
+        """
+        ...
+    def wait(self, timeout: float = -1.0) -> bool:
+        """
+        Block until emissions are pending or the stream is closed.
+        """
+        ...
+    def is_closed(self) -> bool:
+        """
+        Query whether the stream is closed and drained.
+        """
+        ...
+    def close(self) -> None:
+        """
+        Stop queueing emissions.
+        """
+        ...
+    def get_stats(self) -> Dict[str, int]:
+        """
+        Get statistics for the stream's queue.
+        """
+        ...
+
+class LazyMessage:
+    """
+    Message whose type, level and payload tag are parsed up front, and everything else on first access.
+    """
+
+    @property
+    def tag(self) -> Any:
+        """
+        First element of an array payload, or the type field of an object payload. None otherwise.
+        """
+        ...
+    def __getitem__(self, key: str) -> Any: ...
+    def __setitem__(self, key: str, value: Any) -> None: ...
+    def __delitem__(self, key: str) -> None: ...
+    def __contains__(self, key: object) -> bool: ...
+    def __iter__(self) -> Iterator[str]: ...
+    def __len__(self) -> int: ...
+    def get(self, key: str, default: Any = None) -> Any:
+        """
+        Get a field, or the default if the message doesn't have it.
+        """
+        ...
+    def keys(self) -> List[str]:
+        """
+        Get the field names.
+        """
+        ...
+    def values(self) -> List[Any]:
+        """
+        Get the field values.
+        """
+        ...
+    def items(self) -> List[Tuple[str, Any]]:
+        """
+        Get the fields as (name, value) pairs.
+        """
+        ...
+    def to_dict(self) -> Dict[str, Any]:
+        """
+        Parse the whole message and return it as a dict.
+        """
+        ...
+    def is_materialized(self) -> bool:
+        """
+        Query whether the whole message has been parsed.
+        """
+        ...
+
 class Spawn(Object):
     @property
     def identifier(self) -> str:
@@ -0,0 +1,114 @@
+import sys
+import threading
+import time
+
+import telco
+
+COUNT = 50000
+
+AGENT = """\
+const BASE = 0x7fff00000000;
+
+function makeSample(index) {
+  const addresses = [];
+  const counters = [];
+  for (let i = 0; i !== 16; i++) {
+    addresses.push(BASE + (index * 16 + i) * 16);
+    counters.push(index * i);
+  }
+  return { index, addresses, counters };
+}
+
+// Minimal CBOR encoder covering what makeSample() produces: unsigned integers, arrays and short ASCII keys.
+function encodeCbor(value) {
+  const bytes = [];
+
+  function head(major, n) {
+    if (n < 24) {
+      bytes.push((major << 5) | n);
+    } else if (n < 0x100) {
+      bytes.push((major << 5) | 24, n);
+    } else if (n < 0x10000) {
+      bytes.push((major << 5) | 25, n >>> 8, n & 0xff);
+    } else if (n < 0x100000000) {
+      bytes.push((major << 5) | 26, n >>> 24, (n >>> 16) & 0xff, (n >>> 8) & 0xff, n & 0xff);
+    } else {
+      const hi = Math.floor(n / 0x100000000);
+      const lo = n >>> 0;
+      bytes.push((major << 5) | 27, hi >>> 24, (hi >>> 16) & 0xff, (hi >>> 8) & 0xff, hi & 0xff,
+          lo >>> 24, (lo >>> 16) & 0xff, (lo >>> 8) & 0xff, lo & 0xff);
+    }
+  }
+
+  function encode(v) {
+    if (typeof v === 'number') {
+      head(0, v);
+    } else if (typeof v === 'string') {
+      head(3, v.length);
+      for (let i = 0; i !== v.length; i++)
+        bytes.push(v.charCodeAt(i));
+    } else if (Array.isArray(v)) {
+      head(4, v.length);
+      v.forEach(encode);
+    } else {
+      const keys = Object.keys(v);
+      head(5, keys.length);
+      for (const key of keys) {
+        encode(key);
+        encode(v[key]);
+      }
+    }
+  }
+
+  encode(value);
+  return new Uint8Array(bytes).buffer;
+}
+
+// Answer in whichever encoding the kick-off message arrived in.
+recv(message => {
+  const useCbor = message.type === 'telco:cbor';
+  for (let i = 0; i !== %d; i++) {
+    const sample = makeSample(i);
+    if (useCbor) {
+      const encoded = encodeCbor(sample);
+      send({ type: 'telco:cbor', length: encoded.byteLength }, encoded);
+    } else {
+      send(sample);
+    }
+  }
+});
+"""
+
+
+def measure(session, message_encoding):
+    done = threading.Event()
+    received = 0
+
+    def on_message(message, data):
+        nonlocal received
+        received += 1
+        if received == COUNT:
+            done.set()
+
+    script = session.create_script(AGENT % COUNT, message_encoding=message_encoding)
+    script.on("message", on_message)
+    script.load()
+
+    start = time.perf_counter()
+    script.post({"type": "go"})
+    done.wait()
+    elapsed = time.perf_counter() - start
+
+    script.unload()
+
+    return COUNT / elapsed
+
+
+target = sys.argv[1] if len(sys.argv) > 1 else "Twitter"
+session = telco.attach(target)
+
+for message_encoding in ("json", "cbor"):
+    rate = measure(session, message_encoding)
+    print("message_encoding=%s: %.0f messages/sec" % (message_encoding, rate))
+
+session.detach()
@@ -0,0 +1,59 @@
+import subprocess
+import sys
+import time
+
+import telco
+
+SAMPLES = 200
+
+NOISY_AGENT = """\
+setInterval(() => { send({ event: 'tick' }); }, 25);
+"""
+
+QUIET_AGENT = """\
+rpc.exports = {
+  ping() {
+    return 'pong';
+  }
+};
+"""
+
+
+def measure(target, threads):
+    if threads != 0:
+        telco.start_dispatcher(threads)
+
+    session = telco.attach(target)
+
+    noisy = session.create_script(NOISY_AGENT)
+    noisy.on("message", lambda message, data: time.sleep(0.02))
+    noisy.load()
+
+    quiet = session.create_script(QUIET_AGENT)
+    quiet.load()
+
+    latencies = []
+    for _ in range(SAMPLES):
+        start = time.perf_counter()
+        quiet.exports_sync.ping()
+        latencies.append(time.perf_counter() - start)
+        time.sleep(0.005)
+
+    noisy.unload()
+    quiet.unload()
+    session.detach()
+
+    latencies.sort()
+    p50 = latencies[len(latencies) // 2] * 1000
+    p99 = latencies[int(len(latencies) * 0.99)] * 1000
+    print("threads=%d: p50=%.2f ms p99=%.2f ms" % (threads, p50, p99))
+
+
+target = sys.argv[1] if len(sys.argv) > 1 else "Twitter"
+
+if len(sys.argv) > 2:
+    measure(target, int(sys.argv[2]))
+else:
+    # The dispatcher can only be started once per process, so measure each mode separately.
+    for threads in (0, 4):
+        subprocess.run([sys.executable, __file__, target, str(threads)], check=True)
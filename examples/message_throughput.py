@@ -0,0 +1,52 @@
+import sys
+import threading
+import time
+
+import telco
+
+COUNT = 100000
+
+AGENT = """\
+recv('go', () => {
+  for (let i = 0; i !== %d; i++) {
+    send({ event: 'call', index: i, name: 'open', args: ['/etc/hosts', 0, 420], flags: [true, false, null] });
+  }
+});
+"""
+
+
+def measure(session, native_decoding, max_batch_size):
+    done = threading.Event()
+    received = 0
+
+    def on_messages(messages):
+        nonlocal received
+        received += len(messages)
+        if received == COUNT:
+            done.set()
+
+    script = session.create_script(
+        AGENT % COUNT, native_decoding=native_decoding, max_batch_size=max_batch_size, max_batch_delay=0.001
+    )
+    script.on("messages", on_messages)
+    script.load()
+
+    start = time.perf_counter()
+    script.post({"type": "go"})
+    done.wait()
+    elapsed = time.perf_counter() - start
+
+    script.unload()
+
+    return COUNT / elapsed
+
+
+target = sys.argv[1] if len(sys.argv) > 1 else "Twitter"
+session = telco.attach(target)
+
+for native_decoding in (False, True):
+    for max_batch_size in (0, 256):
+        rate = measure(session, native_decoding, max_batch_size)
+        print("native_decoding=%s max_batch_size=%d: %.0f messages/sec" % (native_decoding, max_batch_size, rate))
+
+session.detach()
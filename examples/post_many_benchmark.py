@@ -0,0 +1,58 @@
+import sys
+import threading
+import time
+
+import telco
+
+COUNT = 100000
+BATCH_SIZE = 256
+
+AGENT = """\
+let received = 0;
+recv(function onMessage(message) {
+  if (++received === %d) {
+    send('done');
+    received = 0;
+  }
+  recv(onMessage);
+});
+"""
+
+
+def measure(script, batched):
+    done = threading.Event()
+
+    def on_message(message, data):
+        done.set()
+
+    script.on("message", on_message)
+
+    messages = [{"event": "call", "index": i, "args": ["/etc/hosts", 0, 420]} for i in range(COUNT)]
+
+    start = time.perf_counter()
+    if batched:
+        for offset in range(0, COUNT, BATCH_SIZE):
+            script.post_many(messages[offset : offset + BATCH_SIZE])
+    else:
+        for message in messages:
+            script.post(message)
+    done.wait()
+    elapsed = time.perf_counter() - start
+
+    script.off("message", on_message)
+
+    return COUNT / elapsed
+
+
+target = sys.argv[1] if len(sys.argv) > 1 else "Twitter"
+session = telco.attach(target)
+
+script = session.create_script(AGENT % COUNT)
+script.load()
+
+for batched in (False, True):
+    rate = measure(script, batched)
+    print("%s: %.0f messages/sec" % ("post_many" if batched else "post", rate))
+
+script.unload()
+session.detach()
@@ -0,0 +1,21 @@
+import sys
+import time
+
+import telco
+
+ROUNDS = 20
+
+device = telco.get_device(sys.argv[1]) if len(sys.argv) > 1 else telco.get_local_device()
+
+processes = device.enumerate_processes(scope="full")
+n_parameters = sum(len(process.parameters) for process in processes)
+
+start = time.perf_counter()
+for _ in range(ROUNDS):
+    device.enumerate_processes(scope="full")
+elapsed = (time.perf_counter() - start) / ROUNDS
+
+print(
+    "%d processes, %d parameters: %.2f ms per enumerate_processes(scope='full')"
+    % (len(processes), n_parameters, elapsed * 1000)
+)
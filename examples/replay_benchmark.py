@@ -0,0 +1,40 @@
+import json
+import sys
+import time
+
+import telco
+
+AGENT = """\
+setInterval(() => {
+  for (let i = 0; i !== 100; i++) {
+    send({ event: 'call', index: i, name: 'open', args: ['/etc/hosts', 0, 420], flags: [true, false, null] });
+  }
+}, 10);
+"""
+
+
+def on_message(message, data):
+    json.dumps(message["payload"])
+
+
+if len(sys.argv) < 3 or sys.argv[1] not in ("record", "replay"):
+    print("Usage: %s record <target> <recording> | replay <recording>" % sys.argv[0])
+    sys.exit(1)
+
+if sys.argv[1] == "record":
+    session = telco.attach(sys.argv[2])
+    script = session.create_script(AGENT)
+    script.on("message", on_message)
+    script.start_recording(sys.argv[3])
+    script.load()
+    time.sleep(5)
+    script.unload()
+    print(script.get_recording_stats())
+    session.detach()
+else:
+    # Replaying needs no target, it only runs the handlers, so it works on any machine.
+    with telco.MessageRecording(sys.argv[2]) as recording:
+        start = time.perf_counter()
+        count = recording.replay(lambda raw_message, data: on_message(json.loads(raw_message), data), speed=0)
+        elapsed = time.perf_counter() - start
+    print("replayed %d messages: %.0f messages/sec" % (count, count / elapsed))
@@ -0,0 +1,28 @@
+import time
+
+import telco
+
+COUNT = 10000
+
+
+class Subscriber:
+    def on_changed(self):
+        pass
+
+
+manager = telco.get_device_manager()
+subscribers = [Subscriber() for _ in range(COUNT)]
+
+start = time.perf_counter()
+for subscriber in subscribers:
+    manager.on("changed", subscriber.on_changed)
+print("on: %.1f ms for %d handlers" % ((time.perf_counter() - start) * 1000, COUNT))
+
+start = time.perf_counter()
+for subscriber in subscribers[: COUNT // 2]:
+    manager.off("changed", subscriber.on_changed)
+print("off: %.1f ms for %d handlers" % ((time.perf_counter() - start) * 1000, COUNT // 2))
+
+start = time.perf_counter()
+manager.off_all("changed")
+print("off_all: %.1f ms for the remaining %d handlers" % ((time.perf_counter() - start) * 1000, COUNT - COUNT // 2))
@@ -145,10 +145,12 @@ if __name__ == "__main__":
         ],
         packages=["telco", "_telco"],
         package_data={"telco": ["py.typed"], "_telco": ["py.typed", "__init__.pyi"]},
+        headers=["src/telco-python.h"],
         ext_modules=[
             Extension(
                 name="_telco",
                 sources=["src/_telco.c"],
+                depends=["src/telco-python.h"],
                 include_dirs=include_dirs,
                 library_dirs=library_dirs,
                 libraries=libraries,
@@ -5,7 +5,21 @@
  */
 
 #include <telco-core.h>
+#include <errno.h>
+#include <stdio.h>
 #include <string.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_WIN32
+# include <io.h>
+# include <windows.h>
+# define close _close
+# define dup _dup
+# define fdopen _fdopen
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
 
 #ifdef _MSC_VER
 # pragma warning (push)
@@ -16,7 +30,14 @@
 # undef _POSIX_C_SOURCE
 #endif
 
-#define Py_LIMITED_API 0x03070000
+/*
+ * Building against a newer limited API unlocks features that are only part of
+ * the stable ABI from that version onwards, e.g. zero-copy buffers on 3.11+.
+ */
+#ifndef PYTELCO_LIMITED_API
+# define PYTELCO_LIMITED_API 0x03070000
+#endif
+#define Py_LIMITED_API PYTELCO_LIMITED_API
 #define PY_SSIZE_T_CLEAN
 
 /*
@@ -36,6 +57,7 @@
 #include <Python.h>
 #include <structmember.h>
 #include <string.h>
+#include "telco-python.h"
 #ifdef _MSC_VER
 # pragma warning (pop)
 #endif
@@ -43,6 +65,13 @@
 # include <crt_externs.h>
 #endif
 
+#if PYTELCO_LIMITED_API >= 0x030B0000
+# define PYTELCO_HAVE_BUFFER_PROTOCOL 1
+#endif
+#if PYTELCO_LIMITED_API >= 0x030C0000
+# define PYTELCO_HAVE_VECTORCALL 1
+#endif
+
 #define PyUnicode_FromUTF8String(str) PyUnicode_DecodeUTF8 (str, strlen (str), "strict")
 #define MOD_INIT(name) PyMODINIT_FUNC PyInit_##name (void)
 #define MOD_DEF(ob, name, doc, methods) \
@@ -122,22 +151,111 @@
 
 #define TELCO_FUNCPTR_TO_POINTER(f) (GSIZE_TO_POINTER (f))
 
+#define PYTELCO_JSON_MAX_DEPTH 512
+#define PYTELCO_CBOR_MAX_DEPTH 512
+/* Containers may box their elements, and GVariant itself gives up past 128 levels. */
+#define PYTELCO_VARIANT_MAX_DEPTH 64
+
+#define PYTELCO_DEFAULT_STREAM_QUEUE_SIZE 1024
+
+#define PYTELCO_MAX_INTERNED_KEYS 4096
+
+#define PYTELCO_MAX_ROUTE_TAG_LENGTH 255
+
+#define PYTELCO_LOG_SINK_FLUSH_INTERVAL 500
+#define PYTELCO_MAX_FILTER_VALUE_LENGTH 255
+
+#define PYTELCO_TAP_MAGIC "TELCOTAP"
+#define PYTELCO_TAP_VERSION 1
+#define PYTELCO_TAP_MIN_CAPACITY 4096
+#define PYTELCO_TAP_MAX_CAPACITY (1U << 30)
+#define PYTELCO_TAP_RECORD_ALIGNMENT 16
+#define PYTELCO_TAP_RECORD_PADDING (1 << 0)
+#define PYTELCO_TAP_RECORD_HAS_DATA (1 << 1)
+
+#define PYTELCO_RECORDING_MAGIC "TELCOREC"
+#define PYTELCO_RECORDING_VERSION 1
+#define PYTELCO_RECORDING_ALIGNMENT 8
+#define PYTELCO_RECORDING_NO_DATA G_MAXUINT32
+#define PYTELCO_RECORDING_BUFFER_SIZE (1 << 20)
+
+#define PYTELCO_DISPATCHER_MAX_LANES 64
+#define PYTELCO_DISPATCHER_MAX_EVENTS_PER_WAKEUP 64
+
+#define PYTELCO_N_HISTOGRAM_BUCKETS 24
+
+#define PYTELCO_SIGNAL_QUEUE_MAX_WORKERS 4
+
 static volatile gint toplevel_objects_alive = 0;
 
 static PyObject * inspect_getargspec;
 static PyObject * inspect_ismethod;
 
 static PyObject * datetime_constructor;
+static PyObject * json_loads;
+
+static GThreadPool * signal_queue_pool;
 
 static initproc PyGObject_tp_init;
 static destructor PyGObject_tp_dealloc;
 static GHashTable * pygobject_type_spec_by_type;
+static GHashTable * pygobject_signal_signatures;
+static GHashTable * pygobject_interned_keys;
 static GHashTable * telco_exception_by_error_code;
 static PyObject * cancelled_exception;
 
+static const gchar * pytelco_log_level_names[] = { "debug", "info", "warning", "error" };
+
+static GAsyncQueue ** dispatcher_lanes = NULL;
+static guint dispatcher_lane_count = 0;
+static GThread ** dispatcher_threads = NULL;
+
+/* Only touched with the GIL held, so that timing disabled callbacks costs a single comparison. */
+static gint64 watchdog_threshold = -1;
+static PyObject * watchdog_hook = NULL;
+static GHashTable * watchdog_stats = NULL;
+
+static const gchar * pytelco_gil_site_names[] =
+{
+  "signal-emission",
+  "rpc-reply",
+  "batch-flush",
+  "signal-queue",
+  "dispatcher",
+  "closure-finalize",
+  "router-free",
+  "buffer-release",
+  "device-matching",
+  "authentication",
+  "authentication-dispose",
+  "cancelled",
+  "cancelled-destroy",
+};
+
 typedef struct _PyGObject                      PyGObject;
 typedef struct _PyGObjectType                  PyGObjectType;
 typedef struct _PyGObjectSignalClosure         PyGObjectSignalClosure;
+typedef struct _PyGObjectSignalKey             PyGObjectSignalKey;
+typedef struct _PyGObjectSignalSignature       PyGObjectSignalSignature;
+typedef struct _PyGObjectSignalOptions         PyGObjectSignalOptions;
+typedef struct _PyGObjectSignalBatch           PyGObjectSignalBatch;
+typedef struct _PyGObjectSignalQueue           PyGObjectSignalQueue;
+typedef struct _PyGObjectSignalLane            PyGObjectSignalLane;
+typedef struct _PyGObjectSignalEvent           PyGObjectSignalEvent;
+typedef struct _PyGObjectSignalRouter          PyGObjectSignalRouter;
+typedef struct _PyGObjectSignalLimiter         PyGObjectSignalLimiter;
+typedef struct _PyGObjectSignalFilter          PyGObjectSignalFilter;
+typedef struct _PyGObjectSignalLogSink         PyGObjectSignalLogSink;
+typedef struct _PyGObjectSignalLogEntry        PyGObjectSignalLogEntry;
+typedef struct _PyTelcoCallbackStats           PyTelcoCallbackStats;
+typedef struct _PyTelcoGilSiteStats            PyTelcoGilSiteStats;
+typedef struct _PyGObjectSignalTap             PyGObjectSignalTap;
+typedef struct _PyTelcoTapHeader               PyTelcoTapHeader;
+typedef struct _PyTelcoTapRecord               PyTelcoTapRecord;
+typedef struct _PyGObjectSignalRecorder        PyGObjectSignalRecorder;
+typedef struct _PyTelcoRecordingHeader         PyTelcoRecordingHeader;
+typedef struct _PyTelcoNativeHandler           PyTelcoNativeHandler;
+typedef struct _PyTelcoRecordingEntry          PyTelcoRecordingEntry;
 typedef struct _PyDeviceManager                PyDeviceManager;
 typedef struct _PyDevice                       PyDevice;
 typedef struct _PyApplication                  PyApplication;
@@ -148,6 +266,7 @@ typedef struct _PyCrash                        PyCrash;
 typedef struct _PyBus                          PyBus;
 typedef struct _PySession                      PySession;
 typedef struct _PyScript                       PyScript;
+typedef struct _PyScriptRpcRequest             PyScriptRpcRequest;
 typedef struct _PyRelay                        PyRelay;
 typedef struct _PyPortalMembership             PyPortalMembership;
 typedef struct _PyPortalService                PyPortalService;
@@ -156,11 +275,69 @@ typedef struct _PyCompiler                     PyCompiler;
 typedef struct _PyFileMonitor                  PyFileMonitor;
 typedef struct _PyIOStream                     PyIOStream;
 typedef struct _PyCancellable                  PyCancellable;
+typedef struct _PyBytesView                    PyBytesView;
+typedef struct _PySignalStream                 PySignalStream;
+typedef struct _PyLazyMessage                  PyLazyMessage;
+typedef struct _PyTelcoJsonParser              PyTelcoJsonParser;
+typedef struct _PyTelcoCborParser              PyTelcoCborParser;
 
 #define TELCO_TYPE_PYTHON_AUTHENTICATION_SERVICE (telco_python_authentication_service_get_type ())
 G_DECLARE_FINAL_TYPE (TelcoPythonAuthenticationService, telco_python_authentication_service, TELCO, PYTHON_AUTHENTICATION_SERVICE, GObject)
 
 typedef void (* PyGObjectInitFromHandleFunc) (PyObject * self, gpointer handle);
+typedef PyObject * (* PyGObjectMarshalValueFunc) (const GValue * value);
+typedef PyObject * (* PyGObjectMarshalVariantFunc) (GVariant * variant);
+
+typedef enum
+{
+  PY_GOBJECT_SIGNAL_DECODE_JSON  = (1 << 0),
+  PY_GOBJECT_SIGNAL_DISPATCH_RPC = (1 << 1),
+  PY_GOBJECT_SIGNAL_ZERO_COPY    = (1 << 2),
+  PY_GOBJECT_SIGNAL_LAZY_JSON    = (1 << 3),
+} PyGObjectSignalFlags;
+
+typedef enum
+{
+  PY_GOBJECT_SIGNAL_QUEUE_BLOCK,
+  PY_GOBJECT_SIGNAL_QUEUE_DROP_OLDEST,
+  PY_GOBJECT_SIGNAL_QUEUE_DROP_NEWEST,
+  PY_GOBJECT_SIGNAL_QUEUE_COALESCE,
+} PyGObjectSignalQueuePolicy;
+
+typedef enum
+{
+  PY_GOBJECT_SIGNAL_PRIORITY_HIGH,
+  PY_GOBJECT_SIGNAL_PRIORITY_NORMAL,
+
+  PY_GOBJECT_SIGNAL_N_PRIORITIES
+} PyGObjectSignalPriority;
+
+typedef enum
+{
+  PYTELCO_LOG_LEVEL_DEBUG,
+  PYTELCO_LOG_LEVEL_INFO,
+  PYTELCO_LOG_LEVEL_WARNING,
+  PYTELCO_LOG_LEVEL_ERROR,
+} PyTelcoLogLevel;
+
+typedef enum
+{
+  PYTELCO_GIL_SITE_SIGNAL_EMISSION,
+  PYTELCO_GIL_SITE_RPC_REPLY,
+  PYTELCO_GIL_SITE_BATCH_FLUSH,
+  PYTELCO_GIL_SITE_SIGNAL_QUEUE,
+  PYTELCO_GIL_SITE_DISPATCHER,
+  PYTELCO_GIL_SITE_CLOSURE_FINALIZE,
+  PYTELCO_GIL_SITE_ROUTER_FREE,
+  PYTELCO_GIL_SITE_BUFFER_RELEASE,
+  PYTELCO_GIL_SITE_DEVICE_MATCHING,
+  PYTELCO_GIL_SITE_AUTHENTICATION,
+  PYTELCO_GIL_SITE_AUTHENTICATION_DISPOSE,
+  PYTELCO_GIL_SITE_CANCELLED,
+  PYTELCO_GIL_SITE_CANCELLED_DESTROY,
+
+  PYTELCO_N_GIL_SITES
+} PyTelcoGilSite;
 
 struct _PyGObject
 {
@@ -169,7 +346,7 @@ struct _PyGObject
   gpointer handle;
   const PyGObjectType * type;
 
-  GSList * signal_closures;
+  GHashTable * signal_closures;
 };
 
 struct _PyGObjectType
@@ -184,7 +361,262 @@ struct _PyGObjectSignalClosure
 {
   GClosure parent;
   guint signal_id;
+  gulong handler_id;
   guint max_arg_count;
+  PyGObjectSignalFlags flags;
+  const PyGObjectSignalSignature * signature;
+  guint first_arg;
+  guint n_args;
+  guint max_batch_size;
+  PyGObjectSignalBatch * batch;
+  PyGObjectSignalQueue * queue;
+  PyGObjectSignalRouter * router;
+  PyGObjectSignalLimiter * limiter;
+  PyGObjectSignalFilter * filter;
+  PyGObjectSignalLogSink * log_sink;
+  PyGObjectSignalTap * tap;
+  PyGObjectSignalRecorder * recorder;
+};
+
+struct _PyGObjectSignalKey
+{
+  guint signal_id;
+  guint hash;
+  PyObject * callback;
+};
+
+struct _PyGObjectSignalSignature
+{
+  guint n_values;
+  PyGObjectMarshalValueFunc * marshal_value;
+};
+
+struct _PyGObjectSignalOptions
+{
+  PyGObjectSignalFlags flags;
+  guint max_batch_size;
+  guint max_batch_delay;
+  guint queue_size;
+  PyGObjectSignalQueuePolicy queue_policy;
+  gboolean stream;
+};
+
+struct _PyGObjectSignalBatch
+{
+  GMutex lock;
+  guint max_delay;
+  guint stride;
+  GArray * values;
+  guint length;
+  GSource * source;
+  gboolean invalidated;
+};
+
+struct _PyGObjectSignalLane
+{
+  GValue * slots;
+  gint64 * enqueued_at;
+  guint head;
+  guint length;
+  guint64 delivered;
+  gint64 total_wait;
+  gint64 max_wait;
+};
+
+struct _PyGObjectSignalQueue
+{
+  GMutex lock;
+  GCond cond;
+  guint capacity;
+  PyGObjectSignalQueuePolicy policy;
+  guint stride;
+  PyGObjectSignalLane lanes[PY_GOBJECT_SIGNAL_N_PRIORITIES];
+  guint length;
+  gint priority_length;
+  guint high_water;
+  guint64 dropped;
+  gboolean invalidated;
+  gboolean scheduled;
+  GCancellable * wakeup;
+};
+
+struct _PyGObjectSignalEvent
+{
+  PyGObjectSignalClosure * closure;
+  GArray * values;
+  guint length;
+  guint stride;
+  PyGObjectSignalPriority priority;
+  guint serial;
+};
+
+struct _PyGObjectSignalRouter
+{
+  GMutex lock;
+  GHashTable * routes;
+  GHashTable * priority_tags;
+  gint n_priority_tags;
+  gboolean deliver_unmatched;
+  guint64 routed;
+  guint64 unmatched;
+  guint64 dropped;
+};
+
+struct _PyGObjectSignalLimiter
+{
+  GMutex lock;
+  guint sample_every;
+  guint sample_countdown;
+  gdouble max_rate;
+  gdouble max_burst;
+  gdouble tokens;
+  gint64 refilled_at;
+  guint64 passed;
+  guint64 sampled_out;
+  guint64 throttled;
+};
+
+struct _PyGObjectSignalFilter
+{
+  GMutex lock;
+  gchar * key;
+  GHashTable * values;
+  guint64 passed;
+  guint64 filtered;
+};
+
+struct _PyGObjectSignalLogSink
+{
+  GMutex lock;
+  gboolean enabled;
+  PyTelcoLogLevel min_level;
+  FILE * stream;
+  FILE * file;
+  gchar * path;
+  guint64 file_size;
+  guint64 max_bytes;
+  guint backup_count;
+  GSource * flush_source;
+  PyGObjectSignalLogEntry * ring;
+  guint ring_capacity;
+  guint ring_head;
+  guint ring_length;
+  guint64 written;
+  guint64 filtered;
+  guint64 overwritten;
+  guint64 errors;
+};
+
+struct _PyGObjectSignalLogEntry
+{
+  PyTelcoLogLevel level;
+  gchar * text;
+};
+
+struct _PyTelcoCallbackStats
+{
+  const gchar * signal_name;
+  gchar * callback_name;
+  guint64 calls;
+  guint64 slow;
+  gint64 total_time;
+  gint64 max_time;
+  guint64 histogram[PYTELCO_N_HISTOGRAM_BUCKETS];
+};
+
+struct _PyTelcoGilSiteStats
+{
+  guint64 acquisitions;
+  gint64 total_wait;
+  gint64 max_wait;
+  guint64 histogram[PYTELCO_N_HISTOGRAM_BUCKETS];
+};
+
+/* Updated right after taking the GIL, and read with it held. */
+static PyTelcoGilSiteStats gil_site_stats[PYTELCO_N_GIL_SITES];
+G_STATIC_ASSERT (G_N_ELEMENTS (pytelco_gil_site_names) == PYTELCO_N_GIL_SITES);
+
+struct _PyGObjectSignalTap
+{
+  GMutex lock;
+  gboolean enabled;
+  guint8 * region;
+  gsize region_size;
+#ifdef G_OS_WIN32
+  HANDLE mapping;
+#endif
+  guint32 capacity;
+  guint32 position;
+  guint64 written;
+  guint64 oversized;
+};
+
+/*
+ * Layout of a tap file: this header followed by a ring of `capacity` bytes, a power of two. Positions are byte offsets
+ * that keep counting up and wrap around at 2^32, so consumers compare them modulo 2^32. The producer bumps `reserve`
+ * before overwriting anything and `commit` once a record is complete, which lets a consumer tell if a record it just
+ * copied was overwritten while doing so.
+ */
+struct _PyTelcoTapHeader
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 header_size;
+  guint32 capacity;
+  gint reserve;
+  gint commit;
+  guint32 reserved[9];
+};
+
+/* Each record is followed by the message, its data, and padding up to PYTELCO_TAP_RECORD_ALIGNMENT. */
+struct _PyTelcoTapRecord
+{
+  guint32 size;
+  guint32 flags;
+  guint32 message_length;
+  guint32 data_length;
+};
+
+G_STATIC_ASSERT (sizeof (PyTelcoTapHeader) == 64);
+G_STATIC_ASSERT (sizeof (PyTelcoTapRecord) == PYTELCO_TAP_RECORD_ALIGNMENT);
+
+struct _PyGObjectSignalRecorder
+{
+  GMutex lock;
+  gboolean enabled;
+  FILE * file;
+  gint64 started_at;
+  guint64 recorded;
+  guint64 bytes;
+  guint64 errors;
+};
+
+/*
+ * Layout of a recording: this header followed by one entry per message, each followed by the message, its data, and
+ * padding up to PYTELCO_RECORDING_ALIGNMENT. Timestamps are microseconds since the recording started.
+ */
+struct _PyTelcoRecordingHeader
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 header_size;
+};
+
+struct _PyTelcoRecordingEntry
+{
+  guint64 timestamp;
+  guint32 message_length;
+  guint32 data_length;
+};
+
+G_STATIC_ASSERT (sizeof (PyTelcoRecordingHeader) % PYTELCO_RECORDING_ALIGNMENT == 0);
+G_STATIC_ASSERT (sizeof (PyTelcoRecordingEntry) % PYTELCO_RECORDING_ALIGNMENT == 0);
+
+struct _PyTelcoNativeHandler
+{
+  PyTelcoMessageFunc func;
+  void * user_data;
+  PyTelcoDestroyFunc destroy;
 };
 
 struct _PyDeviceManager
@@ -262,6 +694,22 @@ struct _PySession
 struct _PyScript
 {
   PyGObject parent;
+
+  GHashTable * rpc_requests;
+  guint next_rpc_request_id;
+  GMutex rpc_lock;
+  GCond rpc_cond;
+};
+
+struct _PyScriptRpcRequest
+{
+  guint id;
+  PyObject * on_complete;
+  gboolean waiting;
+  gboolean completed;
+  gboolean aborted;
+  PyObject * value;
+  PyObject * error;
 };
 
 struct _PyRelay
@@ -318,25 +766,195 @@ struct _PyCancellable
   PyGObject parent;
 };
 
+struct _PyBytesView
+{
+  PyObject_HEAD
+
+  GBytes * bytes;
+};
+
+struct _PySignalStream
+{
+  PyObject_HEAD
+
+  PyGObject * owner;
+  PyGObjectSignalClosure * closure;
+};
+
+struct _PyLazyMessage
+{
+  PyObject_HEAD
+
+  gchar * json;
+  gsize length;
+  PyObject * type;
+  PyObject * level;
+  PyObject * tag;
+  PyObject * message;
+};
+
+struct _PyTelcoJsonParser
+{
+  const gchar * start;
+  const gchar * cursor;
+  const gchar * end;
+  guint depth;
+  GString * scratch;
+};
+
+struct _PyTelcoCborParser
+{
+  const guint8 * start;
+  const guint8 * cursor;
+  const guint8 * end;
+  guint depth;
+};
+
 static PyObject * PyGObject_new_take_handle (gpointer handle, const PyGObjectType * type);
 static PyObject * PyGObject_try_get_from_handle (gpointer handle);
 static int PyGObject_init (PyGObject * self);
 static void PyGObject_dealloc (PyGObject * self);
 static void PyGObject_take_handle (PyGObject * self, gpointer handle, const PyGObjectType * type);
 static gpointer PyGObject_steal_handle (PyGObject * self);
-static PyObject * PyGObject_on (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_on (PyGObject * self, PyObject * args, PyObject * kw);
 static PyObject * PyGObject_off (PyGObject * self, PyObject * args);
-static gint PyGObject_compare_signal_closure_callback (PyGObjectSignalClosure * closure, PyObject * callback);
-static gboolean PyGObject_parse_signal_method_args (PyObject * args, GType instance_type, guint * signal_id, PyObject ** callback);
+static PyObject * PyGObject_off_all (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_queue_stats (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_route (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_route_fallback (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_route_stats (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_priority_tags (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_limits (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_limit_stats (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_filter (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_filter_stats (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_log_sink (PyGObject * self, PyObject * args, PyObject * kw);
+static PyObject * PyGObject_tail_log_sink (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_log_sink_stats (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_tap (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_tap_stats (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_set_recorder (PyGObject * self, PyObject * args);
+static PyObject * PyGObject_get_recorder_stats (PyGObject * self, PyObject * args);
+static PyGObjectSignalClosure * PyGObject_find_signal_closure (PyGObject * self, const gchar * signal_name, PyObject * callback);
+static PyGObjectSignalClosure * PyGObject_find_message_closure (PyGObject * self, const gchar * signal_name, PyObject * callback);
+static PyGObjectSignalClosure * PyGObject_find_script_message_closure (PyGObject * self, const gchar * signal_name, PyObject * callback);
+static PyGObjectSignalRouter * PyGObject_obtain_signal_router (PyGObject * self, const gchar * signal_name, PyObject * callback);
+static PyObject * PyGObject_open_stream (PyGObject * self, PyObject * args, PyObject * kw);
+static void PyGObject_add_signal_closure (PyGObject * self, GClosure * closure);
+static PyGObjectSignalClosure * PyGObject_lookup_signal_closure (PyGObject * self, guint signal_id, PyObject * callback);
+static gboolean PyGObject_remove_signal_closure (PyGObject * self, PyGObjectSignalClosure * closure);
+static void PyGObject_disconnect_signal_closure (PyGObjectSignalClosure * closure, PyGObject * self);
+static void PyGObjectSignalKey_init (PyGObjectSignalKey * key, guint signal_id, PyObject * callback);
+static void PyGObjectSignalKey_free (PyGObjectSignalKey * key);
+static guint PyGObjectSignalKey_hash (const PyGObjectSignalKey * key);
+static gboolean PyGObjectSignalKey_equal (const PyGObjectSignalKey * a, const PyGObjectSignalKey * b);
+static gboolean PyGObject_parse_signal_method_args (PyObject * args, PyObject * kw, GType instance_type, guint * signal_id, PyObject ** callback,
+    PyGObjectSignalOptions * options);
+static gboolean PyGObject_parse_signal_options (PyObject * kw, GType instance_type, PyGObjectSignalOptions * options);
+static gboolean PyGObject_lookup_signal (const gchar * signal_name, GType instance_type, guint * signal_id);
 static const gchar * PyGObject_class_name_from_c (const gchar * cname);
-static GClosure * PyGObject_make_closure_for_signal (guint signal_id, PyObject * callback, guint max_arg_count);
+static GClosure * PyGObject_make_closure_for_signal (guint signal_id, PyObject * callback, guint max_arg_count,
+    const PyGObjectSignalOptions * options);
 static void PyGObjectSignalClosure_finalize (PyObject * callback);
+static const PyGObjectSignalSignature * PyGObjectSignalSignature_obtain (guint signal_id, PyGObjectSignalFlags flags);
+static PyGObjectMarshalValueFunc PyGObject_get_value_marshaller (GType type, PyGObjectSignalFlags flags);
+static PyGObjectSignalBatch * PyGObjectSignalBatch_new (guint signal_id, const PyGObjectSignalOptions * options);
+static void PyGObjectSignalBatch_free (PyGObjectSignalBatch * self);
+static void PyGObjectSignalBatch_invalidate (PyGObjectSignalBatch * self);
+static void PyGObjectSignalClosure_push_batch (PyGObjectSignalClosure * self, const GValue * params, guint params_length);
+static gboolean PyGObjectSignalClosure_on_batch_timeout (PyGObjectSignalClosure * self);
+static void PyGObjectSignalClosure_flush_batch (PyGObjectSignalClosure * self);
+static PyGObjectSignalQueue * PyGObjectSignalQueue_new (guint signal_id, const PyGObjectSignalOptions * options);
+static void PyGObjectSignalQueue_free (PyGObjectSignalQueue * self);
+static void PyGObjectSignalQueue_invalidate (PyGObjectSignalQueue * self);
+static gboolean PyGObjectSignalQueue_push (PyGObjectSignalQueue * self, const GValue * params, PyGObjectSignalPriority priority);
+static GValue * PyGObjectSignalQueue_take (PyGObjectSignalQueue * self, guint max_length, guint * length);
+static gint64 PyGObjectSignalLane_pop (PyGObjectSignalLane * self, const PyGObjectSignalQueue * queue, GValue * entry);
+static PyObject * PyGObjectSignalQueue_get_stats (PyGObjectSignalQueue * self);
+static gint64 PyGObjectSignalLane_get_average_wait (const PyGObjectSignalLane * self);
+static void PyGObjectSignalQueue_free_values (GValue * values, guint n_values);
+static void PyGObjectSignalClosure_process_queue (PyGObjectSignalClosure * self, gpointer user_data);
+static void PyGObjectSignalClosure_deliver_queued (PyGObjectSignalClosure * self, const GValue * values, guint length);
+static gboolean PyGObjectSignalClosure_may_carry_rpc_reply (PyGObjectSignalClosure * self, const GValue * params);
+static PyGObjectSignalPriority PyGObjectSignalClosure_classify (PyGObjectSignalClosure * self, const GValue * params);
+static gboolean PyGObjectSignalClosure_try_route (PyGObjectSignalClosure * self, const GValue * params);
+static PyGObjectSignalRouter * PyGObjectSignalRouter_new (void);
+static void PyGObjectSignalRouter_free (PyGObjectSignalRouter * self);
+static gboolean PyGObjectSignalRouter_accepts (PyGObjectSignalRouter * self, const GValue * params);
+static gboolean PyGObjectSignalRouter_route (PyGObjectSignalRouter * self, const GValue * params, PyObject ** handler);
+static gboolean PyGObjectSignalRouter_is_priority (PyGObjectSignalRouter * self, const GValue * params);
+static gboolean PyGObjectSignalRouter_peek_tag (const GValue * params, gchar * tag);
+static PyObject * PyGObjectSignalRouter_get_stats (PyGObjectSignalRouter * self);
+static gboolean PyGObjectSignalClosure_admit (PyGObjectSignalClosure * self, PyGObjectSignalLimiter * limiter, const GValue * params);
+static PyGObjectSignalLimiter * PyGObjectSignalLimiter_new (void);
+static void PyGObjectSignalLimiter_free (PyGObjectSignalLimiter * self);
+static void PyGObjectSignalLimiter_configure (PyGObjectSignalLimiter * self, guint sample_every, gdouble max_rate, gdouble max_burst);
+static gboolean PyGObjectSignalLimiter_admit (PyGObjectSignalLimiter * self);
+static PyObject * PyGObjectSignalLimiter_get_stats (PyGObjectSignalLimiter * self);
+static gboolean PyGObjectSignalClosure_filter (PyGObjectSignalClosure * self, PyGObjectSignalFilter * filter, const GValue * params);
+static PyGObjectSignalFilter * PyGObjectSignalFilter_new (void);
+static void PyGObjectSignalFilter_free (PyGObjectSignalFilter * self);
+static void PyGObjectSignalFilter_configure (PyGObjectSignalFilter * self, gchar * key, GHashTable * values);
+static gboolean PyGObjectSignalFilter_accepts (PyGObjectSignalFilter * self, const GValue * params);
+static PyObject * PyGObjectSignalFilter_get_stats (PyGObjectSignalFilter * self);
+static PyGObjectSignalLogSink * PyGObjectSignalLogSink_new (void);
+static void PyGObjectSignalLogSink_free (PyGObjectSignalLogSink * self);
+static void PyGObjectSignalLogSink_configure (PyGObjectSignalLogSink * self, PyGObjectSignalLogSink * config);
+static void PyGObjectSignalLogSink_close (PyGObjectSignalLogSink * self);
+static gboolean PyGObjectSignalLogSink_try_write (PyGObjectSignalLogSink * self, const GValue * params, GClosure * owner);
+static void PyGObjectSignalLogSink_append (PyGObjectSignalLogSink * self, PyTelcoLogLevel level, GString * text);
+static void PyGObjectSignalLogSink_rotate (PyGObjectSignalLogSink * self);
+static void PyGObjectSignalLogSink_flush (PyGObjectSignalLogSink * self);
+static gboolean PyGObjectSignalClosure_on_log_flush_timeout (PyGObjectSignalClosure * self);
+static PyObject * PyGObjectSignalLogSink_tail (PyGObjectSignalLogSink * self, guint count);
+static PyObject * PyGObjectSignalLogSink_get_stats (PyGObjectSignalLogSink * self);
+static PyGObjectSignalTap * PyGObjectSignalTap_new (void);
+static void PyGObjectSignalTap_free (PyGObjectSignalTap * self);
+static gboolean PyGObjectSignalTap_open (PyGObjectSignalTap * self, const gchar * path, guint32 capacity);
+static void PyGObjectSignalTap_configure (PyGObjectSignalTap * self, PyGObjectSignalTap * config);
+static void PyGObjectSignalTap_close (PyGObjectSignalTap * self);
+static void PyGObjectSignalTap_write (PyGObjectSignalTap * self, const GValue * params, guint n_params);
+static PyObject * PyGObjectSignalTap_get_stats (PyGObjectSignalTap * self);
+static PyGObjectSignalRecorder * PyGObjectSignalRecorder_new (void);
+static void PyGObjectSignalRecorder_free (PyGObjectSignalRecorder * self);
+static FILE * PyGObjectSignalRecorder_open (const gchar * path);
+static void PyGObjectSignalRecorder_configure (PyGObjectSignalRecorder * self, FILE * file);
+static void PyGObjectSignalRecorder_write (PyGObjectSignalRecorder * self, const GValue * params, guint n_params);
+static PyObject * PyGObjectSignalRecorder_get_stats (PyGObjectSignalRecorder * self);
+static void PyGObjectSignalClosure_deliver (PyGObjectSignalClosure * self, const GValue * values, guint length, guint stride);
+static PyObject * PyGObjectSignalClosure_marshal_batch (PyGObjectSignalClosure * self, const GValue * values, guint length, guint stride);
+static gboolean PyGObjectSignalClosure_try_dispatch (PyGObjectSignalClosure * self, GArray * values, guint length, guint stride,
+    PyGObjectSignalPriority priority);
+static gint PyGObjectSignalEvent_compare (const PyGObjectSignalEvent * a, const PyGObjectSignalEvent * b, gpointer user_data);
+static void PyGObjectSignalEvent_free (PyGObjectSignalEvent * event);
 static void PyGObjectSignalClosure_marshal (GClosure * closure, GValue * return_gvalue, guint n_param_values, const GValue * param_values,
     gpointer invocation_hint, gpointer marshal_data);
-static PyObject * PyGObjectSignalClosure_marshal_params (const GValue * params, guint params_length);
+static PyObject * PyGObjectSignalClosure_marshal_args (PyGObjectSignalClosure * self, const GValue * params);
+static void PyGObjectSignalClosure_invoke (PyGObjectSignalClosure * self, PyObject * callback, const GValue * params);
 static PyObject * PyGObject_marshal_value (const GValue * value);
+static PyObject * PyGObject_marshal_boolean_value (const GValue * value);
+static PyObject * PyGObject_marshal_int_value (const GValue * value);
+static PyObject * PyGObject_marshal_uint_value (const GValue * value);
+static PyObject * PyGObject_marshal_float_value (const GValue * value);
+static PyObject * PyGObject_marshal_double_value (const GValue * value);
+static PyObject * PyGObject_marshal_string_value (const GValue * value);
+static PyObject * PyGObject_marshal_json_value (const GValue * value);
+static PyObject * PyGObject_marshal_lazy_json_value (const GValue * value);
+static PyObject * PyGObject_marshal_variant_value (const GValue * value);
+static PyObject * PyGObject_marshal_enum_value (const GValue * value);
+static PyObject * PyGObject_marshal_bytes_value (const GValue * value);
+static PyObject * PyGObject_marshal_bytes_view_value (const GValue * value);
+static PyObject * PyGObject_marshal_object_value (const GValue * value);
 static PyObject * PyGObject_marshal_string (const gchar * str);
+static PyObject * PyGObject_marshal_json (const gchar * json);
 static gboolean PyGObject_unmarshal_string (PyObject * value, gchar ** str);
+static gboolean PyGObject_unmarshal_data (PyObject * value, GBytes ** data);
+static int PyGObject_convert_data (PyObject * value, void * result);
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+static void PyGObject_release_buffer (Py_buffer * view);
+#else
+static void PyGObject_release_bytes_object (PyObject * object);
+#endif
 static PyObject * PyGObject_marshal_datetime (const gchar * iso8601_text);
 static PyObject * PyGObject_marshal_strv (gchar * const * strv, gint length);
 static gboolean PyGObject_unmarshal_strv (PyObject * value, gchar *** strv, gint * length);
@@ -346,8 +964,31 @@ static PyObject * PyGObject_marshal_enum (gint value, GType type);
 static gboolean PyGObject_unmarshal_enum (const gchar * str, GType type, gpointer value);
 static PyObject * PyGObject_marshal_bytes (GBytes * bytes);
 static PyObject * PyGObject_marshal_bytes_non_nullable (GBytes * bytes);
+static PyObject * PyGObject_marshal_bytes_view (GBytes * bytes);
 static PyObject * PyGObject_marshal_variant (GVariant * variant);
-static gboolean PyGObject_unmarshal_variant (PyObject * value, GVariant ** variant);
+static PyObject * PyGObject_marshal_variant_boolean (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_byte (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_int16 (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_uint16 (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_int32 (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_uint32 (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_int64 (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_uint64 (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_handle (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_double (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_string (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_variant (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_maybe (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_array (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_dict (GVariant * variant);
+static PyObject * PyGObject_marshal_variant_tuple (GVariant * variant);
+static PyObject * PyGObject_marshal_dict_key (const gchar * key);
+static gboolean PyGObject_unmarshal_variant (PyObject * value, guint depth, GVariant ** variant);
+static gboolean PyGObject_unmarshal_variant_int (PyObject * value, GVariant ** variant);
+static gboolean PyGObject_unmarshal_variant_bytes (PyObject * value, GVariant ** variant);
+static gboolean PyGObject_unmarshal_variant_sequence (PyObject * value, gboolean as_tuple, guint depth,
+    GVariant ** variant);
+static gboolean PyGObject_unmarshal_variant_dict (PyObject * value, guint depth, GVariant ** variant);
 static PyObject * PyGObject_marshal_parameters_dict (GHashTable * dict);
 static PyObject * PyGObject_marshal_socket_address (GSocketAddress * address);
 static gboolean PyGObject_unmarshal_certificate (const gchar * str, GTlsCertificate ** certificate);
@@ -425,6 +1066,7 @@ static PyObject * PyCrash_repr (PyCrash * self);
 static PyObject * PyBus_new_take_handle (TelcoBus * handle);
 static PyObject * PyBus_attach (PySession * self);
 static PyObject * PyBus_post (PyScript * self, PyObject * args, PyObject * kw);
+static PyObject * PyBus_post_many (PyScript * self, PyObject * args, PyObject * kw);
 
 static PyObject * PySession_new_take_handle (TelcoSession * handle);
 static int PySession_init (PySession * self, PyObject * args, PyObject * kw);
@@ -449,13 +1091,25 @@ static PyObject * PySession_join_portal (PySession * self, PyObject * args, PyOb
 static TelcoPortalOptions * PySession_parse_portal_options (const gchar * certificate_value, const gchar * token, PyObject * acl_value);
 
 static PyObject * PyScript_new_take_handle (TelcoScript * handle);
+static int PyScript_init (PyScript * self, PyObject * args, PyObject * kw);
+static void PyScript_dealloc (PyScript * self);
 static PyObject * PyScript_is_destroyed (PyScript * self);
 static PyObject * PyScript_load (PyScript * self);
 static PyObject * PyScript_unload (PyScript * self);
 static PyObject * PyScript_eternalize (PyScript * self);
 static PyObject * PyScript_post (PyScript * self, PyObject * args, PyObject * kw);
+static PyObject * PyScript_post_many (PyScript * self, PyObject * args, PyObject * kw);
 static PyObject * PyScript_enable_debugger (PyScript * self, PyObject * args, PyObject * kw);
 static PyObject * PyScript_disable_debugger (PyScript * self);
+static PyObject * PyScript_begin_rpc (PyScript * self, PyObject * args);
+static PyObject * PyScript_wait_for_rpc (PyScript * self, PyObject * args);
+static PyObject * PyScript_abort_rpcs (PyScript * self);
+static PyObject * PyScript_enumerate_pending_rpcs (PyScript * self);
+static gboolean PyScript_try_dispatch_rpc_reply (PyScript * self, const GValue * params, guint params_length, PyGObjectSignalFlags flags);
+static gboolean PyScript_fail_undecodable_rpc_reply (PyScript * self, const gchar * raw_message);
+static void PyScript_complete_rpc_request (PyScript * self, PyScriptRpcRequest * request, PyObject * value, PyObject * error);
+static void PyScript_on_rpc_cancelled (GCancellable * cancellable, PyScript * self);
+static void PyScriptRpcRequest_free (PyScriptRpcRequest * request);
 
 static int PyRelay_init (PyRelay * self, PyObject * args, PyObject * kw);
 static void PyRelay_init_from_handle (PyRelay * self, TelcoRelay * handle);
@@ -525,15 +1179,142 @@ static void PyCancellable_on_cancelled (GCancellable * cancellable, PyObject * c
 static void PyCancellable_destroy_callback (PyObject * callback);
 static PyObject * PyCancellable_cancel (PyCancellable * self);
 
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+static PyObject * PyBytesView_new_take_bytes (GBytes * bytes);
+static void PyBytesView_dealloc (PyBytesView * self);
+static PyObject * PyBytesView_repr (PyBytesView * self);
+static Py_ssize_t PyBytesView_length (PyBytesView * self);
+static int PyBytesView_get_buffer (PyBytesView * self, Py_buffer * view, int flags);
+static PyObject * PyBytesView_tobytes (PyBytesView * self);
+#endif
+
+static PyObject * PySignalStream_new (PyGObject * owner, GClosure * closure);
+static void PySignalStream_dealloc (PySignalStream * self);
+static PyObject * PySignalStream_repr (PySignalStream * self);
+static PyObject * PySignalStream_fileno (PySignalStream * self);
+static PyObject * PySignalStream_drain (PySignalStream * self, PyObject * args, PyObject * kw);
+static PyObject * PySignalStream_wait (PySignalStream * self, PyObject * args);
+static PyObject * PySignalStream_is_closed (PySignalStream * self);
+static PyObject * PySignalStream_close (PySignalStream * self);
+static PyObject * PySignalStream_get_stats (PySignalStream * self);
+
+static PyObject * PyLazyMessage_new_from_json (const gchar * json);
+static void PyLazyMessage_dealloc (PyLazyMessage * self);
+static PyObject * PyLazyMessage_repr (PyLazyMessage * self);
+static gboolean PyLazyMessage_scan (PyLazyMessage * self);
+static gboolean PyLazyMessage_scan_tag (PyLazyMessage * self, PyTelcoJsonParser * parser);
+static PyObject * PyLazyMessage_materialize (PyLazyMessage * self);
+static PyObject * PyLazyMessage_lookup_eager (PyLazyMessage * self, PyObject * key, gboolean * found);
+static PyObject * PyLazyMessage_subscript (PyLazyMessage * self, PyObject * key);
+static int PyLazyMessage_ass_subscript (PyLazyMessage * self, PyObject * key, PyObject * value);
+static Py_ssize_t PyLazyMessage_length (PyLazyMessage * self);
+static int PyLazyMessage_contains (PyLazyMessage * self, PyObject * key);
+static PyObject * PyLazyMessage_iter (PyLazyMessage * self);
+static PyObject * PyLazyMessage_richcompare (PyLazyMessage * self, PyObject * other, int op);
+static PyObject * PyLazyMessage_get (PyLazyMessage * self, PyObject * args);
+static PyObject * PyLazyMessage_keys (PyLazyMessage * self);
+static PyObject * PyLazyMessage_values (PyLazyMessage * self);
+static PyObject * PyLazyMessage_items (PyLazyMessage * self);
+static PyObject * PyLazyMessage_to_dict (PyLazyMessage * self);
+static PyObject * PyLazyMessage_is_materialized (PyLazyMessage * self);
+
 static PyObject * PyTelco_raise (GError * error);
+static gboolean PyTelco_unmarshal_post_batch (PyObject * messages, PyObject * datas, gchar *** raw_messages, GBytes *** raw_datas,
+    Py_ssize_t * length);
+static void PyTelco_free_post_batch (gchar ** raw_messages, GBytes ** raw_datas, Py_ssize_t length);
 static gboolean PyTelco_is_string (PyObject * obj);
 static gchar * PyTelco_repr (PyObject * obj);
 static guint PyTelco_get_max_argument_count (PyObject * callable);
 
+static PyObject * PyTelco_json_decode (const gchar * json, gsize length);
+static PyObject * PyTelcoJsonParser_parse_value (PyTelcoJsonParser * self);
+static PyObject * PyTelcoJsonParser_parse_object (PyTelcoJsonParser * self);
+static PyObject * PyTelcoJsonParser_parse_array (PyTelcoJsonParser * self);
+static PyObject * PyTelcoJsonParser_parse_string (PyTelcoJsonParser * self);
+static PyObject * PyTelcoJsonParser_parse_number (PyTelcoJsonParser * self);
+static gboolean PyTelcoJsonParser_parse_hex4 (PyTelcoJsonParser * self, gunichar * c);
+static gboolean PyTelcoJsonParser_consume_literal (PyTelcoJsonParser * self, const gchar * literal);
+static void PyTelcoJsonParser_skip_whitespace (PyTelcoJsonParser * self);
+static gboolean PyTelcoJsonParser_skip_value (PyTelcoJsonParser * self);
+static gboolean PyTelcoJsonParser_scan_plain_string (PyTelcoJsonParser * self, const gchar ** str, gsize * length);
+static gboolean PyTelcoJsonParser_scan_payload_tag (PyTelcoJsonParser * self, const gchar ** tag, gsize * tag_length);
+static gboolean PyTelco_peek_message_tag (const gchar * json, gboolean * is_send, const gchar ** tag, gsize * tag_length);
+static gboolean PyTelco_peek_message_value (const gchar * json, const gchar * key, gchar * value);
+static gboolean PyTelcoJsonParser_scan_string (PyTelcoJsonParser * self, GString * str);
+static gboolean PyTelcoJsonParser_scan_hex4 (PyTelcoJsonParser * self, gunichar * c);
+static gboolean PyTelco_peek_log_message (const gchar * json, PyTelcoLogLevel * level, GString * text);
+static gboolean PyTelco_parse_log_level (const gchar * name, gsize length, PyTelcoLogLevel * level);
+static PyObject * PyTelcoJsonParser_raise (PyTelcoJsonParser * self, const gchar * message);
+static PyObject * PyTelco_cbor_encode (PyObject * self, PyObject * args);
+static gboolean PyTelco_cbor_encode_value (GByteArray * buffer, PyObject * value, guint depth);
+static gboolean PyTelco_cbor_encode_int (GByteArray * buffer, PyObject * value);
+static void PyTelco_cbor_append_head (GByteArray * buffer, guint8 major_type, guint64 argument);
+static PyObject * PyTelco_cbor_decode (PyObject * self, PyObject * args);
+static PyObject * PyTelcoCborParser_parse_value (PyTelcoCborParser * self);
+static PyObject * PyTelcoCborParser_parse_array (PyTelcoCborParser * self, guint64 length);
+static PyObject * PyTelcoCborParser_parse_map (PyTelcoCborParser * self, guint64 length);
+static PyObject * PyTelcoCborParser_parse_simple (PyTelcoCborParser * self, guint8 info);
+static gboolean PyTelcoCborParser_read_argument (PyTelcoCborParser * self, guint8 info, guint64 * argument);
+static gdouble PyTelcoCborParser_decode_half (guint16 half);
+static PyObject * PyTelcoCborParser_raise (PyTelcoCborParser * self, const gchar * message);
+
+static PyObject * PyTelco_start_dispatcher (PyObject * self, PyObject * args, PyObject * kw);
+static PyObject * PyTelco_stop_dispatcher (PyObject * self);
+static gpointer PyTelco_process_dispatcher_lane (GAsyncQueue * lane);
+
+static PyObject * PyTelco_set_watchdog (PyObject * self, PyObject * args, PyObject * kw);
+static PyObject * PyTelco_get_callback_stats (PyObject * self, PyObject * args);
+static PyObject * PyTelco_reset_callback_stats (PyObject * self, PyObject * args);
+static PyObject * PyTelco_record_callback_time (PyObject * self, PyObject * args);
+static void PyTelco_observe_callback (const gchar * signal_name, PyObject * callback, gint64 elapsed);
+static gchar * PyTelco_describe_callable (PyObject * callable);
+static void PyTelcoCallbackStats_free (PyTelcoCallbackStats * stats);
+
+static PyGILState_STATE PyTelco_ensure_gil (PyTelcoGilSite site);
+static PyObject * PyTelco_get_gil_stats (PyObject * self, PyObject * args);
+static PyObject * PyTelco_reset_gil_stats (PyObject * self, PyObject * args);
+
+static guint PyTelco_histogram_bucket (gint64 microseconds);
+static PyObject * PyTelco_marshal_histogram (const guint64 * histogram);
+
+static unsigned long PyTelco_capi_add_message_handler (PyObject * object, const char * signal_name, PyTelcoMessageFunc func,
+    void * user_data, PyTelcoDestroyFunc destroy);
+static int PyTelco_capi_remove_message_handler (PyObject * object, unsigned long handler_id);
+static GObject * PyTelco_capi_resolve_handle (PyObject * object);
+static void PyTelco_capi_on_message (GObject * instance, const gchar * message, GBytes * data,
+    PyTelcoNativeHandler * handler);
+static void PyTelco_capi_free_handler (PyTelcoNativeHandler * handler, GClosure * closure);
+static const void * PyTelco_capi_bytes_get_data (GBytes * bytes, size_t * size);
+static GBytes * PyTelco_capi_bytes_ref (GBytes * bytes);
+static void PyTelco_capi_bytes_unref (GBytes * bytes);
+
 static PyMethodDef PyGObject_methods[] =
 {
-  { "on", (PyCFunction) PyGObject_on, METH_VARARGS, "Add a signal handler." },
+  { "on", (PyCFunction) PyGObject_on, METH_VARARGS | METH_KEYWORDS, "Add a signal handler." },
   { "off", (PyCFunction) PyGObject_off, METH_VARARGS, "Remove a signal handler." },
+  { "off_all", (PyCFunction) PyGObject_off_all, METH_VARARGS, "Remove all handlers of a signal." },
+  { "get_queue_stats", (PyCFunction) PyGObject_get_queue_stats, METH_VARARGS, "Get statistics for a queued signal handler." },
+  { "set_route", (PyCFunction) PyGObject_set_route, METH_VARARGS, "Route messages with the given tag to a separate handler." },
+  { "set_route_fallback", (PyCFunction) PyGObject_set_route_fallback, METH_VARARGS,
+    "Choose whether unrouted messages reach the signal handler." },
+  { "get_route_stats", (PyCFunction) PyGObject_get_route_stats, METH_VARARGS, "Get statistics for a routed signal handler." },
+  { "set_priority_tags", (PyCFunction) PyGObject_set_priority_tags, METH_VARARGS,
+    "Let messages with the given tags overtake others queued for a signal handler." },
+  { "set_limits", (PyCFunction) PyGObject_set_limits, METH_VARARGS, "Sample or rate limit emissions before they reach a signal handler." },
+  { "get_limit_stats", (PyCFunction) PyGObject_get_limit_stats, METH_VARARGS, "Get statistics for a rate limited signal handler." },
+  { "set_filter", (PyCFunction) PyGObject_set_filter, METH_VARARGS,
+    "Only let messages with one of the given values for a top-level key reach a signal handler." },
+  { "get_filter_stats", (PyCFunction) PyGObject_get_filter_stats, METH_VARARGS, "Get statistics for a filtered signal handler." },
+  { "set_log_sink", (PyCFunction) PyGObject_set_log_sink, METH_VARARGS | METH_KEYWORDS,
+    "Write log messages natively instead of passing them to a signal handler." },
+  { "tail_log_sink", (PyCFunction) PyGObject_tail_log_sink, METH_VARARGS, "Get the most recent log messages kept by a log sink." },
+  { "get_log_sink_stats", (PyCFunction) PyGObject_get_log_sink_stats, METH_VARARGS, "Get statistics for a log sink." },
+  { "set_tap", (PyCFunction) PyGObject_set_tap, METH_VARARGS,
+    "Mirror raw messages into a memory-mapped ring buffer file for other processes to read." },
+  { "get_tap_stats", (PyCFunction) PyGObject_get_tap_stats, METH_VARARGS, "Get statistics for a message tap." },
+  { "set_recorder", (PyCFunction) PyGObject_set_recorder, METH_VARARGS, "Record raw messages with timestamps to a file." },
+  { "get_recorder_stats", (PyCFunction) PyGObject_get_recorder_stats, METH_VARARGS, "Get statistics for a message recorder." },
+  { "open_stream", (PyCFunction) PyGObject_open_stream, METH_VARARGS | METH_KEYWORDS, "Queue a signal's emissions for polling." },
   { NULL }
 };
 
@@ -630,6 +1411,7 @@ static PyMethodDef PyBus_methods[] =
 {
   { "attach", (PyCFunction) PyBus_attach, METH_NOARGS, "Attach to the bus." },
   { "post", (PyCFunction) PyBus_post, METH_VARARGS | METH_KEYWORDS, "Post a JSON-encoded message to the bus." },
+  { "post_many", (PyCFunction) PyBus_post_many, METH_VARARGS | METH_KEYWORDS, "Post a batch of JSON-encoded messages to the bus." },
   { NULL }
 };
 
@@ -662,8 +1444,13 @@ static PyMethodDef PyScript_methods[] =
   { "unload", (PyCFunction) PyScript_unload, METH_NOARGS, "Unload the script." },
   { "eternalize", (PyCFunction) PyScript_eternalize, METH_NOARGS, "Eternalize the script." },
   { "post", (PyCFunction) PyScript_post, METH_VARARGS | METH_KEYWORDS, "Post a JSON-encoded message to the script." },
+  { "post_many", (PyCFunction) PyScript_post_many, METH_VARARGS | METH_KEYWORDS, "Post a batch of JSON-encoded messages to the script." },
   { "enable_debugger", (PyCFunction) PyScript_enable_debugger, METH_VARARGS | METH_KEYWORDS, "Enable the Node.js compatible script debugger." },
   { "disable_debugger", (PyCFunction) PyScript_disable_debugger, METH_NOARGS, "Disable the Node.js compatible script debugger." },
+  { "begin_rpc", (PyCFunction) PyScript_begin_rpc, METH_VARARGS, "Register a pending RPC request and return its ID." },
+  { "wait_for_rpc", (PyCFunction) PyScript_wait_for_rpc, METH_VARARGS, "Wait for the reply to a pending RPC request." },
+  { "abort_rpcs", (PyCFunction) PyScript_abort_rpcs, METH_NOARGS, "Fail all pending RPC requests." },
+  { "enumerate_pending_rpcs", (PyCFunction) PyScript_enumerate_pending_rpcs, METH_NOARGS, "Enumerate IDs of pending RPC requests." },
   { NULL }
 };
 
@@ -742,6 +1529,114 @@ static PyMethodDef PyCancellable_methods[] =
   { NULL }
 };
 
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+static PyMethodDef PyBytesView_methods[] =
+{
+  { "tobytes", (PyCFunction) PyBytesView_tobytes, METH_NOARGS, "Copy the data into a bytes object." },
+  { "__bytes__", (PyCFunction) PyBytesView_tobytes, METH_NOARGS, "Copy the data into a bytes object." },
+  { NULL }
+};
+
+static PyType_Slot PyBytesView_slots[] =
+{
+  { Py_tp_doc, "Telco Bytes View" },
+  { Py_tp_dealloc, PyBytesView_dealloc },
+  { Py_tp_repr, PyBytesView_repr },
+  { Py_tp_methods, PyBytesView_methods },
+  { Py_sq_length, PyBytesView_length },
+  { Py_bf_getbuffer, PyBytesView_get_buffer },
+  { 0 },
+};
+
+static PyType_Spec PyBytesView_spec =
+{
+  .name = "_telco.BytesView",
+  .basicsize = sizeof (PyBytesView),
+  .itemsize = 0,
+  .flags = Py_TPFLAGS_DEFAULT,
+  .slots = PyBytesView_slots,
+};
+
+static PyObject * PyBytesView_type;
+#endif
+
+static PyMethodDef PySignalStream_methods[] =
+{
+  { "fileno", (PyCFunction) PySignalStream_fileno, METH_NOARGS, "Get a file descriptor that becomes readable when emissions are pending, or -1." },
+  { "drain", (PyCFunction) PySignalStream_drain, METH_VARARGS | METH_KEYWORDS, "Take pending emissions as a list of argument tuples." },
+  { "wait", (PyCFunction) PySignalStream_wait, METH_VARARGS, "Block until emissions are pending or the stream is closed." },
+  { "is_closed", (PyCFunction) PySignalStream_is_closed, METH_NOARGS, "Query whether the stream is closed and drained." },
+  { "close", (PyCFunction) PySignalStream_close, METH_NOARGS, "Stop queueing emissions." },
+  { "get_stats", (PyCFunction) PySignalStream_get_stats, METH_NOARGS, "Get statistics for the stream's queue." },
+  { NULL }
+};
+
+static PyType_Slot PySignalStream_slots[] =
+{
+  { Py_tp_doc, "Telco Signal Stream" },
+  { Py_tp_dealloc, PySignalStream_dealloc },
+  { Py_tp_repr, PySignalStream_repr },
+  { Py_tp_methods, PySignalStream_methods },
+  { 0 },
+};
+
+static PyType_Spec PySignalStream_spec =
+{
+  .name = "_telco.SignalStream",
+  .basicsize = sizeof (PySignalStream),
+  .itemsize = 0,
+  .flags = Py_TPFLAGS_DEFAULT,
+  .slots = PySignalStream_slots,
+};
+
+static PyObject * PySignalStream_type;
+
+static PyMethodDef PyLazyMessage_methods[] =
+{
+  { "get", (PyCFunction) PyLazyMessage_get, METH_VARARGS, "Get a field, or the default if the message doesn't have it." },
+  { "keys", (PyCFunction) PyLazyMessage_keys, METH_NOARGS, "Get the field names." },
+  { "values", (PyCFunction) PyLazyMessage_values, METH_NOARGS, "Get the field values." },
+  { "items", (PyCFunction) PyLazyMessage_items, METH_NOARGS, "Get the fields as (name, value) pairs." },
+  { "to_dict", (PyCFunction) PyLazyMessage_to_dict, METH_NOARGS, "Parse the whole message and return it as a dict." },
+  { "is_materialized", (PyCFunction) PyLazyMessage_is_materialized, METH_NOARGS, "Query whether the whole message has been parsed." },
+  { NULL }
+};
+
+static PyMemberDef PyLazyMessage_members[] =
+{
+  { "tag", T_OBJECT_EX, G_STRUCT_OFFSET (PyLazyMessage, tag), READONLY,
+    "First element of an array payload, or the type field of an object payload. None otherwise." },
+  { NULL }
+};
+
+static PyType_Slot PyLazyMessage_slots[] =
+{
+  { Py_tp_doc, "Telco Lazy Message" },
+  { Py_tp_dealloc, PyLazyMessage_dealloc },
+  { Py_tp_repr, PyLazyMessage_repr },
+  { Py_tp_hash, PyObject_HashNotImplemented },
+  { Py_tp_iter, PyLazyMessage_iter },
+  { Py_tp_richcompare, PyLazyMessage_richcompare },
+  { Py_tp_methods, PyLazyMessage_methods },
+  { Py_tp_members, PyLazyMessage_members },
+  { Py_mp_subscript, PyLazyMessage_subscript },
+  { Py_mp_ass_subscript, PyLazyMessage_ass_subscript },
+  { Py_mp_length, PyLazyMessage_length },
+  { Py_sq_contains, PyLazyMessage_contains },
+  { 0 },
+};
+
+static PyType_Spec PyLazyMessage_spec =
+{
+  .name = "_telco.LazyMessage",
+  .basicsize = sizeof (PyLazyMessage),
+  .itemsize = 0,
+  .flags = Py_TPFLAGS_DEFAULT,
+  .slots = PyLazyMessage_slots,
+};
+
+static PyObject * PyLazyMessage_type;
+
 PYTELCO_DEFINE_BASETYPE ("_telco.Object", GObject, NULL, g_object_unref,
   { Py_tp_doc, "Telco Object" },
   { Py_tp_init, PyGObject_init },
@@ -820,6 +1715,8 @@ PYTELCO_DEFINE_TYPE ("_telco.Session", Session, GObject, PySession_init_from_han
 
 PYTELCO_DEFINE_TYPE ("_telco.Script", Script, GObject, NULL, telco_unref,
   { Py_tp_doc, "Telco Script" },
+  { Py_tp_init, PyScript_init },
+  { Py_tp_dealloc, PyScript_dealloc },
   { Py_tp_methods, PyScript_methods },
 );
 
@@ -875,6 +1772,38 @@ PYTELCO_DEFINE_TYPE ("_telco.Cancellable", Cancellable, GObject, NULL, g_object_
   { Py_tp_methods, PyCancellable_methods },
 );
 
+static PyMethodDef PyTelco_functions[] =
+{
+  { "start_dispatcher", (PyCFunction) PyTelco_start_dispatcher, METH_VARARGS | METH_KEYWORDS,
+    "Run signal callbacks on dedicated dispatcher threads instead of the thread emitting them." },
+  { "stop_dispatcher", (PyCFunction) PyTelco_stop_dispatcher, METH_NOARGS,
+    "Deliver the callbacks already handed to the dispatcher threads, then stop and join them." },
+  { "cbor_encode", (PyCFunction) PyTelco_cbor_encode, METH_VARARGS, "Encode a value as CBOR." },
+  { "cbor_decode", (PyCFunction) PyTelco_cbor_decode, METH_VARARGS, "Decode a single CBOR-encoded value." },
+  { "set_watchdog", (PyCFunction) PyTelco_set_watchdog, METH_VARARGS | METH_KEYWORDS,
+    "Time signal callbacks and report those slower than a threshold." },
+  { "get_callback_stats", (PyCFunction) PyTelco_get_callback_stats, METH_NOARGS, "Get timing statistics for signal callbacks." },
+  { "reset_callback_stats", (PyCFunction) PyTelco_reset_callback_stats, METH_NOARGS,
+    "Discard timing statistics for signal callbacks." },
+  { "record_callback_time", (PyCFunction) PyTelco_record_callback_time, METH_VARARGS,
+    "Account for a callback invoked from Python on behalf of a signal." },
+  { "get_gil_stats", (PyCFunction) PyTelco_get_gil_stats, METH_NOARGS,
+    "Get how long each place that takes the GIL from a foreign thread waited for it." },
+  { "reset_gil_stats", (PyCFunction) PyTelco_reset_gil_stats, METH_NOARGS, "Discard GIL wait statistics." },
+  { NULL }
+};
+
+static const PyTelcoCApi pytelco_capi =
+{
+  PYTELCO_CAPI_VERSION,
+  sizeof (PyTelcoCApi),
+  PyTelco_capi_add_message_handler,
+  PyTelco_capi_remove_message_handler,
+  PyTelco_capi_bytes_get_data,
+  PyTelco_capi_bytes_ref,
+  PyTelco_capi_bytes_unref,
+};
+
 
 static PyObject *
 PyGObject_new_take_handle (gpointer handle, const PyGObjectType * pytype)
@@ -932,7 +1861,7 @@ PyGObject_dealloc (PyGObject * self)
     Py_END_ALLOW_THREADS
   }
 
-  ((freefunc) PyType_GetSlot (Py_TYPE (self), Py_tp_free)) (self);
+  ((freefunc) PyType_GetSlot (Py_TYPE ((PyObject *) self), Py_tp_free)) (self);
 }
 
 static void
@@ -949,20 +1878,19 @@ static gpointer
 PyGObject_steal_handle (PyGObject * self)
 {
   gpointer handle = self->handle;
-  GSList * entry;
+  GHashTableIter iter;
+  GQueue * closures;
 
   if (handle == NULL)
     return NULL;
 
-  for (entry = self->signal_closures; entry != NULL; entry = entry->next)
+  if (self->signal_closures != NULL)
   {
-    PyGObjectSignalClosure * closure = entry->data;
-    G_GNUC_UNUSED guint num_matches;
-
-    num_matches = g_signal_handlers_disconnect_matched (handle, G_SIGNAL_MATCH_CLOSURE, closure->signal_id, 0, &closure->parent, NULL, NULL);
-    g_assert (num_matches == 1);
+    g_hash_table_iter_init (&iter, self->signal_closures);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &closures))
+      g_queue_foreach (closures, (GFunc) PyGObject_disconnect_signal_closure, self);
+    g_clear_pointer (&self->signal_closures, g_hash_table_unref);
   }
-  g_clear_pointer (&self->signal_closures, g_slist_free);
 
   g_object_set_data (G_OBJECT (handle), "pyobject", NULL);
 
@@ -972,21 +1900,22 @@ PyGObject_steal_handle (PyGObject * self)
 }
 
 static PyObject *
-PyGObject_on (PyGObject * self, PyObject * args)
+PyGObject_on (PyGObject * self, PyObject * args, PyObject * kw)
 {
   GType instance_type;
   guint signal_id;
   PyObject * callback;
+  PyGObjectSignalOptions options;
   guint max_arg_count, allowed_arg_count_including_sender;
   GSignalQuery query;
   GClosure * closure;
 
   instance_type = G_OBJECT_TYPE (self->handle);
 
-  if (!PyGObject_parse_signal_method_args (args, instance_type, &signal_id, &callback))
+  if (!PyGObject_parse_signal_method_args (args, kw, instance_type, &signal_id, &callback, &options))
     return NULL;
 
-  max_arg_count = PyTelco_get_max_argument_count (callback);
+  max_arg_count = (options.max_batch_size == 0) ? PyTelco_get_max_argument_count (callback) : G_MAXUINT;
   if (max_arg_count != G_MAXUINT)
   {
     g_signal_query (signal_id, &query);
@@ -997,10 +1926,8 @@ PyGObject_on (PyGObject * self, PyObject * args)
       goto too_many_arguments;
   }
 
-  closure = PyGObject_make_closure_for_signal (signal_id, callback, max_arg_count);
-  g_signal_connect_closure_by_id (self->handle, signal_id, 0, closure, TRUE);
-
-  self->signal_closures = g_slist_prepend (self->signal_closures, closure);
+  closure = PyGObject_make_closure_for_signal (signal_id, callback, max_arg_count, &options);
+  PyGObject_add_signal_closure (self, closure);
 
   Py_RETURN_NONE;
 
@@ -1017,22 +1944,17 @@ PyGObject_off (PyGObject * self, PyObject * args)
 {
   guint signal_id;
   PyObject * callback;
-  GSList * entry;
-  GClosure * closure;
-  G_GNUC_UNUSED guint num_matches;
+  PyGObjectSignalClosure * closure;
 
-  if (!PyGObject_parse_signal_method_args (args, G_OBJECT_TYPE (self->handle), &signal_id, &callback))
+  if (!PyGObject_parse_signal_method_args (args, NULL, G_OBJECT_TYPE (self->handle), &signal_id, &callback, NULL))
     return NULL;
 
-  entry = g_slist_find_custom (self->signal_closures, callback, (GCompareFunc) PyGObject_compare_signal_closure_callback);
-  if (entry == NULL)
+  closure = PyGObject_lookup_signal_closure (self, signal_id, callback);
+  if (closure == NULL)
     goto unknown_callback;
 
-  closure = entry->data;
-  self->signal_closures = g_slist_delete_link (self->signal_closures, entry);
-
-  num_matches = g_signal_handlers_disconnect_matched (self->handle, G_SIGNAL_MATCH_CLOSURE, signal_id, 0, closure, NULL, NULL);
-  g_assert (num_matches == 1);
+  PyGObject_remove_signal_closure (self, closure);
+  PyGObject_disconnect_signal_closure (closure, self);
 
   Py_RETURN_NONE;
 
@@ -1043,1807 +1965,7687 @@ unknown_callback:
   }
 }
 
-static gint
-PyGObject_compare_signal_closure_callback (PyGObjectSignalClosure * closure,
-                                           PyObject * callback)
+static PyObject *
+PyGObject_off_all (PyGObject * self, PyObject * args)
 {
-  int result;
+  const gchar * signal_name;
+  guint signal_id;
+  GHashTableIter iter;
+  PyGObjectSignalKey * key;
+  GQueue * closures;
 
-  result = PyObject_RichCompareBool (closure->parent.data, callback, Py_EQ);
+  if (!PyArg_ParseTuple (args, "s", &signal_name))
+    return NULL;
+
+  if (!PyGObject_lookup_signal (signal_name, G_OBJECT_TYPE (self->handle), &signal_id))
+    return NULL;
+
+  if (self->signal_closures == NULL)
+    Py_RETURN_NONE;
+
+  g_hash_table_iter_init (&iter, self->signal_closures);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &closures))
+  {
+    /* Streams are left alone, they are closed through their own object. */
+    if (key->signal_id != signal_id || key->callback == Py_None)
+      continue;
+
+    g_queue_foreach (closures, (GFunc) PyGObject_disconnect_signal_closure, self);
+    g_hash_table_iter_remove (&iter);
+  }
 
-  return (result == 1) ? 0 : -1;
+  Py_RETURN_NONE;
 }
 
-static gboolean
-PyGObject_parse_signal_method_args (PyObject * args, GType instance_type, guint * signal_id, PyObject ** callback)
+static PyObject *
+PyGObject_get_queue_stats (PyGObject * self, PyObject * args)
 {
-  const gchar * signal_name;
+  guint signal_id;
+  PyObject * callback;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalQueue * queue;
 
-  if (!PyArg_ParseTuple (args, "sO", &signal_name, callback))
-    return FALSE;
+  if (!PyGObject_parse_signal_method_args (args, NULL, G_OBJECT_TYPE (self->handle), &signal_id, &callback, NULL))
+    return NULL;
 
-  if (!PyCallable_Check (*callback))
-  {
-    PyErr_SetString (PyExc_TypeError, "second argument must be callable");
-    return FALSE;
-  }
+  closure = PyGObject_lookup_signal_closure (self, signal_id, callback);
+  if (closure == NULL)
+    goto unknown_callback;
 
-  *signal_id = g_signal_lookup (signal_name, instance_type);
-  if (*signal_id == 0)
-    goto invalid_signal_name;
+  queue = closure->queue;
+  if (queue == NULL)
+    goto not_queued;
 
-  return TRUE;
+  return PyGObjectSignalQueue_get_stats (queue);
 
-invalid_signal_name:
+unknown_callback:
   {
-    GString * message;
-    guint * ids, n_ids, i;
+    PyErr_SetString (PyExc_ValueError, "unknown callback");
+    return NULL;
+  }
+not_queued:
+  {
+    PyErr_SetString (PyExc_ValueError, "callback was not connected with a queue");
+    return NULL;
+  }
+}
 
-    message = g_string_sized_new (128);
+static PyObject *
+PyGObject_set_route (PyGObject * self, PyObject * args)
+{
+  const gchar * signal_name, * tag;
+  PyObject * callback, * handler, * old_handler = NULL;
+  gchar * old_tag = NULL;
+  PyGObjectSignalRouter * router;
 
-    g_string_append (message, PyGObject_class_name_from_c (g_type_name (instance_type)));
+  if (!PyArg_ParseTuple (args, "sOsO", &signal_name, &callback, &tag, &handler))
+    return NULL;
 
-    ids = g_signal_list_ids (instance_type, &n_ids);
+  if (handler != Py_None && !PyCallable_Check (handler))
+    goto not_callable;
 
-    if (n_ids > 0)
-    {
-      g_string_append_printf (message, " does not have a signal named '%s', it only has: ", signal_name);
+  if (tag[0] == '\0' || g_str_has_prefix (tag, "telco:"))
+    goto invalid_tag;
 
-      for (i = 0; i != n_ids; i++)
-      {
-        if (i != 0)
-          g_string_append (message, ", ");
-        g_string_append_c (message, '\'');
-        g_string_append (message, g_signal_name (ids[i]));
-        g_string_append_c (message, '\'');
-      }
-    }
-    else
-    {
-      g_string_append (message, " does not have any signals");
-    }
+  if (strlen (tag) > PYTELCO_MAX_ROUTE_TAG_LENGTH)
+    goto tag_too_long;
 
-    g_free (ids);
+  router = PyGObject_obtain_signal_router (self, signal_name, callback);
+  if (router == NULL)
+    return NULL;
 
-    PyErr_SetString (PyExc_ValueError, message->str);
+  g_mutex_lock (&router->lock);
+  g_hash_table_steal_extended (router->routes, tag, (gpointer *) &old_tag, (gpointer *) &old_handler);
+  if (handler != Py_None)
+  {
+    Py_INCREF (handler);
+    g_hash_table_insert (router->routes, g_strdup (tag), handler);
+  }
+  g_mutex_unlock (&router->lock);
 
-    g_string_free (message, TRUE);
+  g_free (old_tag);
+  Py_XDECREF (old_handler);
 
-    return FALSE;
+  Py_RETURN_NONE;
+
+not_callable:
+  {
+    PyErr_SetString (PyExc_TypeError, "handler must be callable or None");
+    return NULL;
+  }
+invalid_tag:
+  {
+    PyErr_SetString (PyExc_ValueError, "tag must not be empty or start with 'telco:'");
+    return NULL;
+  }
+tag_too_long:
+  {
+    PyErr_SetString (PyExc_ValueError, "tag is too long");
+    return NULL;
   }
 }
 
-static const gchar *
-PyGObject_class_name_from_c (const gchar * cname)
+static PyObject *
+PyGObject_set_route_fallback (PyGObject * self, PyObject * args)
 {
-  if (g_str_has_prefix (cname, "Telco"))
-    return cname + 5;
+  const gchar * signal_name;
+  PyObject * callback;
+  int enabled;
+  PyGObjectSignalRouter * router;
 
-  return cname;
-}
+  if (!PyArg_ParseTuple (args, "sOp", &signal_name, &callback, &enabled))
+    return NULL;
 
-static void
-PyGObject_class_init (void)
-{
-  pygobject_type_spec_by_type = g_hash_table_new_full (NULL, NULL, NULL, NULL);
-}
+  router = PyGObject_obtain_signal_router (self, signal_name, callback);
+  if (router == NULL)
+    return NULL;
 
-static void
-PyGObject_register_type (GType instance_type, PyGObjectType * python_type)
-{
-  g_hash_table_insert (pygobject_type_spec_by_type, GSIZE_TO_POINTER (instance_type), python_type);
+  g_mutex_lock (&router->lock);
+  router->deliver_unmatched = enabled;
+  g_mutex_unlock (&router->lock);
+
+  Py_RETURN_NONE;
 }
 
-static GClosure *
-PyGObject_make_closure_for_signal (guint signal_id, PyObject * callback, guint max_arg_count)
+static PyObject *
+PyGObject_get_route_stats (PyGObject * self, PyObject * args)
 {
-  GClosure * closure;
-  PyGObjectSignalClosure * pyclosure;
-
-  closure = g_closure_new_simple (sizeof (PyGObjectSignalClosure), callback);
-  Py_IncRef (callback);
+  const gchar * signal_name;
+  PyObject * callback;
+  PyGObjectSignalRouter * router;
 
-  g_closure_add_finalize_notifier (closure, callback, (GClosureNotify) PyGObjectSignalClosure_finalize);
-  g_closure_set_marshal (closure, PyGObjectSignalClosure_marshal);
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, &callback))
+    return NULL;
 
-  pyclosure = PY_GOBJECT_SIGNAL_CLOSURE (closure);
-  pyclosure->signal_id = signal_id;
-  pyclosure->max_arg_count = max_arg_count;
+  router = PyGObject_obtain_signal_router (self, signal_name, callback);
+  if (router == NULL)
+    return NULL;
 
-  return closure;
+  return PyGObjectSignalRouter_get_stats (router);
 }
 
-static void
-PyGObjectSignalClosure_finalize (PyObject * callback)
+static PyGObjectSignalRouter *
+PyGObject_obtain_signal_router (PyGObject * self, const gchar * signal_name, PyObject * callback)
 {
-  PyGILState_STATE gstate;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalRouter * router;
 
-  gstate = PyGILState_Ensure ();
-  Py_DecRef (callback);
-  PyGILState_Release (gstate);
-}
+  closure = PyGObject_find_script_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-static void
-PyGObjectSignalClosure_marshal (GClosure * closure, GValue * return_gvalue, guint n_param_values, const GValue * param_values,
-    gpointer invocation_hint, gpointer marshal_data)
-{
-  PyGObjectSignalClosure * self = PY_GOBJECT_SIGNAL_CLOSURE (closure);
-  PyObject * callback = closure->data;
-  PyGILState_STATE gstate;
-  PyObject * args, * result;
+  /* Routers are only created and replaced with the GIL held, but emitting threads read them without it. */
+  router = closure->router;
+  if (router == NULL)
+  {
+    router = PyGObjectSignalRouter_new ();
+    g_closure_add_finalize_notifier (&closure->parent, router, (GClosureNotify) PyGObjectSignalRouter_free);
+    g_atomic_pointer_set (&closure->router, router);
+  }
 
-  (void) return_gvalue;
-  (void) invocation_hint;
-  (void) marshal_data;
+  return router;
+}
 
-  if (g_atomic_int_get (&toplevel_objects_alive) == 0)
-    return;
+static PyObject *
+PyGObject_set_priority_tags (PyGObject * self, PyObject * args)
+{
+  const gchar * signal_name;
+  PyObject * callback, * tags_value;
+  gchar ** tags;
+  gint n_tags, i;
+  PyGObjectSignalRouter * router;
+  GHashTable * priority_tags, * old_priority_tags;
 
-  gstate = PyGILState_Ensure ();
+  if (!PyArg_ParseTuple (args, "sOO", &signal_name, &callback, &tags_value))
+    return NULL;
 
-  if (PyGObject_try_get_from_handle (g_value_get_object (&param_values[0])) == NULL)
-    goto beach;
+  if (!PyGObject_unmarshal_strv (tags_value, &tags, &n_tags))
+    return NULL;
 
-  if (self->max_arg_count == n_param_values)
-    args = PyGObjectSignalClosure_marshal_params (param_values, n_param_values);
-  else
-    args = PyGObjectSignalClosure_marshal_params (param_values + 1, MIN (n_param_values - 1, self->max_arg_count));
-  if (args == NULL)
+  router = PyGObject_obtain_signal_router (self, signal_name, callback);
+  if (router == NULL)
   {
-    PyErr_Print ();
-    goto beach;
+    g_strfreev (tags);
+    return NULL;
   }
 
-  result = PyObject_CallObject (callback, args);
-  if (result != NULL)
-    Py_DECREF (result);
-  else
-    PyErr_Print ();
+  priority_tags = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (i = 0; i != n_tags; i++)
+    g_hash_table_add (priority_tags, g_steal_pointer (&tags[i]));
+  g_free (tags);
 
-  Py_DECREF (args);
+  g_mutex_lock (&router->lock);
+  old_priority_tags = router->priority_tags;
+  router->priority_tags = priority_tags;
+  g_atomic_int_set (&router->n_priority_tags, g_hash_table_size (priority_tags));
+  g_mutex_unlock (&router->lock);
 
-beach:
-  PyGILState_Release (gstate);
+  g_hash_table_unref (old_priority_tags);
+
+  Py_RETURN_NONE;
 }
 
 static PyObject *
-PyGObjectSignalClosure_marshal_params (const GValue * params, guint params_length)
+PyGObject_set_limits (PyGObject * self, PyObject * args)
 {
-  PyObject * args;
-  guint i;
+  const gchar * signal_name;
+  PyObject * callback;
+  unsigned int sample_every;
+  double max_rate, max_burst;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalLimiter * limiter;
 
-  args = PyTuple_New (params_length);
+  if (!PyArg_ParseTuple (args, "sOIdd", &signal_name, &callback, &sample_every, &max_rate, &max_burst))
+    return NULL;
 
-  for (i = 0; i != params_length; i++)
-  {
-    PyObject * arg;
+  if (sample_every == 0)
+    goto invalid_sample_every;
 
-    arg = PyGObject_marshal_value (&params[i]);
-    if (arg == NULL)
-      goto marshal_error;
+  if (max_rate < 0 || max_burst < 0)
+    goto invalid_rate;
 
-    PyTuple_SetItem (args, i, arg);
+  closure = PyGObject_find_signal_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
+
+  /* Like routers, limiters are created with the GIL held and then read by emitting threads without it. */
+  limiter = closure->limiter;
+  if (limiter == NULL)
+  {
+    limiter = PyGObjectSignalLimiter_new ();
+    g_closure_add_finalize_notifier (&closure->parent, limiter, (GClosureNotify) PyGObjectSignalLimiter_free);
   }
 
-  return args;
+  PyGObjectSignalLimiter_configure (limiter, sample_every, max_rate, max_burst);
 
-marshal_error:
+  g_atomic_pointer_set (&closure->limiter, limiter);
+
+  Py_RETURN_NONE;
+
+invalid_sample_every:
   {
-    Py_DECREF (args);
+    PyErr_SetString (PyExc_ValueError, "sample_every must be at least 1");
+    return NULL;
+  }
+invalid_rate:
+  {
+    PyErr_SetString (PyExc_ValueError, "max_rate and max_burst must not be negative");
     return NULL;
   }
 }
 
 static PyObject *
-PyGObject_marshal_value (const GValue * value)
+PyGObject_get_limit_stats (PyGObject * self, PyObject * args)
 {
-  GType type;
+  const gchar * signal_name;
+  PyObject * callback;
+  PyGObjectSignalClosure * closure;
 
-  type = G_VALUE_TYPE (value);
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, &callback))
+    return NULL;
 
-  switch (type)
-  {
-    case G_TYPE_BOOLEAN:
-      return PyBool_FromLong (g_value_get_boolean (value));
+  closure = PyGObject_find_signal_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-    case G_TYPE_INT:
-      return PyLong_FromLong (g_value_get_int (value));
+  if (closure->limiter == NULL)
+    goto not_limited;
 
-    case G_TYPE_UINT:
-      return PyLong_FromUnsignedLong (g_value_get_uint (value));
+  return PyGObjectSignalLimiter_get_stats (closure->limiter);
 
-    case G_TYPE_FLOAT:
-      return PyFloat_FromDouble (g_value_get_float (value));
+not_limited:
+  {
+    PyErr_SetString (PyExc_ValueError, "callback does not have any limits");
+    return NULL;
+  }
+}
 
-    case G_TYPE_DOUBLE:
-      return PyFloat_FromDouble (g_value_get_double (value));
+static PyObject *
+PyGObject_set_filter (PyGObject * self, PyObject * args)
+{
+  const gchar * signal_name;
+  PyObject * callback, * values_value;
+  const char * key;
+  gchar ** values = NULL;
+  gint n_values, i;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalFilter * filter;
+  GHashTable * accepted_values = NULL;
+
+  if (!PyArg_ParseTuple (args, "sOzO", &signal_name, &callback, &key, &values_value))
+    return NULL;
 
-    case G_TYPE_STRING:
-      return PyGObject_marshal_string (g_value_get_string (value));
+  if (key != NULL)
+  {
+    if (key[0] == '\0')
+      goto invalid_key;
 
-    case G_TYPE_VARIANT:
-      return PyGObject_marshal_variant (g_value_get_variant (value));
+    if (!PyGObject_unmarshal_strv (values_value, &values, &n_values))
+      return NULL;
 
-    default:
-      if (G_TYPE_IS_ENUM (type))
-        return PyGObject_marshal_enum (g_value_get_enum (value), type);
+    for (i = 0; i != n_values; i++)
+    {
+      if (strlen (values[i]) > PYTELCO_MAX_FILTER_VALUE_LENGTH)
+        goto value_too_long;
+    }
+  }
 
-      if (type == G_TYPE_BYTES)
-        return PyGObject_marshal_bytes (g_value_get_boxed (value));
+  closure = PyGObject_find_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    goto beach;
 
-      if (G_TYPE_IS_OBJECT (type))
-        return PyGObject_marshal_object (g_value_get_object (value), type);
+  if (key != NULL)
+  {
+    accepted_values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    for (i = 0; i != n_values; i++)
+      g_hash_table_add (accepted_values, g_steal_pointer (&values[i]));
+  }
 
-      goto unsupported_type;
+  /* Filters are created with the GIL held and read by emitting threads without it, so they are only reconfigured. */
+  filter = closure->filter;
+  if (filter == NULL)
+  {
+    filter = PyGObjectSignalFilter_new ();
+    g_closure_add_finalize_notifier (&closure->parent, filter, (GClosureNotify) PyGObjectSignalFilter_free);
+    g_atomic_pointer_set (&closure->filter, filter);
   }
 
-  g_assert_not_reached ();
+  PyGObjectSignalFilter_configure (filter, g_strdup (key), accepted_values);
 
-unsupported_type:
+  g_strfreev (values);
+
+  Py_RETURN_NONE;
+
+invalid_key:
   {
-    return PyErr_Format (PyExc_NotImplementedError,
-        "unsupported type: '%s'",
-        g_type_name (type));
+    PyErr_SetString (PyExc_ValueError, "key must not be empty");
+    return NULL;
+  }
+value_too_long:
+  {
+    PyErr_SetString (PyExc_ValueError, "value is too long");
+    goto beach;
+  }
+beach:
+  {
+    g_strfreev (values);
+    return NULL;
   }
 }
 
 static PyObject *
-PyGObject_marshal_string (const gchar * str)
-{
-  if (str == NULL)
-    Py_RETURN_NONE;
-
-  return PyUnicode_FromUTF8String (str);
-}
-
-static gboolean
-PyGObject_unmarshal_string (PyObject * value, gchar ** str)
+PyGObject_get_filter_stats (PyGObject * self, PyObject * args)
 {
-  PyObject * bytes;
+  const gchar * signal_name;
+  PyObject * callback;
+  PyGObjectSignalClosure * closure;
 
-  *str = NULL;
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, &callback))
+    return NULL;
 
-  bytes = PyUnicode_AsUTF8String (value);
-  if (bytes == NULL)
-    return FALSE;
+  closure = PyGObject_find_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-  *str = g_strdup (PyBytes_AsString (bytes));
+  if (closure->filter == NULL)
+    goto not_filtered;
 
-  Py_DecRef (bytes);
+  return PyGObjectSignalFilter_get_stats (closure->filter);
 
-  return *str != NULL;
+not_filtered:
+  {
+    PyErr_SetString (PyExc_ValueError, "callback does not have a filter");
+    return NULL;
+  }
 }
 
 static PyObject *
-PyGObject_marshal_datetime (const gchar * iso8601_text)
+PyGObject_set_log_sink (PyGObject * self, PyObject * args, PyObject * kw)
 {
-  PyObject * result;
-  GDateTime * raw_dt, * dt;
-
-  raw_dt = g_date_time_new_from_iso8601 (iso8601_text, NULL);
-  if (raw_dt == NULL)
-    Py_RETURN_NONE;
-
-  dt = g_date_time_to_local (raw_dt);
-
-  result = PyObject_CallFunction (datetime_constructor, "iiiiiii",
-      g_date_time_get_year (dt),
-      g_date_time_get_month (dt),
-      g_date_time_get_day_of_month (dt),
-      g_date_time_get_hour (dt),
-      g_date_time_get_minute (dt),
-      g_date_time_get_second (dt),
-      g_date_time_get_microsecond (dt));
+  static char * keywords[] = { "fd", "path", "max_bytes", "backup_count", "buffer_size", "level", NULL };
+  const gchar * signal_name;
+  PyObject * callback;
+  int fd = -1;
+  const char * path = NULL;
+  unsigned long long max_bytes = 0;
+  unsigned int backup_count = 0;
+  unsigned int buffer_size = 0;
+  const char * level_name = "debug";
+  PyTelcoLogLevel min_level;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalLogSink * sink;
+  PyGObjectSignalLogSink config = { 0, };
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "sO|$izKIIs", keywords, &signal_name, &callback, &fd, &path, &max_bytes,
+        &backup_count, &buffer_size, &level_name))
+    return NULL;
 
-  g_date_time_unref (dt);
-  g_date_time_unref (raw_dt);
+  if (!PyTelco_parse_log_level (level_name, strlen (level_name), &min_level))
+    goto invalid_level;
 
-  return result;
-}
+  closure = PyGObject_find_script_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-static PyObject *
-PyGObject_marshal_strv (gchar * const * strv, gint length)
-{
-  PyObject * result;
-  gint i;
+  config.min_level = min_level;
+  config.max_bytes = max_bytes;
+  config.backup_count = backup_count;
 
-  if (strv == NULL)
-    Py_RETURN_NONE;
+  if (fd != -1)
+  {
+    int fd_copy;
 
-  result = PyList_New (length);
+    fd_copy = dup (fd);
+    if (fd_copy == -1 || (config.stream = fdopen (fd_copy, "wb")) == NULL)
+    {
+      PyErr_SetFromErrno (PyExc_OSError);
+      if (fd_copy != -1)
+        close (fd_copy);
+      goto propagate_error;
+    }
+  }
 
-  for (i = 0; i != length; i++)
+  if (path != NULL)
   {
-    PyList_SetItem (result, i, PyGObject_marshal_string (strv[i]));
+    config.file = g_fopen (path, "ab");
+    if (config.file == NULL)
+    {
+      PyErr_SetFromErrnoWithFilename (PyExc_OSError, path);
+      goto propagate_error;
+    }
+    fseek (config.file, 0, SEEK_END);
+    config.file_size = ftell (config.file);
+    config.path = g_strdup (path);
   }
 
-  return result;
-}
-
-static gboolean
-PyGObject_unmarshal_strv (PyObject * value, gchar *** strv, gint * length)
-{
-  gint n, i;
-  gchar ** elements;
-
-  if (!PyList_Check (value) && !PyTuple_Check (value))
-    goto invalid_type;
-
-  n = PySequence_Size (value);
-  elements = g_new0 (gchar *, n + 1);
-
-  for (i = 0; i != n; i++)
+  if (buffer_size != 0)
   {
-    PyObject * element;
-
-    element = PySequence_GetItem (value, i);
-    if (PyUnicode_Check (element))
-    {
-      Py_DECREF (element);
-      element = PyUnicode_AsUTF8String (element);
-    }
-    if (PyBytes_Check (element))
-      elements[i] = g_strdup (PyBytes_AsString (element));
-    Py_DECREF (element);
+    config.ring = g_new0 (PyGObjectSignalLogEntry, buffer_size);
+    config.ring_capacity = buffer_size;
+  }
 
-    if (elements[i] == NULL)
-      goto invalid_element;
+  /* Sinks are created with the GIL held and read by emitting threads without it, so they are only reconfigured. */
+  sink = closure->log_sink;
+  if (sink == NULL)
+  {
+    sink = PyGObjectSignalLogSink_new ();
+    g_closure_add_finalize_notifier (&closure->parent, sink, (GClosureNotify) PyGObjectSignalLogSink_free);
+    g_atomic_pointer_set (&closure->log_sink, sink);
   }
 
-  *strv = elements;
-  *length = n;
+  PyGObjectSignalLogSink_configure (sink, &config);
 
-  return TRUE;
+  Py_RETURN_NONE;
 
-invalid_type:
+invalid_level:
   {
-    PyErr_SetString (PyExc_TypeError, "expected list or tuple of strings");
-    return FALSE;
+    PyErr_SetString (PyExc_ValueError, "level must be one of 'debug', 'info', 'warning' or 'error'");
+    return NULL;
   }
-invalid_element:
+propagate_error:
   {
-    g_strfreev (elements);
-
-    PyErr_SetString (PyExc_TypeError, "expected list or tuple with string elements only");
-    return FALSE;
+    PyGObjectSignalLogSink_close (&config);
+    return NULL;
   }
 }
 
 static PyObject *
-PyGObject_marshal_envp (gchar * const * envp, gint length)
+PyGObject_tail_log_sink (PyGObject * self, PyObject * args)
 {
-  PyObject * result;
-  gint i;
+  const gchar * signal_name;
+  PyObject * callback;
+  unsigned int count = 0;
+  PyGObjectSignalClosure * closure;
 
-  if (envp == NULL)
-    Py_RETURN_NONE;
+  if (!PyArg_ParseTuple (args, "sO|I", &signal_name, &callback, &count))
+    return NULL;
 
-  result = PyDict_New ();
+  closure = PyGObject_find_script_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-  for (i = 0; i != length; i++)
+  if (closure->log_sink == NULL)
+    goto no_sink;
+
+  return PyGObjectSignalLogSink_tail (closure->log_sink, count);
+
+no_sink:
   {
-    gchar ** tokens;
+    PyErr_SetString (PyExc_ValueError, "callback does not have a log sink");
+    return NULL;
+  }
+}
 
-    tokens = g_strsplit (envp[i], "=", 2);
+static PyObject *
+PyGObject_get_log_sink_stats (PyGObject * self, PyObject * args)
+{
+  const gchar * signal_name;
+  PyObject * callback;
+  PyGObjectSignalClosure * closure;
 
-    if (g_strv_length (tokens) == 2)
-    {
-      const gchar * name;
-      PyObject * value;
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, &callback))
+    return NULL;
 
-      name = tokens[0];
-      value = PyGObject_marshal_string (tokens[1]);
+  closure = PyGObject_find_script_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-      PyDict_SetItemString (result, name, value);
+  if (closure->log_sink == NULL)
+    goto no_sink;
 
-      Py_DECREF (value);
-    }
+  return PyGObjectSignalLogSink_get_stats (closure->log_sink);
 
-    g_strfreev (tokens);
+no_sink:
+  {
+    PyErr_SetString (PyExc_ValueError, "callback does not have a log sink");
+    return NULL;
   }
-
-  return result;
 }
 
-static gboolean
-PyGObject_unmarshal_envp (PyObject * dict, gchar *** envp, gint * length)
+static PyObject *
+PyGObject_set_tap (PyGObject * self, PyObject * args)
 {
-  gint n;
-  gchar ** elements;
-  gint i;
-  Py_ssize_t pos;
-  PyObject * name, * value;
-  gchar * raw_name = NULL;
-  gchar * raw_value = NULL;
-
-  if (!PyDict_Check (dict))
-    goto invalid_type;
-
-  n = PyDict_Size (dict);
-  elements = g_new0 (gchar *, n + 1);
+  const gchar * signal_name;
+  PyObject * callback;
+  const char * path;
+  unsigned int size;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalTap * tap;
+  PyGObjectSignalTap config = { 0, };
 
-  i = 0;
-  pos = 0;
-  while (PyDict_Next (dict, &pos, &name, &value))
-  {
-    if (!PyGObject_unmarshal_string (name, &raw_name))
-      goto invalid_dict_key;
+  if (!PyArg_ParseTuple (args, "sOzI", &signal_name, &callback, &path, &size))
+    return NULL;
 
-    if (!PyGObject_unmarshal_string (value, &raw_value))
-      goto invalid_dict_value;
+  if (size < PYTELCO_TAP_MIN_CAPACITY || size > PYTELCO_TAP_MAX_CAPACITY)
+    goto invalid_size;
 
-    elements[i] = g_strconcat (raw_name, "=", raw_value, NULL);
+  closure = PyGObject_find_script_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-    g_free (g_steal_pointer (&raw_value));
-    g_free (g_steal_pointer (&raw_name));
+  if (path != NULL && !PyGObjectSignalTap_open (&config, path, 1U << (g_bit_storage (size - 1))))
+    return PyErr_SetFromErrnoWithFilename (PyExc_OSError, path);
 
-    i++;
+  /* Taps are created with the GIL held and read by emitting threads without it, so they are only reconfigured. */
+  tap = closure->tap;
+  if (tap == NULL)
+  {
+    tap = PyGObjectSignalTap_new ();
+    g_closure_add_finalize_notifier (&closure->parent, tap, (GClosureNotify) PyGObjectSignalTap_free);
+    g_atomic_pointer_set (&closure->tap, tap);
   }
 
-  *envp = elements;
-  *length = n;
+  PyGObjectSignalTap_configure (tap, &config);
 
-  return TRUE;
+  Py_RETURN_NONE;
 
-invalid_type:
-  {
-    PyErr_SetString (PyExc_TypeError, "expected dict");
-    return FALSE;
-  }
-invalid_dict_key:
-invalid_dict_value:
+invalid_size:
   {
-    g_free (raw_value);
-    g_free (raw_name);
-    g_strfreev (elements);
-
-    PyErr_SetString (PyExc_TypeError, "expected dict with strings only");
-    return FALSE;
+    PyErr_Format (PyExc_ValueError, "size must be between %u and %u bytes", PYTELCO_TAP_MIN_CAPACITY,
+        PYTELCO_TAP_MAX_CAPACITY);
+    return NULL;
   }
 }
 
 static PyObject *
-PyGObject_marshal_enum (gint value, GType type)
+PyGObject_get_tap_stats (PyGObject * self, PyObject * args)
 {
-  GEnumClass * enum_class;
-  GEnumValue * enum_value;
-  PyObject * result;
+  const gchar * signal_name;
+  PyObject * callback;
+  PyGObjectSignalClosure * closure;
 
-  enum_class = g_type_class_ref (type);
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, &callback))
+    return NULL;
 
-  enum_value = g_enum_get_value (enum_class, value);
-  g_assert (enum_value != NULL);
+  closure = PyGObject_find_script_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-  result = PyUnicode_FromUTF8String (enum_value->value_nick);
+  if (closure->tap == NULL)
+    goto no_tap;
 
-  g_type_class_unref (enum_class);
+  return PyGObjectSignalTap_get_stats (closure->tap);
 
-  return result;
+no_tap:
+  {
+    PyErr_SetString (PyExc_ValueError, "callback does not have a tap");
+    return NULL;
+  }
 }
 
-static gboolean
-PyGObject_unmarshal_enum (const gchar * str, GType type, gpointer value)
+static PyObject *
+PyGObject_set_recorder (PyGObject * self, PyObject * args)
 {
-  GEnumClass * enum_class;
-  GEnumValue * enum_value;
-
-  enum_class = g_type_class_ref (type);
-
-  enum_value = g_enum_get_value_by_nick (enum_class, str);
-  if (enum_value == NULL)
-    goto invalid_value;
+  const gchar * signal_name;
+  PyObject * callback;
+  const char * path;
+  PyGObjectSignalClosure * closure;
+  PyGObjectSignalRecorder * recorder;
+  FILE * file = NULL;
 
-  *((gint *) value) = enum_value->value;
+  if (!PyArg_ParseTuple (args, "sOz", &signal_name, &callback, &path))
+    return NULL;
 
-  g_type_class_unref (enum_class);
+  closure = PyGObject_find_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-  return TRUE;
+  if (path != NULL && (file = PyGObjectSignalRecorder_open (path)) == NULL)
+    return PyErr_SetFromErrnoWithFilename (PyExc_OSError, path);
 
-invalid_value:
+  /* Recorders are created with the GIL held and read by emitting threads without it, so they are only reconfigured. */
+  recorder = closure->recorder;
+  if (recorder == NULL)
   {
-    GString * message;
-    guint i;
+    recorder = PyGObjectSignalRecorder_new ();
+    g_closure_add_finalize_notifier (&closure->parent, recorder, (GClosureNotify) PyGObjectSignalRecorder_free);
+    g_atomic_pointer_set (&closure->recorder, recorder);
+  }
 
-    message = g_string_sized_new (128);
+  /* Closing a recording flushes whatever is still buffered, which may take a while. */
+  Py_BEGIN_ALLOW_THREADS
+  PyGObjectSignalRecorder_configure (recorder, file);
+  Py_END_ALLOW_THREADS
 
-    g_string_append_printf (message,
-        "Enum type %s does not have a value named '%s', it only has: ",
-        PyGObject_class_name_from_c (g_type_name (type)), str);
+  Py_RETURN_NONE;
+}
 
-    for (i = 0; i != enum_class->n_values; i++)
-    {
-      if (i != 0)
-        g_string_append (message, ", ");
-      g_string_append_c (message, '\'');
-      g_string_append (message, enum_class->values[i].value_nick);
-      g_string_append_c (message, '\'');
-    }
+static PyObject *
+PyGObject_get_recorder_stats (PyGObject * self, PyObject * args)
+{
+  const gchar * signal_name;
+  PyObject * callback;
+  PyGObjectSignalClosure * closure;
 
-    PyErr_SetString (PyExc_ValueError, message->str);
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, &callback))
+    return NULL;
 
-    g_string_free (message, TRUE);
+  closure = PyGObject_find_message_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-    g_type_class_unref (enum_class);
+  if (closure->recorder == NULL)
+    goto no_recorder;
 
-    return FALSE;
+  return PyGObjectSignalRecorder_get_stats (closure->recorder);
+
+no_recorder:
+  {
+    PyErr_SetString (PyExc_ValueError, "callback does not have a recorder");
+    return NULL;
   }
 }
 
-static PyObject *
-PyGObject_marshal_bytes (GBytes * bytes)
+static PyGObjectSignalClosure *
+PyGObject_find_message_closure (PyGObject * self, const gchar * signal_name, PyObject * callback)
 {
-  if (bytes == NULL)
-    Py_RETURN_NONE;
+  PyGObjectSignalClosure * closure;
+  GSignalQuery query;
 
-  return PyGObject_marshal_bytes_non_nullable (bytes);
-}
+  closure = PyGObject_find_signal_closure (self, signal_name, callback);
+  if (closure == NULL)
+    return NULL;
 
-static PyObject *
-PyGObject_marshal_bytes_non_nullable (GBytes * bytes)
-{
-  gconstpointer data;
-  gsize size;
+  g_signal_query (closure->signal_id, &query);
+  if (query.n_params == 0 || (query.param_types[0] & ~G_SIGNAL_TYPE_STATIC_SCOPE) != G_TYPE_STRING)
+    goto not_a_message_signal;
 
-  data = g_bytes_get_data (bytes, &size);
+  return closure;
 
-  return PyBytes_FromStringAndSize (data, size);
+not_a_message_signal:
+  {
+    PyErr_Format (PyExc_TypeError, "the '%s' signal does not carry messages", signal_name);
+    return NULL;
+  }
 }
 
-static PyObject *
-PyGObject_marshal_variant (GVariant * variant)
+static PyGObjectSignalClosure *
+PyGObject_find_script_message_closure (PyGObject * self, const gchar * signal_name, PyObject * callback)
 {
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE_STRING))
-    return PyGObject_marshal_string (g_variant_get_string (variant, NULL));
+  if (!g_type_is_a (G_OBJECT_TYPE (self->handle), TELCO_TYPE_SCRIPT))
+    goto not_supported;
 
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE_INT64))
-    return PyLong_FromLongLong (g_variant_get_int64 (variant));
+  return PyGObject_find_message_closure (self, signal_name, callback);
 
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE_BOOLEAN))
-    return PyBool_FromLong (g_variant_get_boolean (variant));
-
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE ("ay")))
+not_supported:
   {
-    gconstpointer elements;
-    gsize n_elements;
-
-    elements = g_variant_get_fixed_array (variant, &n_elements, sizeof (guint8));
-
-    return PyBytes_FromStringAndSize (elements, n_elements);
+    PyErr_SetString (PyExc_TypeError, "this operation is only supported by scripts");
+    return NULL;
   }
+}
 
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE_VARDICT))
-  {
-    PyObject * dict;
-    GVariantIter iter;
-    gchar * key;
-    GVariant * raw_value;
-
-    dict = PyDict_New ();
-
-    g_variant_iter_init (&iter, variant);
+static PyGObjectSignalClosure *
+PyGObject_find_signal_closure (PyGObject * self, const gchar * signal_name, PyObject * callback)
+{
+  guint signal_id;
+  PyGObjectSignalClosure * closure;
 
-    while (g_variant_iter_next (&iter, "{sv}", &key, &raw_value))
-    {
-      PyObject * value = PyGObject_marshal_variant (raw_value);
+  if (!PyGObject_lookup_signal (signal_name, G_OBJECT_TYPE (self->handle), &signal_id))
+    return NULL;
 
-      PyDict_SetItemString (dict, key, value);
+  closure = PyGObject_lookup_signal_closure (self, signal_id, callback);
+  if (closure == NULL)
+    goto unknown_callback;
 
-      Py_DECREF (value);
-      g_variant_unref (raw_value);
-      g_free (key);
-    }
+  return closure;
 
-    return dict;
+unknown_callback:
+  {
+    PyErr_SetString (PyExc_ValueError, "unknown callback");
+    return NULL;
   }
+}
 
-  if (g_variant_is_of_type (variant, G_VARIANT_TYPE_ARRAY))
-  {
-    GVariantIter iter;
-    PyObject * list;
-    guint i;
-    GVariant * child;
-
-    g_variant_iter_init (&iter, variant);
-
-    list = PyList_New (g_variant_iter_n_children (&iter));
+static PyObject *
+PyGObject_open_stream (PyGObject * self, PyObject * args, PyObject * kw)
+{
+  GType instance_type;
+  const gchar * signal_name;
+  guint signal_id;
+  PyGObjectSignalOptions options;
+  GClosure * closure;
 
-    for (i = 0; (child = g_variant_iter_next_value (&iter)) != NULL; i++)
-    {
-      PyList_SetItem (list, i, PyGObject_marshal_variant (child));
-      g_variant_unref (child);
-    }
+  instance_type = G_OBJECT_TYPE (self->handle);
 
-    return list;
-  }
+  if (!PyArg_ParseTuple (args, "s", &signal_name))
+    return NULL;
 
-  Py_RETURN_NONE;
-}
+  if (!PyGObject_parse_signal_options (kw, instance_type, &options))
+    return NULL;
 
-static gboolean
-PyGObject_unmarshal_variant (PyObject * value, GVariant ** variant)
-{
-  if (PyTelco_is_string (value))
-  {
-    gchar * str;
+  if (!PyGObject_lookup_signal (signal_name, instance_type, &signal_id))
+    return NULL;
 
-    PyGObject_unmarshal_string (value, &str);
+  /*
+   * Streams are drained by consumers that may fall behind or go away entirely, so they must never block the
+   * emitting thread, which is shared with every other object.
+   */
+  if (options.queue_policy == PY_GOBJECT_SIGNAL_QUEUE_BLOCK)
+    goto blocking_policy;
 
-    *variant = g_variant_new_take_string (str);
-  }
-  else if (PyBool_Check (value))
-  {
-    *variant = g_variant_new_boolean (value == Py_True);
-  }
-#if PY_MAJOR_VERSION < 3
-  else if (PyUnicode_Check (value))
-  {
-    PyObject * value_utf8;
+  if (options.queue_size == 0)
+    options.queue_size = PYTELCO_DEFAULT_STREAM_QUEUE_SIZE;
+  options.max_batch_size = 0;
+  options.stream = TRUE;
 
-    value_utf8 = PyUnicode_AsUTF8String (value);
-    if (value_utf8 == NULL)
-      goto propagate_error;
+  closure = PyGObject_make_closure_for_signal (signal_id, Py_None, G_MAXUINT, &options);
+  PyGObject_add_signal_closure (self, closure);
 
-    *variant = g_variant_new_string (PyBytes_AsString (value_utf8));
+  return PySignalStream_new (self, closure);
 
-    Py_DECREF (value_utf8);
-  }
-  else if (PyInt_Check (value))
+blocking_policy:
   {
-    *variant = g_variant_new_int64 (PyInt_AS_LONG (value));
+    PyErr_SetString (PyExc_ValueError, "streams must not block, use 'drop-oldest', 'drop-newest', or 'coalesce'");
+    return NULL;
   }
-#endif
-  else if (PyLong_Check (value))
-  {
-    PY_LONG_LONG l;
+}
 
-    l = PyLong_AsLongLong (value);
-    if (l == -1 && PyErr_Occurred ())
-      goto propagate_error;
+static void
+PyGObject_add_signal_closure (PyGObject * self, GClosure * closure)
+{
+  PyGObjectSignalClosure * pyclosure = PY_GOBJECT_SIGNAL_CLOSURE (closure);
+  PyGObjectSignalKey lookup_key, * key;
+  GQueue * closures;
 
-    *variant = g_variant_new_int64 (l);
-  }
-  else
+  /*
+   * Handlers are indexed by signal and callback, so that connecting and disconnecting stays cheap with thousands
+   * of them. The registry is only ever touched with the GIL held, as hashing and comparing callbacks needs it.
+   */
+  if (self->signal_closures == NULL)
   {
-    goto unsupported_type;
+    self->signal_closures = g_hash_table_new_full ((GHashFunc) PyGObjectSignalKey_hash,
+        (GEqualFunc) PyGObjectSignalKey_equal, (GDestroyNotify) PyGObjectSignalKey_free, (GDestroyNotify) g_queue_free);
   }
 
-  return TRUE;
+  pyclosure->handler_id = g_signal_connect_closure_by_id (self->handle, pyclosure->signal_id, 0, closure, TRUE);
 
-unsupported_type:
-  {
-    PyErr_SetString (PyExc_TypeError, "unsupported type");
-    goto propagate_error;
-  }
-propagate_error:
+  PyGObjectSignalKey_init (&lookup_key, pyclosure->signal_id, closure->data);
+
+  closures = g_hash_table_lookup (self->signal_closures, &lookup_key);
+  if (closures == NULL)
   {
-    return FALSE;
+    key = g_slice_dup (PyGObjectSignalKey, &lookup_key);
+    Py_INCREF (key->callback);
+
+    closures = g_queue_new ();
+    g_hash_table_insert (self->signal_closures, key, closures);
   }
+
+  /* The most recently added handler is the one found, and removed, first. */
+  g_queue_push_head (closures, pyclosure);
 }
 
-static PyObject *
-PyGObject_marshal_parameters_dict (GHashTable * dict)
+static PyGObjectSignalClosure *
+PyGObject_lookup_signal_closure (PyGObject * self, guint signal_id, PyObject * callback)
 {
-  PyObject * result;
-  GHashTableIter iter;
-  const gchar * key;
-  GVariant * raw_value;
-
-  result = PyDict_New ();
-
-  g_hash_table_iter_init (&iter, dict);
+  PyGObjectSignalKey key;
+  GQueue * closures;
 
-  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &raw_value))
-  {
-    PyObject * value = PyGObject_marshal_variant (raw_value);
+  if (self->signal_closures == NULL)
+    return NULL;
 
-    PyDict_SetItemString (result, key, value);
+  PyGObjectSignalKey_init (&key, signal_id, callback);
 
-    Py_DECREF (value);
-  }
+  closures = g_hash_table_lookup (self->signal_closures, &key);
+  if (closures == NULL)
+    return NULL;
 
-  return result;
+  return g_queue_peek_head (closures);
 }
 
-static PyObject *
-PyGObject_marshal_object (gpointer handle, GType type)
+static gboolean
+PyGObject_remove_signal_closure (PyGObject * self, PyGObjectSignalClosure * closure)
 {
-  const PyGObjectType * pytype;
+  PyGObjectSignalKey key;
+  GQueue * closures;
 
-  if (handle == NULL)
-    Py_RETURN_NONE;
+  if (self->signal_closures == NULL)
+    return FALSE;
 
-  pytype = g_hash_table_lookup (pygobject_type_spec_by_type, GSIZE_TO_POINTER (type));
-  if (pytype == NULL)
-    pytype = PYTELCO_TYPE (GObject);
+  PyGObjectSignalKey_init (&key, closure->signal_id, closure->parent.data);
 
-  if (G_IS_SOCKET_ADDRESS (handle))
-    return PyGObject_marshal_socket_address (handle);
+  closures = g_hash_table_lookup (self->signal_closures, &key);
+  if (closures == NULL || !g_queue_remove (closures, closure))
+    return FALSE;
 
-  return PyGObject_new_take_handle (g_object_ref (handle), pytype);
+  if (g_queue_is_empty (closures))
+    g_hash_table_remove (self->signal_closures, &key);
+
+  return TRUE;
 }
 
-static PyObject *
-PyGObject_marshal_socket_address (GSocketAddress * address)
+static void
+PyGObject_disconnect_signal_closure (PyGObjectSignalClosure * closure, PyGObject * self)
 {
-  PyObject * result = NULL;
+  /* By ID rather than by closure, as GLib would otherwise scan every handler of the signal. */
+  g_signal_handler_disconnect (self->handle, closure->handler_id);
+}
 
-  if (G_IS_INET_SOCKET_ADDRESS (address))
+static void
+PyGObjectSignalKey_init (PyGObjectSignalKey * key, guint signal_id, PyObject * callback)
+{
+  Py_hash_t hash;
+
+  hash = PyObject_Hash (callback);
+  if (hash == -1)
   {
-    GInetSocketAddress * sa;
-    GInetAddress * ia;
-    gchar * host;
-    guint16 port;
+    /* Unhashable callbacks all share a bucket, and are then told apart by equality like before. */
+    PyErr_Clear ();
+    hash = 0;
+  }
 
-    sa = G_INET_SOCKET_ADDRESS (address);
-    ia = g_inet_socket_address_get_address (sa);
+  key->signal_id = signal_id;
+  key->hash = (guint) ((guint64) hash ^ ((guint64) hash >> 32)) ^ (signal_id * 0x9e3779b1U);
+  key->callback = callback;
+}
 
-    host = g_inet_address_to_string (ia);
-    port = g_inet_socket_address_get_port (sa);
+static void
+PyGObjectSignalKey_free (PyGObjectSignalKey * key)
+{
+  Py_DECREF (key->callback);
 
-    if (g_socket_address_get_family (address) == G_SOCKET_FAMILY_IPV4)
-      result = Py_BuildValue ("(sH)", host, port);
-    else
-      result = Py_BuildValue ("(sHII)", host, port, g_inet_socket_address_get_flowinfo (sa), g_inet_socket_address_get_scope_id (sa));
+  g_slice_free (PyGObjectSignalKey, key);
+}
 
-    g_free (host);
-  }
-  else if (G_IS_UNIX_SOCKET_ADDRESS (address))
-  {
-    GUnixSocketAddress * sa = G_UNIX_SOCKET_ADDRESS (address);
+static guint
+PyGObjectSignalKey_hash (const PyGObjectSignalKey * key)
+{
+  return key->hash;
+}
 
-    switch (g_unix_socket_address_get_address_type (sa))
-    {
-      case G_UNIX_SOCKET_ADDRESS_ANONYMOUS:
-      {
-        result = PyUnicode_FromUTF8String ("");
-        break;
-      }
-      case G_UNIX_SOCKET_ADDRESS_PATH:
-      {
-        gchar * path = g_filename_to_utf8 (g_unix_socket_address_get_path (sa), -1, NULL, NULL, NULL);
-        result = PyUnicode_FromUTF8String (path);
-        g_free (path);
-        break;
-      }
-      case G_UNIX_SOCKET_ADDRESS_ABSTRACT:
-      case G_UNIX_SOCKET_ADDRESS_ABSTRACT_PADDED:
-      {
-        result = PyBytes_FromStringAndSize (g_unix_socket_address_get_path (sa), g_unix_socket_address_get_path_len (sa));
-        break;
-      }
-      default:
-      {
-        result = Py_None;
-        Py_INCREF (result);
-        break;
-      }
-    }
-  }
+static gboolean
+PyGObjectSignalKey_equal (const PyGObjectSignalKey * a, const PyGObjectSignalKey * b)
+{
+  int result;
 
-  if (result == NULL)
-    result = PyGObject_new_take_handle (g_object_ref (address), PYTELCO_TYPE (GObject));
+  if (a->signal_id != b->signal_id)
+    return FALSE;
 
-  return result;
+  /* Bound methods are created anew on every attribute access, so identity alone isn't enough. */
+  if (a->callback == b->callback)
+    return TRUE;
+
+  result = PyObject_RichCompareBool (a->callback, b->callback, Py_EQ);
+  if (result == -1)
+    PyErr_Clear ();
+
+  return result == 1;
 }
 
 static gboolean
-PyGObject_unmarshal_certificate (const gchar * str, GTlsCertificate ** certificate)
+PyGObject_parse_signal_method_args (PyObject * args, PyObject * kw, GType instance_type, guint * signal_id, PyObject ** callback,
+    PyGObjectSignalOptions * options)
 {
-  GError * error = NULL;
+  const gchar * signal_name;
 
-  if (strchr (str, '\n') != NULL)
-    *certificate = g_tls_certificate_new_from_pem (str, -1, &error);
-  else
-    *certificate = g_tls_certificate_new_from_file (str, &error);
-  if (error != NULL)
-    goto propagate_error;
+  if (!PyArg_ParseTuple (args, "sO", &signal_name, callback))
+    return FALSE;
 
-  return TRUE;
+  if (options != NULL && !PyGObject_parse_signal_options (kw, instance_type, options))
+    return FALSE;
 
-propagate_error:
+  if (!PyCallable_Check (*callback))
   {
-    PyTelco_raise (g_error_new_literal (TELCO_ERROR, TELCO_ERROR_INVALID_ARGUMENT, error->message));
-    g_error_free (error);
-
+    PyErr_SetString (PyExc_TypeError, "second argument must be callable");
     return FALSE;
   }
+
+  return PyGObject_lookup_signal (signal_name, instance_type, signal_id);
 }
 
+static gboolean
+PyGObject_parse_signal_options (PyObject * kw, GType instance_type, PyGObjectSignalOptions * options)
+{
+  static char * keywords[] =
+      { "decode_json", "lazy_json", "dispatch_rpc", "zero_copy", "max_batch_size", "max_batch_delay", "queue_size", "queue_policy",
+        NULL };
+  PyObject * no_args;
+  int decode_json = FALSE;
+  int lazy_json = FALSE;
+  int dispatch_rpc = FALSE;
+  int zero_copy = FALSE;
+  int max_batch_size = 0;
+  double max_batch_delay = 0.0;
+  int queue_size = 0;
+  const char * queue_policy = "drop-oldest";
+  gboolean valid;
+
+  no_args = PyTuple_New (0);
+  valid = PyArg_ParseTupleAndKeywords (no_args, kw, "|$ppppidis", keywords, &decode_json, &lazy_json, &dispatch_rpc, &zero_copy,
+      &max_batch_size, &max_batch_delay, &queue_size, &queue_policy);
+  Py_DECREF (no_args);
+  if (!valid)
+    return FALSE;
 
-static int
-PyDeviceManager_init (PyDeviceManager * self, PyObject * args, PyObject * kw)
-{
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  memset (options, 0, sizeof (PyGObjectSignalOptions));
 
-  g_atomic_int_inc (&toplevel_objects_alive);
+  if (decode_json)
+    options->flags |= PY_GOBJECT_SIGNAL_DECODE_JSON;
+  if (lazy_json)
+    options->flags |= PY_GOBJECT_SIGNAL_LAZY_JSON;
+  if (dispatch_rpc)
+  {
+    if (!g_type_is_a (instance_type, TELCO_TYPE_SCRIPT))
+    {
+      PyErr_SetString (PyExc_TypeError, "dispatch_rpc is only supported by scripts");
+      return FALSE;
+    }
+    options->flags |= PY_GOBJECT_SIGNAL_DISPATCH_RPC;
+  }
+  if (zero_copy)
+    options->flags |= PY_GOBJECT_SIGNAL_ZERO_COPY;
 
-  PyGObject_take_handle (&self->parent, telco_device_manager_new (), PYTELCO_TYPE (DeviceManager));
+  if (max_batch_size < 0)
+  {
+    PyErr_SetString (PyExc_ValueError, "max_batch_size must be non-negative");
+    return FALSE;
+  }
+  if (max_batch_delay < 0.0 || max_batch_delay > G_MAXUINT / 1000)
+  {
+    PyErr_SetString (PyExc_ValueError, "max_batch_delay is out of range");
+    return FALSE;
+  }
+  options->max_batch_size = max_batch_size;
+  options->max_batch_delay = (guint) (max_batch_delay * 1000.0);
 
-  return 0;
+  if (queue_size < 0)
+  {
+    PyErr_SetString (PyExc_ValueError, "queue_size must be non-negative");
+    return FALSE;
+  }
+  options->queue_size = queue_size;
+
+  if (strcmp (queue_policy, "block") == 0)
+    options->queue_policy = PY_GOBJECT_SIGNAL_QUEUE_BLOCK;
+  else if (strcmp (queue_policy, "drop-oldest") == 0)
+    options->queue_policy = PY_GOBJECT_SIGNAL_QUEUE_DROP_OLDEST;
+  else if (strcmp (queue_policy, "drop-newest") == 0)
+    options->queue_policy = PY_GOBJECT_SIGNAL_QUEUE_DROP_NEWEST;
+  else if (strcmp (queue_policy, "coalesce") == 0)
+    options->queue_policy = PY_GOBJECT_SIGNAL_QUEUE_COALESCE;
+  else
+  {
+    PyErr_SetString (PyExc_ValueError,
+        "queue_policy must be one of 'block', 'drop-oldest', 'drop-newest', or 'coalesce'");
+    return FALSE;
+  }
+
+  return TRUE;
 }
 
-static void
-PyDeviceManager_dealloc (PyDeviceManager * self)
+static gboolean
+PyGObject_lookup_signal (const gchar * signal_name, GType instance_type, guint * signal_id)
 {
-  TelcoDeviceManager * handle;
+  *signal_id = g_signal_lookup (signal_name, instance_type);
+  if (*signal_id == 0)
+    goto invalid_signal_name;
 
-  g_atomic_int_dec_and_test (&toplevel_objects_alive);
+  return TRUE;
 
-  handle = PyGObject_steal_handle (&self->parent);
-  if (handle != NULL)
+invalid_signal_name:
   {
-    Py_BEGIN_ALLOW_THREADS
-    telco_device_manager_close_sync (handle, NULL, NULL);
-    telco_unref (handle);
-    Py_END_ALLOW_THREADS
-  }
-
-  PyGObject_tp_dealloc ((PyObject *) self);
-}
+    GString * message;
+    guint * ids, n_ids, i;
 
-static PyObject *
-PyDeviceManager_close (PyDeviceManager * self)
-{
-  GError * error = NULL;
+    message = g_string_sized_new (128);
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_device_manager_close_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+    g_string_append (message, PyGObject_class_name_from_c (g_type_name (instance_type)));
 
-  Py_RETURN_NONE;
-}
+    ids = g_signal_list_ids (instance_type, &n_ids);
 
-static PyObject *
-PyDeviceManager_get_device_matching (PyDeviceManager * self, PyObject * args)
-{
-  PyObject * predicate;
-  gint timeout;
-  GError * error = NULL;
-  TelcoDevice * result;
+    if (n_ids > 0)
+    {
+      g_string_append_printf (message, " does not have a signal named '%s', it only has: ", signal_name);
 
-  if (!PyArg_ParseTuple (args, "Oi", &predicate, &timeout))
-    return NULL;
+      for (i = 0; i != n_ids; i++)
+      {
+        if (i != 0)
+          g_string_append (message, ", ");
+        g_string_append_c (message, '\'');
+        g_string_append (message, g_signal_name (ids[i]));
+        g_string_append_c (message, '\'');
+      }
+    }
+    else
+    {
+      g_string_append (message, " does not have any signals");
+    }
 
-  if (!PyCallable_Check (predicate))
-    goto not_callable;
+    g_free (ids);
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_manager_get_device_sync (PY_GOBJECT_HANDLE (self), (TelcoDeviceManagerPredicate) PyDeviceManager_is_matching_device,
-      predicate, timeout, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+    PyErr_SetString (PyExc_ValueError, message->str);
 
-  return PyDevice_new_take_handle (result);
+    g_string_free (message, TRUE);
 
-not_callable:
-  {
-    PyErr_SetString (PyExc_TypeError, "object must be callable");
-    return NULL;
+    return FALSE;
   }
 }
 
-static gboolean
-PyDeviceManager_is_matching_device (TelcoDevice * device, PyObject * predicate)
+static const gchar *
+PyGObject_class_name_from_c (const gchar * cname)
 {
-  gboolean is_matching = FALSE;
-  PyGILState_STATE gstate;
-  PyObject * device_object, * result;
+  if (g_str_has_prefix (cname, "Telco"))
+    return cname + 5;
 
-  gstate = PyGILState_Ensure ();
+  return cname;
+}
 
-  device_object = PyDevice_new_take_handle (g_object_ref (device));
+static void
+PyGObject_class_init (void)
+{
+  pygobject_type_spec_by_type = g_hash_table_new_full (NULL, NULL, NULL, NULL);
+  pygobject_signal_signatures = g_hash_table_new_full (NULL, NULL, NULL, NULL);
+  pygobject_interned_keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
 
-  result = PyObject_CallFunction (predicate, "O", device_object);
-  if (result != NULL)
-  {
-    is_matching = result == Py_True;
+static void
+PyGObject_register_type (GType instance_type, PyGObjectType * python_type)
+{
+  g_hash_table_insert (pygobject_type_spec_by_type, GSIZE_TO_POINTER (instance_type), python_type);
+}
 
-    Py_DECREF (result);
+static GClosure *
+PyGObject_make_closure_for_signal (guint signal_id, PyObject * callback, guint max_arg_count, const PyGObjectSignalOptions * options)
+{
+  GClosure * closure;
+  PyGObjectSignalClosure * pyclosure;
+  const PyGObjectSignalSignature * signature;
+
+  closure = g_closure_new_simple (sizeof (PyGObjectSignalClosure), callback);
+  Py_IncRef (callback);
+
+  g_closure_add_finalize_notifier (closure, callback, (GClosureNotify) PyGObjectSignalClosure_finalize);
+  g_closure_set_marshal (closure, PyGObjectSignalClosure_marshal);
+
+  pyclosure = PY_GOBJECT_SIGNAL_CLOSURE (closure);
+  pyclosure->signal_id = signal_id;
+  pyclosure->max_arg_count = max_arg_count;
+  pyclosure->flags = options->flags;
+  pyclosure->max_batch_size = options->max_batch_size;
+
+  signature = PyGObjectSignalSignature_obtain (signal_id, options->flags);
+  pyclosure->signature = signature;
+  if (max_arg_count == signature->n_values)
+  {
+    pyclosure->first_arg = 0;
+    pyclosure->n_args = signature->n_values;
   }
   else
   {
-    PyErr_Print ();
+    pyclosure->first_arg = 1;
+    pyclosure->n_args = MIN (signature->n_values - 1, max_arg_count);
   }
 
-  Py_DECREF (device_object);
+  if (options->queue_size != 0)
+  {
+    pyclosure->queue = PyGObjectSignalQueue_new (signal_id, options);
 
-  PyGILState_Release (gstate);
+    g_closure_add_invalidate_notifier (closure, pyclosure->queue, (GClosureNotify) PyGObjectSignalQueue_invalidate);
+    g_closure_add_finalize_notifier (closure, pyclosure->queue, (GClosureNotify) PyGObjectSignalQueue_free);
 
-  return is_matching;
-}
+    /* Queues are drained by a small shared pool rather than a thread each, streams are drained by their reader. */
+    if (!options->stream && signal_queue_pool == NULL)
+      signal_queue_pool = g_thread_pool_new ((GFunc) PyGObjectSignalClosure_process_queue, NULL,
+          PYTELCO_SIGNAL_QUEUE_MAX_WORKERS, FALSE, NULL);
+  }
+  else if (options->max_batch_size != 0)
+  {
+    pyclosure->batch = PyGObjectSignalBatch_new (signal_id, options);
 
-static PyObject *
-PyDeviceManager_enumerate_devices (PyDeviceManager * self)
-{
-  GError * error = NULL;
-  TelcoDeviceList * result;
-  gint result_length, i;
-  PyObject * devices;
+    g_closure_add_invalidate_notifier (closure, pyclosure->batch, (GClosureNotify) PyGObjectSignalBatch_invalidate);
+    g_closure_add_finalize_notifier (closure, pyclosure->batch, (GClosureNotify) PyGObjectSignalBatch_free);
+  }
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_manager_enumerate_devices_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  return closure;
+}
 
-  result_length = telco_device_list_size (result);
-  devices = PyList_New (result_length);
-  for (i = 0; i != result_length; i++)
-  {
-    PyList_SetItem (devices, i, PyDevice_new_take_handle (telco_device_list_get (result, i)));
-  }
-  telco_unref (result);
+static void
+PyGObjectSignalClosure_finalize (PyObject * callback)
+{
+  PyGILState_STATE gstate;
 
-  return devices;
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_CLOSURE_FINALIZE);
+  Py_DecRef (callback);
+  PyGILState_Release (gstate);
 }
 
-static PyObject *
-PyDeviceManager_add_remote_device (PyDeviceManager * self, PyObject * args, PyObject * kw)
+static const PyGObjectSignalSignature *
+PyGObjectSignalSignature_obtain (guint signal_id, PyGObjectSignalFlags flags)
 {
-  PyObject * result = NULL;
-  static char * keywords[] = { "address", "certificate", "origin", "token", "keepalive_interval", NULL };
-  char * address;
-  char * certificate = NULL;
-  char * origin = NULL;
-  char * token = NULL;
-  int keepalive_interval = -1;
-  TelcoRemoteDeviceOptions * options;
-  GError * error = NULL;
-  TelcoDevice * handle;
+  PyGObjectSignalSignature * signature;
+  gpointer key;
+  GSignalQuery query;
+  guint i;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esesesi", keywords,
-        "utf-8", &address,
-        "utf-8", &certificate,
-        "utf-8", &origin,
-        "utf-8", &token,
-        &keepalive_interval))
-    return NULL;
+  /* Only called with the GIL held, which also serializes access to the cache. The flags fit in the low byte. */
+  key = GUINT_TO_POINTER ((signal_id << 8) | flags);
 
-  options = PyDeviceManager_parse_remote_device_options (certificate, origin, token, keepalive_interval);
-  if (options == NULL)
-    goto beach;
+  signature = g_hash_table_lookup (pygobject_signal_signatures, key);
+  if (signature != NULL)
+    return signature;
 
-  Py_BEGIN_ALLOW_THREADS
-  handle = telco_device_manager_add_remote_device_sync (PY_GOBJECT_HANDLE (self), address, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  g_signal_query (signal_id, &query);
 
-  result = (error == NULL)
-      ? PyDevice_new_take_handle (handle)
-      : PyTelco_raise (error);
+  signature = g_new (PyGObjectSignalSignature, 1);
+  signature->n_values = 1 + query.n_params;
+  signature->marshal_value = g_new (PyGObjectMarshalValueFunc, signature->n_values);
 
-beach:
-  g_clear_object (&options);
+  signature->marshal_value[0] = PyGObject_get_value_marshaller (query.itype, flags);
+  for (i = 0; i != query.n_params; i++)
+    signature->marshal_value[1 + i] = PyGObject_get_value_marshaller (query.param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE, flags);
 
-  PyMem_Free (token);
-  PyMem_Free (origin);
-  PyMem_Free (certificate);
-  PyMem_Free (address);
+  g_hash_table_insert (pygobject_signal_signatures, key, signature);
 
-  return result;
+  return signature;
 }
 
-static PyObject *
-PyDeviceManager_remove_remote_device (PyDeviceManager * self, PyObject * args, PyObject * kw)
+static PyGObjectMarshalValueFunc
+PyGObject_get_value_marshaller (GType type, PyGObjectSignalFlags flags)
 {
-  static char * keywords[] = { "address", NULL };
-  char * address;
-  GError * error = NULL;
+  switch (type)
+  {
+    case G_TYPE_BOOLEAN:
+      return PyGObject_marshal_boolean_value;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es", keywords, "utf-8", &address))
-    return NULL;
+    case G_TYPE_INT:
+      return PyGObject_marshal_int_value;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_device_manager_remove_remote_device_sync (PY_GOBJECT_HANDLE (self), address, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+    case G_TYPE_UINT:
+      return PyGObject_marshal_uint_value;
 
-  PyMem_Free (address);
+    case G_TYPE_FLOAT:
+      return PyGObject_marshal_float_value;
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+    case G_TYPE_DOUBLE:
+      return PyGObject_marshal_double_value;
 
-  Py_RETURN_NONE;
+    case G_TYPE_STRING:
+      if ((flags & PY_GOBJECT_SIGNAL_LAZY_JSON) != 0)
+        return PyGObject_marshal_lazy_json_value;
+      return ((flags & PY_GOBJECT_SIGNAL_DECODE_JSON) != 0) ? PyGObject_marshal_json_value : PyGObject_marshal_string_value;
+
+    case G_TYPE_VARIANT:
+      return PyGObject_marshal_variant_value;
+
+    default:
+      if (G_TYPE_IS_ENUM (type))
+        return PyGObject_marshal_enum_value;
+
+      if (type == G_TYPE_BYTES)
+        return ((flags & PY_GOBJECT_SIGNAL_ZERO_COPY) != 0) ? PyGObject_marshal_bytes_view_value : PyGObject_marshal_bytes_value;
+
+      if (G_TYPE_IS_OBJECT (type))
+        return PyGObject_marshal_object_value;
+
+      /* Anything else is resolved per emission, which reports it as unsupported. */
+      return PyGObject_marshal_value;
+  }
 }
 
-static TelcoRemoteDeviceOptions *
-PyDeviceManager_parse_remote_device_options (const gchar * certificate_value, const gchar * origin, const gchar * token,
-    gint keepalive_interval)
+static void
+PyGObjectSignalClosure_marshal (GClosure * closure, GValue * return_gvalue, guint n_param_values, const GValue * param_values,
+    gpointer invocation_hint, gpointer marshal_data)
 {
-  TelcoRemoteDeviceOptions * options;
+  PyGObjectSignalClosure * self = PY_GOBJECT_SIGNAL_CLOSURE (closure);
+  PyGObjectSignalRouter * router;
+  PyGObjectSignalLimiter * limiter;
+  PyGObjectSignalFilter * filter;
+  PyGObjectSignalLogSink * log_sink;
+  PyGObjectSignalTap * tap;
+  PyGObjectSignalRecorder * recorder;
+  PyGObjectSignalPriority priority;
+  PyGILState_STATE gstate;
+  PyObject * instance;
 
-  options = telco_remote_device_options_new ();
+  (void) return_gvalue;
+  (void) invocation_hint;
+  (void) marshal_data;
 
-  if (certificate_value != NULL)
-  {
-    GTlsCertificate * certificate;
+  if (g_atomic_int_get (&toplevel_objects_alive) == 0)
+    return;
 
-    if (!PyGObject_unmarshal_certificate (certificate_value, &certificate))
-      goto propagate_error;
+  /* The tap mirrors everything the script emits, before any of it is consumed, filtered or reordered below. */
+  tap = g_atomic_pointer_get (&self->tap);
+  if (tap != NULL)
+    PyGObjectSignalTap_write (tap, param_values, n_param_values);
 
-    telco_remote_device_options_set_certificate (options, certificate);
+  recorder = g_atomic_pointer_get (&self->recorder);
+  if (recorder != NULL)
+    PyGObjectSignalRecorder_write (recorder, param_values, n_param_values);
 
-    g_object_unref (certificate);
-  }
+  log_sink = g_atomic_pointer_get (&self->log_sink);
+  if (log_sink != NULL && PyGObjectSignalLogSink_try_write (log_sink, param_values, closure))
+    return;
 
-  if (origin != NULL)
-    telco_remote_device_options_set_origin (options, origin);
+  filter = g_atomic_pointer_get (&self->filter);
+  if (filter != NULL && !PyGObjectSignalClosure_filter (self, filter, param_values))
+    return;
 
-  if (token != NULL)
-    telco_remote_device_options_set_token (options, token);
+  router = g_atomic_pointer_get (&self->router);
+  if (router != NULL && !PyGObjectSignalRouter_accepts (router, param_values))
+    return;
 
-  if (keepalive_interval != -1)
-    telco_remote_device_options_set_keepalive_interval (options, keepalive_interval);
+  limiter = g_atomic_pointer_get (&self->limiter);
+  if (limiter != NULL && !PyGObjectSignalClosure_admit (self, limiter, param_values))
+    return;
 
-  return options;
+  priority = PyGObjectSignalClosure_classify (self, param_values);
 
-propagate_error:
+  /*
+   * RPC replies skip the queue and the dispatcher lanes altogether, as the callback may be blocked waiting for one,
+   * and a lane may be busy with a slow handler for another object. Should the reply turn out to be something else,
+   * the priority lane still lets it overtake the backlog.
+   */
+  if ((self->queue != NULL || g_atomic_pointer_get (&dispatcher_lanes) != NULL) &&
+      priority == PY_GOBJECT_SIGNAL_PRIORITY_HIGH && PyGObjectSignalClosure_may_carry_rpc_reply (self, param_values))
   {
-    g_object_unref (options);
+    gboolean handled = FALSE;
 
-    return NULL;
+    gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_RPC_REPLY);
+    instance = PyGObject_try_get_from_handle (g_value_get_object (&param_values[0]));
+    if (instance != NULL)
+      handled = PyScript_try_dispatch_rpc_reply ((PyScript *) instance, param_values, n_param_values, self->flags);
+    PyGILState_Release (gstate);
+
+    if (handled)
+      return;
   }
-}
 
+  if (self->queue != NULL)
+  {
+    if (PyGObjectSignalQueue_push (self->queue, param_values, priority))
+      g_thread_pool_push (signal_queue_pool, g_closure_ref (closure), NULL);
+    return;
+  }
 
-static PyObject *
-PyDevice_new_take_handle (TelcoDevice * handle)
-{
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Device));
-}
+  /* High priority messages don't wait for the batch to fill up, they are delivered in a batch of their own. */
+  if (self->batch != NULL && priority == PY_GOBJECT_SIGNAL_PRIORITY_NORMAL)
+  {
+    PyGObjectSignalClosure_push_batch (self, param_values, n_param_values);
+    return;
+  }
 
-static int
-PyDevice_init (PyDevice * self, PyObject * args, PyObject * kw)
-{
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  if (g_atomic_pointer_get (&dispatcher_lanes) != NULL)
+  {
+    GArray * values;
+    guint i;
 
-  self->id = NULL;
-  self->name = NULL;
-  self->icon = NULL;
-  self->type = NULL;
-  self->bus = NULL;
+    values = g_array_sized_new (FALSE, TRUE, sizeof (GValue), n_param_values);
+    g_array_set_clear_func (values, (GDestroyNotify) g_value_unset);
+    g_array_set_size (values, n_param_values);
+    for (i = 0; i != n_param_values; i++)
+    {
+      GValue * value = &g_array_index (values, GValue, i);
 
-  return 0;
+      g_value_init (value, G_VALUE_TYPE (&param_values[i]));
+      g_value_copy (&param_values[i], value);
+    }
+
+    PyGObjectSignalClosure_try_dispatch (self, values, 1, n_param_values, priority);
+    g_array_unref (values);
+    return;
+  }
+
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_SIGNAL_EMISSION);
+  PyGObjectSignalClosure_deliver (self, param_values, 1, n_param_values);
+  PyGILState_Release (gstate);
 }
 
-static void
-PyDevice_init_from_handle (PyDevice * self, TelcoDevice * handle)
+static PyGObjectSignalBatch *
+PyGObjectSignalBatch_new (guint signal_id, const PyGObjectSignalOptions * options)
 {
-  GVariant * icon;
+  PyGObjectSignalBatch * batch;
+  GSignalQuery query;
 
-  self->id = PyUnicode_FromUTF8String (telco_device_get_id (handle));
-  self->name = PyUnicode_FromUTF8String (telco_device_get_name (handle));
-  icon = telco_device_get_icon (handle);
-  if (icon != NULL)
-  {
-    self->icon = PyGObject_marshal_variant (icon);
-  }
-  else
-  {
-    self->icon = Py_None;
-    Py_IncRef (Py_None);
-  }
-  self->type = PyGObject_marshal_enum (telco_device_get_dtype (handle), TELCO_TYPE_DEVICE_TYPE);
-  self->bus = PyBus_new_take_handle (g_object_ref (telco_device_get_bus (handle)));
+  g_signal_query (signal_id, &query);
+
+  batch = g_slice_new0 (PyGObjectSignalBatch);
+  g_mutex_init (&batch->lock);
+  batch->max_delay = options->max_batch_delay;
+  batch->stride = 1 + query.n_params;
+  batch->values = g_array_sized_new (FALSE, TRUE, sizeof (GValue), batch->stride * MIN (options->max_batch_size, 64));
+  g_array_set_clear_func (batch->values, (GDestroyNotify) g_value_unset);
+
+  return batch;
 }
 
 static void
-PyDevice_dealloc (PyDevice * self)
+PyGObjectSignalBatch_free (PyGObjectSignalBatch * self)
 {
-  Py_XDECREF (self->bus);
-  Py_XDECREF (self->type);
-  Py_XDECREF (self->icon);
-  Py_XDECREF (self->name);
-  Py_XDECREF (self->id);
+  g_clear_pointer (&self->source, g_source_unref);
+  g_array_unref (self->values);
+  g_mutex_clear (&self->lock);
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  g_slice_free (PyGObjectSignalBatch, self);
 }
 
-static PyObject *
-PyDevice_repr (PyDevice * self)
+static void
+PyGObjectSignalBatch_invalidate (PyGObjectSignalBatch * self)
 {
-  PyObject * id_bytes, * name_bytes, * type_bytes, * result;
+  GArray * values;
 
-  id_bytes = PyUnicode_AsUTF8String (self->id);
-  name_bytes = PyUnicode_AsUTF8String (self->name);
-  type_bytes = PyUnicode_AsUTF8String (self->type);
+  g_mutex_lock (&self->lock);
 
-  result = PyRepr_FromFormat ("Device(id=\"%s\", name=\"%s\", type='%s')",
-      PyBytes_AsString (id_bytes),
-      PyBytes_AsString (name_bytes),
-      PyBytes_AsString (type_bytes));
+  self->invalidated = TRUE;
 
-  Py_DECREF (type_bytes);
-  Py_DECREF (name_bytes);
-  Py_DECREF (id_bytes);
+  if (self->source != NULL)
+  {
+    g_source_destroy (self->source);
+    g_clear_pointer (&self->source, g_source_unref);
+  }
 
-  return result;
+  values = self->values;
+  self->values = g_array_new (FALSE, TRUE, sizeof (GValue));
+  g_array_set_clear_func (self->values, (GDestroyNotify) g_value_unset);
+  self->length = 0;
+
+  g_mutex_unlock (&self->lock);
+
+  g_array_unref (values);
 }
 
-static PyObject *
-PyDevice_is_lost (PyDevice * self)
+static void
+PyGObjectSignalClosure_push_batch (PyGObjectSignalClosure * self, const GValue * params, guint params_length)
 {
-  gboolean is_lost;
+  PyGObjectSignalBatch * batch = self->batch;
+  gboolean flush_now;
+  guint offset, i;
 
-  Py_BEGIN_ALLOW_THREADS
-  is_lost = telco_device_is_lost (PY_GOBJECT_HANDLE (self));
-  Py_END_ALLOW_THREADS
+  g_assert (params_length == batch->stride);
 
-  return PyBool_FromLong (is_lost);
-}
+  g_mutex_lock (&batch->lock);
 
-static PyObject *
-PyDevice_query_system_parameters (PyDevice * self)
-{
-  GError * error = NULL;
-  GHashTable * result;
-  PyObject * parameters;
+  if (batch->invalidated)
+  {
+    g_mutex_unlock (&batch->lock);
+    return;
+  }
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_query_system_parameters_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  offset = batch->values->len;
+  g_array_set_size (batch->values, offset + params_length);
+  for (i = 0; i != params_length; i++)
+  {
+    GValue * value = &g_array_index (batch->values, GValue, offset + i);
 
-  parameters = PyGObject_marshal_parameters_dict (result);
-  g_hash_table_unref (result);
+    g_value_init (value, G_VALUE_TYPE (&params[i]));
+    g_value_copy (&params[i], value);
+  }
+  batch->length++;
 
-  return parameters;
+  /* RPC replies have a thread blocked on them, so they are not held back. */
+  flush_now = batch->length >= self->max_batch_size || PyGObjectSignalClosure_may_carry_rpc_reply (self, params);
+
+  if (!flush_now && batch->source == NULL)
+  {
+    batch->source = (batch->max_delay != 0) ? g_timeout_source_new (batch->max_delay) : g_idle_source_new ();
+    g_source_set_callback (batch->source, (GSourceFunc) PyGObjectSignalClosure_on_batch_timeout, g_closure_ref (&self->parent),
+        (GDestroyNotify) g_closure_unref);
+    g_source_attach (batch->source, g_main_context_get_thread_default ());
+  }
+
+  g_mutex_unlock (&batch->lock);
+
+  if (flush_now)
+    PyGObjectSignalClosure_flush_batch (self);
 }
 
-static PyObject *
-PyDevice_get_frontmost_application (PyDevice * self, PyObject * args, PyObject * kw)
+static gboolean
+PyGObjectSignalClosure_on_batch_timeout (PyGObjectSignalClosure * self)
 {
-  static char * keywords[] = { "scope", NULL };
-  const char * scope_value = NULL;
-  TelcoFrontmostQueryOptions * options;
-  GError * error = NULL;
-  TelcoApplication * result;
-
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|s", keywords, &scope_value))
-    return NULL;
+  PyGObjectSignalClosure_flush_batch (self);
 
-  options = telco_frontmost_query_options_new ();
+  return G_SOURCE_REMOVE;
+}
 
-  if (scope_value != NULL)
-  {
-    TelcoScope scope;
+static void
+PyGObjectSignalClosure_flush_batch (PyGObjectSignalClosure * self)
+{
+  PyGObjectSignalBatch * batch = self->batch;
+  GArray * values;
+  guint length, stride;
+  PyGILState_STATE gstate;
 
-    if (!PyGObject_unmarshal_enum (scope_value, TELCO_TYPE_SCOPE, &scope))
-      goto invalid_argument;
+  g_mutex_lock (&batch->lock);
 
-    telco_frontmost_query_options_set_scope (options, scope);
+  if (batch->source != NULL)
+  {
+    g_source_destroy (batch->source);
+    g_clear_pointer (&batch->source, g_source_unref);
   }
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_get_frontmost_application_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  values = batch->values;
+  length = batch->length;
+  stride = batch->stride;
+  batch->values = g_array_sized_new (FALSE, TRUE, sizeof (GValue), values->len);
+  g_array_set_clear_func (batch->values, (GDestroyNotify) g_value_unset);
+  batch->length = 0;
 
-  g_object_unref (options);
+  g_mutex_unlock (&batch->lock);
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (length == 0 || g_atomic_int_get (&toplevel_objects_alive) == 0)
+    goto beach;
 
-  if (result != NULL)
-    return PyApplication_new_take_handle (result);
-  else
-    Py_RETURN_NONE;
+  if (PyGObjectSignalClosure_try_dispatch (self, values, length, stride, PY_GOBJECT_SIGNAL_PRIORITY_NORMAL))
+    goto beach;
 
-invalid_argument:
-  {
-    g_object_unref (options);
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_BATCH_FLUSH);
+  PyGObjectSignalClosure_deliver (self, (const GValue *) values->data, length, stride);
+  PyGILState_Release (gstate);
 
-    return NULL;
-  }
+beach:
+  g_array_unref (values);
 }
 
-static PyObject *
-PyDevice_enumerate_applications (PyDevice * self, PyObject * args, PyObject * kw)
+static PyGObjectSignalQueue *
+PyGObjectSignalQueue_new (guint signal_id, const PyGObjectSignalOptions * options)
 {
-  static char * keywords[] = { "identifiers", "scope", NULL };
-  PyObject * identifiers = NULL;
-  const char * scope = NULL;
-  TelcoApplicationQueryOptions * options;
-  GError * error = NULL;
-  TelcoApplicationList * result;
-  gint result_length, i;
-  PyObject * applications;
+  PyGObjectSignalQueue * queue;
+  GSignalQuery query;
+  guint i;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|Os", keywords, &identifiers, &scope))
-    return NULL;
+  g_signal_query (signal_id, &query);
 
-  options = PyDevice_parse_application_query_options (identifiers, scope);
-  if (options == NULL)
-    return NULL;
+  queue = g_slice_new0 (PyGObjectSignalQueue);
+  g_mutex_init (&queue->lock);
+  g_cond_init (&queue->cond);
+  queue->capacity = options->queue_size;
+  queue->policy = options->queue_policy;
+  queue->stride = 1 + query.n_params;
+  for (i = 0; i != PY_GOBJECT_SIGNAL_N_PRIORITIES; i++)
+  {
+    queue->lanes[i].slots = g_new0 (GValue, queue->capacity * queue->stride);
+    queue->lanes[i].enqueued_at = g_new (gint64, queue->capacity);
+  }
+  if (options->stream)
+    queue->wakeup = g_cancellable_new ();
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_enumerate_applications_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  return queue;
+}
 
-  g_object_unref (options);
+static void
+PyGObjectSignalQueue_free (PyGObjectSignalQueue * self)
+{
+  guint length, i;
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+  PyGObjectSignalQueue_free_values (PyGObjectSignalQueue_take (self, self->length, &length), length * self->stride);
 
-  result_length = telco_application_list_size (result);
-  applications = PyList_New (result_length);
-  for (i = 0; i != result_length; i++)
+  for (i = 0; i != PY_GOBJECT_SIGNAL_N_PRIORITIES; i++)
   {
-    PyList_SetItem (applications, i, PyApplication_new_take_handle (telco_application_list_get (result, i)));
+    g_free (self->lanes[i].slots);
+    g_free (self->lanes[i].enqueued_at);
   }
-  g_object_unref (result);
+  g_clear_object (&self->wakeup);
+  g_cond_clear (&self->cond);
+  g_mutex_clear (&self->lock);
 
-  return applications;
+  g_slice_free (PyGObjectSignalQueue, self);
 }
 
-static TelcoApplicationQueryOptions *
-PyDevice_parse_application_query_options (PyObject * identifiers_value, const gchar * scope_value)
+static void
+PyGObjectSignalQueue_invalidate (PyGObjectSignalQueue * self)
 {
-  TelcoApplicationQueryOptions * options;
+  GValue * values = NULL;
+  guint length = 0;
 
-  options = telco_application_query_options_new ();
+  g_mutex_lock (&self->lock);
+  self->invalidated = TRUE;
+  /* A stream's consumer still gets to drain whatever was emitted before it was closed. */
+  if (self->wakeup == NULL)
+    values = PyGObjectSignalQueue_take (self, self->length, &length);
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
 
-  if (identifiers_value != NULL)
-  {
-    gint n, i;
+  PyGObjectSignalQueue_free_values (values, length * self->stride);
 
-    n = PySequence_Size (identifiers_value);
-    if (n == -1)
-      goto propagate_error;
+  if (self->wakeup != NULL)
+    g_cancellable_cancel (self->wakeup);
+}
 
-    for (i = 0; i != n; i++)
-    {
-      PyObject * element;
-      gchar * identifier = NULL;
+static gboolean
+PyGObjectSignalQueue_push (PyGObjectSignalQueue * self, const GValue * params, PyGObjectSignalPriority priority)
+{
+  PyGObjectSignalLane * lane = &self->lanes[priority];
+  GValue * displaced = NULL;
+  guint n_displaced = 0;
+  gboolean was_empty = FALSE;
+  gboolean schedule = FALSE;
+  GValue * slot;
+  guint i;
 
-      element = PySequence_GetItem (identifiers_value, i);
-      if (element == NULL)
-        goto propagate_error;
-      PyGObject_unmarshal_string (element, &identifier);
-      Py_DECREF (element);
-      if (identifier == NULL)
-        goto propagate_error;
+  /*
+   * RPC replies are consumed by the fast path in marshal before they get here, so both lanes follow the configured
+   * policy: a prioritized tag must not be able to stall the emitting main context when the user asked to shed.
+   */
+  g_mutex_lock (&self->lock);
 
-      telco_application_query_options_select_identifier (options, identifier);
+  if (self->invalidated)
+    goto beach;
 
-      g_free (identifier);
+  if (lane->length == self->capacity)
+  {
+    switch (self->policy)
+    {
+      case PY_GOBJECT_SIGNAL_QUEUE_BLOCK:
+        /* Stalls the emitting main context, so the callback must not wait on it. */
+        while (lane->length == self->capacity && !self->invalidated)
+          g_cond_wait (&self->cond, &self->lock);
+        if (self->invalidated)
+          goto beach;
+        break;
+      case PY_GOBJECT_SIGNAL_QUEUE_DROP_OLDEST:
+        displaced = g_malloc (self->stride * sizeof (GValue));
+        n_displaced = 1;
+        PyGObjectSignalLane_pop (lane, self, displaced);
+        self->length--;
+        self->dropped++;
+        break;
+      case PY_GOBJECT_SIGNAL_QUEUE_DROP_NEWEST:
+        self->dropped++;
+        goto beach;
+      case PY_GOBJECT_SIGNAL_QUEUE_COALESCE:
+        /* Replace the newest pending message so the consumer catches up on the latest state. */
+        slot = &lane->slots[((lane->head + lane->length - 1) % self->capacity) * self->stride];
+        displaced = g_malloc (self->stride * sizeof (GValue));
+        n_displaced = 1;
+        memcpy (displaced, slot, self->stride * sizeof (GValue));
+        memset (slot, 0, self->stride * sizeof (GValue));
+        lane->length--;
+        self->length--;
+        self->dropped++;
+        break;
     }
   }
 
-  if (scope_value != NULL)
+  i = (lane->head + lane->length) % self->capacity;
+  lane->enqueued_at[i] = g_get_monotonic_time ();
+  slot = &lane->slots[i * self->stride];
+  for (i = 0; i != self->stride; i++)
   {
-    TelcoScope scope;
+    g_value_init (&slot[i], G_VALUE_TYPE (&params[i]));
+    g_value_copy (&params[i], &slot[i]);
+  }
+  lane->length++;
 
-    if (!PyGObject_unmarshal_enum (scope_value, TELCO_TYPE_SCOPE, &scope))
-      goto propagate_error;
+  was_empty = self->length == 0;
+  self->length++;
+  self->high_water = MAX (self->high_water, self->length);
+  g_atomic_int_set (&self->priority_length, self->lanes[PY_GOBJECT_SIGNAL_PRIORITY_HIGH].length);
 
-    telco_application_query_options_set_scope (options, scope);
+  if (self->wakeup == NULL && !self->scheduled)
+  {
+    self->scheduled = TRUE;
+    schedule = TRUE;
   }
 
-  return options;
+  g_cond_broadcast (&self->cond);
 
-propagate_error:
-  {
-    g_object_unref (options);
+beach:
+  g_mutex_unlock (&self->lock);
 
-    return NULL;
-  }
+  PyGObjectSignalQueue_free_values (displaced, n_displaced * self->stride);
+
+  if (was_empty && self->wakeup != NULL)
+    g_cancellable_cancel (self->wakeup);
+
+  return schedule;
 }
 
-static PyObject *
-PyDevice_enumerate_processes (PyDevice * self, PyObject * args, PyObject * kw)
+static GValue *
+PyGObjectSignalQueue_take (PyGObjectSignalQueue * self, guint max_length, guint * length)
 {
-  static char * keywords[] = { "pids", "scope", NULL };
-  PyObject * pids = NULL;
-  const char * scope = NULL;
-  TelcoProcessQueryOptions * options;
-  GError * error = NULL;
-  TelcoProcessList * result;
-  gint result_length, i;
-  PyObject * processes;
+  GValue * values;
+  gint64 now;
+  guint n, i;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|Os", keywords, &pids, &scope))
+  *length = MIN (self->length, max_length);
+  if (*length == 0)
     return NULL;
 
-  options = PyDevice_parse_process_query_options (pids, scope);
-  if (options == NULL)
-    return NULL;
+  values = g_malloc (*length * self->stride * sizeof (GValue));
+  now = g_get_monotonic_time ();
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_enumerate_processes_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  /* Lanes are drained in priority order, each one in the order it was filled. */
+  for (n = 0, i = 0; i != PY_GOBJECT_SIGNAL_N_PRIORITIES; i++)
+  {
+    PyGObjectSignalLane * lane = &self->lanes[i];
 
-  g_object_unref (options);
+    for (; n != *length && lane->length != 0; n++)
+    {
+      gint64 wait;
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+      wait = now - PyGObjectSignalLane_pop (lane, self, &values[n * self->stride]);
 
-  result_length = telco_process_list_size (result);
-  processes = PyList_New (result_length);
-  for (i = 0; i != result_length; i++)
-  {
-    PyList_SetItem (processes, i, PyProcess_new_take_handle (telco_process_list_get (result, i)));
+      lane->delivered++;
+      lane->total_wait += wait;
+      lane->max_wait = MAX (lane->max_wait, wait);
+    }
   }
-  g_object_unref (result);
+  self->length -= *length;
+  g_atomic_int_set (&self->priority_length, self->lanes[PY_GOBJECT_SIGNAL_PRIORITY_HIGH].length);
 
-  return processes;
+  return values;
 }
 
-static TelcoProcessQueryOptions *
-PyDevice_parse_process_query_options (PyObject * pids_value, const gchar * scope_value)
+static gint64
+PyGObjectSignalLane_pop (PyGObjectSignalLane * self, const PyGObjectSignalQueue * queue, GValue * entry)
 {
-  TelcoProcessQueryOptions * options;
+  gsize entry_size = queue->stride * sizeof (GValue);
+  GValue * slot = &self->slots[self->head * queue->stride];
+  gint64 enqueued_at = self->enqueued_at[self->head];
 
-  options = telco_process_query_options_new ();
+  memcpy (entry, slot, entry_size);
+  memset (slot, 0, entry_size);
 
-  if (pids_value != NULL)
-  {
-    gint n, i;
+  self->head = (self->head + 1) % queue->capacity;
+  self->length--;
 
-    n = PySequence_Size (pids_value);
-    if (n == -1)
-      goto propagate_error;
+  return enqueued_at;
+}
 
-    for (i = 0; i != n; i++)
-    {
-      PyObject * element;
-      long long pid;
+static PyObject *
+PyGObjectSignalQueue_get_stats (PyGObjectSignalQueue * self)
+{
+  guint length, capacity, high_water;
+  guint64 dropped;
+  PyGObjectSignalLane high, normal;
+
+  g_mutex_lock (&self->lock);
+  length = self->length;
+  capacity = self->capacity;
+  high_water = self->high_water;
+  dropped = self->dropped;
+  high = self->lanes[PY_GOBJECT_SIGNAL_PRIORITY_HIGH];
+  normal = self->lanes[PY_GOBJECT_SIGNAL_PRIORITY_NORMAL];
+  g_mutex_unlock (&self->lock);
+
+  /* Waits are in microseconds, from when a message was queued until it was taken for delivery. */
+  return Py_BuildValue ("{s:I,s:I,s:I,s:K,s:I,s:K,s:L,s:L,s:I,s:K,s:L,s:L}",
+      "length", length,
+      "capacity", capacity,
+      "high_water", high_water,
+      "dropped", (unsigned long long) dropped,
+      "priority_length", high.length,
+      "priority_delivered", (unsigned long long) high.delivered,
+      "priority_wait_avg_us", (long long) PyGObjectSignalLane_get_average_wait (&high),
+      "priority_wait_max_us", (long long) high.max_wait,
+      "bulk_length", normal.length,
+      "bulk_delivered", (unsigned long long) normal.delivered,
+      "bulk_wait_avg_us", (long long) PyGObjectSignalLane_get_average_wait (&normal),
+      "bulk_wait_max_us", (long long) normal.max_wait);
+}
+
+static gint64
+PyGObjectSignalLane_get_average_wait (const PyGObjectSignalLane * self)
+{
+  return (self->delivered != 0) ? self->total_wait / (gint64) self->delivered : 0;
+}
 
-      element = PySequence_GetItem (pids_value, i);
-      if (element == NULL)
-        goto propagate_error;
-      pid = PyLong_AsLongLong (element);
-      Py_DECREF (element);
-      if (pid == -1)
-        goto propagate_error;
+static void
+PyGObjectSignalQueue_free_values (GValue * values, guint n_values)
+{
+  guint i;
 
-      telco_process_query_options_select_pid (options, pid);
-    }
+  if (values == NULL)
+    return;
+
+  for (i = 0; i != n_values; i++)
+    g_value_unset (&values[i]);
+  g_free (values);
+}
+
+static void
+PyGObjectSignalClosure_process_queue (PyGObjectSignalClosure * self, gpointer user_data)
+{
+  PyGObjectSignalQueue * queue = self->queue;
+  GValue * values = NULL;
+  guint max_length, length = 0;
+  gboolean reschedule;
+  PyGILState_STATE gstate;
+
+  max_length = (self->max_batch_size != 0) ? self->max_batch_size : queue->capacity;
+
+  g_mutex_lock (&queue->lock);
+  if (!queue->invalidated)
+  {
+    values = PyGObjectSignalQueue_take (queue, max_length, &length);
+    g_cond_broadcast (&queue->cond);
   }
+  g_mutex_unlock (&queue->lock);
 
-  if (scope_value != NULL)
+  if (length != 0 && g_atomic_int_get (&toplevel_objects_alive) != 0)
   {
-    TelcoScope scope;
+    gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_SIGNAL_QUEUE);
+    if (self->max_batch_size != 0)
+      PyGObjectSignalClosure_deliver (self, values, length, queue->stride);
+    else
+      PyGObjectSignalClosure_deliver_queued (self, values, length);
+    PyGILState_Release (gstate);
+  }
 
-    if (!PyGObject_unmarshal_enum (scope_value, TELCO_TYPE_SCOPE, &scope))
-      goto propagate_error;
+  PyGObjectSignalQueue_free_values (values, length * queue->stride);
 
-    telco_process_query_options_set_scope (options, scope);
-  }
+  /* Requeue behind the other closures rather than draining to empty, so one busy signal can't starve the pool. */
+  g_mutex_lock (&queue->lock);
+  reschedule = queue->length != 0 && !queue->invalidated;
+  queue->scheduled = reschedule;
+  g_mutex_unlock (&queue->lock);
 
-  return options;
+  if (reschedule)
+    g_thread_pool_push (signal_queue_pool, self, NULL);
+  else
+    g_closure_unref (&self->parent);
+}
 
-propagate_error:
+static void
+PyGObjectSignalClosure_deliver_queued (PyGObjectSignalClosure * self, const GValue * values, guint length)
+{
+  PyGObjectSignalQueue * queue = self->queue;
+  guint i;
+
+  /* Called with the GIL held. Messages that enter the priority lane meanwhile get to overtake the rest of the chunk. */
+  for (i = 0; i != length; i++)
   {
-    g_object_unref (options);
+    if (g_atomic_int_get (&queue->priority_length) != 0)
+    {
+      GValue * urgent;
+      guint n_urgent;
 
-    return NULL;
+      g_mutex_lock (&queue->lock);
+      urgent = PyGObjectSignalQueue_take (queue, queue->lanes[PY_GOBJECT_SIGNAL_PRIORITY_HIGH].length, &n_urgent);
+      g_cond_broadcast (&queue->cond);
+      g_mutex_unlock (&queue->lock);
+
+      if (n_urgent != 0)
+        PyGObjectSignalClosure_deliver (self, urgent, n_urgent, queue->stride);
+      PyGObjectSignalQueue_free_values (urgent, n_urgent * queue->stride);
+    }
+
+    PyGObjectSignalClosure_deliver (self, &values[i * queue->stride], 1, queue->stride);
   }
 }
 
-static PyObject *
-PyDevice_enable_spawn_gating (PyDevice * self)
+static gboolean
+PyGObjectSignalClosure_may_carry_rpc_reply (PyGObjectSignalClosure * self, const GValue * params)
 {
-  GError * error = NULL;
+  const gchar * raw_message;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_device_enable_spawn_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if ((self->flags & PY_GOBJECT_SIGNAL_DISPATCH_RPC) == 0 || G_VALUE_TYPE (&params[1]) != G_TYPE_STRING)
+    return FALSE;
 
-  Py_RETURN_NONE;
+  raw_message = g_value_get_string (&params[1]);
+
+  return raw_message != NULL && strstr (raw_message, "\"telco:rpc\"") != NULL;
 }
 
-static PyObject *
-PyDevice_disable_spawn_gating (PyDevice * self)
+static PyGObjectSignalPriority
+PyGObjectSignalClosure_classify (PyGObjectSignalClosure * self, const GValue * params)
 {
-  GError * error = NULL;
+  PyGObjectSignalRouter * router;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_device_disable_spawn_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (PyGObjectSignalClosure_may_carry_rpc_reply (self, params))
+    return PY_GOBJECT_SIGNAL_PRIORITY_HIGH;
 
-  Py_RETURN_NONE;
+  router = g_atomic_pointer_get (&self->router);
+  if (router != NULL && PyGObjectSignalRouter_is_priority (router, params))
+    return PY_GOBJECT_SIGNAL_PRIORITY_HIGH;
+
+  return PY_GOBJECT_SIGNAL_PRIORITY_NORMAL;
 }
 
-static PyObject *
-PyDevice_enumerate_pending_spawn (PyDevice * self)
+static gboolean
+PyGObjectSignalClosure_try_route (PyGObjectSignalClosure * self, const GValue * params)
 {
-  GError * error = NULL;
-  TelcoSpawnList * result;
-  gint result_length, i;
-  PyObject * spawn;
+  PyObject * handler;
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_enumerate_pending_spawn_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (!PyGObjectSignalRouter_route (self->router, params, &handler))
+    return TRUE;
 
-  result_length = telco_spawn_list_size (result);
-  spawn = PyList_New (result_length);
-  for (i = 0; i != result_length; i++)
-  {
-    PyList_SetItem (spawn, i, PySpawn_new_take_handle (telco_spawn_list_get (result, i)));
-  }
-  g_object_unref (result);
+  if (handler == NULL)
+    return FALSE;
 
-  return spawn;
+  PyGObjectSignalClosure_invoke (self, handler, params);
+  Py_DECREF (handler);
+
+  return TRUE;
 }
 
-static PyObject *
-PyDevice_enumerate_pending_children (PyDevice * self)
+static PyGObjectSignalRouter *
+PyGObjectSignalRouter_new (void)
 {
-  GError * error = NULL;
-  TelcoChildList * result;
-  gint result_length, i;
-  PyObject * children;
+  PyGObjectSignalRouter * router;
 
-  Py_BEGIN_ALLOW_THREADS
-  result = telco_device_enumerate_pending_children_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  router = g_slice_new0 (PyGObjectSignalRouter);
+  g_mutex_init (&router->lock);
+  router->routes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  router->priority_tags = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  router->deliver_unmatched = TRUE;
 
-  result_length = telco_child_list_size (result);
-  children = PyList_New (result_length);
-  for (i = 0; i != result_length; i++)
+  return router;
+}
+
+static void
+PyGObjectSignalRouter_free (PyGObjectSignalRouter * self)
+{
+  PyGILState_STATE gstate;
+  GHashTableIter iter;
+  PyObject * handler;
+
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_ROUTER_FREE);
+  g_hash_table_iter_init (&iter, self->routes);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &handler))
+    Py_DecRef (handler);
+  PyGILState_Release (gstate);
+
+  g_hash_table_unref (self->priority_tags);
+  g_hash_table_unref (self->routes);
+  g_mutex_clear (&self->lock);
+
+  g_slice_free (PyGObjectSignalRouter, self);
+}
+
+static gboolean
+PyGObjectSignalRouter_accepts (PyGObjectSignalRouter * self, const GValue * params)
+{
+  gchar tag[PYTELCO_MAX_ROUTE_TAG_LENGTH + 1];
+  gboolean accepted;
+
+  /* Called by the emitting thread without the GIL, so that unwanted messages never reach the interpreter. */
+  if (g_atomic_int_get (&self->deliver_unmatched))
+    return TRUE;
+
+  if (!PyGObjectSignalRouter_peek_tag (params, tag))
+    return TRUE;
+
+  g_mutex_lock (&self->lock);
+  accepted = self->deliver_unmatched || g_hash_table_contains (self->routes, tag);
+  if (!accepted)
+    self->dropped++;
+  g_mutex_unlock (&self->lock);
+
+  return accepted;
+}
+
+static gboolean
+PyGObjectSignalRouter_route (PyGObjectSignalRouter * self, const GValue * params, PyObject ** handler)
+{
+  gchar tag[PYTELCO_MAX_ROUTE_TAG_LENGTH + 1];
+  gboolean deliver = TRUE;
+
+  *handler = NULL;
+
+  if (!PyGObjectSignalRouter_peek_tag (params, tag))
+    return TRUE;
+
+  g_mutex_lock (&self->lock);
+  *handler = g_hash_table_lookup (self->routes, tag);
+  if (*handler != NULL)
   {
-    PyList_SetItem (children, i, PyChild_new_take_handle (telco_child_list_get (result, i)));
+    Py_INCREF (*handler);
+    self->routed++;
   }
-  g_object_unref (result);
+  else if (self->deliver_unmatched)
+  {
+    self->unmatched++;
+  }
+  else
+  {
+    self->dropped++;
+    deliver = FALSE;
+  }
+  g_mutex_unlock (&self->lock);
 
-  return children;
+  return deliver;
 }
 
-static PyObject *
-PyDevice_spawn (PyDevice * self, PyObject * args, PyObject * kw)
+static gboolean
+PyGObjectSignalRouter_is_priority (PyGObjectSignalRouter * self, const GValue * params)
 {
-  static char * keywords[] = { "program", "argv", "envp", "env", "cwd", "stdio", "aux", NULL };
-  const char * program;
-  PyObject * argv_value = Py_None;
-  PyObject * envp_value = Py_None;
-  PyObject * env_value = Py_None;
-  const char * cwd = NULL;
-  const char * stdio_value = NULL;
-  PyObject * aux_value = Py_None;
-  TelcoSpawnOptions * options;
-  GError * error = NULL;
-  guint pid;
+  gchar tag[PYTELCO_MAX_ROUTE_TAG_LENGTH + 1];
+  gboolean is_priority;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "s|OOOzzO", keywords,
-      &program,
-      &argv_value,
-      &envp_value,
-      &env_value,
-      &cwd,
-      &stdio_value,
-      &aux_value))
-    return NULL;
+  if (g_atomic_int_get (&self->n_priority_tags) == 0)
+    return FALSE;
 
-  options = telco_spawn_options_new ();
+  if (!PyGObjectSignalRouter_peek_tag (params, tag))
+    return FALSE;
 
-  if (argv_value != Py_None)
-  {
-    gchar ** argv;
-    gint argv_length;
+  g_mutex_lock (&self->lock);
+  is_priority = g_hash_table_contains (self->priority_tags, tag);
+  g_mutex_unlock (&self->lock);
 
-    if (!PyGObject_unmarshal_strv (argv_value, &argv, &argv_length))
-      goto invalid_argument;
+  return is_priority;
+}
 
-    telco_spawn_options_set_argv (options, argv, argv_length);
+static gboolean
+PyGObjectSignalRouter_peek_tag (const GValue * params, gchar * tag)
+{
+  const gchar * raw_message, * raw_tag;
+  gboolean is_send;
+  gsize tag_length;
 
-    g_strfreev (argv);
-  }
+  if (G_VALUE_TYPE (&params[1]) != G_TYPE_STRING)
+    return FALSE;
 
-  if (envp_value != Py_None)
-  {
-    gchar ** envp;
-    gint envp_length;
+  raw_message = g_value_get_string (&params[1]);
+  if (raw_message == NULL)
+    return FALSE;
 
-    if (!PyGObject_unmarshal_envp (envp_value, &envp, &envp_length))
-      goto invalid_argument;
+  /*
+   * Only "send" messages take part in routing. Logs, errors, and anything tagged with our own "telco:" prefix,
+   * such as RPC replies, always take the regular path.
+   */
+  if (!PyTelco_peek_message_tag (raw_message, &is_send, &raw_tag, &tag_length) || !is_send)
+    return FALSE;
 
-    telco_spawn_options_set_envp (options, envp, envp_length);
+  if (raw_tag != NULL && g_str_has_prefix (raw_tag, "telco:"))
+    return FALSE;
 
-    g_strfreev (envp);
-  }
+  /* Untagged messages, and those with tags too long to ever be routed, are matched against the empty tag. */
+  if (raw_tag == NULL || tag_length > PYTELCO_MAX_ROUTE_TAG_LENGTH)
+    tag_length = 0;
+  if (tag_length != 0)
+    memcpy (tag, raw_tag, tag_length);
+  tag[tag_length] = '\0';
 
-  if (env_value != Py_None)
-  {
-    gchar ** env;
-    gint env_length;
+  return TRUE;
+}
 
-    if (!PyGObject_unmarshal_envp (env_value, &env, &env_length))
-      goto invalid_argument;
+static PyObject *
+PyGObjectSignalRouter_get_stats (PyGObjectSignalRouter * self)
+{
+  guint routes;
+  guint64 routed, unmatched, dropped;
 
-    telco_spawn_options_set_env (options, env, env_length);
+  g_mutex_lock (&self->lock);
+  routes = g_hash_table_size (self->routes);
+  routed = self->routed;
+  unmatched = self->unmatched;
+  dropped = self->dropped;
+  g_mutex_unlock (&self->lock);
 
-    g_strfreev (env);
-  }
+  return Py_BuildValue ("{s:I,s:K,s:K,s:K}",
+      "routes", routes,
+      "routed", (unsigned long long) routed,
+      "unmatched", (unsigned long long) unmatched,
+      "dropped", (unsigned long long) dropped);
+}
 
-  if (cwd != NULL)
-    telco_spawn_options_set_cwd (options, cwd);
+static gboolean
+PyGObjectSignalClosure_admit (PyGObjectSignalClosure * self, PyGObjectSignalLimiter * limiter, const GValue * params)
+{
+  gchar tag[PYTELCO_MAX_ROUTE_TAG_LENGTH + 1];
 
-  if (stdio_value != NULL)
-  {
-    TelcoStdio stdio;
+  /* Script messages other than regular "send" ones, such as errors and RPC replies, are never shed. */
+  if ((self->flags & PY_GOBJECT_SIGNAL_DISPATCH_RPC) != 0 && !PyGObjectSignalRouter_peek_tag (params, tag))
+    return TRUE;
 
-    if (!PyGObject_unmarshal_enum (stdio_value, TELCO_TYPE_STDIO, &stdio))
-      goto invalid_argument;
+  return PyGObjectSignalLimiter_admit (limiter);
+}
 
-    telco_spawn_options_set_stdio (options, stdio);
-  }
+static PyGObjectSignalLimiter *
+PyGObjectSignalLimiter_new (void)
+{
+  PyGObjectSignalLimiter * limiter;
 
-  if (aux_value != Py_None)
+  limiter = g_slice_new0 (PyGObjectSignalLimiter);
+  g_mutex_init (&limiter->lock);
+  limiter->sample_every = 1;
+
+  return limiter;
+}
+
+static void
+PyGObjectSignalLimiter_free (PyGObjectSignalLimiter * self)
+{
+  g_mutex_clear (&self->lock);
+
+  g_slice_free (PyGObjectSignalLimiter, self);
+}
+
+static void
+PyGObjectSignalLimiter_configure (PyGObjectSignalLimiter * self, guint sample_every, gdouble max_rate, gdouble max_burst)
+{
+  g_mutex_lock (&self->lock);
+
+  self->sample_every = sample_every;
+  self->sample_countdown = 0;
+
+  /* Without an explicit burst the bucket holds one second's worth, which amounts to a per-second cap. */
+  self->max_rate = max_rate;
+  self->max_burst = (max_burst != 0) ? max_burst : MAX (max_rate, 1.0);
+  self->tokens = self->max_burst;
+  self->refilled_at = g_get_monotonic_time ();
+
+  g_mutex_unlock (&self->lock);
+}
+
+static gboolean
+PyGObjectSignalLimiter_admit (PyGObjectSignalLimiter * self)
+{
+  gboolean admitted = FALSE;
+
+  g_mutex_lock (&self->lock);
+
+  if (self->sample_countdown != 0)
   {
-    GHashTable * aux;
-    Py_ssize_t pos;
-    PyObject * key, * value;
+    self->sample_countdown--;
+    self->sampled_out++;
+    goto beach;
+  }
+  self->sample_countdown = self->sample_every - 1;
 
-    aux = telco_spawn_options_get_aux (options);
+  if (self->max_rate != 0)
+  {
+    gint64 now;
 
-    if (!PyDict_Check (aux_value))
-      goto invalid_aux_dict;
+    now = g_get_monotonic_time ();
+    self->tokens = MIN (self->tokens + (now - self->refilled_at) * self->max_rate / G_USEC_PER_SEC, self->max_burst);
+    self->refilled_at = now;
 
-    pos = 0;
-    while (PyDict_Next (aux_value, &pos, &key, &value))
+    if (self->tokens < 1.0)
     {
-      gchar * raw_key;
-      GVariant * raw_value;
+      self->throttled++;
+      goto beach;
+    }
+    self->tokens -= 1.0;
+  }
 
-      if (!PyGObject_unmarshal_string (key, &raw_key))
-        goto invalid_dict_key;
+  self->passed++;
+  admitted = TRUE;
 
-      if (!PyGObject_unmarshal_variant (value, &raw_value))
+beach:
+  g_mutex_unlock (&self->lock);
+
+  return admitted;
+}
+
+static PyObject *
+PyGObjectSignalLimiter_get_stats (PyGObjectSignalLimiter * self)
+{
+  guint64 passed, sampled_out, throttled;
+
+  g_mutex_lock (&self->lock);
+  passed = self->passed;
+  sampled_out = self->sampled_out;
+  throttled = self->throttled;
+  g_mutex_unlock (&self->lock);
+
+  return Py_BuildValue ("{s:K,s:K,s:K}",
+      "passed", (unsigned long long) passed,
+      "sampled_out", (unsigned long long) sampled_out,
+      "throttled", (unsigned long long) throttled);
+}
+
+static gboolean
+PyGObjectSignalClosure_filter (PyGObjectSignalClosure * self, PyGObjectSignalFilter * filter, const GValue * params)
+{
+  gchar tag[PYTELCO_MAX_ROUTE_TAG_LENGTH + 1];
+
+  /* As with limits, script messages other than regular "send" ones always make it through. */
+  if ((self->flags & PY_GOBJECT_SIGNAL_DISPATCH_RPC) != 0 && !PyGObjectSignalRouter_peek_tag (params, tag))
+    return TRUE;
+
+  return PyGObjectSignalFilter_accepts (filter, params);
+}
+
+static PyGObjectSignalFilter *
+PyGObjectSignalFilter_new (void)
+{
+  PyGObjectSignalFilter * filter;
+
+  filter = g_slice_new0 (PyGObjectSignalFilter);
+  g_mutex_init (&filter->lock);
+
+  return filter;
+}
+
+static void
+PyGObjectSignalFilter_free (PyGObjectSignalFilter * self)
+{
+  if (self->values != NULL)
+    g_hash_table_unref (self->values);
+  g_free (self->key);
+  g_mutex_clear (&self->lock);
+
+  g_slice_free (PyGObjectSignalFilter, self);
+}
+
+static void
+PyGObjectSignalFilter_configure (PyGObjectSignalFilter * self, gchar * key, GHashTable * values)
+{
+  gchar * old_key;
+  GHashTable * old_values;
+
+  /* Takes ownership of key and values, a NULL key lets everything through. */
+  g_mutex_lock (&self->lock);
+  old_key = self->key;
+  old_values = self->values;
+  self->key = key;
+  self->values = values;
+  g_mutex_unlock (&self->lock);
+
+  if (old_values != NULL)
+    g_hash_table_unref (old_values);
+  g_free (old_key);
+}
+
+static gboolean
+PyGObjectSignalFilter_accepts (PyGObjectSignalFilter * self, const GValue * params)
+{
+  gchar value[PYTELCO_MAX_FILTER_VALUE_LENGTH + 1];
+  const gchar * raw_message;
+  gboolean accepted;
+
+  /* Called by the emitting thread without the GIL, so that unwanted messages are never even decoded. */
+  if (G_VALUE_TYPE (&params[1]) != G_TYPE_STRING)
+    return TRUE;
+
+  raw_message = g_value_get_string (&params[1]);
+  if (raw_message == NULL)
+    return TRUE;
+
+  g_mutex_lock (&self->lock);
+  if (self->key != NULL)
+  {
+    accepted = PyTelco_peek_message_value (raw_message, self->key, value) && g_hash_table_contains (self->values, value);
+    if (accepted)
+      self->passed++;
+    else
+      self->filtered++;
+  }
+  else
+  {
+    accepted = TRUE;
+  }
+  g_mutex_unlock (&self->lock);
+
+  return accepted;
+}
+
+static PyObject *
+PyGObjectSignalFilter_get_stats (PyGObjectSignalFilter * self)
+{
+  gchar * key;
+  guint values;
+  guint64 passed, filtered;
+  PyObject * stats;
+
+  g_mutex_lock (&self->lock);
+  key = g_strdup (self->key);
+  values = (self->values != NULL) ? g_hash_table_size (self->values) : 0;
+  passed = self->passed;
+  filtered = self->filtered;
+  g_mutex_unlock (&self->lock);
+
+  stats = Py_BuildValue ("{s:z,s:I,s:K,s:K}",
+      "key", key,
+      "values", values,
+      "passed", (unsigned long long) passed,
+      "filtered", (unsigned long long) filtered);
+  g_free (key);
+
+  return stats;
+}
+
+static PyGObjectSignalLogSink *
+PyGObjectSignalLogSink_new (void)
+{
+  PyGObjectSignalLogSink * sink;
+
+  sink = g_slice_new0 (PyGObjectSignalLogSink);
+  g_mutex_init (&sink->lock);
+
+  return sink;
+}
+
+static void
+PyGObjectSignalLogSink_free (PyGObjectSignalLogSink * self)
+{
+  PyGObjectSignalLogSink_close (self);
+  g_mutex_clear (&self->lock);
+
+  g_slice_free (PyGObjectSignalLogSink, self);
+}
+
+static void
+PyGObjectSignalLogSink_configure (PyGObjectSignalLogSink * self, PyGObjectSignalLogSink * config)
+{
+  PyGObjectSignalLogSink previous = { 0, };
+
+  g_mutex_lock (&self->lock);
+
+  previous.stream = self->stream;
+  previous.file = self->file;
+  previous.path = self->path;
+  previous.ring = self->ring;
+  previous.ring_capacity = self->ring_capacity;
+  previous.ring_head = self->ring_head;
+  previous.ring_length = self->ring_length;
+
+  self->min_level = config->min_level;
+  self->stream = config->stream;
+  self->file = config->file;
+  self->path = config->path;
+  self->file_size = config->file_size;
+  self->max_bytes = config->max_bytes;
+  self->backup_count = config->backup_count;
+  self->ring = config->ring;
+  self->ring_capacity = config->ring_capacity;
+  self->ring_head = 0;
+  self->ring_length = 0;
+
+  g_atomic_int_set (&self->enabled, self->stream != NULL || self->file != NULL || self->ring != NULL);
+
+  g_mutex_unlock (&self->lock);
+
+  PyGObjectSignalLogSink_close (&previous);
+}
+
+static void
+PyGObjectSignalLogSink_close (PyGObjectSignalLogSink * self)
+{
+  guint i;
+
+  g_clear_pointer (&self->stream, fclose);
+  g_clear_pointer (&self->file, fclose);
+  g_clear_pointer (&self->path, g_free);
+
+  for (i = 0; i != self->ring_length; i++)
+    g_free (self->ring[(self->ring_head + i) % self->ring_capacity].text);
+  g_clear_pointer (&self->ring, g_free);
+  self->ring_capacity = 0;
+  self->ring_head = 0;
+  self->ring_length = 0;
+}
+
+static gboolean
+PyGObjectSignalLogSink_try_write (PyGObjectSignalLogSink * self, const GValue * params, GClosure * owner)
+{
+  const gchar * raw_message;
+  PyTelcoLogLevel level;
+  GString * text;
+
+  /* Called by the emitting thread without the GIL. Log messages are consumed here and never reach Python. */
+  if (!g_atomic_int_get (&self->enabled) || G_VALUE_TYPE (&params[1]) != G_TYPE_STRING)
+    return FALSE;
+
+  raw_message = g_value_get_string (&params[1]);
+  if (raw_message == NULL || strstr (raw_message, "\"log\"") == NULL)
+    return FALSE;
+
+  text = g_string_sized_new (128);
+
+  if (!PyTelco_peek_log_message (raw_message, &level, text))
+  {
+    g_string_free (text, TRUE);
+    return FALSE;
+  }
+
+  g_mutex_lock (&self->lock);
+  if (self->enabled)
+  {
+    PyGObjectSignalLogSink_append (self, level, text);
+
+    /* Lines are written buffered, and flushed shortly after instead of once each on the emitting thread. */
+    if ((self->stream != NULL || self->file != NULL) && self->flush_source == NULL)
+    {
+      self->flush_source = g_timeout_source_new (PYTELCO_LOG_SINK_FLUSH_INTERVAL);
+      g_source_set_callback (self->flush_source, (GSourceFunc) PyGObjectSignalClosure_on_log_flush_timeout,
+          g_closure_ref (owner), (GDestroyNotify) g_closure_unref);
+      g_source_attach (self->flush_source, g_main_context_get_thread_default ());
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_string_free (text, TRUE);
+
+  return TRUE;
+}
+
+static void
+PyGObjectSignalLogSink_append (PyGObjectSignalLogSink * self, PyTelcoLogLevel level, GString * text)
+{
+  gboolean failed = FALSE;
+
+  if (level < self->min_level)
+  {
+    self->filtered++;
+    return;
+  }
+
+  if (self->ring != NULL)
+  {
+    PyGObjectSignalLogEntry * entry;
+
+    if (self->ring_length == self->ring_capacity)
+    {
+      entry = &self->ring[self->ring_head];
+      g_free (entry->text);
+      self->ring_head = (self->ring_head + 1) % self->ring_capacity;
+      self->ring_length--;
+      self->overwritten++;
+    }
+
+    entry = &self->ring[(self->ring_head + self->ring_length) % self->ring_capacity];
+    entry->level = level;
+    entry->text = g_strndup (text->str, text->len);
+    self->ring_length++;
+  }
+
+  g_string_append_c (text, '\n');
+
+  if (self->stream != NULL)
+  {
+    if (fwrite (text->str, 1, text->len, self->stream) != text->len)
+      failed = TRUE;
+  }
+
+  /* The file stays unset if reopening it after a rotation failed, and every line dropped from then on is an error. */
+  if (self->path != NULL)
+  {
+    if (self->file != NULL && self->max_bytes != 0 && self->backup_count != 0 && self->file_size != 0 &&
+        self->file_size + text->len > self->max_bytes)
+    {
+      PyGObjectSignalLogSink_rotate (self);
+    }
+
+    if (self->file != NULL && fwrite (text->str, 1, text->len, self->file) == text->len)
+      self->file_size += text->len;
+    else
+      failed = TRUE;
+  }
+
+  if (failed)
+    self->errors++;
+  else
+    self->written++;
+}
+
+static void
+PyGObjectSignalLogSink_rotate (PyGObjectSignalLogSink * self)
+{
+  guint i;
+
+  /* Same scheme as logging.handlers.RotatingFileHandler: path becomes path.1, path.1 becomes path.2, and so on. */
+  fclose (self->file);
+
+  for (i = self->backup_count; i != 0; i--)
+  {
+    gchar * source, * destination;
+
+    source = (i == 1) ? g_strdup (self->path) : g_strdup_printf ("%s.%u", self->path, i - 1);
+    destination = g_strdup_printf ("%s.%u", self->path, i);
+
+    g_remove (destination);
+    g_rename (source, destination);
+
+    g_free (destination);
+    g_free (source);
+  }
+
+  self->file = g_fopen (self->path, "wb");
+  self->file_size = 0;
+}
+
+static void
+PyGObjectSignalLogSink_flush (PyGObjectSignalLogSink * self)
+{
+  if (self->stream != NULL && fflush (self->stream) != 0)
+    self->errors++;
+
+  if (self->file != NULL && fflush (self->file) != 0)
+    self->errors++;
+}
+
+static gboolean
+PyGObjectSignalClosure_on_log_flush_timeout (PyGObjectSignalClosure * self)
+{
+  PyGObjectSignalLogSink * sink = self->log_sink;
+
+  g_mutex_lock (&sink->lock);
+  PyGObjectSignalLogSink_flush (sink);
+  g_clear_pointer (&sink->flush_source, g_source_unref);
+  g_mutex_unlock (&sink->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+static PyObject *
+PyGObjectSignalLogSink_tail (PyGObjectSignalLogSink * self, guint count)
+{
+  PyGObjectSignalLogEntry * copies;
+  PyObject * entries;
+  guint n, i;
+
+  /* Emitting threads take the lock without the GIL, so entries are copied out before building any Python objects. */
+  g_mutex_lock (&self->lock);
+
+  n = (count != 0) ? MIN (count, self->ring_length) : self->ring_length;
+  copies = g_new (PyGObjectSignalLogEntry, n);
+  for (i = 0; i != n; i++)
+  {
+    const PyGObjectSignalLogEntry * entry =
+        &self->ring[(self->ring_head + self->ring_length - n + i) % self->ring_capacity];
+
+    copies[i].level = entry->level;
+    copies[i].text = g_strdup (entry->text);
+  }
+
+  g_mutex_unlock (&self->lock);
+
+  entries = PyList_New (n);
+  if (entries == NULL)
+    goto beach;
+
+  for (i = 0; i != n; i++)
+  {
+    PyObject * item;
+
+    item = Py_BuildValue ("(sN)", pytelco_log_level_names[copies[i].level], PyUnicode_DecodeUTF8 (copies[i].text,
+          strlen (copies[i].text), "replace"));
+    if (item == NULL)
+    {
+      Py_CLEAR (entries);
+      goto beach;
+    }
+    PyList_SetItem (entries, i, item);
+  }
+
+beach:
+  for (i = 0; i != n; i++)
+    g_free (copies[i].text);
+  g_free (copies);
+
+  return entries;
+}
+
+static PyObject *
+PyGObjectSignalLogSink_get_stats (PyGObjectSignalLogSink * self)
+{
+  guint buffered;
+  guint64 written, filtered, overwritten, errors;
+
+  g_mutex_lock (&self->lock);
+  buffered = self->ring_length;
+  written = self->written;
+  filtered = self->filtered;
+  overwritten = self->overwritten;
+  errors = self->errors;
+  g_mutex_unlock (&self->lock);
+
+  return Py_BuildValue ("{s:I,s:K,s:K,s:K,s:K}",
+      "buffered", buffered,
+      "written", (unsigned long long) written,
+      "filtered", (unsigned long long) filtered,
+      "overwritten", (unsigned long long) overwritten,
+      "errors", (unsigned long long) errors);
+}
+
+static PyGObjectSignalTap *
+PyGObjectSignalTap_new (void)
+{
+  PyGObjectSignalTap * tap;
+
+  tap = g_slice_new0 (PyGObjectSignalTap);
+  g_mutex_init (&tap->lock);
+
+  return tap;
+}
+
+static void
+PyGObjectSignalTap_free (PyGObjectSignalTap * self)
+{
+  PyGObjectSignalTap_close (self);
+  g_mutex_clear (&self->lock);
+
+  g_slice_free (PyGObjectSignalTap, self);
+}
+
+static gboolean
+PyGObjectSignalTap_open (PyGObjectSignalTap * self, const gchar * path, guint32 capacity)
+{
+  gsize region_size = sizeof (PyTelcoTapHeader) + capacity;
+  PyTelcoTapHeader * header;
+
+  /* Replace rather than truncate the file, so consumers still mapping a previous one don't crash. */
+  g_remove (path);
+
+#ifdef G_OS_WIN32
+  {
+    gunichar2 * wide_path;
+    HANDLE file;
+
+    wide_path = g_utf8_to_utf16 (path, -1, NULL, NULL, NULL);
+    file = CreateFileW (wide_path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    g_free (wide_path);
+    if (file == INVALID_HANDLE_VALUE)
+      goto windows_error;
+
+    self->mapping = CreateFileMappingW (file, NULL, PAGE_READWRITE, 0, (DWORD) region_size, NULL);
+    CloseHandle (file);
+    if (self->mapping == NULL)
+      goto windows_error;
+
+    self->region = MapViewOfFile (self->mapping, FILE_MAP_WRITE, 0, 0, region_size);
+    if (self->region == NULL)
+    {
+      CloseHandle (self->mapping);
+      self->mapping = NULL;
+      goto windows_error;
+    }
+  }
+#else
+  {
+    int fd;
+    void * region;
+
+    fd = g_open (path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+      return FALSE;
+
+    if (ftruncate (fd, region_size) != 0)
+    {
+      close (fd);
+      return FALSE;
+    }
+
+    region = mmap (NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+    if (region == MAP_FAILED)
+      return FALSE;
+
+    self->region = region;
+  }
+#endif
+
+  self->region_size = region_size;
+  self->capacity = capacity;
+  self->position = 0;
+
+  header = (PyTelcoTapHeader *) self->region;
+  header->version = PYTELCO_TAP_VERSION;
+  header->header_size = sizeof (PyTelcoTapHeader);
+  header->capacity = capacity;
+  g_atomic_int_set (&header->reserve, 0);
+  g_atomic_int_set (&header->commit, 0);
+  memcpy (header->magic, PYTELCO_TAP_MAGIC, sizeof (header->magic));
+
+  return TRUE;
+
+#ifdef G_OS_WIN32
+windows_error:
+  {
+    errno = (GetLastError () == ERROR_ACCESS_DENIED) ? EACCES : EIO;
+    return FALSE;
+  }
+#endif
+}
+
+static void
+PyGObjectSignalTap_configure (PyGObjectSignalTap * self, PyGObjectSignalTap * config)
+{
+  PyGObjectSignalTap previous = { 0, };
+
+  g_mutex_lock (&self->lock);
+
+  previous.region = self->region;
+  previous.region_size = self->region_size;
+#ifdef G_OS_WIN32
+  previous.mapping = self->mapping;
+  self->mapping = config->mapping;
+#endif
+
+  self->region = config->region;
+  self->region_size = config->region_size;
+  self->capacity = config->capacity;
+  self->position = 0;
+
+  g_atomic_int_set (&self->enabled, self->region != NULL);
+
+  g_mutex_unlock (&self->lock);
+
+  PyGObjectSignalTap_close (&previous);
+}
+
+static void
+PyGObjectSignalTap_close (PyGObjectSignalTap * self)
+{
+  if (self->region == NULL)
+    return;
+
+#ifdef G_OS_WIN32
+  UnmapViewOfFile (self->region);
+  CloseHandle (self->mapping);
+  self->mapping = NULL;
+#else
+  munmap (self->region, self->region_size);
+#endif
+
+  self->region = NULL;
+  self->region_size = 0;
+}
+
+static void
+PyGObjectSignalTap_write (PyGObjectSignalTap * self, const GValue * params, guint n_params)
+{
+  const gchar * message;
+  GBytes * data = NULL;
+  gconstpointer data_buffer = NULL;
+  gsize message_length, data_length = 0, size;
+  PyTelcoTapHeader * header;
+  PyTelcoTapRecord * record;
+  guint32 offset, reserve;
+
+  /* Called by the emitting thread without the GIL. The lock makes it the ring's only producer. */
+  if (!g_atomic_int_get (&self->enabled) || G_VALUE_TYPE (&params[1]) != G_TYPE_STRING)
+    return;
+
+  message = g_value_get_string (&params[1]);
+  if (message == NULL)
+    return;
+  message_length = strlen (message);
+
+  if (n_params > 2 && G_VALUE_TYPE (&params[2]) == G_TYPE_BYTES)
+    data = g_value_get_boxed (&params[2]);
+  if (data != NULL)
+    data_buffer = g_bytes_get_data (data, &data_length);
+
+  size = sizeof (PyTelcoTapRecord) + message_length + data_length;
+  size = (size + PYTELCO_TAP_RECORD_ALIGNMENT - 1) & ~(gsize) (PYTELCO_TAP_RECORD_ALIGNMENT - 1);
+
+  g_mutex_lock (&self->lock);
+
+  if (!self->enabled)
+    goto beach;
+
+  if (size > self->capacity)
+  {
+    self->oversized++;
+    goto beach;
+  }
+
+  header = (PyTelcoTapHeader *) self->region;
+  offset = self->position & (self->capacity - 1);
+
+  reserve = self->position + (guint32) size;
+  if (self->capacity - offset < size)
+    reserve += self->capacity - offset;
+  g_atomic_int_set (&header->reserve, (gint) reserve);
+
+  /* Records never wrap around, the tail of the ring is skipped with a padding record instead. */
+  if (self->capacity - offset < size)
+  {
+    record = (PyTelcoTapRecord *) (self->region + sizeof (PyTelcoTapHeader) + offset);
+    record->size = self->capacity - offset;
+    record->flags = PYTELCO_TAP_RECORD_PADDING;
+    record->message_length = 0;
+    record->data_length = 0;
+
+    self->position += record->size;
+    offset = 0;
+  }
+
+  record = (PyTelcoTapRecord *) (self->region + sizeof (PyTelcoTapHeader) + offset);
+  record->size = size;
+  record->flags = (data != NULL) ? PYTELCO_TAP_RECORD_HAS_DATA : 0;
+  record->message_length = message_length;
+  record->data_length = data_length;
+  memcpy (record + 1, message, message_length);
+  if (data_length != 0)
+    memcpy ((guint8 *) (record + 1) + message_length, data_buffer, data_length);
+
+  self->position += size;
+  g_atomic_int_set (&header->commit, (gint) self->position);
+
+  self->written++;
+
+beach:
+  g_mutex_unlock (&self->lock);
+}
+
+static PyObject *
+PyGObjectSignalTap_get_stats (PyGObjectSignalTap * self)
+{
+  guint32 capacity, position;
+  guint64 written, oversized;
+
+  g_mutex_lock (&self->lock);
+  capacity = self->capacity;
+  position = self->position;
+  written = self->written;
+  oversized = self->oversized;
+  g_mutex_unlock (&self->lock);
+
+  return Py_BuildValue ("{s:I,s:I,s:K,s:K}",
+      "capacity", (unsigned int) capacity,
+      "position", (unsigned int) position,
+      "written", (unsigned long long) written,
+      "oversized", (unsigned long long) oversized);
+}
+
+static PyGObjectSignalRecorder *
+PyGObjectSignalRecorder_new (void)
+{
+  PyGObjectSignalRecorder * recorder;
+
+  recorder = g_slice_new0 (PyGObjectSignalRecorder);
+  g_mutex_init (&recorder->lock);
+
+  return recorder;
+}
+
+static void
+PyGObjectSignalRecorder_free (PyGObjectSignalRecorder * self)
+{
+  g_clear_pointer (&self->file, fclose);
+  g_mutex_clear (&self->lock);
+
+  g_slice_free (PyGObjectSignalRecorder, self);
+}
+
+static FILE *
+PyGObjectSignalRecorder_open (const gchar * path)
+{
+  FILE * file;
+  PyTelcoRecordingHeader header = { 0, };
+
+  file = g_fopen (path, "wb");
+  if (file == NULL)
+    return NULL;
+
+  setvbuf (file, NULL, _IOFBF, PYTELCO_RECORDING_BUFFER_SIZE);
+
+  memcpy (header.magic, PYTELCO_RECORDING_MAGIC, sizeof (header.magic));
+  header.version = PYTELCO_RECORDING_VERSION;
+  header.header_size = sizeof (header);
+
+  if (fwrite (&header, sizeof (header), 1, file) != 1)
+  {
+    int saved_errno = errno;
+
+    fclose (file);
+    errno = saved_errno;
+
+    return NULL;
+  }
+
+  return file;
+}
+
+static void
+PyGObjectSignalRecorder_configure (PyGObjectSignalRecorder * self, FILE * file)
+{
+  FILE * previous;
+
+  g_mutex_lock (&self->lock);
+
+  previous = self->file;
+
+  self->file = file;
+  self->started_at = g_get_monotonic_time ();
+  if (file != NULL)
+  {
+    self->recorded = 0;
+    self->bytes = sizeof (PyTelcoRecordingHeader);
+    self->errors = 0;
+  }
+
+  g_atomic_int_set (&self->enabled, file != NULL);
+
+  g_mutex_unlock (&self->lock);
+
+  if (previous != NULL)
+    fclose (previous);
+}
+
+static void
+PyGObjectSignalRecorder_write (PyGObjectSignalRecorder * self, const GValue * params, guint n_params)
+{
+  static const guint8 padding[PYTELCO_RECORDING_ALIGNMENT] = { 0, };
+  const gchar * message;
+  GBytes * data = NULL;
+  gconstpointer data_buffer = NULL;
+  gsize data_length = 0, padding_length;
+  PyTelcoRecordingEntry entry;
+  gboolean written;
+
+  /* Called by the emitting thread without the GIL, the entry only lands in the stdio buffer most of the time. */
+  if (!g_atomic_int_get (&self->enabled) || G_VALUE_TYPE (&params[1]) != G_TYPE_STRING)
+    return;
+
+  message = g_value_get_string (&params[1]);
+  if (message == NULL)
+    return;
+
+  if (n_params > 2 && G_VALUE_TYPE (&params[2]) == G_TYPE_BYTES)
+    data = g_value_get_boxed (&params[2]);
+  if (data != NULL)
+    data_buffer = g_bytes_get_data (data, &data_length);
+
+  entry.message_length = strlen (message);
+  entry.data_length = (data != NULL) ? data_length : PYTELCO_RECORDING_NO_DATA;
+  padding_length = (PYTELCO_RECORDING_ALIGNMENT - ((entry.message_length + data_length) % PYTELCO_RECORDING_ALIGNMENT)) %
+      PYTELCO_RECORDING_ALIGNMENT;
+
+  g_mutex_lock (&self->lock);
+
+  if (self->file == NULL)
+    goto beach;
+
+  entry.timestamp = g_get_monotonic_time () - self->started_at;
+
+  written = fwrite (&entry, sizeof (entry), 1, self->file) == 1 &&
+      fwrite (message, 1, entry.message_length, self->file) == entry.message_length &&
+      (data_length == 0 || fwrite (data_buffer, 1, data_length, self->file) == data_length) &&
+      fwrite (padding, 1, padding_length, self->file) == padding_length;
+  if (written)
+  {
+    self->recorded++;
+    self->bytes += sizeof (entry) + entry.message_length + data_length + padding_length;
+  }
+  else
+  {
+    self->errors++;
+  }
+
+beach:
+  g_mutex_unlock (&self->lock);
+}
+
+static PyObject *
+PyGObjectSignalRecorder_get_stats (PyGObjectSignalRecorder * self)
+{
+  gboolean recording;
+  guint64 recorded, bytes, errors;
+
+  g_mutex_lock (&self->lock);
+  recording = self->file != NULL;
+  recorded = self->recorded;
+  bytes = self->bytes;
+  errors = self->errors;
+  g_mutex_unlock (&self->lock);
+
+  return Py_BuildValue ("{s:O,s:K,s:K,s:K}",
+      "recording", recording ? Py_True : Py_False,
+      "recorded", (unsigned long long) recorded,
+      "bytes", (unsigned long long) bytes,
+      "errors", (unsigned long long) errors);
+}
+
+static void
+PyGObjectSignalClosure_deliver (PyGObjectSignalClosure * self, const GValue * values, guint length, guint stride)
+{
+  PyObject * callback = self->parent.data;
+  PyObject * instance, * items, * result;
+  guint i;
+
+  if (self->max_batch_size != 0)
+  {
+    items = PyGObjectSignalClosure_marshal_batch (self, values, length, stride);
+    if (items == NULL)
+      return;
+
+    if (PyList_Size (items) != 0)
+    {
+      gint64 started = (watchdog_threshold != -1) ? g_get_monotonic_time () : -1;
+
+      result = PyObject_CallFunctionObjArgs (callback, items, NULL);
+      if (result != NULL)
+        Py_DECREF (result);
+      else
+        PyErr_Print ();
+
+      if (started != -1)
+        PyTelco_observe_callback (g_signal_name (self->signal_id), callback, g_get_monotonic_time () - started);
+    }
+
+    Py_DECREF (items);
+    return;
+  }
+
+  instance = PyGObject_try_get_from_handle (g_value_get_object (&values[0]));
+  if (instance == NULL)
+    return;
+
+  for (i = 0; i != length; i++)
+  {
+    const GValue * params = &values[i * stride];
+
+    if ((self->flags & PY_GOBJECT_SIGNAL_DISPATCH_RPC) != 0 &&
+        PyScript_try_dispatch_rpc_reply ((PyScript *) instance, params, stride, self->flags))
+      continue;
+
+    if (self->router != NULL && PyGObjectSignalClosure_try_route (self, params))
+      continue;
+
+    PyGObjectSignalClosure_invoke (self, callback, params);
+  }
+}
+
+static PyObject *
+PyGObjectSignalClosure_marshal_batch (PyGObjectSignalClosure * self, const GValue * values, guint length, guint stride)
+{
+  PyObject * instance, * items;
+  guint i;
+
+  instance = PyGObject_try_get_from_handle (g_value_get_object (&values[0]));
+  if (instance == NULL)
+    return NULL;
+
+  items = PyList_New (0);
+  if (items == NULL)
+    goto propagate_error;
+
+  for (i = 0; i != length; i++)
+  {
+    const GValue * params = &values[i * stride];
+    PyObject * args;
+    int append_result;
+
+    if ((self->flags & PY_GOBJECT_SIGNAL_DISPATCH_RPC) != 0 &&
+        PyScript_try_dispatch_rpc_reply ((PyScript *) instance, params, stride, self->flags))
+      continue;
+
+    if (self->router != NULL && PyGObjectSignalClosure_try_route (self, params))
+      continue;
+
+    args = PyGObjectSignalClosure_marshal_args (self, params);
+    if (args == NULL)
+    {
+      PyErr_Print ();
+      continue;
+    }
+
+    append_result = PyList_Append (items, args);
+    Py_DECREF (args);
+    if (append_result == -1)
+      goto propagate_error;
+  }
+
+  return items;
+
+propagate_error:
+  {
+    PyErr_Print ();
+    Py_XDECREF (items);
+    return NULL;
+  }
+}
+
+static gboolean
+PyGObjectSignalClosure_try_dispatch (PyGObjectSignalClosure * self, GArray * values, guint length, guint stride,
+    PyGObjectSignalPriority priority)
+{
+  static gint next_serial = 0;
+  GAsyncQueue ** lanes, * lane;
+  PyGObjectSignalEvent * event;
+  gpointer instance;
+
+  lanes = g_atomic_pointer_get (&dispatcher_lanes);
+  if (lanes == NULL)
+    return FALSE;
+
+  event = g_slice_new (PyGObjectSignalEvent);
+  event->closure = PY_GOBJECT_SIGNAL_CLOSURE (g_closure_ref (&self->parent));
+  event->values = g_array_ref (values);
+  event->length = length;
+  event->stride = stride;
+  event->priority = priority;
+  event->serial = (guint) g_atomic_int_add (&next_serial, 1);
+
+  /*
+   * Events from the same object always share a lane, which keeps them in order. High priority events are sorted in
+   * ahead of the backlog, while the rest simply go at the back.
+   */
+  instance = g_value_get_object (&g_array_index (values, GValue, 0));
+  lane = lanes[(GPOINTER_TO_SIZE (instance) >> 4) % dispatcher_lane_count];
+  if (priority == PY_GOBJECT_SIGNAL_PRIORITY_HIGH)
+    g_async_queue_push_sorted (lane, event, (GCompareDataFunc) PyGObjectSignalEvent_compare, NULL);
+  else
+    g_async_queue_push (lane, event);
+
+  return TRUE;
+}
+
+static gint
+PyGObjectSignalEvent_compare (const PyGObjectSignalEvent * a, const PyGObjectSignalEvent * b, gpointer user_data)
+{
+  if (a->priority != b->priority)
+    return (gint) a->priority - (gint) b->priority;
+
+  return (gint) (a->serial - b->serial);
+}
+
+static void
+PyGObjectSignalEvent_free (PyGObjectSignalEvent * event)
+{
+  g_array_unref (event->values);
+  g_closure_unref (&event->closure->parent);
+
+  g_slice_free (PyGObjectSignalEvent, event);
+}
+
+static PyObject *
+PyGObjectSignalClosure_marshal_args (PyGObjectSignalClosure * self, const GValue * params)
+{
+  PyGObjectMarshalValueFunc * marshal_value = self->signature->marshal_value + self->first_arg;
+  PyObject * args;
+  guint i;
+
+  params += self->first_arg;
+
+  args = PyTuple_New (self->n_args);
+
+  for (i = 0; i != self->n_args; i++)
+  {
+    PyObject * arg;
+
+    arg = marshal_value[i] (&params[i]);
+    if (arg == NULL)
+      goto marshal_error;
+
+    PyTuple_SetItem (args, i, arg);
+  }
+
+  return args;
+
+marshal_error:
+  {
+    Py_DECREF (args);
+    return NULL;
+  }
+}
+
+static void
+PyGObjectSignalClosure_invoke (PyGObjectSignalClosure * self, PyObject * callback, const GValue * params)
+{
+  PyObject * result;
+  gint64 started = (watchdog_threshold != -1) ? g_get_monotonic_time () : -1;
+#ifdef PYTELCO_HAVE_VECTORCALL
+  PyGObjectMarshalValueFunc * marshal_value = self->signature->marshal_value + self->first_arg;
+  PyObject ** args;
+  guint i, n;
+
+  params += self->first_arg;
+
+  args = g_newa (PyObject *, self->n_args);
+
+  for (n = 0; n != self->n_args; n++)
+  {
+    args[n] = marshal_value[n] (&params[n]);
+    if (args[n] == NULL)
+      break;
+  }
+
+  if (n == self->n_args)
+    result = PyObject_Vectorcall (callback, args, n, NULL);
+  else
+    result = NULL;
+
+  for (i = 0; i != n; i++)
+    Py_DECREF (args[i]);
+#else
+  PyObject * args;
+
+  args = PyGObjectSignalClosure_marshal_args (self, params);
+  if (args == NULL)
+  {
+    PyErr_Print ();
+    return;
+  }
+
+  result = PyObject_CallObject (callback, args);
+
+  Py_DECREF (args);
+#endif
+
+  if (result != NULL)
+    Py_DECREF (result);
+  else
+    PyErr_Print ();
+
+  if (started != -1)
+    PyTelco_observe_callback (g_signal_name (self->signal_id), callback, g_get_monotonic_time () - started);
+}
+
+static PyObject *
+PyGObject_marshal_value (const GValue * value)
+{
+  GType type;
+
+  type = G_VALUE_TYPE (value);
+
+  switch (type)
+  {
+    case G_TYPE_BOOLEAN:
+      return PyBool_FromLong (g_value_get_boolean (value));
+
+    case G_TYPE_INT:
+      return PyLong_FromLong (g_value_get_int (value));
+
+    case G_TYPE_UINT:
+      return PyLong_FromUnsignedLong (g_value_get_uint (value));
+
+    case G_TYPE_FLOAT:
+      return PyFloat_FromDouble (g_value_get_float (value));
+
+    case G_TYPE_DOUBLE:
+      return PyFloat_FromDouble (g_value_get_double (value));
+
+    case G_TYPE_STRING:
+      return PyGObject_marshal_string (g_value_get_string (value));
+
+    case G_TYPE_VARIANT:
+      return PyGObject_marshal_variant (g_value_get_variant (value));
+
+    default:
+      if (G_TYPE_IS_ENUM (type))
+        return PyGObject_marshal_enum (g_value_get_enum (value), type);
+
+      if (type == G_TYPE_BYTES)
+        return PyGObject_marshal_bytes (g_value_get_boxed (value));
+
+      if (G_TYPE_IS_OBJECT (type))
+        return PyGObject_marshal_object (g_value_get_object (value), type);
+
+      goto unsupported_type;
+  }
+
+  g_assert_not_reached ();
+
+unsupported_type:
+  {
+    return PyErr_Format (PyExc_NotImplementedError,
+        "unsupported type: '%s'",
+        g_type_name (type));
+  }
+}
+
+static PyObject *
+PyGObject_marshal_boolean_value (const GValue * value)
+{
+  return PyBool_FromLong (g_value_get_boolean (value));
+}
+
+static PyObject *
+PyGObject_marshal_int_value (const GValue * value)
+{
+  return PyLong_FromLong (g_value_get_int (value));
+}
+
+static PyObject *
+PyGObject_marshal_uint_value (const GValue * value)
+{
+  return PyLong_FromUnsignedLong (g_value_get_uint (value));
+}
+
+static PyObject *
+PyGObject_marshal_float_value (const GValue * value)
+{
+  return PyFloat_FromDouble (g_value_get_float (value));
+}
+
+static PyObject *
+PyGObject_marshal_double_value (const GValue * value)
+{
+  return PyFloat_FromDouble (g_value_get_double (value));
+}
+
+static PyObject *
+PyGObject_marshal_string_value (const GValue * value)
+{
+  return PyGObject_marshal_string (g_value_get_string (value));
+}
+
+static PyObject *
+PyGObject_marshal_json_value (const GValue * value)
+{
+  return PyGObject_marshal_json (g_value_get_string (value));
+}
+
+static PyObject *
+PyGObject_marshal_lazy_json_value (const GValue * value)
+{
+  return PyLazyMessage_new_from_json (g_value_get_string (value));
+}
+
+static PyObject *
+PyGObject_marshal_variant_value (const GValue * value)
+{
+  return PyGObject_marshal_variant (g_value_get_variant (value));
+}
+
+static PyObject *
+PyGObject_marshal_enum_value (const GValue * value)
+{
+  return PyGObject_marshal_enum (g_value_get_enum (value), G_VALUE_TYPE (value));
+}
+
+static PyObject *
+PyGObject_marshal_bytes_value (const GValue * value)
+{
+  return PyGObject_marshal_bytes (g_value_get_boxed (value));
+}
+
+static PyObject *
+PyGObject_marshal_bytes_view_value (const GValue * value)
+{
+  return PyGObject_marshal_bytes_view (g_value_get_boxed (value));
+}
+
+static PyObject *
+PyGObject_marshal_object_value (const GValue * value)
+{
+  return PyGObject_marshal_object (g_value_get_object (value), G_VALUE_TYPE (value));
+}
+
+static PyObject *
+PyGObject_marshal_string (const gchar * str)
+{
+  if (str == NULL)
+    Py_RETURN_NONE;
+
+  return PyUnicode_FromUTF8String (str);
+}
+
+static PyObject *
+PyGObject_marshal_json (const gchar * json)
+{
+  PyObject * result;
+
+  if (json == NULL)
+    Py_RETURN_NONE;
+
+  result = PyTelco_json_decode (json, strlen (json));
+  if (result == NULL)
+  {
+    /* Let the handler see the raw text and report the problem itself. */
+    PyErr_Clear ();
+    result = PyGObject_marshal_string (json);
+  }
+
+  return result;
+}
+
+static gboolean
+PyGObject_unmarshal_string (PyObject * value, gchar ** str)
+{
+  PyObject * bytes;
+
+  *str = NULL;
+
+  bytes = PyUnicode_AsUTF8String (value);
+  if (bytes == NULL)
+    return FALSE;
+
+  *str = g_strdup (PyBytes_AsString (bytes));
+
+  Py_DecRef (bytes);
+
+  return *str != NULL;
+}
+
+static gboolean
+PyGObject_unmarshal_data (PyObject * value, GBytes ** data)
+{
+  PyObject * owner;
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+  Py_buffer * view;
+#endif
+
+  *data = NULL;
+
+  if (value == Py_None)
+    return TRUE;
+
+  if (PyUnicode_Check (value))
+  {
+    owner = PyUnicode_AsUTF8String (value);
+    if (owner == NULL)
+      return FALSE;
+  }
+  else
+  {
+    owner = value;
+    Py_IncRef (owner);
+  }
+
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+  view = g_new (Py_buffer, 1);
+  if (PyObject_GetBuffer (owner, view, PyBUF_SIMPLE) != 0)
+  {
+    g_free (view);
+    Py_DecRef (owner);
+    goto invalid_type;
+  }
+  Py_DecRef (owner);
+
+  *data = g_bytes_new_with_free_func (view->buf, view->len, (GDestroyNotify) PyGObject_release_buffer, view);
+#else
+  if (!PyBytes_Check (owner))
+  {
+    PyObject * copy;
+
+    /* Without the buffer protocol we can only borrow from bytes, so copy the other bytes-like objects we know of. */
+    if (!PyByteArray_Check (owner) && !PyObject_TypeCheck (owner, &PyMemoryView_Type))
+    {
+      Py_DecRef (owner);
+      goto invalid_type;
+    }
+
+    copy = PyBytes_FromObject (owner);
+    Py_DecRef (owner);
+    if (copy == NULL)
+      goto invalid_type;
+    owner = copy;
+  }
+
+  *data = g_bytes_new_with_free_func (PyBytes_AsString (owner), PyBytes_Size (owner),
+      (GDestroyNotify) PyGObject_release_bytes_object, owner);
+#endif
+
+  return TRUE;
+
+invalid_type:
+  {
+    PyErr_Clear ();
+    PyErr_SetString (PyExc_TypeError, "data must be a bytes-like object, str or None");
+    return FALSE;
+  }
+}
+
+static int
+PyGObject_convert_data (PyObject * value, void * result)
+{
+  return PyGObject_unmarshal_data (value, result);
+}
+
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+
+static void
+PyGObject_release_buffer (Py_buffer * view)
+{
+  PyGILState_STATE gstate;
+
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_BUFFER_RELEASE);
+  PyBuffer_Release (view);
+  PyGILState_Release (gstate);
+
+  g_free (view);
+}
+
+#else
+
+static void
+PyGObject_release_bytes_object (PyObject * object)
+{
+  PyGILState_STATE gstate;
+
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_BUFFER_RELEASE);
+  Py_DecRef (object);
+  PyGILState_Release (gstate);
+}
+
+#endif
+
+static PyObject *
+PyGObject_marshal_datetime (const gchar * iso8601_text)
+{
+  PyObject * result;
+  GDateTime * raw_dt, * dt;
+
+  raw_dt = g_date_time_new_from_iso8601 (iso8601_text, NULL);
+  if (raw_dt == NULL)
+    Py_RETURN_NONE;
+
+  dt = g_date_time_to_local (raw_dt);
+
+  result = PyObject_CallFunction (datetime_constructor, "iiiiiii",
+      g_date_time_get_year (dt),
+      g_date_time_get_month (dt),
+      g_date_time_get_day_of_month (dt),
+      g_date_time_get_hour (dt),
+      g_date_time_get_minute (dt),
+      g_date_time_get_second (dt),
+      g_date_time_get_microsecond (dt));
+
+  g_date_time_unref (dt);
+  g_date_time_unref (raw_dt);
+
+  return result;
+}
+
+static PyObject *
+PyGObject_marshal_strv (gchar * const * strv, gint length)
+{
+  PyObject * result;
+  gint i;
+
+  if (strv == NULL)
+    Py_RETURN_NONE;
+
+  result = PyList_New (length);
+
+  for (i = 0; i != length; i++)
+  {
+    PyList_SetItem (result, i, PyGObject_marshal_string (strv[i]));
+  }
+
+  return result;
+}
+
+static gboolean
+PyGObject_unmarshal_strv (PyObject * value, gchar *** strv, gint * length)
+{
+  gint n, i;
+  gchar ** elements;
+
+  if (!PyList_Check (value) && !PyTuple_Check (value))
+    goto invalid_type;
+
+  n = PySequence_Size (value);
+  elements = g_new0 (gchar *, n + 1);
+
+  for (i = 0; i != n; i++)
+  {
+    PyObject * element;
+
+    element = PySequence_GetItem (value, i);
+    if (PyUnicode_Check (element))
+    {
+      Py_DECREF (element);
+      element = PyUnicode_AsUTF8String (element);
+    }
+    if (PyBytes_Check (element))
+      elements[i] = g_strdup (PyBytes_AsString (element));
+    Py_DECREF (element);
+
+    if (elements[i] == NULL)
+      goto invalid_element;
+  }
+
+  *strv = elements;
+  *length = n;
+
+  return TRUE;
+
+invalid_type:
+  {
+    PyErr_SetString (PyExc_TypeError, "expected list or tuple of strings");
+    return FALSE;
+  }
+invalid_element:
+  {
+    g_strfreev (elements);
+
+    PyErr_SetString (PyExc_TypeError, "expected list or tuple with string elements only");
+    return FALSE;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_envp (gchar * const * envp, gint length)
+{
+  PyObject * result;
+  gint i;
+
+  if (envp == NULL)
+    Py_RETURN_NONE;
+
+  result = PyDict_New ();
+
+  for (i = 0; i != length; i++)
+  {
+    gchar ** tokens;
+
+    tokens = g_strsplit (envp[i], "=", 2);
+
+    if (g_strv_length (tokens) == 2)
+    {
+      const gchar * name;
+      PyObject * value;
+
+      name = tokens[0];
+      value = PyGObject_marshal_string (tokens[1]);
+
+      PyDict_SetItemString (result, name, value);
+
+      Py_DECREF (value);
+    }
+
+    g_strfreev (tokens);
+  }
+
+  return result;
+}
+
+static gboolean
+PyGObject_unmarshal_envp (PyObject * dict, gchar *** envp, gint * length)
+{
+  gint n;
+  gchar ** elements;
+  gint i;
+  Py_ssize_t pos;
+  PyObject * name, * value;
+  gchar * raw_name = NULL;
+  gchar * raw_value = NULL;
+
+  if (!PyDict_Check (dict))
+    goto invalid_type;
+
+  n = PyDict_Size (dict);
+  elements = g_new0 (gchar *, n + 1);
+
+  i = 0;
+  pos = 0;
+  while (PyDict_Next (dict, &pos, &name, &value))
+  {
+    if (!PyGObject_unmarshal_string (name, &raw_name))
+      goto invalid_dict_key;
+
+    if (!PyGObject_unmarshal_string (value, &raw_value))
+      goto invalid_dict_value;
+
+    elements[i] = g_strconcat (raw_name, "=", raw_value, NULL);
+
+    g_free (g_steal_pointer (&raw_value));
+    g_free (g_steal_pointer (&raw_name));
+
+    i++;
+  }
+
+  *envp = elements;
+  *length = n;
+
+  return TRUE;
+
+invalid_type:
+  {
+    PyErr_SetString (PyExc_TypeError, "expected dict");
+    return FALSE;
+  }
+invalid_dict_key:
+invalid_dict_value:
+  {
+    g_free (raw_value);
+    g_free (raw_name);
+    g_strfreev (elements);
+
+    PyErr_SetString (PyExc_TypeError, "expected dict with strings only");
+    return FALSE;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_enum (gint value, GType type)
+{
+  GEnumClass * enum_class;
+  GEnumValue * enum_value;
+  PyObject * result;
+
+  enum_class = g_type_class_ref (type);
+
+  enum_value = g_enum_get_value (enum_class, value);
+  g_assert (enum_value != NULL);
+
+  result = PyUnicode_FromUTF8String (enum_value->value_nick);
+
+  g_type_class_unref (enum_class);
+
+  return result;
+}
+
+static gboolean
+PyGObject_unmarshal_enum (const gchar * str, GType type, gpointer value)
+{
+  GEnumClass * enum_class;
+  GEnumValue * enum_value;
+
+  enum_class = g_type_class_ref (type);
+
+  enum_value = g_enum_get_value_by_nick (enum_class, str);
+  if (enum_value == NULL)
+    goto invalid_value;
+
+  *((gint *) value) = enum_value->value;
+
+  g_type_class_unref (enum_class);
+
+  return TRUE;
+
+invalid_value:
+  {
+    GString * message;
+    guint i;
+
+    message = g_string_sized_new (128);
+
+    g_string_append_printf (message,
+        "Enum type %s does not have a value named '%s', it only has: ",
+        PyGObject_class_name_from_c (g_type_name (type)), str);
+
+    for (i = 0; i != enum_class->n_values; i++)
+    {
+      if (i != 0)
+        g_string_append (message, ", ");
+      g_string_append_c (message, '\'');
+      g_string_append (message, enum_class->values[i].value_nick);
+      g_string_append_c (message, '\'');
+    }
+
+    PyErr_SetString (PyExc_ValueError, message->str);
+
+    g_string_free (message, TRUE);
+
+    g_type_class_unref (enum_class);
+
+    return FALSE;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_bytes (GBytes * bytes)
+{
+  if (bytes == NULL)
+    Py_RETURN_NONE;
+
+  return PyGObject_marshal_bytes_non_nullable (bytes);
+}
+
+static PyObject *
+PyGObject_marshal_bytes_non_nullable (GBytes * bytes)
+{
+  gconstpointer data;
+  gsize size;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  return PyBytes_FromStringAndSize (data, size);
+}
+
+static PyObject *
+PyGObject_marshal_bytes_view (GBytes * bytes)
+{
+  if (bytes == NULL)
+    Py_RETURN_NONE;
+
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+  return PyBytesView_new_take_bytes (g_bytes_ref (bytes));
+#else
+  return PyGObject_marshal_bytes_non_nullable (bytes);
+#endif
+}
+
+static const PyGObjectMarshalVariantFunc pygobject_variant_marshallers[128] =
+{
+  ['b'] = PyGObject_marshal_variant_boolean,
+  ['y'] = PyGObject_marshal_variant_byte,
+  ['n'] = PyGObject_marshal_variant_int16,
+  ['q'] = PyGObject_marshal_variant_uint16,
+  ['i'] = PyGObject_marshal_variant_int32,
+  ['u'] = PyGObject_marshal_variant_uint32,
+  ['x'] = PyGObject_marshal_variant_int64,
+  ['t'] = PyGObject_marshal_variant_uint64,
+  ['h'] = PyGObject_marshal_variant_handle,
+  ['d'] = PyGObject_marshal_variant_double,
+  ['s'] = PyGObject_marshal_variant_string,
+  ['o'] = PyGObject_marshal_variant_string,
+  ['g'] = PyGObject_marshal_variant_string,
+  ['v'] = PyGObject_marshal_variant_variant,
+  ['m'] = PyGObject_marshal_variant_maybe,
+  ['a'] = PyGObject_marshal_variant_array,
+  ['('] = PyGObject_marshal_variant_tuple,
+  ['{'] = PyGObject_marshal_variant_tuple,
+};
+
+static PyObject *
+PyGObject_marshal_variant (GVariant * variant)
+{
+  guchar type_char;
+  PyGObjectMarshalVariantFunc marshal;
+
+  type_char = g_variant_get_type_string (variant)[0];
+
+  marshal = (type_char < G_N_ELEMENTS (pygobject_variant_marshallers)) ? pygobject_variant_marshallers[type_char] : NULL;
+  if (marshal == NULL)
+    Py_RETURN_NONE;
+
+  return marshal (variant);
+}
+
+static PyObject *
+PyGObject_marshal_variant_boolean (GVariant * variant)
+{
+  return PyBool_FromLong (g_variant_get_boolean (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_byte (GVariant * variant)
+{
+  return PyLong_FromLong (g_variant_get_byte (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_int16 (GVariant * variant)
+{
+  return PyLong_FromLong (g_variant_get_int16 (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_uint16 (GVariant * variant)
+{
+  return PyLong_FromLong (g_variant_get_uint16 (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_int32 (GVariant * variant)
+{
+  return PyLong_FromLong (g_variant_get_int32 (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_uint32 (GVariant * variant)
+{
+  return PyLong_FromUnsignedLong (g_variant_get_uint32 (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_int64 (GVariant * variant)
+{
+  return PyLong_FromLongLong (g_variant_get_int64 (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_uint64 (GVariant * variant)
+{
+  return PyLong_FromUnsignedLongLong (g_variant_get_uint64 (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_handle (GVariant * variant)
+{
+  return PyLong_FromLong (g_variant_get_handle (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_double (GVariant * variant)
+{
+  return PyFloat_FromDouble (g_variant_get_double (variant));
+}
+
+static PyObject *
+PyGObject_marshal_variant_string (GVariant * variant)
+{
+  return PyGObject_marshal_string (g_variant_get_string (variant, NULL));
+}
+
+static PyObject *
+PyGObject_marshal_variant_variant (GVariant * variant)
+{
+  PyObject * result;
+  GVariant * inner;
+
+  inner = g_variant_get_variant (variant);
+  result = PyGObject_marshal_variant (inner);
+  g_variant_unref (inner);
+
+  return result;
+}
+
+static PyObject *
+PyGObject_marshal_variant_maybe (GVariant * variant)
+{
+  PyObject * result;
+  GVariant * inner;
+
+  inner = g_variant_get_maybe (variant);
+  if (inner == NULL)
+    Py_RETURN_NONE;
+
+  result = PyGObject_marshal_variant (inner);
+  g_variant_unref (inner);
+
+  return result;
+}
+
+static PyObject *
+PyGObject_marshal_variant_array (GVariant * variant)
+{
+  const gchar * element_type;
+  PyObject * list;
+  gsize n, i;
+
+  element_type = g_variant_get_type_string (variant) + 1;
+
+  if (element_type[0] == 'y')
+  {
+    gconstpointer elements;
+    gsize n_elements;
+
+    elements = g_variant_get_fixed_array (variant, &n_elements, sizeof (guint8));
+
+    return PyBytes_FromStringAndSize (elements, n_elements);
+  }
+
+  if (element_type[0] == '{')
+    return PyGObject_marshal_variant_dict (variant);
+
+  n = g_variant_n_children (variant);
+
+  list = PyList_New (n);
+
+  for (i = 0; i != n; i++)
+  {
+    GVariant * child;
+    PyObject * element;
+
+    child = g_variant_get_child_value (variant, i);
+    element = PyGObject_marshal_variant (child);
+    g_variant_unref (child);
+    if (element == NULL)
+      goto propagate_error;
+
+    PyList_SetItem (list, i, element);
+  }
+
+  return list;
+
+propagate_error:
+  {
+    Py_DECREF (list);
+    return NULL;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_variant_dict (GVariant * variant)
+{
+  PyObject * dict, * key = NULL, * value = NULL;
+  GVariantIter iter;
+
+  dict = PyDict_New ();
+
+  g_variant_iter_init (&iter, variant);
+
+  if (strcmp (g_variant_get_type_string (variant), "a{sv}") == 0)
+  {
+    const gchar * raw_key;
+    GVariant * raw_value;
+
+    while (g_variant_iter_next (&iter, "{&sv}", &raw_key, &raw_value))
+    {
+      key = PyGObject_marshal_dict_key (raw_key);
+      value = PyGObject_marshal_variant (raw_value);
+      g_variant_unref (raw_value);
+      if (key == NULL || value == NULL)
+        goto propagate_error;
+
+      PyDict_SetItem (dict, key, value);
+
+      Py_DECREF (value);
+      Py_DECREF (key);
+    }
+  }
+  else
+  {
+    GVariant * raw_key, * raw_value;
+
+    while (g_variant_iter_next (&iter, "{@?@*}", &raw_key, &raw_value))
+    {
+      if (g_variant_is_of_type (raw_key, G_VARIANT_TYPE_STRING))
+        key = PyGObject_marshal_dict_key (g_variant_get_string (raw_key, NULL));
+      else
+        key = PyGObject_marshal_variant (raw_key);
+      value = PyGObject_marshal_variant (raw_value);
+      g_variant_unref (raw_value);
+      g_variant_unref (raw_key);
+      if (key == NULL || value == NULL)
+        goto propagate_error;
+
+      PyDict_SetItem (dict, key, value);
+
+      Py_DECREF (value);
+      Py_DECREF (key);
+    }
+  }
+
+  return dict;
+
+propagate_error:
+  {
+    Py_XDECREF (value);
+    Py_XDECREF (key);
+    Py_DECREF (dict);
+    return NULL;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_variant_tuple (GVariant * variant)
+{
+  PyObject * tuple;
+  gsize n, i;
+
+  n = g_variant_n_children (variant);
+
+  tuple = PyTuple_New (n);
+
+  for (i = 0; i != n; i++)
+  {
+    GVariant * child;
+    PyObject * element;
+
+    child = g_variant_get_child_value (variant, i);
+    element = PyGObject_marshal_variant (child);
+    g_variant_unref (child);
+    if (element == NULL)
+      goto propagate_error;
+
+    PyTuple_SetItem (tuple, i, element);
+  }
+
+  return tuple;
+
+propagate_error:
+  {
+    Py_DECREF (tuple);
+    return NULL;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_dict_key (const gchar * key)
+{
+  PyObject * result;
+
+  /*
+   * Parameter dicts repeat the same handful of keys over and over, so we hand out the same
+   * interned string for each of them. The cache is bounded in case a dict is keyed by data.
+   */
+  result = g_hash_table_lookup (pygobject_interned_keys, key);
+  if (result != NULL)
+  {
+    Py_INCREF (result);
+    return result;
+  }
+
+  result = PyUnicode_InternFromString (key);
+  if (result == NULL)
+    return NULL;
+
+  if (g_hash_table_size (pygobject_interned_keys) < PYTELCO_MAX_INTERNED_KEYS)
+  {
+    Py_INCREF (result);
+    g_hash_table_insert (pygobject_interned_keys, g_strdup (key), result);
+  }
+
+  return result;
+}
+
+static gboolean
+PyGObject_unmarshal_variant (PyObject * value, guint depth, GVariant ** variant)
+{
+  if (depth > PYTELCO_VARIANT_MAX_DEPTH)
+    goto nesting_too_deep;
+
+  if (PyTelco_is_string (value))
+  {
+    gchar * str;
+
+    PyGObject_unmarshal_string (value, &str);
+
+    *variant = g_variant_new_take_string (str);
+  }
+  else if (PyBool_Check (value))
+  {
+    *variant = g_variant_new_boolean (value == Py_True);
+  }
+#if PY_MAJOR_VERSION < 3
+  else if (PyUnicode_Check (value))
+  {
+    PyObject * value_utf8;
+
+    value_utf8 = PyUnicode_AsUTF8String (value);
+    if (value_utf8 == NULL)
+      goto propagate_error;
+
+    *variant = g_variant_new_string (PyBytes_AsString (value_utf8));
+
+    Py_DECREF (value_utf8);
+  }
+  else if (PyInt_Check (value))
+  {
+    *variant = g_variant_new_int64 (PyInt_AS_LONG (value));
+  }
+#endif
+  else if (PyLong_Check (value))
+  {
+    return PyGObject_unmarshal_variant_int (value, variant);
+  }
+  else if (PyFloat_Check (value))
+  {
+    *variant = g_variant_new_double (PyFloat_AsDouble (value));
+  }
+  else if (PyBytes_Check (value) || PyByteArray_Check (value))
+  {
+    return PyGObject_unmarshal_variant_bytes (value, variant);
+  }
+  else if (value == Py_None)
+  {
+    *variant = g_variant_new_maybe (G_VARIANT_TYPE_VARIANT, NULL);
+  }
+  else if (PyTuple_Check (value))
+  {
+    return PyGObject_unmarshal_variant_sequence (value, TRUE, depth, variant);
+  }
+  else if (PyList_Check (value))
+  {
+    return PyGObject_unmarshal_variant_sequence (value, FALSE, depth, variant);
+  }
+  else if (PyDict_Check (value))
+  {
+    return PyGObject_unmarshal_variant_dict (value, depth, variant);
+  }
+  else
+  {
+    goto unsupported_type;
+  }
+
+  return TRUE;
+
+nesting_too_deep:
+  {
+    PyErr_SetString (PyExc_ValueError, "nesting too deep");
+    goto propagate_error;
+  }
+unsupported_type:
+  {
+    PyErr_SetString (PyExc_TypeError, "unsupported type");
+    goto propagate_error;
+  }
+propagate_error:
+  {
+    return FALSE;
+  }
+}
+
+static gboolean
+PyGObject_unmarshal_variant_int (PyObject * value, GVariant ** variant)
+{
+  PY_LONG_LONG l;
+  unsigned PY_LONG_LONG ul;
+
+  l = PyLong_AsLongLong (value);
+  if (l != -1 || !PyErr_Occurred ())
+  {
+    *variant = g_variant_new_int64 (l);
+    return TRUE;
+  }
+
+  if (!PyErr_ExceptionMatches (PyExc_OverflowError))
+    return FALSE;
+  PyErr_Clear ();
+
+  /* Values past the signed range still fit as long as they aren't negative. */
+  ul = PyLong_AsUnsignedLongLong (value);
+  if (ul == (unsigned PY_LONG_LONG) -1 && PyErr_Occurred ())
+    return FALSE;
+
+  *variant = g_variant_new_uint64 (ul);
+
+  return TRUE;
+}
+
+static gboolean
+PyGObject_unmarshal_variant_bytes (PyObject * value, GVariant ** variant)
+{
+  const char * data;
+  Py_ssize_t size;
+
+  if (PyBytes_Check (value))
+  {
+    data = PyBytes_AsString (value);
+    size = PyBytes_Size (value);
+  }
+  else
+  {
+    data = PyByteArray_AsString (value);
+    size = PyByteArray_Size (value);
+  }
+
+  *variant = g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, data, size, sizeof (guint8));
+
+  return TRUE;
+}
+
+static gboolean
+PyGObject_unmarshal_variant_sequence (PyObject * value, gboolean as_tuple, guint depth, GVariant ** variant)
+{
+  gboolean success = FALSE;
+  Py_ssize_t n, i;
+  GVariant ** children;
+  gboolean homogeneous;
+
+  n = PySequence_Size (value);
+
+  children = g_new0 (GVariant *, MAX (n, 1));
+
+  homogeneous = TRUE;
+  for (i = 0; i != n; i++)
+  {
+    PyObject * element;
+    gboolean valid;
+
+    element = PySequence_GetItem (value, i);
+    valid = PyGObject_unmarshal_variant (element, depth + 1, &children[i]);
+    Py_DECREF (element);
+    if (!valid)
+      goto beach;
+
+    g_variant_ref_sink (children[i]);
+
+    if (i != 0 && !g_variant_type_equal (g_variant_get_type (children[i]), g_variant_get_type (children[0])))
+      homogeneous = FALSE;
+  }
+
+  if (as_tuple)
+  {
+    *variant = g_variant_new_tuple (children, n);
+  }
+  else if (n != 0 && homogeneous)
+  {
+    *variant = g_variant_new_array (NULL, children, n);
+  }
+  else
+  {
+    /* Mixed lists can't be typed arrays, so every element gets boxed instead. */
+    for (i = 0; i != n; i++)
+    {
+      GVariant * boxed = g_variant_ref_sink (g_variant_new_variant (children[i]));
+
+      g_variant_unref (children[i]);
+      children[i] = boxed;
+    }
+
+    *variant = g_variant_new_array (G_VARIANT_TYPE_VARIANT, children, n);
+  }
+
+  success = TRUE;
+
+beach:
+  for (i = 0; i != n; i++)
+  {
+    if (children[i] != NULL)
+      g_variant_unref (children[i]);
+  }
+  g_free (children);
+
+  return success;
+}
+
+static gboolean
+PyGObject_unmarshal_variant_dict (PyObject * value, guint depth, GVariant ** variant)
+{
+  GVariantBuilder builder;
+  Py_ssize_t pos;
+  PyObject * key, * element;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+  pos = 0;
+  while (PyDict_Next (value, &pos, &key, &element))
+  {
+    gchar * raw_key;
+    GVariant * raw_value;
+
+    if (!PyTelco_is_string (key))
+      goto invalid_key;
+
+    if (!PyGObject_unmarshal_variant (element, depth + 1, &raw_value))
+      goto propagate_error;
+
+    PyGObject_unmarshal_string (key, &raw_key);
+
+    g_variant_builder_add_value (&builder,
+        g_variant_new_dict_entry (g_variant_new_take_string (raw_key), g_variant_new_variant (raw_value)));
+  }
+
+  *variant = g_variant_builder_end (&builder);
+
+  return TRUE;
+
+invalid_key:
+  {
+    PyErr_SetString (PyExc_TypeError, "dict keys must be strings");
+    goto propagate_error;
+  }
+propagate_error:
+  {
+    g_variant_builder_clear (&builder);
+    return FALSE;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_parameters_dict (GHashTable * dict)
+{
+  PyObject * result;
+  GHashTableIter iter;
+  const gchar * raw_key;
+  GVariant * raw_value;
+
+  result = PyDict_New ();
+
+  g_hash_table_iter_init (&iter, dict);
+
+  while (g_hash_table_iter_next (&iter, (gpointer *) &raw_key, (gpointer *) &raw_value))
+  {
+    PyObject * key = PyGObject_marshal_dict_key (raw_key);
+    PyObject * value = PyGObject_marshal_variant (raw_value);
+
+    if (key == NULL || value == NULL)
+    {
+      Py_XDECREF (value);
+      Py_XDECREF (key);
+      goto propagate_error;
+    }
+
+    PyDict_SetItem (result, key, value);
+
+    Py_DECREF (value);
+    Py_DECREF (key);
+  }
+
+  return result;
+
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
+}
+
+static PyObject *
+PyGObject_marshal_object (gpointer handle, GType type)
+{
+  const PyGObjectType * pytype;
+
+  if (handle == NULL)
+    Py_RETURN_NONE;
+
+  pytype = g_hash_table_lookup (pygobject_type_spec_by_type, GSIZE_TO_POINTER (type));
+  if (pytype == NULL)
+    pytype = PYTELCO_TYPE (GObject);
+
+  if (G_IS_SOCKET_ADDRESS (handle))
+    return PyGObject_marshal_socket_address (handle);
+
+  return PyGObject_new_take_handle (g_object_ref (handle), pytype);
+}
+
+static PyObject *
+PyGObject_marshal_socket_address (GSocketAddress * address)
+{
+  PyObject * result = NULL;
+
+  if (G_IS_INET_SOCKET_ADDRESS (address))
+  {
+    GInetSocketAddress * sa;
+    GInetAddress * ia;
+    gchar * host;
+    guint16 port;
+
+    sa = G_INET_SOCKET_ADDRESS (address);
+    ia = g_inet_socket_address_get_address (sa);
+
+    host = g_inet_address_to_string (ia);
+    port = g_inet_socket_address_get_port (sa);
+
+    if (g_socket_address_get_family (address) == G_SOCKET_FAMILY_IPV4)
+      result = Py_BuildValue ("(sH)", host, port);
+    else
+      result = Py_BuildValue ("(sHII)", host, port, g_inet_socket_address_get_flowinfo (sa), g_inet_socket_address_get_scope_id (sa));
+
+    g_free (host);
+  }
+  else if (G_IS_UNIX_SOCKET_ADDRESS (address))
+  {
+    GUnixSocketAddress * sa = G_UNIX_SOCKET_ADDRESS (address);
+
+    switch (g_unix_socket_address_get_address_type (sa))
+    {
+      case G_UNIX_SOCKET_ADDRESS_ANONYMOUS:
+      {
+        result = PyUnicode_FromUTF8String ("");
+        break;
+      }
+      case G_UNIX_SOCKET_ADDRESS_PATH:
+      {
+        gchar * path = g_filename_to_utf8 (g_unix_socket_address_get_path (sa), -1, NULL, NULL, NULL);
+        result = PyUnicode_FromUTF8String (path);
+        g_free (path);
+        break;
+      }
+      case G_UNIX_SOCKET_ADDRESS_ABSTRACT:
+      case G_UNIX_SOCKET_ADDRESS_ABSTRACT_PADDED:
+      {
+        result = PyBytes_FromStringAndSize (g_unix_socket_address_get_path (sa), g_unix_socket_address_get_path_len (sa));
+        break;
+      }
+      default:
+      {
+        result = Py_None;
+        Py_INCREF (result);
+        break;
+      }
+    }
+  }
+
+  if (result == NULL)
+    result = PyGObject_new_take_handle (g_object_ref (address), PYTELCO_TYPE (GObject));
+
+  return result;
+}
+
+static gboolean
+PyGObject_unmarshal_certificate (const gchar * str, GTlsCertificate ** certificate)
+{
+  GError * error = NULL;
+
+  if (strchr (str, '\n') != NULL)
+    *certificate = g_tls_certificate_new_from_pem (str, -1, &error);
+  else
+    *certificate = g_tls_certificate_new_from_file (str, &error);
+  if (error != NULL)
+    goto propagate_error;
+
+  return TRUE;
+
+propagate_error:
+  {
+    PyTelco_raise (g_error_new_literal (TELCO_ERROR, TELCO_ERROR_INVALID_ARGUMENT, error->message));
+    g_error_free (error);
+
+    return FALSE;
+  }
+}
+
+
+static int
+PyDeviceManager_init (PyDeviceManager * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  g_atomic_int_inc (&toplevel_objects_alive);
+
+  PyGObject_take_handle (&self->parent, telco_device_manager_new (), PYTELCO_TYPE (DeviceManager));
+
+  return 0;
+}
+
+static void
+PyDeviceManager_dealloc (PyDeviceManager * self)
+{
+  TelcoDeviceManager * handle;
+
+  g_atomic_int_dec_and_test (&toplevel_objects_alive);
+
+  handle = PyGObject_steal_handle (&self->parent);
+  if (handle != NULL)
+  {
+    Py_BEGIN_ALLOW_THREADS
+    telco_device_manager_close_sync (handle, NULL, NULL);
+    telco_unref (handle);
+    Py_END_ALLOW_THREADS
+  }
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyDeviceManager_close (PyDeviceManager * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_manager_close_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyDeviceManager_get_device_matching (PyDeviceManager * self, PyObject * args)
+{
+  PyObject * predicate;
+  gint timeout;
+  GError * error = NULL;
+  TelcoDevice * result;
+
+  if (!PyArg_ParseTuple (args, "Oi", &predicate, &timeout))
+    return NULL;
+
+  if (!PyCallable_Check (predicate))
+    goto not_callable;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_manager_get_device_sync (PY_GOBJECT_HANDLE (self), (TelcoDeviceManagerPredicate) PyDeviceManager_is_matching_device,
+      predicate, timeout, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  return PyDevice_new_take_handle (result);
+
+not_callable:
+  {
+    PyErr_SetString (PyExc_TypeError, "object must be callable");
+    return NULL;
+  }
+}
+
+static gboolean
+PyDeviceManager_is_matching_device (TelcoDevice * device, PyObject * predicate)
+{
+  gboolean is_matching = FALSE;
+  PyGILState_STATE gstate;
+  PyObject * device_object, * result;
+
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_DEVICE_MATCHING);
+
+  device_object = PyDevice_new_take_handle (g_object_ref (device));
+
+  result = PyObject_CallFunction (predicate, "O", device_object);
+  if (result != NULL)
+  {
+    is_matching = result == Py_True;
+
+    Py_DECREF (result);
+  }
+  else
+  {
+    PyErr_Print ();
+  }
+
+  Py_DECREF (device_object);
+
+  PyGILState_Release (gstate);
+
+  return is_matching;
+}
+
+static PyObject *
+PyDeviceManager_enumerate_devices (PyDeviceManager * self)
+{
+  GError * error = NULL;
+  TelcoDeviceList * result;
+  gint result_length, i;
+  PyObject * devices;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_manager_enumerate_devices_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  result_length = telco_device_list_size (result);
+  devices = PyList_New (result_length);
+  for (i = 0; i != result_length; i++)
+  {
+    PyList_SetItem (devices, i, PyDevice_new_take_handle (telco_device_list_get (result, i)));
+  }
+  telco_unref (result);
+
+  return devices;
+}
+
+static PyObject *
+PyDeviceManager_add_remote_device (PyDeviceManager * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "address", "certificate", "origin", "token", "keepalive_interval", NULL };
+  char * address;
+  char * certificate = NULL;
+  char * origin = NULL;
+  char * token = NULL;
+  int keepalive_interval = -1;
+  TelcoRemoteDeviceOptions * options;
+  GError * error = NULL;
+  TelcoDevice * handle;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esesesi", keywords,
+        "utf-8", &address,
+        "utf-8", &certificate,
+        "utf-8", &origin,
+        "utf-8", &token,
+        &keepalive_interval))
+    return NULL;
+
+  options = PyDeviceManager_parse_remote_device_options (certificate, origin, token, keepalive_interval);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  handle = telco_device_manager_add_remote_device_sync (PY_GOBJECT_HANDLE (self), address, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  result = (error == NULL)
+      ? PyDevice_new_take_handle (handle)
+      : PyTelco_raise (error);
+
+beach:
+  g_clear_object (&options);
+
+  PyMem_Free (token);
+  PyMem_Free (origin);
+  PyMem_Free (certificate);
+  PyMem_Free (address);
+
+  return result;
+}
+
+static PyObject *
+PyDeviceManager_remove_remote_device (PyDeviceManager * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "address", NULL };
+  char * address;
+  GError * error = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es", keywords, "utf-8", &address))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_manager_remove_remote_device_sync (PY_GOBJECT_HANDLE (self), address, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  PyMem_Free (address);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static TelcoRemoteDeviceOptions *
+PyDeviceManager_parse_remote_device_options (const gchar * certificate_value, const gchar * origin, const gchar * token,
+    gint keepalive_interval)
+{
+  TelcoRemoteDeviceOptions * options;
+
+  options = telco_remote_device_options_new ();
+
+  if (certificate_value != NULL)
+  {
+    GTlsCertificate * certificate;
+
+    if (!PyGObject_unmarshal_certificate (certificate_value, &certificate))
+      goto propagate_error;
+
+    telco_remote_device_options_set_certificate (options, certificate);
+
+    g_object_unref (certificate);
+  }
+
+  if (origin != NULL)
+    telco_remote_device_options_set_origin (options, origin);
+
+  if (token != NULL)
+    telco_remote_device_options_set_token (options, token);
+
+  if (keepalive_interval != -1)
+    telco_remote_device_options_set_keepalive_interval (options, keepalive_interval);
+
+  return options;
+
+propagate_error:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+
+static PyObject *
+PyDevice_new_take_handle (TelcoDevice * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Device));
+}
+
+static int
+PyDevice_init (PyDevice * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->id = NULL;
+  self->name = NULL;
+  self->icon = NULL;
+  self->type = NULL;
+  self->bus = NULL;
+
+  return 0;
+}
+
+static void
+PyDevice_init_from_handle (PyDevice * self, TelcoDevice * handle)
+{
+  GVariant * icon;
+
+  self->id = PyUnicode_FromUTF8String (telco_device_get_id (handle));
+  self->name = PyUnicode_FromUTF8String (telco_device_get_name (handle));
+  icon = telco_device_get_icon (handle);
+  if (icon != NULL)
+  {
+    self->icon = PyGObject_marshal_variant (icon);
+  }
+  else
+  {
+    self->icon = Py_None;
+    Py_IncRef (Py_None);
+  }
+  self->type = PyGObject_marshal_enum (telco_device_get_dtype (handle), TELCO_TYPE_DEVICE_TYPE);
+  self->bus = PyBus_new_take_handle (g_object_ref (telco_device_get_bus (handle)));
+}
+
+static void
+PyDevice_dealloc (PyDevice * self)
+{
+  Py_XDECREF (self->bus);
+  Py_XDECREF (self->type);
+  Py_XDECREF (self->icon);
+  Py_XDECREF (self->name);
+  Py_XDECREF (self->id);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyDevice_repr (PyDevice * self)
+{
+  PyObject * id_bytes, * name_bytes, * type_bytes, * result;
+
+  id_bytes = PyUnicode_AsUTF8String (self->id);
+  name_bytes = PyUnicode_AsUTF8String (self->name);
+  type_bytes = PyUnicode_AsUTF8String (self->type);
+
+  result = PyRepr_FromFormat ("Device(id=\"%s\", name=\"%s\", type='%s')",
+      PyBytes_AsString (id_bytes),
+      PyBytes_AsString (name_bytes),
+      PyBytes_AsString (type_bytes));
+
+  Py_DECREF (type_bytes);
+  Py_DECREF (name_bytes);
+  Py_DECREF (id_bytes);
+
+  return result;
+}
+
+static PyObject *
+PyDevice_is_lost (PyDevice * self)
+{
+  gboolean is_lost;
+
+  Py_BEGIN_ALLOW_THREADS
+  is_lost = telco_device_is_lost (PY_GOBJECT_HANDLE (self));
+  Py_END_ALLOW_THREADS
+
+  return PyBool_FromLong (is_lost);
+}
+
+static PyObject *
+PyDevice_query_system_parameters (PyDevice * self)
+{
+  GError * error = NULL;
+  GHashTable * result;
+  PyObject * parameters;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_query_system_parameters_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  parameters = PyGObject_marshal_parameters_dict (result);
+  g_hash_table_unref (result);
+
+  return parameters;
+}
+
+static PyObject *
+PyDevice_get_frontmost_application (PyDevice * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "scope", NULL };
+  const char * scope_value = NULL;
+  TelcoFrontmostQueryOptions * options;
+  GError * error = NULL;
+  TelcoApplication * result;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|s", keywords, &scope_value))
+    return NULL;
+
+  options = telco_frontmost_query_options_new ();
+
+  if (scope_value != NULL)
+  {
+    TelcoScope scope;
+
+    if (!PyGObject_unmarshal_enum (scope_value, TELCO_TYPE_SCOPE, &scope))
+      goto invalid_argument;
+
+    telco_frontmost_query_options_set_scope (options, scope);
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_get_frontmost_application_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  g_object_unref (options);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  if (result != NULL)
+    return PyApplication_new_take_handle (result);
+  else
+    Py_RETURN_NONE;
+
+invalid_argument:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PyDevice_enumerate_applications (PyDevice * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "identifiers", "scope", NULL };
+  PyObject * identifiers = NULL;
+  const char * scope = NULL;
+  TelcoApplicationQueryOptions * options;
+  GError * error = NULL;
+  TelcoApplicationList * result;
+  gint result_length, i;
+  PyObject * applications;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|Os", keywords, &identifiers, &scope))
+    return NULL;
+
+  options = PyDevice_parse_application_query_options (identifiers, scope);
+  if (options == NULL)
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_enumerate_applications_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  g_object_unref (options);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  result_length = telco_application_list_size (result);
+  applications = PyList_New (result_length);
+  for (i = 0; i != result_length; i++)
+  {
+    PyList_SetItem (applications, i, PyApplication_new_take_handle (telco_application_list_get (result, i)));
+  }
+  g_object_unref (result);
+
+  return applications;
+}
+
+static TelcoApplicationQueryOptions *
+PyDevice_parse_application_query_options (PyObject * identifiers_value, const gchar * scope_value)
+{
+  TelcoApplicationQueryOptions * options;
+
+  options = telco_application_query_options_new ();
+
+  if (identifiers_value != NULL)
+  {
+    gint n, i;
+
+    n = PySequence_Size (identifiers_value);
+    if (n == -1)
+      goto propagate_error;
+
+    for (i = 0; i != n; i++)
+    {
+      PyObject * element;
+      gchar * identifier = NULL;
+
+      element = PySequence_GetItem (identifiers_value, i);
+      if (element == NULL)
+        goto propagate_error;
+      PyGObject_unmarshal_string (element, &identifier);
+      Py_DECREF (element);
+      if (identifier == NULL)
+        goto propagate_error;
+
+      telco_application_query_options_select_identifier (options, identifier);
+
+      g_free (identifier);
+    }
+  }
+
+  if (scope_value != NULL)
+  {
+    TelcoScope scope;
+
+    if (!PyGObject_unmarshal_enum (scope_value, TELCO_TYPE_SCOPE, &scope))
+      goto propagate_error;
+
+    telco_application_query_options_set_scope (options, scope);
+  }
+
+  return options;
+
+propagate_error:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PyDevice_enumerate_processes (PyDevice * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "pids", "scope", NULL };
+  PyObject * pids = NULL;
+  const char * scope = NULL;
+  TelcoProcessQueryOptions * options;
+  GError * error = NULL;
+  TelcoProcessList * result;
+  gint result_length, i;
+  PyObject * processes;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|Os", keywords, &pids, &scope))
+    return NULL;
+
+  options = PyDevice_parse_process_query_options (pids, scope);
+  if (options == NULL)
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_enumerate_processes_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  g_object_unref (options);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  result_length = telco_process_list_size (result);
+  processes = PyList_New (result_length);
+  for (i = 0; i != result_length; i++)
+  {
+    PyList_SetItem (processes, i, PyProcess_new_take_handle (telco_process_list_get (result, i)));
+  }
+  g_object_unref (result);
+
+  return processes;
+}
+
+static TelcoProcessQueryOptions *
+PyDevice_parse_process_query_options (PyObject * pids_value, const gchar * scope_value)
+{
+  TelcoProcessQueryOptions * options;
+
+  options = telco_process_query_options_new ();
+
+  if (pids_value != NULL)
+  {
+    gint n, i;
+
+    n = PySequence_Size (pids_value);
+    if (n == -1)
+      goto propagate_error;
+
+    for (i = 0; i != n; i++)
+    {
+      PyObject * element;
+      long long pid;
+
+      element = PySequence_GetItem (pids_value, i);
+      if (element == NULL)
+        goto propagate_error;
+      pid = PyLong_AsLongLong (element);
+      Py_DECREF (element);
+      if (pid == -1)
+        goto propagate_error;
+
+      telco_process_query_options_select_pid (options, pid);
+    }
+  }
+
+  if (scope_value != NULL)
+  {
+    TelcoScope scope;
+
+    if (!PyGObject_unmarshal_enum (scope_value, TELCO_TYPE_SCOPE, &scope))
+      goto propagate_error;
+
+    telco_process_query_options_set_scope (options, scope);
+  }
+
+  return options;
+
+propagate_error:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PyDevice_enable_spawn_gating (PyDevice * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_enable_spawn_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyDevice_disable_spawn_gating (PyDevice * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_disable_spawn_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyDevice_enumerate_pending_spawn (PyDevice * self)
+{
+  GError * error = NULL;
+  TelcoSpawnList * result;
+  gint result_length, i;
+  PyObject * spawn;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_enumerate_pending_spawn_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  result_length = telco_spawn_list_size (result);
+  spawn = PyList_New (result_length);
+  for (i = 0; i != result_length; i++)
+  {
+    PyList_SetItem (spawn, i, PySpawn_new_take_handle (telco_spawn_list_get (result, i)));
+  }
+  g_object_unref (result);
+
+  return spawn;
+}
+
+static PyObject *
+PyDevice_enumerate_pending_children (PyDevice * self)
+{
+  GError * error = NULL;
+  TelcoChildList * result;
+  gint result_length, i;
+  PyObject * children;
+
+  Py_BEGIN_ALLOW_THREADS
+  result = telco_device_enumerate_pending_children_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  result_length = telco_child_list_size (result);
+  children = PyList_New (result_length);
+  for (i = 0; i != result_length; i++)
+  {
+    PyList_SetItem (children, i, PyChild_new_take_handle (telco_child_list_get (result, i)));
+  }
+  g_object_unref (result);
+
+  return children;
+}
+
+static PyObject *
+PyDevice_spawn (PyDevice * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "program", "argv", "envp", "env", "cwd", "stdio", "aux", NULL };
+  const char * program;
+  PyObject * argv_value = Py_None;
+  PyObject * envp_value = Py_None;
+  PyObject * env_value = Py_None;
+  const char * cwd = NULL;
+  const char * stdio_value = NULL;
+  PyObject * aux_value = Py_None;
+  TelcoSpawnOptions * options;
+  GError * error = NULL;
+  guint pid;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "s|OOOzzO", keywords,
+      &program,
+      &argv_value,
+      &envp_value,
+      &env_value,
+      &cwd,
+      &stdio_value,
+      &aux_value))
+    return NULL;
+
+  options = telco_spawn_options_new ();
+
+  if (argv_value != Py_None)
+  {
+    gchar ** argv;
+    gint argv_length;
+
+    if (!PyGObject_unmarshal_strv (argv_value, &argv, &argv_length))
+      goto invalid_argument;
+
+    telco_spawn_options_set_argv (options, argv, argv_length);
+
+    g_strfreev (argv);
+  }
+
+  if (envp_value != Py_None)
+  {
+    gchar ** envp;
+    gint envp_length;
+
+    if (!PyGObject_unmarshal_envp (envp_value, &envp, &envp_length))
+      goto invalid_argument;
+
+    telco_spawn_options_set_envp (options, envp, envp_length);
+
+    g_strfreev (envp);
+  }
+
+  if (env_value != Py_None)
+  {
+    gchar ** env;
+    gint env_length;
+
+    if (!PyGObject_unmarshal_envp (env_value, &env, &env_length))
+      goto invalid_argument;
+
+    telco_spawn_options_set_env (options, env, env_length);
+
+    g_strfreev (env);
+  }
+
+  if (cwd != NULL)
+    telco_spawn_options_set_cwd (options, cwd);
+
+  if (stdio_value != NULL)
+  {
+    TelcoStdio stdio;
+
+    if (!PyGObject_unmarshal_enum (stdio_value, TELCO_TYPE_STDIO, &stdio))
+      goto invalid_argument;
+
+    telco_spawn_options_set_stdio (options, stdio);
+  }
+
+  if (aux_value != Py_None)
+  {
+    GHashTable * aux;
+    Py_ssize_t pos;
+    PyObject * key, * value;
+
+    aux = telco_spawn_options_get_aux (options);
+
+    if (!PyDict_Check (aux_value))
+      goto invalid_aux_dict;
+
+    pos = 0;
+    while (PyDict_Next (aux_value, &pos, &key, &value))
+    {
+      gchar * raw_key;
+      GVariant * raw_value;
+
+      if (!PyGObject_unmarshal_string (key, &raw_key))
+        goto invalid_dict_key;
+
+      if (!PyGObject_unmarshal_variant (value, 0, &raw_value))
       {
         g_free (raw_key);
         goto invalid_dict_value;
       }
 
-      g_hash_table_insert (aux, raw_key, g_variant_ref_sink (raw_value));
+      g_hash_table_insert (aux, raw_key, g_variant_ref_sink (raw_value));
+    }
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  pid = telco_device_spawn_sync (PY_GOBJECT_HANDLE (self), program, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  g_object_unref (options);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  return PyLong_FromUnsignedLong (pid);
+
+invalid_argument:
+invalid_dict_key:
+invalid_dict_value:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+invalid_aux_dict:
+  {
+    g_object_unref (options);
+
+    PyErr_SetString (PyExc_TypeError, "unsupported parameter");
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PyDevice_input (PyDevice * self, PyObject * args)
+{
+  long pid;
+  gconstpointer data_buffer;
+  Py_ssize_t data_size;
+  GBytes * data;
+  GError * error = NULL;
+
+  if (!PyArg_ParseTuple (args, "ly#", &pid, &data_buffer, &data_size))
+    return NULL;
+
+  data = g_bytes_new (data_buffer, data_size);
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_input_sync (PY_GOBJECT_HANDLE (self), (guint) pid, data, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (data);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyDevice_resume (PyDevice * self, PyObject * args)
+{
+  long pid;
+  GError * error = NULL;
+
+  if (!PyArg_ParseTuple (args, "l", &pid))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_resume_sync (PY_GOBJECT_HANDLE (self), (guint) pid, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyDevice_kill (PyDevice * self, PyObject * args)
+{
+  long pid;
+  GError * error = NULL;
+
+  if (!PyArg_ParseTuple (args, "l", &pid))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_kill_sync (PY_GOBJECT_HANDLE (self), (guint) pid, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyDevice_attach (PyDevice * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "pid", "realm", "persist_timeout", NULL };
+  long pid;
+  char * realm_value = NULL;
+  unsigned int persist_timeout = 0;
+  TelcoSessionOptions * options = NULL;
+  GError * error = NULL;
+  TelcoSession * handle;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "l|esI", keywords,
+        &pid,
+        "utf-8", &realm_value,
+        &persist_timeout))
+    return NULL;
+
+  options = PyDevice_parse_session_options (realm_value, persist_timeout);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  handle = telco_device_attach_sync (PY_GOBJECT_HANDLE (self), (guint) pid, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  result = (error == NULL)
+      ? PySession_new_take_handle (handle)
+      : PyTelco_raise (error);
+
+beach:
+  g_clear_object (&options);
+
+  PyMem_Free (realm_value);
+
+  return result;
+}
+
+static TelcoSessionOptions *
+PyDevice_parse_session_options (const gchar * realm_value,
+                                guint persist_timeout)
+{
+  TelcoSessionOptions * options;
+
+  options = telco_session_options_new ();
+
+  if (realm_value != NULL)
+  {
+    TelcoRealm realm;
+
+    if (!PyGObject_unmarshal_enum (realm_value, TELCO_TYPE_REALM, &realm))
+      goto propagate_error;
+
+    telco_session_options_set_realm (options, realm);
+  }
+
+  telco_session_options_set_persist_timeout (options, persist_timeout);
+
+  return options;
+
+propagate_error:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PyDevice_inject_library_file (PyDevice * self, PyObject * args)
+{
+  long pid;
+  const char * path, * entrypoint, * data;
+  GError * error = NULL;
+  guint id;
+
+  if (!PyArg_ParseTuple (args, "lsss", &pid, &path, &entrypoint, &data))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  id = telco_device_inject_library_file_sync (PY_GOBJECT_HANDLE (self), (guint) pid, path, entrypoint, data, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  return PyLong_FromUnsignedLong (id);
+}
+
+static PyObject *
+PyDevice_inject_library_blob (PyDevice * self, PyObject * args)
+{
+  long pid;
+  GBytes * blob;
+  gconstpointer blob_buffer;
+  Py_ssize_t blob_size;
+  const char * entrypoint, * data;
+  GError * error = NULL;
+  guint id;
+
+  if (!PyArg_ParseTuple (args, "ly#ss", &pid, &blob_buffer, &blob_size, &entrypoint, &data))
+    return NULL;
+
+  blob = g_bytes_new (blob_buffer, blob_size);
+
+  Py_BEGIN_ALLOW_THREADS
+  id = telco_device_inject_library_blob_sync (PY_GOBJECT_HANDLE (self), (guint) pid, blob, entrypoint, data, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (blob);
+
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  return PyLong_FromUnsignedLong (id);
+}
+
+static PyObject *
+PyDevice_open_channel (PyDevice * self, PyObject * args)
+{
+  const char * address;
+  GError * error = NULL;
+  GIOStream * stream;
+
+  if (!PyArg_ParseTuple (args, "s", &address))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  stream = telco_device_open_channel_sync (PY_GOBJECT_HANDLE (self), address, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  return PyIOStream_new_take_handle (stream);
+}
+
+static PyObject *
+PyDevice_unpair (PyDevice * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_device_unpair_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+
+static PyObject *
+PyApplication_new_take_handle (TelcoApplication * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Application));
+}
+
+static int
+PyApplication_init (PyApplication * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->identifier = NULL;
+  self->name = NULL;
+  self->pid = 0;
+  self->parameters = NULL;
+
+  return 0;
+}
+
+static void
+PyApplication_init_from_handle (PyApplication * self, TelcoApplication * handle)
+{
+  self->identifier = PyUnicode_FromUTF8String (telco_application_get_identifier (handle));
+  self->name = PyUnicode_FromUTF8String (telco_application_get_name (handle));
+  self->pid = telco_application_get_pid (handle);
+  self->parameters = PyApplication_marshal_parameters_dict (telco_application_get_parameters (handle));
+}
+
+static void
+PyApplication_dealloc (PyApplication * self)
+{
+  Py_XDECREF (self->parameters);
+  Py_XDECREF (self->name);
+  Py_XDECREF (self->identifier);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyApplication_repr (PyApplication * self)
+{
+  PyObject * result;
+  TelcoApplication * handle;
+  GString * repr;
+  gchar * str;
+
+  handle = PY_GOBJECT_HANDLE (self);
+
+  repr = g_string_new ("Application(");
+
+  g_string_append_printf (repr, "identifier=\"%s\", name=\"%s\"",
+      telco_application_get_identifier (handle),
+      telco_application_get_name (handle));
+
+  if (self->pid != 0)
+    g_string_append_printf (repr, ", pid=%u", self->pid);
+
+  str = PyTelco_repr (self->parameters);
+  g_string_append_printf (repr, ", parameters=%s", str);
+  g_free (str);
+
+  g_string_append (repr, ")");
+
+  result = PyRepr_FromString (repr->str);
+
+  g_string_free (repr, TRUE);
+
+  return result;
+}
+
+static PyObject *
+PyApplication_marshal_parameters_dict (GHashTable * dict)
+{
+  PyObject * result;
+  GHashTableIter iter;
+  const gchar * raw_key;
+  GVariant * raw_value;
+
+  result = PyDict_New ();
+
+  g_hash_table_iter_init (&iter, dict);
+
+  while (g_hash_table_iter_next (&iter, (gpointer *) &raw_key, (gpointer *) &raw_value))
+  {
+    PyObject * key, * value;
+
+    key = PyGObject_marshal_dict_key (raw_key);
+
+    if (strcmp (raw_key, "started") == 0 && g_variant_is_of_type (raw_value, G_VARIANT_TYPE_STRING))
+      value = PyGObject_marshal_datetime (g_variant_get_string (raw_value, NULL));
+    else
+      value = PyGObject_marshal_variant (raw_value);
+
+    if (key == NULL || value == NULL)
+    {
+      Py_XDECREF (value);
+      Py_XDECREF (key);
+      goto propagate_error;
+    }
+
+    PyDict_SetItem (result, key, value);
+
+    Py_DECREF (value);
+    Py_DECREF (key);
+  }
+
+  return result;
+
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
+}
+
+
+static PyObject *
+PyProcess_new_take_handle (TelcoProcess * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Process));
+}
+
+static int
+PyProcess_init (PyProcess * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->pid = 0;
+  self->name = NULL;
+  self->parameters = NULL;
+
+  return 0;
+}
+
+static void
+PyProcess_init_from_handle (PyProcess * self, TelcoProcess * handle)
+{
+  self->pid = telco_process_get_pid (handle);
+  self->name = PyUnicode_FromUTF8String (telco_process_get_name (handle));
+  self->parameters = PyProcess_marshal_parameters_dict (telco_process_get_parameters (handle));
+}
+
+static void
+PyProcess_dealloc (PyProcess * self)
+{
+  Py_XDECREF (self->parameters);
+  Py_XDECREF (self->name);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyProcess_repr (PyProcess * self)
+{
+  PyObject * result;
+  TelcoProcess * handle;
+  GString * repr;
+  gchar * str;
+
+  handle = PY_GOBJECT_HANDLE (self);
+
+  repr = g_string_new ("Process(");
+
+  g_string_append_printf (repr, "pid=%u, name=\"%s\"",
+      self->pid,
+      telco_process_get_name (handle));
+
+  str = PyTelco_repr (self->parameters);
+  g_string_append_printf (repr, ", parameters=%s", str);
+  g_free (str);
+
+  g_string_append (repr, ")");
+
+  result = PyRepr_FromString (repr->str);
+
+  g_string_free (repr, TRUE);
+
+  return result;
+}
+
+static PyObject *
+PyProcess_marshal_parameters_dict (GHashTable * dict)
+{
+  PyObject * result;
+  GHashTableIter iter;
+  const gchar * raw_key;
+  GVariant * raw_value;
+
+  result = PyDict_New ();
+
+  g_hash_table_iter_init (&iter, dict);
+
+  while (g_hash_table_iter_next (&iter, (gpointer *) &raw_key, (gpointer *) &raw_value))
+  {
+    PyObject * key, * value;
+
+    key = PyGObject_marshal_dict_key (raw_key);
+
+    if (strcmp (raw_key, "started") == 0 && g_variant_is_of_type (raw_value, G_VARIANT_TYPE_STRING))
+      value = PyGObject_marshal_datetime (g_variant_get_string (raw_value, NULL));
+    else
+      value = PyGObject_marshal_variant (raw_value);
+
+    if (key == NULL || value == NULL)
+    {
+      Py_XDECREF (value);
+      Py_XDECREF (key);
+      goto propagate_error;
+    }
+
+    PyDict_SetItem (result, key, value);
+
+    Py_DECREF (value);
+    Py_DECREF (key);
+  }
+
+  return result;
+
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
+}
+
+
+static PyObject *
+PySpawn_new_take_handle (TelcoSpawn * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Spawn));
+}
+
+static int
+PySpawn_init (PySpawn * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->pid = 0;
+  self->identifier = NULL;
+
+  return 0;
+}
+
+static void
+PySpawn_init_from_handle (PySpawn * self, TelcoSpawn * handle)
+{
+  self->pid = telco_spawn_get_pid (handle);
+  self->identifier = PyGObject_marshal_string (telco_spawn_get_identifier (handle));
+}
+
+static void
+PySpawn_dealloc (PySpawn * self)
+{
+  Py_XDECREF (self->identifier);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PySpawn_repr (PySpawn * self)
+{
+  PyObject * result;
+
+  if (self->identifier != Py_None)
+  {
+    PyObject * identifier_bytes;
+
+    identifier_bytes = PyUnicode_AsUTF8String (self->identifier);
+
+    result = PyRepr_FromFormat ("Spawn(pid=%u, identifier=\"%s\")",
+        self->pid,
+        PyBytes_AsString (identifier_bytes));
+
+    Py_DECREF (identifier_bytes);
+  }
+  else
+  {
+    result = PyRepr_FromFormat ("Spawn(pid=%u)",
+        self->pid);
+  }
+
+  return result;
+}
+
+
+static PyObject *
+PyChild_new_take_handle (TelcoChild * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Child));
+}
+
+static int
+PyChild_init (PyChild * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->pid = 0;
+  self->parent_pid = 0;
+  self->origin = NULL;
+  self->identifier = NULL;
+  self->path = NULL;
+  self->argv = NULL;
+  self->envp = NULL;
+
+  return 0;
+}
+
+static void
+PyChild_init_from_handle (PyChild * self, TelcoChild * handle)
+{
+  gchar * const * argv, * const * envp;
+  gint argv_length, envp_length;
+
+  self->pid = telco_child_get_pid (handle);
+  self->parent_pid = telco_child_get_parent_pid (handle);
+
+  self->origin = PyGObject_marshal_enum (telco_child_get_origin (handle), TELCO_TYPE_CHILD_ORIGIN);
+
+  self->identifier = PyGObject_marshal_string (telco_child_get_identifier (handle));
+
+  self->path = PyGObject_marshal_string (telco_child_get_path (handle));
+
+  argv = telco_child_get_argv (handle, &argv_length);
+  self->argv = PyGObject_marshal_strv (argv, argv_length);
+
+  envp = telco_child_get_envp (handle, &envp_length);
+  self->envp = PyGObject_marshal_envp (envp, envp_length);
+}
+
+static void
+PyChild_dealloc (PyChild * self)
+{
+  Py_XDECREF (self->envp);
+  Py_XDECREF (self->argv);
+  Py_XDECREF (self->path);
+  Py_XDECREF (self->identifier);
+  Py_XDECREF (self->origin);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyChild_repr (PyChild * self)
+{
+  PyObject * result;
+  TelcoChild * handle;
+  GString * repr;
+  TelcoChildOrigin origin;
+  GEnumClass * origin_class;
+  GEnumValue * origin_value;
+
+  handle = PY_GOBJECT_HANDLE (self);
+
+  repr = g_string_new ("Child(");
+
+  g_string_append_printf (repr, "pid=%u, parent_pid=%u", self->pid, self->parent_pid);
+
+  origin = telco_child_get_origin (handle);
+  origin_class = g_type_class_ref (TELCO_TYPE_CHILD_ORIGIN);
+  origin_value = g_enum_get_value (origin_class, origin);
+  g_string_append_printf (repr, ", origin=%s", origin_value->value_nick);
+  g_type_class_unref (origin_class);
+
+  if (self->identifier != Py_None)
+  {
+    gchar * identifier;
+
+    identifier = PyTelco_repr (self->identifier);
+
+    g_string_append_printf (repr, ", identifier=%s", identifier);
+
+    g_free (identifier);
+  }
+
+  if (origin != TELCO_CHILD_ORIGIN_FORK)
+  {
+    gchar * path, * argv, * envp;
+
+    path = PyTelco_repr (self->path);
+    argv = PyTelco_repr (self->argv);
+    envp = PyTelco_repr (self->envp);
+
+    g_string_append_printf (repr, ", path=%s, argv=%s, envp=%s", path, argv, envp);
+
+    g_free (envp);
+    g_free (argv);
+    g_free (path);
+  }
+
+  g_string_append (repr, ")");
+
+  result = PyRepr_FromString (repr->str);
+
+  g_string_free (repr, TRUE);
+
+  return result;
+}
+
+
+static int
+PyCrash_init (PyCrash * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->pid = 0;
+  self->process_name = NULL;
+  self->summary = NULL;
+  self->report = NULL;
+  self->parameters = NULL;
+
+  return 0;
+}
+
+static void
+PyCrash_init_from_handle (PyCrash * self, TelcoCrash * handle)
+{
+  self->pid = telco_crash_get_pid (handle);
+  self->process_name = PyGObject_marshal_string (telco_crash_get_process_name (handle));
+  self->summary = PyGObject_marshal_string (telco_crash_get_summary (handle));
+  self->report = PyGObject_marshal_string (telco_crash_get_report (handle));
+  self->parameters = PyGObject_marshal_parameters_dict (telco_crash_get_parameters (handle));
+}
+
+static void
+PyCrash_dealloc (PyCrash * self)
+{
+  Py_XDECREF (self->parameters);
+  Py_XDECREF (self->report);
+  Py_XDECREF (self->summary);
+  Py_XDECREF (self->process_name);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyCrash_repr (PyCrash * self)
+{
+  PyObject * result;
+  TelcoCrash * handle;
+  GString * repr;
+  gchar * str;
+
+  handle = PY_GOBJECT_HANDLE (self);
+
+  repr = g_string_new ("Crash(");
+
+  g_string_append_printf (repr, "pid=%u, process_name=\"%s\", summary=\"%s\", report=<%u bytes>",
+      self->pid,
+      telco_crash_get_process_name (handle),
+      telco_crash_get_summary (handle),
+      (guint) strlen (telco_crash_get_report (handle)));
+
+  str = PyTelco_repr (self->parameters);
+  g_string_append_printf (repr, ", parameters=%s", str);
+  g_free (str);
+
+  g_string_append (repr, ")");
+
+  result = PyRepr_FromString (repr->str);
+
+  g_string_free (repr, TRUE);
+
+  return result;
+}
+
+
+static PyObject *
+PyBus_new_take_handle (TelcoBus * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Bus));
+}
+
+static PyObject *
+PyBus_attach (PySession * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_bus_attach_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyBus_post (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "message", "data", NULL };
+  char * message;
+  GBytes * data = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|O&", keywords, "utf-8", &message, PyGObject_convert_data, &data))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_bus_post (PY_GOBJECT_HANDLE (self), message, data);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (data);
+  PyMem_Free (message);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyBus_post_many (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "messages", "datas", NULL };
+  PyObject * messages, * datas = Py_None;
+  gchar ** raw_messages;
+  GBytes ** raw_datas;
+  Py_ssize_t length, i;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "O|O", keywords, &messages, &datas))
+    return NULL;
+
+  if (!PyTelco_unmarshal_post_batch (messages, datas, &raw_messages, &raw_datas, &length))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  for (i = 0; i != length; i++)
+    telco_bus_post (PY_GOBJECT_HANDLE (self), raw_messages[i], raw_datas[i]);
+  Py_END_ALLOW_THREADS
+
+  PyTelco_free_post_batch (raw_messages, raw_datas, length);
+
+  Py_RETURN_NONE;
+}
+
+
+static PyObject *
+PySession_new_take_handle (TelcoSession * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Session));
+}
+
+static int
+PySession_init (PySession * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->pid = 0;
+
+  return 0;
+}
+
+static void
+PySession_init_from_handle (PySession * self, TelcoSession * handle)
+{
+  self->pid = telco_session_get_pid (handle);
+}
+
+static PyObject *
+PySession_repr (PySession * self)
+{
+  return PyRepr_FromFormat ("Session(pid=%u)", self->pid);
+}
+
+static PyObject *
+PySession_is_detached (PySession * self)
+{
+  gboolean is_detached;
+
+  Py_BEGIN_ALLOW_THREADS
+  is_detached = telco_session_is_detached (PY_GOBJECT_HANDLE (self));
+  Py_END_ALLOW_THREADS
+
+  return PyBool_FromLong (is_detached);
+}
+
+static PyObject *
+PySession_detach (PySession * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_session_detach_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PySession_resume (PySession * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_session_resume_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PySession_enable_child_gating (PySession * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_session_enable_child_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PySession_disable_child_gating (PySession * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_session_disable_child_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PySession_create_script (PySession * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "source", "name", "snapshot", "runtime", NULL };
+  char * source;
+  char * name = NULL;
+  gconstpointer snapshot_data = NULL;
+  Py_ssize_t snapshot_size = 0;
+  const char * runtime_value = NULL;
+  TelcoScriptOptions * options;
+  GError * error = NULL;
+  TelcoScript * handle;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esy#z", keywords, "utf-8", &source, "utf-8", &name, &snapshot_data, &snapshot_size, &runtime_value))
+    return NULL;
+
+  options = PySession_parse_script_options (name, snapshot_data, snapshot_size, runtime_value);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  handle = telco_session_create_script_sync (PY_GOBJECT_HANDLE (self), source, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  result = (error == NULL)
+      ? PyScript_new_take_handle (handle)
+      : PyTelco_raise (error);
+
+beach:
+  g_clear_object (&options);
+
+  PyMem_Free (name);
+  PyMem_Free (source);
+
+  return result;
+}
+
+static PyObject *
+PySession_create_script_from_bytes (PySession * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "data", "name", "snapshot", "runtime", NULL };
+  guint8 * data;
+  Py_ssize_t size;
+  char * name = NULL;
+  gconstpointer snapshot_data = NULL;
+  Py_ssize_t snapshot_size = 0;
+  const char * runtime_value = NULL;
+  GBytes * bytes;
+  TelcoScriptOptions * options;
+  GError * error = NULL;
+  TelcoScript * handle;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "y#|esy#z", keywords, &data, &size, "utf-8", &name, &snapshot_data, &snapshot_size, &runtime_value))
+    return NULL;
+
+  bytes = g_bytes_new (data, size);
+
+  options = PySession_parse_script_options (name, snapshot_data, snapshot_size, runtime_value);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  handle = telco_session_create_script_from_bytes_sync (PY_GOBJECT_HANDLE (self), bytes, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  result = (error == NULL)
+      ? PyScript_new_take_handle (handle)
+      : PyTelco_raise (error);
+
+beach:
+  g_clear_object (&options);
+  g_bytes_unref (bytes);
+
+  PyMem_Free (name);
+
+  return result;
+}
+
+static PyObject *
+PySession_compile_script (PySession * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "source", "name", "runtime", NULL };
+  char * source;
+  char * name = NULL;
+  const char * runtime_value = NULL;
+  TelcoScriptOptions * options;
+  GError * error = NULL;
+  GBytes * bytes;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esz", keywords, "utf-8", &source, "utf-8", &name, &runtime_value))
+    return NULL;
+
+  options = PySession_parse_script_options (name, NULL, 0, runtime_value);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  bytes = telco_session_compile_script_sync (PY_GOBJECT_HANDLE (self), source, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  if (error == NULL)
+  {
+    result = PyGObject_marshal_bytes_non_nullable (bytes);
+
+    g_bytes_unref (bytes);
+  }
+  else
+  {
+    result = PyTelco_raise (error);
+  }
+
+beach:
+  g_clear_object (&options);
+
+  PyMem_Free (name);
+  PyMem_Free (source);
+
+  return result;
+}
+
+static TelcoScriptOptions *
+PySession_parse_script_options (const gchar * name, gconstpointer snapshot_data, gsize snapshot_size, const gchar * runtime_value)
+{
+  TelcoScriptOptions * options;
+
+  options = telco_script_options_new ();
+
+  if (name != NULL)
+    telco_script_options_set_name (options, name);
+
+  if (snapshot_data != NULL)
+  {
+    GBytes * snapshot = g_bytes_new (snapshot_data, snapshot_size);
+    telco_script_options_set_snapshot (options, snapshot);
+    g_bytes_unref (snapshot);
+  }
+
+  if (runtime_value != NULL)
+  {
+    TelcoScriptRuntime runtime;
+
+    if (!PyGObject_unmarshal_enum (runtime_value, TELCO_TYPE_SCRIPT_RUNTIME, &runtime))
+      goto invalid_argument;
+
+    telco_script_options_set_runtime (options, runtime);
+  }
+
+  return options;
+
+invalid_argument:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PySession_snapshot_script (PySession * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "embed_script", "warmup_script", "runtime", NULL };
+  char * embed_script;
+  char * warmup_script = NULL;
+  const char * runtime_value = NULL;
+  TelcoSnapshotOptions * options;
+  GError * error = NULL;
+  GBytes * bytes;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esz", keywords, "utf-8", &embed_script, "utf-8", &warmup_script, &runtime_value))
+    return NULL;
+
+  options = PySession_parse_snapshot_options (warmup_script, runtime_value);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  bytes = telco_session_snapshot_script_sync (PY_GOBJECT_HANDLE (self), embed_script, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  if (error == NULL)
+  {
+    result = PyGObject_marshal_bytes_non_nullable (bytes);
+
+    g_bytes_unref (bytes);
+  }
+  else
+  {
+    result = PyTelco_raise (error);
+  }
+
+beach:
+  g_clear_object (&options);
+
+  PyMem_Free (warmup_script);
+  PyMem_Free (embed_script);
+
+  return result;
+}
+
+static TelcoSnapshotOptions *
+PySession_parse_snapshot_options (const gchar * warmup_script, const gchar * runtime_value)
+{
+  TelcoSnapshotOptions * options;
+
+  options = telco_snapshot_options_new ();
+
+  if (warmup_script != NULL)
+    telco_snapshot_options_set_warmup_script (options, warmup_script);
+
+  if (runtime_value != NULL)
+  {
+    TelcoScriptRuntime runtime;
+
+    if (!PyGObject_unmarshal_enum (runtime_value, TELCO_TYPE_SCRIPT_RUNTIME, &runtime))
+      goto invalid_argument;
+
+    telco_snapshot_options_set_runtime (options, runtime);
+  }
+
+  return options;
+
+invalid_argument:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PySession_setup_peer_connection (PySession * self, PyObject * args, PyObject * kw)
+{
+  gboolean success = FALSE;
+  static char * keywords[] = { "stun_server", "relays", NULL };
+  char * stun_server = NULL;
+  PyObject * relays = NULL;
+  TelcoPeerOptions * options = NULL;
+  GError * error = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|esO", keywords,
+        "utf-8", &stun_server,
+        &relays))
+    return NULL;
+
+  options = PySession_parse_peer_options (stun_server, relays);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_session_setup_peer_connection_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  if (error != NULL)
+    goto propagate_error;
+
+  success = TRUE;
+  goto beach;
+
+propagate_error:
+  {
+    PyTelco_raise (error);
+    goto beach;
+  }
+beach:
+  {
+    g_clear_object (&options);
+
+    PyMem_Free (stun_server);
+
+    if (!success)
+      return NULL;
+
+    Py_RETURN_NONE;
+  }
+}
+
+static TelcoPeerOptions *
+PySession_parse_peer_options (const gchar * stun_server, PyObject * relays)
+{
+  TelcoPeerOptions * options;
+  PyObject * relay;
+
+  options = telco_peer_options_new ();
+
+  telco_peer_options_set_stun_server (options, stun_server);
+
+  if (relays != NULL)
+  {
+    Py_ssize_t n, i;
+
+    n = PySequence_Length (relays);
+    if (n == -1)
+      goto propagate_error;
+
+    for (i = 0; i != n; i++)
+    {
+      relay = PySequence_GetItem (relays, i);
+      if (relay == NULL)
+        goto propagate_error;
+
+      if (!PyObject_IsInstance (relay, PYTELCO_TYPE_OBJECT (Relay)))
+        goto expected_relay;
+
+      telco_peer_options_add_relay (options, PY_GOBJECT_HANDLE (relay));
+
+      Py_DECREF (relay);
+    }
+  }
+
+  return options;
+
+expected_relay:
+  {
+    Py_DECREF (relay);
+
+    PyErr_SetString (PyExc_TypeError, "expected sequence of Relay objects");
+    goto propagate_error;
+  }
+propagate_error:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+static PyObject *
+PySession_join_portal (PySession * self, PyObject * args, PyObject * kw)
+{
+  PyObject * result = NULL;
+  static char * keywords[] = { "address", "certificate", "token", "acl", NULL };
+  char * address;
+  char * certificate = NULL;
+  char * token = NULL;
+  PyObject * acl = NULL;
+  TelcoPortalOptions * options;
+  GError * error = NULL;
+  TelcoPortalMembership * handle;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esesO", keywords,
+        "utf-8", &address,
+        "utf-8", &certificate,
+        "utf-8", &token,
+        &acl))
+    return NULL;
+
+  options = PySession_parse_portal_options (certificate, token, acl);
+  if (options == NULL)
+    goto beach;
+
+  Py_BEGIN_ALLOW_THREADS
+  handle = telco_session_join_portal_sync (PY_GOBJECT_HANDLE (self), address, options, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+
+  result = (error == NULL)
+      ? PyPortalMembership_new_take_handle (handle)
+      : PyTelco_raise (error);
+
+beach:
+  g_clear_object (&options);
+
+  PyMem_Free (token);
+  PyMem_Free (certificate);
+  PyMem_Free (address);
+
+  return result;
+}
+
+static TelcoPortalOptions *
+PySession_parse_portal_options (const gchar * certificate_value, const gchar * token, PyObject * acl_value)
+{
+  TelcoPortalOptions * options;
+
+  options = telco_portal_options_new ();
+
+  if (certificate_value != NULL)
+  {
+    GTlsCertificate * certificate;
+
+    if (!PyGObject_unmarshal_certificate (certificate_value, &certificate))
+      goto propagate_error;
+
+    telco_portal_options_set_certificate (options, certificate);
+
+    g_object_unref (certificate);
+  }
+
+  if (token != NULL)
+    telco_portal_options_set_token (options, token);
+
+  if (acl_value != NULL)
+  {
+    gchar ** acl;
+    gint acl_length;
+
+    if (!PyGObject_unmarshal_strv (acl_value, &acl, &acl_length))
+      goto propagate_error;
+
+    telco_portal_options_set_acl (options, acl, acl_length);
+
+    g_strfreev (acl);
+  }
+
+  return options;
+
+propagate_error:
+  {
+    g_object_unref (options);
+
+    return NULL;
+  }
+}
+
+
+static PyObject *
+PyScript_new_take_handle (TelcoScript * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Script));
+}
+
+static int
+PyScript_init (PyScript * self, PyObject * args, PyObject * kw)
+{
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  self->rpc_requests = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) PyScriptRpcRequest_free);
+  self->next_rpc_request_id = 1;
+  g_mutex_init (&self->rpc_lock);
+  g_cond_init (&self->rpc_cond);
+
+  return 0;
+}
+
+static void
+PyScript_dealloc (PyScript * self)
+{
+  if (self->rpc_requests != NULL)
+  {
+    g_hash_table_unref (self->rpc_requests);
+    g_cond_clear (&self->rpc_cond);
+    g_mutex_clear (&self->rpc_lock);
+  }
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyScript_is_destroyed (PyScript * self)
+{
+  gboolean is_destroyed;
+
+  Py_BEGIN_ALLOW_THREADS
+  is_destroyed = telco_script_is_destroyed (PY_GOBJECT_HANDLE (self));
+  Py_END_ALLOW_THREADS
+
+  return PyBool_FromLong (is_destroyed);
+}
+
+static PyObject *
+PyScript_load (PyScript * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_script_load_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_unload (PyScript * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_script_unload_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_eternalize (PyScript * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_script_eternalize_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_post (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "message", "data", NULL };
+  char * message;
+  GBytes * data = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|O&", keywords, "utf-8", &message, PyGObject_convert_data, &data))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_script_post (PY_GOBJECT_HANDLE (self), message, data);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (data);
+  PyMem_Free (message);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_post_many (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "messages", "datas", NULL };
+  PyObject * messages, * datas = Py_None;
+  gchar ** raw_messages;
+  GBytes ** raw_datas;
+  Py_ssize_t length, i;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "O|O", keywords, &messages, &datas))
+    return NULL;
+
+  if (!PyTelco_unmarshal_post_batch (messages, datas, &raw_messages, &raw_datas, &length))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  for (i = 0; i != length; i++)
+    telco_script_post (PY_GOBJECT_HANDLE (self), raw_messages[i], raw_datas[i]);
+  Py_END_ALLOW_THREADS
+
+  PyTelco_free_post_batch (raw_messages, raw_datas, length);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_enable_debugger (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "port", NULL };
+  unsigned short int port = 0;
+  GError * error = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|H", keywords, &port))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_script_enable_debugger_sync (PY_GOBJECT_HANDLE (self), port, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_disable_debugger (PyScript * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_script_disable_debugger_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_begin_rpc (PyScript * self, PyObject * args)
+{
+  PyObject * on_complete = NULL;
+  PyScriptRpcRequest * request;
+
+  if (!PyArg_ParseTuple (args, "|O", &on_complete))
+    return NULL;
+
+  if (on_complete == Py_None)
+    on_complete = NULL;
+  if (on_complete != NULL && !PyCallable_Check (on_complete))
+    goto not_callable;
+
+  request = g_slice_new0 (PyScriptRpcRequest);
+  request->id = self->next_rpc_request_id++;
+  request->on_complete = on_complete;
+  Py_XINCREF (on_complete);
+
+  g_hash_table_insert (self->rpc_requests, GUINT_TO_POINTER (request->id), request);
+
+  return PyLong_FromUnsignedLong (request->id);
+
+not_callable:
+  {
+    PyErr_SetString (PyExc_TypeError, "on_complete must be callable");
+    return NULL;
+  }
+}
+
+static PyObject *
+PyScript_wait_for_rpc (PyScript * self, PyObject * args)
+{
+  guint request_id;
+  PyScriptRpcRequest * request;
+  GCancellable * cancellable;
+  gulong cancelled_handler = 0;
+  PyObject * result;
+
+  if (!PyArg_ParseTuple (args, "I", &request_id))
+    return NULL;
+
+  request = g_hash_table_lookup (self->rpc_requests, GUINT_TO_POINTER (request_id));
+  if (request == NULL || request->on_complete != NULL || request->waiting)
+    goto invalid_request;
+  request->waiting = TRUE;
+
+  cancellable = g_cancellable_get_current ();
+
+  Py_BEGIN_ALLOW_THREADS
+  if (cancellable != NULL)
+    cancelled_handler = g_cancellable_connect (cancellable, G_CALLBACK (PyScript_on_rpc_cancelled), self, NULL);
+
+  g_mutex_lock (&self->rpc_lock);
+  while (!request->completed && (cancellable == NULL || !g_cancellable_is_cancelled (cancellable)))
+    g_cond_wait (&self->rpc_cond, &self->rpc_lock);
+  g_mutex_unlock (&self->rpc_lock);
+
+  if (cancellable != NULL)
+    g_cancellable_disconnect (cancellable, cancelled_handler);
+  Py_END_ALLOW_THREADS
+
+  g_hash_table_steal (self->rpc_requests, GUINT_TO_POINTER (request_id));
+
+  if (!request->completed)
+  {
+    GError * error = NULL;
+
+    g_cancellable_set_error_if_cancelled (cancellable, &error);
+    result = PyTelco_raise (error);
+  }
+  else if (request->aborted)
+  {
+    result = PyTelco_raise (g_error_new_literal (TELCO_ERROR, TELCO_ERROR_INVALID_OPERATION, "Script has been destroyed"));
+  }
+  else
+  {
+    result = PyTuple_Pack (2, request->value, (request->error != NULL) ? request->error : Py_None);
+  }
+
+  PyScriptRpcRequest_free (request);
+
+  return result;
+
+invalid_request:
+  {
+    PyErr_SetString (PyExc_ValueError, "invalid request ID");
+    return NULL;
+  }
+}
+
+static PyObject *
+PyScript_abort_rpcs (PyScript * self)
+{
+  GHashTableIter iter;
+  PyScriptRpcRequest * request;
+  GSList * aborted = NULL, * cur;
+
+  g_hash_table_iter_init (&iter, self->rpc_requests);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &request))
+  {
+    if (request->completed)
+      continue;
+
+    if (request->on_complete != NULL)
+    {
+      g_hash_table_iter_steal (&iter);
+      aborted = g_slist_prepend (aborted, request);
+    }
+    else
+    {
+      g_mutex_lock (&self->rpc_lock);
+      request->completed = TRUE;
+      request->aborted = TRUE;
+      g_cond_broadcast (&self->rpc_cond);
+      g_mutex_unlock (&self->rpc_lock);
+    }
+  }
+
+  aborted = g_slist_reverse (aborted);
+  for (cur = aborted; cur != NULL; cur = cur->next)
+  {
+    PyObject * exception, * error;
+
+    request = cur->data;
+
+    exception = g_hash_table_lookup (telco_exception_by_error_code, GINT_TO_POINTER (TELCO_ERROR_INVALID_OPERATION));
+    error = PyObject_CallFunction (exception, "s", "script has been destroyed");
+    if (error != NULL)
+    {
+      PyScript_complete_rpc_request (self, request, Py_None, error);
+      Py_DECREF (error);
+    }
+    else
+    {
+      PyErr_Print ();
+      PyScriptRpcRequest_free (request);
+    }
+  }
+  g_slist_free (aborted);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyScript_enumerate_pending_rpcs (PyScript * self)
+{
+  PyObject * result;
+  GHashTableIter iter;
+  PyScriptRpcRequest * request;
+
+  result = PyList_New (0);
+
+  g_hash_table_iter_init (&iter, self->rpc_requests);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &request))
+  {
+    PyObject * id;
+
+    if (request->completed)
+      continue;
+
+    id = PyLong_FromUnsignedLong (request->id);
+    PyList_Append (result, id);
+    Py_DECREF (id);
+  }
+
+  return result;
+}
+
+static gboolean
+PyScript_try_dispatch_rpc_reply (PyScript * self, const GValue * params, guint params_length, PyGObjectSignalFlags flags)
+{
+  gboolean handled = FALSE;
+  const gchar * raw_message;
+  PyObject * message, * type, * payload, * operation;
+  PyScriptRpcRequest * request;
+  gulong request_id;
+
+  raw_message = g_value_get_string (&params[1]);
+  if (raw_message == NULL || strstr (raw_message, "\"telco:rpc\"") == NULL)
+    return FALSE;
+
+  message = PyTelco_json_decode (raw_message, strlen (raw_message));
+  if (message == NULL)
+  {
+    /* A reply that slipped through to the handlers would leave its caller waiting forever. */
+    PyErr_Clear ();
+    message = PyObject_CallFunction (json_loads, "s", raw_message);
+    if (message == NULL)
+    {
+      PyErr_Clear ();
+      return PyScript_fail_undecodable_rpc_reply (self, raw_message);
+    }
+  }
+
+  if (!PyDict_Check (message))
+    goto beach;
+
+  type = PyDict_GetItemString (message, "type");
+  if (type == NULL || !PyUnicode_Check (type) || PyUnicode_CompareWithASCIIString (type, "send") != 0)
+    goto beach;
+
+  payload = PyDict_GetItemString (message, "payload");
+  if (payload == NULL || !PyList_Check (payload) || PyList_Size (payload) < 3)
+    goto beach;
+
+  if (!PyTelco_is_string (PyList_GetItem (payload, 0)) ||
+      PyUnicode_CompareWithASCIIString (PyList_GetItem (payload, 0), "telco:rpc") != 0)
+    goto beach;
+
+  handled = TRUE;
+
+  request_id = PyLong_AsUnsignedLong (PyList_GetItem (payload, 1));
+  if (request_id == (gulong) -1 && PyErr_Occurred ())
+  {
+    PyErr_Clear ();
+    goto beach;
+  }
+
+  request = g_hash_table_lookup (self->rpc_requests, GSIZE_TO_POINTER (request_id));
+  if (request == NULL || request->completed)
+    goto beach;
+
+  operation = PyList_GetItem (payload, 2);
+  if (!PyTelco_is_string (operation))
+    goto beach;
+
+  if (PyUnicode_CompareWithASCIIString (operation, "ok") == 0)
+  {
+    PyObject * value;
+
+    if (params_length > 2 && g_value_get_boxed (&params[2]) != NULL)
+    {
+      if ((flags & PY_GOBJECT_SIGNAL_ZERO_COPY) != 0)
+        value = PyGObject_marshal_bytes_view (g_value_get_boxed (&params[2]));
+      else
+        value = PyGObject_marshal_bytes (g_value_get_boxed (&params[2]));
+    }
+    else
+    {
+      value = (PyList_Size (payload) > 3) ? PyList_GetItem (payload, 3) : Py_None;
+      Py_INCREF (value);
+    }
+
+    if (request->on_complete != NULL)
+      g_hash_table_steal (self->rpc_requests, GUINT_TO_POINTER (request->id));
+    PyScript_complete_rpc_request (self, request, value, NULL);
+
+    Py_DECREF (value);
+  }
+  else if (PyUnicode_CompareWithASCIIString (operation, "error") == 0)
+  {
+    PyObject * error;
+
+    error = PyList_GetSlice (payload, 3, 6);
+
+    if (request->on_complete != NULL)
+      g_hash_table_steal (self->rpc_requests, GUINT_TO_POINTER (request->id));
+    PyScript_complete_rpc_request (self, request, Py_None, error);
+
+    Py_DECREF (error);
+  }
+
+beach:
+  Py_DECREF (message);
+
+  return handled;
+}
+
+static gboolean
+PyScript_fail_undecodable_rpc_reply (PyScript * self, const gchar * raw_message)
+{
+  const gchar * cursor;
+  gchar * end;
+  guint64 request_id;
+  PyScriptRpcRequest * request;
+  PyObject * error;
+
+  cursor = strstr (raw_message, "\"telco:rpc\"") + strlen ("\"telco:rpc\"");
+  while (g_ascii_isspace (*cursor))
+    cursor++;
+  if (*cursor++ != ',')
+    return FALSE;
+  while (g_ascii_isspace (*cursor))
+    cursor++;
+
+  request_id = g_ascii_strtoull (cursor, &end, 10);
+  if (end == cursor)
+    return FALSE;
+
+  request = g_hash_table_lookup (self->rpc_requests, GSIZE_TO_POINTER (request_id));
+  if (request == NULL || request->completed)
+    return TRUE;
+
+  error = Py_BuildValue ("[s]", "unable to decode RPC reply");
+  if (error == NULL)
+  {
+    PyErr_Print ();
+    return TRUE;
+  }
+
+  if (request->on_complete != NULL)
+    g_hash_table_steal (self->rpc_requests, GUINT_TO_POINTER (request->id));
+  PyScript_complete_rpc_request (self, request, Py_None, error);
+
+  Py_DECREF (error);
+
+  return TRUE;
+}
+
+static void
+PyScript_complete_rpc_request (PyScript * self, PyScriptRpcRequest * request, PyObject * value, PyObject * error)
+{
+  if (request->on_complete != NULL)
+  {
+    PyObject * result;
+
+    result = PyObject_CallFunctionObjArgs (request->on_complete, value, (error != NULL) ? error : Py_None, NULL);
+    if (result != NULL)
+      Py_DECREF (result);
+    else
+      PyErr_Print ();
+
+    PyScriptRpcRequest_free (request);
+    return;
+  }
+
+  Py_INCREF (value);
+  Py_XINCREF (error);
+
+  g_mutex_lock (&self->rpc_lock);
+  request->value = value;
+  request->error = error;
+  request->completed = TRUE;
+  g_cond_broadcast (&self->rpc_cond);
+  g_mutex_unlock (&self->rpc_lock);
+}
+
+static void
+PyScript_on_rpc_cancelled (GCancellable * cancellable, PyScript * self)
+{
+  g_mutex_lock (&self->rpc_lock);
+  g_cond_broadcast (&self->rpc_cond);
+  g_mutex_unlock (&self->rpc_lock);
+}
+
+static void
+PyScriptRpcRequest_free (PyScriptRpcRequest * request)
+{
+  Py_XDECREF (request->error);
+  Py_XDECREF (request->value);
+  Py_XDECREF (request->on_complete);
+
+  g_slice_free (PyScriptRpcRequest, request);
+}
+
+
+static int
+PyRelay_init (PyRelay * self, PyObject * args, PyObject * kw)
+{
+  int result = -1;
+  static char * keywords[] = { "address", "username", "password", "kind", NULL };
+  char * address = NULL;
+  char * username = NULL;
+  char * password = NULL;
+  char * kind_value = NULL;
+  TelcoRelayKind kind;
+  TelcoRelay * handle;
+
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "eseseses", keywords,
+        "utf-8", &address,
+        "utf-8", &username,
+        "utf-8", &password,
+        "utf-8", &kind_value))
+    return -1;
+
+  if (!PyGObject_unmarshal_enum (kind_value, TELCO_TYPE_RELAY_KIND, &kind))
+    goto beach;
+
+  handle = telco_relay_new (address, username, password, kind);
+
+  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (Relay));
+
+  PyRelay_init_from_handle (self, handle);
+
+  result = 0;
+
+beach:
+  PyMem_Free (kind_value);
+  PyMem_Free (password);
+  PyMem_Free (username);
+  PyMem_Free (address);
+
+  return result;
+}
+
+static void
+PyRelay_init_from_handle (PyRelay * self, TelcoRelay * handle)
+{
+  self->address = PyUnicode_FromUTF8String (telco_relay_get_address (handle));
+  self->username = PyUnicode_FromUTF8String (telco_relay_get_username (handle));
+  self->password = PyUnicode_FromUTF8String (telco_relay_get_password (handle));
+  self->kind = PyGObject_marshal_enum (telco_relay_get_kind (handle), TELCO_TYPE_RELAY_KIND);
+}
+
+static void
+PyRelay_dealloc (PyRelay * self)
+{
+  Py_XDECREF (self->kind);
+  Py_XDECREF (self->password);
+  Py_XDECREF (self->username);
+  Py_XDECREF (self->address);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyRelay_repr (PyRelay * self)
+{
+  PyObject * result, * address_bytes, * username_bytes, * password_bytes, * kind_bytes;
+
+  address_bytes = PyUnicode_AsUTF8String (self->address);
+  username_bytes = PyUnicode_AsUTF8String (self->username);
+  password_bytes = PyUnicode_AsUTF8String (self->password);
+  kind_bytes = PyUnicode_AsUTF8String (self->kind);
+
+  result = PyRepr_FromFormat ("Relay(address=\"%s\", username=\"%s\", password=\"%s\", kind='%s')",
+      PyBytes_AsString (address_bytes),
+      PyBytes_AsString (username_bytes),
+      PyBytes_AsString (password_bytes),
+      PyBytes_AsString (kind_bytes));
+
+  Py_DECREF (kind_bytes);
+  Py_DECREF (password_bytes);
+  Py_DECREF (username_bytes);
+  Py_DECREF (address_bytes);
+
+  return result;
+}
+
+
+static PyObject *
+PyPortalMembership_new_take_handle (TelcoPortalMembership * handle)
+{
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (PortalMembership));
+}
+
+static PyObject *
+PyPortalMembership_terminate (PyPortalMembership * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_membership_terminate_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+
+static int
+PyPortalService_init (PyPortalService * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "cluster_params", "control_params", NULL };
+  PyEndpointParameters * cluster_params;
+  PyEndpointParameters * control_params = NULL;
+  TelcoPortalService * handle;
+
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "O!|O!", keywords,
+        PYTELCO_TYPE_OBJECT (EndpointParameters), &cluster_params,
+        PYTELCO_TYPE_OBJECT (EndpointParameters), &control_params))
+    return -1;
+
+  g_atomic_int_inc (&toplevel_objects_alive);
+
+  handle = telco_portal_service_new (PY_GOBJECT_HANDLE (cluster_params),
+      (control_params != NULL) ? PY_GOBJECT_HANDLE (control_params) : NULL);
+
+  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (PortalService));
+
+  PyPortalService_init_from_handle (self, handle);
+
+  return 0;
+}
+
+static void
+PyPortalService_init_from_handle (PyPortalService * self, TelcoPortalService * handle)
+{
+  self->device = PyDevice_new_take_handle (g_object_ref (telco_portal_service_get_device (handle)));
+}
+
+static void
+PyPortalService_dealloc (PyPortalService * self)
+{
+  TelcoPortalService * handle;
+
+  g_atomic_int_dec_and_test (&toplevel_objects_alive);
+
+  handle = PyGObject_steal_handle (&self->parent);
+  if (handle != NULL)
+  {
+    Py_BEGIN_ALLOW_THREADS
+    telco_portal_service_stop_sync (handle, NULL, NULL);
+    telco_unref (handle);
+    Py_END_ALLOW_THREADS
+  }
+
+  Py_XDECREF (self->device);
+
+  PyGObject_tp_dealloc ((PyObject *) self);
+}
+
+static PyObject *
+PyPortalService_start (PyPortalService * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_start_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_stop (PyPortalService * self)
+{
+  GError * error = NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_stop_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_kick (PyScript * self, PyObject * args)
+{
+  unsigned int connection_id;
+
+  if (!PyArg_ParseTuple (args, "I", &connection_id))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_kick (PY_GOBJECT_HANDLE (self), connection_id);
+  Py_END_ALLOW_THREADS
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_post (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "connection_id", "message", "data", NULL };
+  unsigned int connection_id;
+  char * message;
+  GBytes * data = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "Ies|O&", keywords,
+        &connection_id,
+        "utf-8", &message,
+        PyGObject_convert_data, &data))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_post (PY_GOBJECT_HANDLE (self), connection_id, message, data);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (data);
+  PyMem_Free (message);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_narrowcast (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "tag", "message", "data", NULL };
+  char * tag, * message;
+  GBytes * data = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "eses|O&", keywords,
+        "utf-8", &tag,
+        "utf-8", &message,
+        PyGObject_convert_data, &data))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_narrowcast (PY_GOBJECT_HANDLE (self), tag, message, data);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (data);
+  PyMem_Free (message);
+  PyMem_Free (tag);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_broadcast (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "message", "data", NULL };
+  char * message;
+  GBytes * data = NULL;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|O&", keywords,
+        "utf-8", &message,
+        PyGObject_convert_data, &data))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_broadcast (PY_GOBJECT_HANDLE (self), message, data);
+  Py_END_ALLOW_THREADS
+
+  g_bytes_unref (data);
+  PyMem_Free (message);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_enumerate_tags (PyScript * self, PyObject * args)
+{
+  PyObject * result;
+  unsigned int connection_id;
+  gchar ** tags;
+  gint tags_length;
+
+  if (!PyArg_ParseTuple (args, "I", &connection_id))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  tags = telco_portal_service_enumerate_tags (PY_GOBJECT_HANDLE (self), connection_id, &tags_length);
+  Py_END_ALLOW_THREADS
+
+  result = PyGObject_marshal_strv (tags, tags_length);
+  g_strfreev (tags);
+
+  return result;
+}
+
+static PyObject *
+PyPortalService_tag (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "connection_id", "tag", NULL };
+  unsigned int connection_id;
+  char * tag;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "Ies", keywords,
+        &connection_id,
+        "utf-8", &tag))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_tag (PY_GOBJECT_HANDLE (self), connection_id, tag);
+  Py_END_ALLOW_THREADS
+
+  PyMem_Free (tag);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *
+PyPortalService_untag (PyScript * self, PyObject * args, PyObject * kw)
+{
+  static char * keywords[] = { "connection_id", "tag", NULL };
+  unsigned int connection_id;
+  char * tag;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "Ies", keywords,
+        &connection_id,
+        "utf-8", &tag))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  telco_portal_service_untag (PY_GOBJECT_HANDLE (self), connection_id, tag);
+  Py_END_ALLOW_THREADS
+
+  PyMem_Free (tag);
+
+  Py_RETURN_NONE;
+}
+
+
+static int
+PyEndpointParameters_init (PyEndpointParameters * self, PyObject * args, PyObject * kw)
+{
+  int result = -1;
+  static char * keywords[] = { "address", "port", "certificate", "origin", "auth_token", "auth_callback", "asset_root", NULL };
+  char * address = NULL;
+  unsigned short int port = 0;
+  char * certificate_value = NULL;
+  char * origin = NULL;
+  char * auth_token = NULL;
+  PyObject * auth_callback = NULL;
+  char * asset_root_value = NULL;
+  GTlsCertificate * certificate = NULL;
+  TelcoAuthenticationService * auth_service = NULL;
+  GFile * asset_root = NULL;
+  TelcoEndpointParameters * handle;
+
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|esHesesesOes", keywords,
+        "utf-8", &address,
+        &port,
+        "utf-8", &certificate_value,
+        "utf-8", &origin,
+        "utf-8", &auth_token,
+        &auth_callback,
+        "utf-8", &asset_root_value))
+    return -1;
+
+  if (certificate_value != NULL && !PyGObject_unmarshal_certificate (certificate_value, &certificate))
+    goto beach;
+
+  if (auth_token != NULL)
+    auth_service = TELCO_AUTHENTICATION_SERVICE (telco_static_authentication_service_new (auth_token));
+  else if (auth_callback != NULL)
+    auth_service = TELCO_AUTHENTICATION_SERVICE (telco_python_authentication_service_new (auth_callback));
+
+  if (asset_root_value != NULL)
+    asset_root = g_file_new_for_path (asset_root_value);
+
+  handle = telco_endpoint_parameters_new (address, port, certificate, origin, auth_service, asset_root);
+
+  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (EndpointParameters));
+
+  result = 0;
+
+beach:
+  g_clear_object (&asset_root);
+  g_clear_object (&auth_service);
+  g_clear_object (&certificate);
+
+  PyMem_Free (asset_root_value);
+  PyMem_Free (auth_token);
+  PyMem_Free (origin);
+  PyMem_Free (certificate_value);
+  PyMem_Free (address);
+
+  return result;
+}
+
+
+G_DEFINE_TYPE_EXTENDED (TelcoPythonAuthenticationService, telco_python_authentication_service, G_TYPE_OBJECT, 0,
+    G_IMPLEMENT_INTERFACE (TELCO_TYPE_AUTHENTICATION_SERVICE, telco_python_authentication_service_iface_init))
+
+static TelcoPythonAuthenticationService *
+telco_python_authentication_service_new (PyObject * callback)
+{
+  TelcoPythonAuthenticationService * service;
+
+  service = g_object_new (TELCO_TYPE_PYTHON_AUTHENTICATION_SERVICE, NULL);
+  service->callback = callback;
+  Py_IncRef (callback);
+
+  return service;
+}
+
+static void
+telco_python_authentication_service_class_init (TelcoPythonAuthenticationServiceClass * klass)
+{
+  GObjectClass * object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = telco_python_authentication_service_dispose;
+}
+
+static void
+telco_python_authentication_service_iface_init (gpointer g_iface, gpointer iface_data)
+{
+  TelcoAuthenticationServiceIface * iface = g_iface;
+
+  iface->authenticate = telco_python_authentication_service_authenticate;
+  iface->authenticate_finish = telco_python_authentication_service_authenticate_finish;
+}
+
+static void
+telco_python_authentication_service_init (TelcoPythonAuthenticationService * self)
+{
+  self->pool = g_thread_pool_new ((GFunc) telco_python_authentication_service_do_authenticate, self, 1, FALSE, NULL);
+}
+
+static void
+telco_python_authentication_service_dispose (GObject * object)
+{
+  TelcoPythonAuthenticationService * self = TELCO_PYTHON_AUTHENTICATION_SERVICE (object);
+
+  if (self->pool != NULL)
+  {
+    g_thread_pool_free (self->pool, FALSE, FALSE);
+    self->pool = NULL;
+  }
+
+  if (self->callback != NULL)
+  {
+    PyGILState_STATE gstate;
+
+    gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_AUTHENTICATION_DISPOSE);
+
+    Py_DECREF (self->callback);
+    self->callback = NULL;
+
+    PyGILState_Release (gstate);
+  }
+
+  G_OBJECT_CLASS (telco_python_authentication_service_parent_class)->dispose (object);
+}
+
+static void
+telco_python_authentication_service_authenticate (TelcoAuthenticationService * service, const gchar * token, GCancellable * cancellable,
+    GAsyncReadyCallback callback, gpointer user_data)
+{
+  TelcoPythonAuthenticationService * self;
+  GTask * task;
+
+  self = TELCO_PYTHON_AUTHENTICATION_SERVICE (service);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_task_data (task, g_strdup (token), g_free);
+
+  g_thread_pool_push (self->pool, task, NULL);
+}
+
+static gchar *
+telco_python_authentication_service_authenticate_finish (TelcoAuthenticationService * service, GAsyncResult * result, GError ** error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+telco_python_authentication_service_do_authenticate (GTask * task, TelcoPythonAuthenticationService * self)
+{
+  const gchar * token;
+  PyGILState_STATE gstate;
+  PyObject * result;
+  gchar * session_info = NULL;
+  gchar * message = NULL;
+
+  token = g_task_get_task_data (task);
+
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_AUTHENTICATION);
+
+  result = PyObject_CallFunction (self->callback, "s", token);
+  if (result == NULL || !PyGObject_unmarshal_string (result, &session_info))
+  {
+    PyObject * type, * value, * traceback;
+
+    PyErr_Fetch (&type, &value, &traceback);
+
+    if (value != NULL)
+    {
+      PyObject * message_value = PyObject_Str (value);
+      PyGObject_unmarshal_string (message_value, &message);
+      Py_DECREF (message_value);
+    }
+    else
+    {
+      message = g_strdup ("Internal error");
     }
+
+    Py_DECREF (type);
+    Py_XDECREF (value);
+    Py_XDECREF (traceback);
   }
 
-  Py_BEGIN_ALLOW_THREADS
-  pid = telco_device_spawn_sync (PY_GOBJECT_HANDLE (self), program, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  Py_XDECREF (result);
 
-  g_object_unref (options);
+  PyGILState_Release (gstate);
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (session_info != NULL)
+    g_task_return_pointer (task, session_info, g_free);
+  else
+    g_task_return_new_error (task, TELCO_ERROR, TELCO_ERROR_INVALID_ARGUMENT, "%s", message);
 
-  return PyLong_FromUnsignedLong (pid);
+  g_free (message);
+  g_object_unref (task);
+}
 
-invalid_argument:
-invalid_dict_key:
-invalid_dict_value:
-  {
-    g_object_unref (options);
 
-    return NULL;
-  }
-invalid_aux_dict:
-  {
-    g_object_unref (options);
+static int
+PyCompiler_init (PyCompiler * self, PyObject * args, PyObject * kw)
+{
+  PyDeviceManager * manager;
 
-    PyErr_SetString (PyExc_TypeError, "unsupported parameter");
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
 
-    return NULL;
-  }
+  if (!PyArg_ParseTuple (args, "O!", PYTELCO_TYPE_OBJECT (DeviceManager), &manager))
+    return -1;
+
+  PyGObject_take_handle (&self->parent, telco_compiler_new (PY_GOBJECT_HANDLE (manager)), PYTELCO_TYPE (Compiler));
+
+  return 0;
 }
 
 static PyObject *
-PyDevice_input (PyDevice * self, PyObject * args)
+PyCompiler_build (PyCompiler * self, PyObject * args, PyObject * kw)
 {
-  long pid;
-  gconstpointer data_buffer;
-  Py_ssize_t data_size;
-  GBytes * data;
+  PyObject * result;
+  static char * keywords[] = { "entrypoint", "project_root", "source_maps", "compression", NULL };
+  const char * entrypoint;
+  const char * project_root = NULL;
+  const char * source_maps = NULL;
+  const char * compression = NULL;
+  TelcoBuildOptions * options;
   GError * error = NULL;
+  gchar * bundle;
 
-  if (!PyArg_ParseTuple (args, "ly#", &pid, &data_buffer, &data_size))
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "s|sss", keywords, &entrypoint, &project_root, &source_maps, &compression))
     return NULL;
 
-  data = g_bytes_new (data_buffer, data_size);
+  options = telco_build_options_new ();
+  if (!PyCompiler_set_options (TELCO_COMPILER_OPTIONS (options), project_root, source_maps, compression))
+    goto invalid_option_value;
 
   Py_BEGIN_ALLOW_THREADS
-  telco_device_input_sync (PY_GOBJECT_HANDLE (self), (guint) pid, data, g_cancellable_get_current (), &error);
+  bundle = telco_compiler_build_sync (PY_GOBJECT_HANDLE (self), entrypoint, options, g_cancellable_get_current (), &error);
   Py_END_ALLOW_THREADS
 
-  g_bytes_unref (data);
+  g_object_unref (options);
 
   if (error != NULL)
     return PyTelco_raise (error);
 
-  Py_RETURN_NONE;
-}
+  result = PyUnicode_FromUTF8String (bundle);
+  g_free (bundle);
 
-static PyObject *
-PyDevice_resume (PyDevice * self, PyObject * args)
-{
-  long pid;
-  GError * error = NULL;
+  return result;
 
-  if (!PyArg_ParseTuple (args, "l", &pid))
+invalid_option_value:
+  {
+    g_object_unref (options);
     return NULL;
-
-  Py_BEGIN_ALLOW_THREADS
-  telco_device_resume_sync (PY_GOBJECT_HANDLE (self), (guint) pid, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
-
-  Py_RETURN_NONE;
+  }
 }
 
 static PyObject *
-PyDevice_kill (PyDevice * self, PyObject * args)
+PyCompiler_watch (PyCompiler * self, PyObject * args, PyObject * kw)
 {
-  long pid;
+  static char * keywords[] = { "entrypoint", "project_root", "source_maps", "compression", NULL };
+  const char * entrypoint;
+  const char * project_root = NULL;
+  const char * source_maps = NULL;
+  const char * compression = NULL;
+  TelcoWatchOptions * options;
   GError * error = NULL;
 
-  if (!PyArg_ParseTuple (args, "l", &pid))
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "s|sss", keywords, &entrypoint, &project_root, &source_maps, &compression))
     return NULL;
 
+  options = telco_watch_options_new ();
+  if (!PyCompiler_set_options (TELCO_COMPILER_OPTIONS (options), project_root, source_maps, compression))
+    goto invalid_option_value;
+
   Py_BEGIN_ALLOW_THREADS
-  telco_device_kill_sync (PY_GOBJECT_HANDLE (self), (guint) pid, g_cancellable_get_current (), &error);
+  telco_compiler_watch_sync (PY_GOBJECT_HANDLE (self), entrypoint, options, g_cancellable_get_current (), &error);
   Py_END_ALLOW_THREADS
+
+  g_object_unref (options);
+
   if (error != NULL)
     return PyTelco_raise (error);
 
   Py_RETURN_NONE;
-}
-
-static PyObject *
-PyDevice_attach (PyDevice * self, PyObject * args, PyObject * kw)
-{
-  PyObject * result = NULL;
-  static char * keywords[] = { "pid", "realm", "persist_timeout", NULL };
-  long pid;
-  char * realm_value = NULL;
-  unsigned int persist_timeout = 0;
-  TelcoSessionOptions * options = NULL;
-  GError * error = NULL;
-  TelcoSession * handle;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "l|esI", keywords,
-        &pid,
-        "utf-8", &realm_value,
-        &persist_timeout))
+invalid_option_value:
+  {
+    g_object_unref (options);
     return NULL;
-
-  options = PyDevice_parse_session_options (realm_value, persist_timeout);
-  if (options == NULL)
-    goto beach;
-
-  Py_BEGIN_ALLOW_THREADS
-  handle = telco_device_attach_sync (PY_GOBJECT_HANDLE (self), (guint) pid, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-
-  result = (error == NULL)
-      ? PySession_new_take_handle (handle)
-      : PyTelco_raise (error);
-
-beach:
-  g_clear_object (&options);
-
-  PyMem_Free (realm_value);
-
-  return result;
+  }
 }
 
-static TelcoSessionOptions *
-PyDevice_parse_session_options (const gchar * realm_value,
-                                guint persist_timeout)
+static gboolean
+PyCompiler_set_options (TelcoCompilerOptions * options, const gchar * project_root_value, const gchar * source_maps_value,
+    const gchar * compression_value)
 {
-  TelcoSessionOptions * options;
-
-  options = telco_session_options_new ();
+  if (project_root_value != NULL)
+    telco_compiler_options_set_project_root (options, project_root_value);
 
-  if (realm_value != NULL)
+  if (source_maps_value != NULL)
   {
-    TelcoRealm realm;
+    TelcoSourceMaps source_maps;
 
-    if (!PyGObject_unmarshal_enum (realm_value, TELCO_TYPE_REALM, &realm))
-      goto propagate_error;
+    if (!PyGObject_unmarshal_enum (source_maps_value, TELCO_TYPE_SOURCE_MAPS, &source_maps))
+      return FALSE;
 
-    telco_session_options_set_realm (options, realm);
+    telco_compiler_options_set_source_maps (options, source_maps);
   }
 
-  telco_session_options_set_persist_timeout (options, persist_timeout);
-
-  return options;
-
-propagate_error:
+  if (compression_value != NULL)
   {
-    g_object_unref (options);
-
-    return NULL;
-  }
-}
-
-static PyObject *
-PyDevice_inject_library_file (PyDevice * self, PyObject * args)
-{
-  long pid;
-  const char * path, * entrypoint, * data;
-  GError * error = NULL;
-  guint id;
+    TelcoJsCompression compression;
 
-  if (!PyArg_ParseTuple (args, "lsss", &pid, &path, &entrypoint, &data))
-    return NULL;
+    if (!PyGObject_unmarshal_enum (compression_value, TELCO_TYPE_JS_COMPRESSION, &compression))
+      return FALSE;
 
-  Py_BEGIN_ALLOW_THREADS
-  id = telco_device_inject_library_file_sync (PY_GOBJECT_HANDLE (self), (guint) pid, path, entrypoint, data, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+    telco_compiler_options_set_compression (options, compression);
+  }
 
-  return PyLong_FromUnsignedLong (id);
+  return TRUE;
 }
 
-static PyObject *
-PyDevice_inject_library_blob (PyDevice * self, PyObject * args)
-{
-  long pid;
-  GBytes * blob;
-  gconstpointer blob_buffer;
-  Py_ssize_t blob_size;
-  const char * entrypoint, * data;
-  GError * error = NULL;
-  guint id;
-
-  if (!PyArg_ParseTuple (args, "ly#ss", &pid, &blob_buffer, &blob_size, &entrypoint, &data))
-    return NULL;
 
-  blob = g_bytes_new (blob_buffer, blob_size);
+static int
+PyFileMonitor_init (PyFileMonitor * self, PyObject * args, PyObject * kw)
+{
+  const char * path;
 
-  Py_BEGIN_ALLOW_THREADS
-  id = telco_device_inject_library_blob_sync (PY_GOBJECT_HANDLE (self), (guint) pid, blob, entrypoint, data, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
+    return -1;
 
-  g_bytes_unref (blob);
+  if (!PyArg_ParseTuple (args, "s", &path))
+    return -1;
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+  PyGObject_take_handle (&self->parent, telco_file_monitor_new (path), PYTELCO_TYPE (FileMonitor));
 
-  return PyLong_FromUnsignedLong (id);
+  return 0;
 }
 
 static PyObject *
-PyDevice_open_channel (PyDevice * self, PyObject * args)
+PyFileMonitor_enable (PyFileMonitor * self)
 {
-  const char * address;
   GError * error = NULL;
-  GIOStream * stream;
-
-  if (!PyArg_ParseTuple (args, "s", &address))
-    return NULL;
 
   Py_BEGIN_ALLOW_THREADS
-  stream = telco_device_open_channel_sync (PY_GOBJECT_HANDLE (self), address, g_cancellable_get_current (), &error);
+  telco_file_monitor_enable_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
   Py_END_ALLOW_THREADS
   if (error != NULL)
     return PyTelco_raise (error);
 
-  return PyIOStream_new_take_handle (stream);
+  Py_RETURN_NONE;
 }
 
 static PyObject *
-PyDevice_unpair (PyDevice * self)
+PyFileMonitor_disable (PyFileMonitor * self)
 {
   GError * error = NULL;
 
   Py_BEGIN_ALLOW_THREADS
-  telco_device_unpair_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  telco_file_monitor_disable_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
   Py_END_ALLOW_THREADS
   if (error != NULL)
     return PyTelco_raise (error);
@@ -2853,2328 +9655,3273 @@ PyDevice_unpair (PyDevice * self)
 
 
 static PyObject *
-PyApplication_new_take_handle (TelcoApplication * handle)
+PyIOStream_new_take_handle (GIOStream * handle)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Application));
+  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (IOStream));
 }
 
 static int
-PyApplication_init (PyApplication * self, PyObject * args, PyObject * kw)
+PyIOStream_init (PyIOStream * self, PyObject * args, PyObject * kw)
 {
   if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
     return -1;
 
-  self->identifier = NULL;
-  self->name = NULL;
-  self->pid = 0;
-  self->parameters = NULL;
+  self->input = NULL;
+  self->output = NULL;
 
   return 0;
 }
 
 static void
-PyApplication_init_from_handle (PyApplication * self, TelcoApplication * handle)
+PyIOStream_init_from_handle (PyIOStream * self, GIOStream * handle)
 {
-  self->identifier = PyUnicode_FromUTF8String (telco_application_get_identifier (handle));
-  self->name = PyUnicode_FromUTF8String (telco_application_get_name (handle));
-  self->pid = telco_application_get_pid (handle);
-  self->parameters = PyApplication_marshal_parameters_dict (telco_application_get_parameters (handle));
+  self->input = g_io_stream_get_input_stream (handle);
+  self->output = g_io_stream_get_output_stream (handle);
 }
 
-static void
-PyApplication_dealloc (PyApplication * self)
+static PyObject *
+PyIOStream_repr (PyIOStream * self)
 {
-  Py_XDECREF (self->parameters);
-  Py_XDECREF (self->name);
-  Py_XDECREF (self->identifier);
+  GIOStream * handle = PY_GOBJECT_HANDLE (self);
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  return PyRepr_FromFormat ("IOStream(handle=%p, is_closed=%s)",
+      handle,
+      g_io_stream_is_closed (handle) ? "TRUE" : "FALSE");
 }
 
 static PyObject *
-PyApplication_repr (PyApplication * self)
+PyIOStream_is_closed (PyIOStream * self)
 {
-  PyObject * result;
-  TelcoApplication * handle;
-  GString * repr;
-  gchar * str;
-
-  handle = PY_GOBJECT_HANDLE (self);
-
-  repr = g_string_new ("Application(");
-
-  g_string_append_printf (repr, "identifier=\"%s\", name=\"%s\"",
-      telco_application_get_identifier (handle),
-      telco_application_get_name (handle));
-
-  if (self->pid != 0)
-    g_string_append_printf (repr, ", pid=%u", self->pid);
-
-  str = PyTelco_repr (self->parameters);
-  g_string_append_printf (repr, ", parameters=%s", str);
-  g_free (str);
-
-  g_string_append (repr, ")");
+  return PyBool_FromLong (g_io_stream_is_closed (PY_GOBJECT_HANDLE (self)));
+}
 
-  result = PyRepr_FromString (repr->str);
+static PyObject *
+PyIOStream_close (PyIOStream * self)
+{
+  GError * error = NULL;
 
-  g_string_free (repr, TRUE);
+  Py_BEGIN_ALLOW_THREADS
+  g_io_stream_close (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
+  if (error != NULL)
+    return PyTelco_raise (error);
 
-  return result;
+  Py_RETURN_NONE;
 }
 
 static PyObject *
-PyApplication_marshal_parameters_dict (GHashTable * dict)
+PyIOStream_read (PyIOStream * self, PyObject * args)
 {
   PyObject * result;
-  GHashTableIter iter;
-  const gchar * key;
-  GVariant * raw_value;
+  unsigned long count;
+  PyObject * buffer;
+  GError * error = NULL;
+  gssize bytes_read;
 
-  result = PyDict_New ();
+  if (!PyArg_ParseTuple (args, "k", &count))
+    return NULL;
 
-  g_hash_table_iter_init (&iter, dict);
+  buffer = PyBytes_FromStringAndSize (NULL, count);
+  if (buffer == NULL)
+    return NULL;
 
-  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &raw_value))
-  {
-    PyObject * value;
+  Py_BEGIN_ALLOW_THREADS
+  bytes_read = g_input_stream_read (self->input, PyBytes_AsString (buffer), count, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
 
-    if (strcmp (key, "started") == 0 && g_variant_is_of_type (raw_value, G_VARIANT_TYPE_STRING))
-      value = PyGObject_marshal_datetime (g_variant_get_string (raw_value, NULL));
+  if (error == NULL)
+  {
+    if ((unsigned long) bytes_read == count)
+    {
+      result = buffer;
+    }
     else
-      value = PyGObject_marshal_variant (raw_value);
+    {
+      result = PyBytes_FromStringAndSize (PyBytes_AsString (buffer), bytes_read);
 
-    PyDict_SetItemString (result, key, value);
+      Py_DECREF (buffer);
+    }
+  }
+  else
+  {
+    result = PyTelco_raise (error);
 
-    Py_DECREF (value);
+    Py_DECREF (buffer);
   }
 
   return result;
 }
 
-
 static PyObject *
-PyProcess_new_take_handle (TelcoProcess * handle)
+PyIOStream_read_all (PyIOStream * self, PyObject * args)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Process));
-}
+  PyObject * result;
+  unsigned long count;
+  PyObject * buffer;
+  gsize bytes_read;
+  GError * error = NULL;
 
-static int
-PyProcess_init (PyProcess * self, PyObject * args, PyObject * kw)
-{
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  if (!PyArg_ParseTuple (args, "k", &count))
+    return NULL;
 
-  self->pid = 0;
-  self->name = NULL;
-  self->parameters = NULL;
+  buffer = PyBytes_FromStringAndSize (NULL, count);
+  if (buffer == NULL)
+    return NULL;
 
-  return 0;
-}
+  Py_BEGIN_ALLOW_THREADS
+  g_input_stream_read_all (self->input, PyBytes_AsString (buffer), count, &bytes_read, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
 
-static void
-PyProcess_init_from_handle (PyProcess * self, TelcoProcess * handle)
-{
-  self->pid = telco_process_get_pid (handle);
-  self->name = PyUnicode_FromUTF8String (telco_process_get_name (handle));
-  self->parameters = PyProcess_marshal_parameters_dict (telco_process_get_parameters (handle));
-}
+  if (error == NULL)
+  {
+    result = buffer;
+  }
+  else
+  {
+    result = PyTelco_raise (error);
 
-static void
-PyProcess_dealloc (PyProcess * self)
-{
-  Py_XDECREF (self->parameters);
-  Py_XDECREF (self->name);
+    Py_DECREF (buffer);
+  }
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  return result;
 }
 
 static PyObject *
-PyProcess_repr (PyProcess * self)
+PyIOStream_write (PyIOStream * self, PyObject * args)
 {
-  PyObject * result;
-  TelcoProcess * handle;
-  GString * repr;
-  gchar * str;
-
-  handle = PY_GOBJECT_HANDLE (self);
-
-  repr = g_string_new ("Process(");
-
-  g_string_append_printf (repr, "pid=%u, name=\"%s\"",
-      self->pid,
-      telco_process_get_name (handle));
-
-  str = PyTelco_repr (self->parameters);
-  g_string_append_printf (repr, ", parameters=%s", str);
-  g_free (str);
+  const char * data;
+  Py_ssize_t size;
+  GError * error = NULL;
+  gssize bytes_written;
 
-  g_string_append (repr, ")");
+  if (!PyArg_ParseTuple (args, "y#", &data, &size))
+    return NULL;
 
-  result = PyRepr_FromString (repr->str);
+  Py_BEGIN_ALLOW_THREADS
+  bytes_written = g_output_stream_write (self->output, data, size, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
 
-  g_string_free (repr, TRUE);
+  if (error != NULL)
+    return PyTelco_raise (error);
 
-  return result;
+  return PyLong_FromSsize_t (bytes_written);
 }
 
 static PyObject *
-PyProcess_marshal_parameters_dict (GHashTable * dict)
+PyIOStream_write_all (PyIOStream * self, PyObject * args)
 {
-  PyObject * result;
-  GHashTableIter iter;
-  const gchar * key;
-  GVariant * raw_value;
-
-  result = PyDict_New ();
-
-  g_hash_table_iter_init (&iter, dict);
-
-  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &raw_value))
-  {
-    PyObject * value;
+  const char * data;
+  Py_ssize_t size;
+  GError * error = NULL;
 
-    if (strcmp (key, "started") == 0 && g_variant_is_of_type (raw_value, G_VARIANT_TYPE_STRING))
-      value = PyGObject_marshal_datetime (g_variant_get_string (raw_value, NULL));
-    else
-      value = PyGObject_marshal_variant (raw_value);
+  if (!PyArg_ParseTuple (args, "y#", &data, &size))
+    return NULL;
 
-    PyDict_SetItemString (result, key, value);
+  Py_BEGIN_ALLOW_THREADS
+  g_output_stream_write_all (self->output, data, size, NULL, g_cancellable_get_current (), &error);
+  Py_END_ALLOW_THREADS
 
-    Py_DECREF (value);
-  }
+  if (error != NULL)
+    return PyTelco_raise (error);
 
-  return result;
+  Py_RETURN_NONE;
 }
 
 
 static PyObject *
-PySpawn_new_take_handle (TelcoSpawn * handle)
+PyCancellable_new_take_handle (GCancellable * handle)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Spawn));
+  PyObject * object;
+
+  object = (handle != NULL) ? PyGObject_try_get_from_handle (handle) : NULL;
+  if (object == NULL)
+  {
+    object = PyObject_CallFunction (PYTELCO_TYPE_OBJECT (Cancellable), "z#", (char *) &handle, (Py_ssize_t) sizeof (handle));
+  }
+  else
+  {
+    g_object_unref (handle);
+    Py_INCREF (object);
+  }
+
+  return object;
 }
 
 static int
-PySpawn_init (PySpawn * self, PyObject * args, PyObject * kw)
+PyCancellable_init (PyCancellable * self, PyObject * args, PyObject * kw)
 {
+  static char * keywords[] = { "handle", NULL };
+  GCancellable ** handle_buffer = NULL;
+  Py_ssize_t handle_size = 0;
+  GCancellable * handle;
+
   if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
     return -1;
 
-  self->pid = 0;
-  self->identifier = NULL;
-
-  return 0;
-}
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|z#", keywords, &handle_buffer, &handle_size))
+    return -1;
 
-static void
-PySpawn_init_from_handle (PySpawn * self, TelcoSpawn * handle)
-{
-  self->pid = telco_spawn_get_pid (handle);
-  self->identifier = PyGObject_marshal_string (telco_spawn_get_identifier (handle));
-}
+  if (handle_size == sizeof (gpointer))
+    handle = *handle_buffer;
+  else
+    handle = g_cancellable_new ();
 
-static void
-PySpawn_dealloc (PySpawn * self)
-{
-  Py_XDECREF (self->identifier);
+  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (Cancellable));
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  return 0;
 }
 
 static PyObject *
-PySpawn_repr (PySpawn * self)
+PyCancellable_repr (PyCancellable * self)
 {
-  PyObject * result;
-
-  if (self->identifier != Py_None)
-  {
-    PyObject * identifier_bytes;
-
-    identifier_bytes = PyUnicode_AsUTF8String (self->identifier);
-
-    result = PyRepr_FromFormat ("Spawn(pid=%u, identifier=\"%s\")",
-        self->pid,
-        PyBytes_AsString (identifier_bytes));
-
-    Py_DECREF (identifier_bytes);
-  }
-  else
-  {
-    result = PyRepr_FromFormat ("Spawn(pid=%u)",
-        self->pid);
-  }
+  GCancellable * handle = PY_GOBJECT_HANDLE (self);
 
-  return result;
+  return PyRepr_FromFormat ("Cancellable(handle=%p, is_cancelled=%s)",
+      handle,
+      g_cancellable_is_cancelled (handle) ? "TRUE" : "FALSE");
 }
 
-
 static PyObject *
-PyChild_new_take_handle (TelcoChild * handle)
+PyCancellable_is_cancelled (PyCancellable * self)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Child));
+  return PyBool_FromLong (g_cancellable_is_cancelled (PY_GOBJECT_HANDLE (self)));
 }
 
-static int
-PyChild_init (PyChild * self, PyObject * args, PyObject * kw)
+static PyObject *
+PyCancellable_raise_if_cancelled (PyCancellable * self)
 {
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  GError * error = NULL;
 
-  self->pid = 0;
-  self->parent_pid = 0;
-  self->origin = NULL;
-  self->identifier = NULL;
-  self->path = NULL;
-  self->argv = NULL;
-  self->envp = NULL;
+  g_cancellable_set_error_if_cancelled (PY_GOBJECT_HANDLE (self), &error);
+  if (error != NULL)
+    return PyTelco_raise (error);
 
-  return 0;
+  Py_RETURN_NONE;
 }
 
-static void
-PyChild_init_from_handle (PyChild * self, TelcoChild * handle)
+static PyObject *
+PyCancellable_get_fd (PyCancellable * self)
 {
-  gchar * const * argv, * const * envp;
-  gint argv_length, envp_length;
+  return PyLong_FromLong (g_cancellable_get_fd (PY_GOBJECT_HANDLE (self)));
+}
 
-  self->pid = telco_child_get_pid (handle);
-  self->parent_pid = telco_child_get_parent_pid (handle);
+static PyObject *
+PyCancellable_release_fd (PyCancellable * self)
+{
+  g_cancellable_release_fd (PY_GOBJECT_HANDLE (self));
 
-  self->origin = PyGObject_marshal_enum (telco_child_get_origin (handle), TELCO_TYPE_CHILD_ORIGIN);
+  Py_RETURN_NONE;
+}
 
-  self->identifier = PyGObject_marshal_string (telco_child_get_identifier (handle));
+static PyObject *
+PyCancellable_get_current (PyCancellable * self)
+{
+  GCancellable * handle;
 
-  self->path = PyGObject_marshal_string (telco_child_get_path (handle));
+  handle = g_cancellable_get_current ();
 
-  argv = telco_child_get_argv (handle, &argv_length);
-  self->argv = PyGObject_marshal_strv (argv, argv_length);
+  if (handle != NULL)
+    g_object_ref (handle);
 
-  envp = telco_child_get_envp (handle, &envp_length);
-  self->envp = PyGObject_marshal_envp (envp, envp_length);
+  return PyCancellable_new_take_handle (handle);
 }
 
-static void
-PyChild_dealloc (PyChild * self)
+static PyObject *
+PyCancellable_push_current (PyCancellable * self)
 {
-  Py_XDECREF (self->envp);
-  Py_XDECREF (self->argv);
-  Py_XDECREF (self->path);
-  Py_XDECREF (self->identifier);
-  Py_XDECREF (self->origin);
+  g_cancellable_push_current (PY_GOBJECT_HANDLE (self));
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  Py_RETURN_NONE;
 }
 
 static PyObject *
-PyChild_repr (PyChild * self)
+PyCancellable_pop_current (PyCancellable * self)
 {
-  PyObject * result;
-  TelcoChild * handle;
-  GString * repr;
-  TelcoChildOrigin origin;
-  GEnumClass * origin_class;
-  GEnumValue * origin_value;
-
-  handle = PY_GOBJECT_HANDLE (self);
+  GCancellable * handle = PY_GOBJECT_HANDLE (self);
 
-  repr = g_string_new ("Child(");
+  if (g_cancellable_get_current () != handle)
+    goto invalid_operation;
 
-  g_string_append_printf (repr, "pid=%u, parent_pid=%u", self->pid, self->parent_pid);
+  g_cancellable_pop_current (handle);
 
-  origin = telco_child_get_origin (handle);
-  origin_class = g_type_class_ref (TELCO_TYPE_CHILD_ORIGIN);
-  origin_value = g_enum_get_value (origin_class, origin);
-  g_string_append_printf (repr, ", origin=%s", origin_value->value_nick);
-  g_type_class_unref (origin_class);
+  Py_RETURN_NONE;
 
-  if (self->identifier != Py_None)
+invalid_operation:
   {
-    gchar * identifier;
+    return PyTelco_raise (g_error_new (
+          TELCO_ERROR,
+          TELCO_ERROR_INVALID_OPERATION,
+          "Cancellable is not on top of the stack"));
+  }
+}
 
-    identifier = PyTelco_repr (self->identifier);
+static PyObject *
+PyCancellable_connect (PyCancellable * self, PyObject * args)
+{
+  GCancellable * handle = PY_GOBJECT_HANDLE (self);
+  gulong handler_id;
+  PyObject * callback;
 
-    g_string_append_printf (repr, ", identifier=%s", identifier);
+  if (!PyArg_ParseTuple (args, "O", &callback))
+    return NULL;
 
-    g_free (identifier);
-  }
+  if (!PyCallable_Check (callback))
+    goto not_callable;
 
-  if (origin != TELCO_CHILD_ORIGIN_FORK)
+  if (handle != NULL)
   {
-    gchar * path, * argv, * envp;
+    Py_IncRef (callback);
 
-    path = PyTelco_repr (self->path);
-    argv = PyTelco_repr (self->argv);
-    envp = PyTelco_repr (self->envp);
+    Py_BEGIN_ALLOW_THREADS
+    handler_id = g_cancellable_connect (handle, G_CALLBACK (PyCancellable_on_cancelled), callback,
+        (GDestroyNotify) PyCancellable_destroy_callback);
+    Py_END_ALLOW_THREADS
+  }
+  else
+  {
+    handler_id = 0;
+  }
 
-    g_string_append_printf (repr, ", path=%s, argv=%s, envp=%s", path, argv, envp);
+  return PyLong_FromUnsignedLong (handler_id);
 
-    g_free (envp);
-    g_free (argv);
-    g_free (path);
+not_callable:
+  {
+    PyErr_SetString (PyExc_TypeError, "object must be callable");
+    return NULL;
   }
+}
 
-  g_string_append (repr, ")");
+static PyObject *
+PyCancellable_disconnect (PyCancellable * self, PyObject * args)
+{
+  gulong handler_id;
 
-  result = PyRepr_FromString (repr->str);
+  if (!PyArg_ParseTuple (args, "k", &handler_id))
+    return NULL;
 
-  g_string_free (repr, TRUE);
+  Py_BEGIN_ALLOW_THREADS
+  g_cancellable_disconnect (PY_GOBJECT_HANDLE (self), handler_id);
+  Py_END_ALLOW_THREADS
 
-  return result;
+  Py_RETURN_NONE;
 }
 
-
-static int
-PyCrash_init (PyCrash * self, PyObject * args, PyObject * kw)
+static void
+PyCancellable_on_cancelled (GCancellable * cancellable, PyObject * callback)
 {
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  PyGILState_STATE gstate;
+  PyObject * result;
 
-  self->pid = 0;
-  self->process_name = NULL;
-  self->summary = NULL;
-  self->report = NULL;
-  self->parameters = NULL;
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_CANCELLED);
 
-  return 0;
-}
+  result = PyObject_CallObject (callback, NULL);
+  if (result != NULL)
+    Py_DECREF (result);
+  else
+    PyErr_Print ();
 
-static void
-PyCrash_init_from_handle (PyCrash * self, TelcoCrash * handle)
-{
-  self->pid = telco_crash_get_pid (handle);
-  self->process_name = PyGObject_marshal_string (telco_crash_get_process_name (handle));
-  self->summary = PyGObject_marshal_string (telco_crash_get_summary (handle));
-  self->report = PyGObject_marshal_string (telco_crash_get_report (handle));
-  self->parameters = PyGObject_marshal_parameters_dict (telco_crash_get_parameters (handle));
+  PyGILState_Release (gstate);
 }
 
 static void
-PyCrash_dealloc (PyCrash * self)
+PyCancellable_destroy_callback (PyObject * callback)
 {
-  Py_XDECREF (self->parameters);
-  Py_XDECREF (self->report);
-  Py_XDECREF (self->summary);
-  Py_XDECREF (self->process_name);
+  PyGILState_STATE gstate;
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_CANCELLED_DESTROY);
+  Py_DecRef (callback);
+  PyGILState_Release (gstate);
 }
 
 static PyObject *
-PyCrash_repr (PyCrash * self)
+PyCancellable_cancel (PyCancellable * self)
 {
-  PyObject * result;
-  TelcoCrash * handle;
-  GString * repr;
-  gchar * str;
-
-  handle = PY_GOBJECT_HANDLE (self);
-
-  repr = g_string_new ("Crash(");
+  Py_BEGIN_ALLOW_THREADS
+  g_cancellable_cancel (PY_GOBJECT_HANDLE (self));
+  Py_END_ALLOW_THREADS
 
-  g_string_append_printf (repr, "pid=%u, process_name=\"%s\", summary=\"%s\", report=<%u bytes>",
-      self->pid,
-      telco_crash_get_process_name (handle),
-      telco_crash_get_summary (handle),
-      (guint) strlen (telco_crash_get_report (handle)));
+  Py_RETURN_NONE;
+}
 
-  str = PyTelco_repr (self->parameters);
-  g_string_append_printf (repr, ", parameters=%s", str);
-  g_free (str);
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
 
-  g_string_append (repr, ")");
+static PyObject *
+PyBytesView_new_take_bytes (GBytes * bytes)
+{
+  PyTypeObject * type = (PyTypeObject *) PyBytesView_type;
+  PyBytesView * self;
 
-  result = PyRepr_FromString (repr->str);
+  self = (PyBytesView *) ((allocfunc) PyType_GetSlot (type, Py_tp_alloc)) (type, 0);
+  if (self == NULL)
+  {
+    g_bytes_unref (bytes);
+    return NULL;
+  }
 
-  g_string_free (repr, TRUE);
+  self->bytes = bytes;
 
-  return result;
+  return (PyObject *) self;
 }
 
-
-static PyObject *
-PyBus_new_take_handle (TelcoBus * handle)
+static void
+PyBytesView_dealloc (PyBytesView * self)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Bus));
+  g_clear_pointer (&self->bytes, g_bytes_unref);
+
+  ((freefunc) PyType_GetSlot (Py_TYPE ((PyObject *) self), Py_tp_free)) (self);
 }
 
 static PyObject *
-PyBus_attach (PySession * self)
+PyBytesView_repr (PyBytesView * self)
 {
-  GError * error = NULL;
-
-  Py_BEGIN_ALLOW_THREADS
-  telco_bus_attach_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  return PyRepr_FromFormat ("BytesView(size=%zd)", PyBytesView_length (self));
+}
 
-  Py_RETURN_NONE;
+static Py_ssize_t
+PyBytesView_length (PyBytesView * self)
+{
+  return (self->bytes != NULL) ? (Py_ssize_t) g_bytes_get_size (self->bytes) : 0;
 }
 
-static PyObject *
-PyBus_post (PyScript * self, PyObject * args, PyObject * kw)
+static int
+PyBytesView_get_buffer (PyBytesView * self, Py_buffer * view, int flags)
 {
-  static char * keywords[] = { "message", "data", NULL };
-  char * message;
-  gconstpointer data_buffer = NULL;
-  Py_ssize_t data_size = 0;
-  GBytes * data;
+  gconstpointer data;
+  gsize size;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|z#", keywords, "utf-8", &message, &data_buffer, &data_size))
-    return NULL;
+  if (self->bytes == NULL)
+  {
+    PyErr_SetString (PyExc_BufferError, "view is not backed by any data");
+    view->obj = NULL;
+    return -1;
+  }
 
-  data = (data_buffer != NULL) ? g_bytes_new (data_buffer, data_size) : NULL;
+  data = g_bytes_get_data (self->bytes, &size);
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_bus_post (PY_GOBJECT_HANDLE (self), message, data);
-  Py_END_ALLOW_THREADS
+  return PyBuffer_FillInfo (view, (PyObject *) self, (void *) data, size, 1, flags);
+}
 
-  g_bytes_unref (data);
-  PyMem_Free (message);
+static PyObject *
+PyBytesView_tobytes (PyBytesView * self)
+{
+  if (self->bytes == NULL)
+    return PyBytes_FromStringAndSize (NULL, 0);
 
-  Py_RETURN_NONE;
+  return PyGObject_marshal_bytes_non_nullable (self->bytes);
 }
 
+#endif
+
 
 static PyObject *
-PySession_new_take_handle (TelcoSession * handle)
+PySignalStream_new (PyGObject * owner, GClosure * closure)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Session));
+  PyTypeObject * type = (PyTypeObject *) PySignalStream_type;
+  PySignalStream * self;
+
+  self = (PySignalStream *) ((allocfunc) PyType_GetSlot (type, Py_tp_alloc)) (type, 0);
+  if (self == NULL)
+    return NULL;
+
+  Py_INCREF (owner);
+  self->owner = owner;
+  self->closure = PY_GOBJECT_SIGNAL_CLOSURE (g_closure_ref (closure));
+
+  return (PyObject *) self;
 }
 
-static int
-PySession_init (PySession * self, PyObject * args, PyObject * kw)
+static void
+PySignalStream_dealloc (PySignalStream * self)
 {
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  PyObject * result;
 
-  self->pid = 0;
+  result = PySignalStream_close (self);
+  Py_XDECREF (result);
 
-  return 0;
+  g_closure_unref (&self->closure->parent);
+  Py_DECREF (self->owner);
+
+  ((freefunc) PyType_GetSlot (Py_TYPE ((PyObject *) self), Py_tp_free)) (self);
 }
 
-static void
-PySession_init_from_handle (PySession * self, TelcoSession * handle)
+static PyObject *
+PySignalStream_repr (PySignalStream * self)
 {
-  self->pid = telco_session_get_pid (handle);
+  return PyRepr_FromFormat ("SignalStream(signal=\"%s\")", g_signal_name (self->closure->signal_id));
 }
 
 static PyObject *
-PySession_repr (PySession * self)
+PySignalStream_fileno (PySignalStream * self)
 {
-  return PyRepr_FromFormat ("Session(pid=%u)", self->pid);
+  return PyLong_FromLong (g_cancellable_get_fd (self->closure->queue->wakeup));
 }
 
 static PyObject *
-PySession_is_detached (PySession * self)
+PySignalStream_drain (PySignalStream * self, PyObject * args, PyObject * kw)
 {
-  gboolean is_detached;
+  static char * keywords[] = { "max_count", NULL };
+  PyGObjectSignalQueue * queue = self->closure->queue;
+  unsigned int max_count = 0;
+  GValue * values;
+  guint length;
+  gboolean more;
+  PyObject * items;
 
-  Py_BEGIN_ALLOW_THREADS
-  is_detached = telco_session_is_detached (PY_GOBJECT_HANDLE (self));
-  Py_END_ALLOW_THREADS
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|I", keywords, &max_count))
+    return NULL;
 
-  return PyBool_FromLong (is_detached);
+  g_cancellable_reset (queue->wakeup);
+
+  g_mutex_lock (&queue->lock);
+  values = PyGObjectSignalQueue_take (queue, (max_count != 0) ? max_count : queue->length, &length);
+  more = queue->length != 0 || queue->invalidated;
+  g_cond_broadcast (&queue->cond);
+  g_mutex_unlock (&queue->lock);
+
+  /* Keep the descriptor readable for whatever this call left behind. */
+  if (more)
+    g_cancellable_cancel (queue->wakeup);
+
+  items = (length != 0) ? PyGObjectSignalClosure_marshal_batch (self->closure, values, length, queue->stride) : NULL;
+
+  PyGObjectSignalQueue_free_values (values, length * queue->stride);
+
+  return (items != NULL) ? items : PyList_New (0);
 }
 
 static PyObject *
-PySession_detach (PySession * self)
+PySignalStream_wait (PySignalStream * self, PyObject * args)
 {
-  GError * error = NULL;
+  PyGObjectSignalQueue * queue = self->closure->queue;
+  double timeout = -1.0;
+  gint64 deadline;
+  gboolean ready;
+
+  if (!PyArg_ParseTuple (args, "|d", &timeout))
+    return NULL;
+
+  deadline = (timeout >= 0.0) ? g_get_monotonic_time () + (gint64) (timeout * G_USEC_PER_SEC) : -1;
 
   Py_BEGIN_ALLOW_THREADS
-  telco_session_detach_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
+  g_mutex_lock (&queue->lock);
+  while (queue->length == 0 && !queue->invalidated)
+  {
+    if (deadline == -1)
+      g_cond_wait (&queue->cond, &queue->lock);
+    else if (!g_cond_wait_until (&queue->cond, &queue->lock, deadline))
+      break;
+  }
+  ready = queue->length != 0 || queue->invalidated;
+  g_mutex_unlock (&queue->lock);
   Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
 
-  Py_RETURN_NONE;
+  return PyBool_FromLong (ready);
 }
 
 static PyObject *
-PySession_resume (PySession * self)
+PySignalStream_is_closed (PySignalStream * self)
 {
-  GError * error = NULL;
+  PyGObjectSignalQueue * queue = self->closure->queue;
+  gboolean closed;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_session_resume_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  g_mutex_lock (&queue->lock);
+  closed = queue->invalidated && queue->length == 0;
+  g_mutex_unlock (&queue->lock);
 
-  Py_RETURN_NONE;
+  return PyBool_FromLong (closed);
 }
 
 static PyObject *
-PySession_enable_child_gating (PySession * self)
+PySignalStream_close (PySignalStream * self)
 {
-  GError * error = NULL;
+  PyGObject * owner = self->owner;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_session_enable_child_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (PyGObject_remove_signal_closure (owner, self->closure))
+    PyGObject_disconnect_signal_closure (self->closure, owner);
 
   Py_RETURN_NONE;
 }
 
 static PyObject *
-PySession_disable_child_gating (PySession * self)
+PySignalStream_get_stats (PySignalStream * self)
 {
-  GError * error = NULL;
-
-  Py_BEGIN_ALLOW_THREADS
-  telco_session_disable_child_gating_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
-
-  Py_RETURN_NONE;
+  return PyGObjectSignalQueue_get_stats (self->closure->queue);
 }
 
 static PyObject *
-PySession_create_script (PySession * self, PyObject * args, PyObject * kw)
+PyLazyMessage_new_from_json (const gchar * json)
 {
-  PyObject * result = NULL;
-  static char * keywords[] = { "source", "name", "snapshot", "runtime", NULL };
-  char * source;
-  char * name = NULL;
-  gconstpointer snapshot_data = NULL;
-  Py_ssize_t snapshot_size = 0;
-  const char * runtime_value = NULL;
-  TelcoScriptOptions * options;
-  GError * error = NULL;
-  TelcoScript * handle;
+  PyTypeObject * type = (PyTypeObject *) PyLazyMessage_type;
+  PyLazyMessage * self;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esy#z", keywords, "utf-8", &source, "utf-8", &name, &snapshot_data, &snapshot_size, &runtime_value))
-    return NULL;
+  if (json == NULL)
+    Py_RETURN_NONE;
 
-  options = PySession_parse_script_options (name, snapshot_data, snapshot_size, runtime_value);
-  if (options == NULL)
-    goto beach;
+  self = (PyLazyMessage *) ((allocfunc) PyType_GetSlot (type, Py_tp_alloc)) (type, 0);
+  if (self == NULL)
+    return NULL;
 
-  Py_BEGIN_ALLOW_THREADS
-  handle = telco_session_create_script_sync (PY_GOBJECT_HANDLE (self), source, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  self->length = strlen (json);
+  self->json = g_strndup (json, self->length);
 
-  result = (error == NULL)
-      ? PyScript_new_take_handle (handle)
-      : PyTelco_raise (error);
+  if (!PyLazyMessage_scan (self))
+  {
+    /* Not an envelope we understand, so leave it to the regular decoder to make sense of. */
+    PyErr_Clear ();
+    Py_DECREF (self);
+    return PyGObject_marshal_json (json);
+  }
 
-beach:
-  g_clear_object (&options);
+  return (PyObject *) self;
+}
 
-  PyMem_Free (name);
-  PyMem_Free (source);
+static void
+PyLazyMessage_dealloc (PyLazyMessage * self)
+{
+  g_free (self->json);
+  Py_XDECREF (self->type);
+  Py_XDECREF (self->level);
+  Py_XDECREF (self->tag);
+  Py_XDECREF (self->message);
 
-  return result;
+  ((freefunc) PyType_GetSlot (Py_TYPE ((PyObject *) self), Py_tp_free)) (self);
 }
 
 static PyObject *
-PySession_create_script_from_bytes (PySession * self, PyObject * args, PyObject * kw)
+PyLazyMessage_repr (PyLazyMessage * self)
 {
-  PyObject * result = NULL;
-  static char * keywords[] = { "data", "name", "snapshot", "runtime", NULL };
-  guint8 * data;
-  Py_ssize_t size;
-  char * name = NULL;
-  gconstpointer snapshot_data = NULL;
-  Py_ssize_t snapshot_size = 0;
-  const char * runtime_value = NULL;
-  GBytes * bytes;
-  TelcoScriptOptions * options;
-  GError * error = NULL;
-  TelcoScript * handle;
+  PyObject * message;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "y#|esy#z", keywords, &data, &size, "utf-8", &name, &snapshot_data, &snapshot_size, &runtime_value))
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
     return NULL;
 
-  bytes = g_bytes_new (data, size);
-
-  options = PySession_parse_script_options (name, snapshot_data, snapshot_size, runtime_value);
-  if (options == NULL)
-    goto beach;
-
-  Py_BEGIN_ALLOW_THREADS
-  handle = telco_session_create_script_from_bytes_sync (PY_GOBJECT_HANDLE (self), bytes, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-
-  result = (error == NULL)
-      ? PyScript_new_take_handle (handle)
-      : PyTelco_raise (error);
-
-beach:
-  g_clear_object (&options);
-  g_bytes_unref (bytes);
-
-  PyMem_Free (name);
-
-  return result;
+  return PyRepr_FromFormat ("LazyMessage(%R)", message);
 }
 
-static PyObject *
-PySession_compile_script (PySession * self, PyObject * args, PyObject * kw)
+static gboolean
+PyLazyMessage_scan (PyLazyMessage * self)
 {
-  PyObject * result = NULL;
-  static char * keywords[] = { "source", "name", "runtime", NULL };
-  char * source;
-  char * name = NULL;
-  const char * runtime_value = NULL;
-  TelcoScriptOptions * options;
-  GError * error = NULL;
-  GBytes * bytes;
+  gboolean success = FALSE;
+  PyTelcoJsonParser parser;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esz", keywords, "utf-8", &source, "utf-8", &name, &runtime_value))
-    return NULL;
+  parser.start = self->json;
+  parser.cursor = self->json;
+  parser.end = self->json + self->length;
+  parser.depth = 0;
+  parser.scratch = NULL;
 
-  options = PySession_parse_script_options (name, NULL, 0, runtime_value);
-  if (options == NULL)
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor == parser.end || *parser.cursor != '{')
     goto beach;
+  parser.cursor++;
 
-  Py_BEGIN_ALLOW_THREADS
-  bytes = telco_session_compile_script_sync (PY_GOBJECT_HANDLE (self), source, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor != parser.end && *parser.cursor == '}')
+  {
+    parser.cursor++;
+    goto done;
+  }
 
-  if (error == NULL)
+  while (TRUE)
   {
-    result = PyGObject_marshal_bytes_non_nullable (bytes);
+    PyObject * key;
+    gboolean valid;
 
-    g_bytes_unref (bytes);
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end || *parser.cursor != '"')
+      goto beach;
+
+    key = PyTelcoJsonParser_parse_string (&parser);
+    if (key == NULL)
+      goto beach;
+
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end || *parser.cursor != ':')
+    {
+      Py_DECREF (key);
+      goto beach;
+    }
+    parser.cursor++;
+
+    if (PyUnicode_CompareWithASCIIString (key, "type") == 0 && self->type == NULL)
+      valid = (self->type = PyTelcoJsonParser_parse_value (&parser)) != NULL;
+    else if (PyUnicode_CompareWithASCIIString (key, "level") == 0 && self->level == NULL)
+      valid = (self->level = PyTelcoJsonParser_parse_value (&parser)) != NULL;
+    else if (PyUnicode_CompareWithASCIIString (key, "payload") == 0 && self->tag == NULL)
+      valid = PyLazyMessage_scan_tag (self, &parser);
+    else
+      valid = PyTelcoJsonParser_skip_value (&parser);
+    Py_DECREF (key);
+    if (!valid)
+      goto beach;
+
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end)
+      goto beach;
+    if (*parser.cursor == '}')
+    {
+      parser.cursor++;
+      break;
+    }
+    if (*parser.cursor != ',')
+      goto beach;
+    parser.cursor++;
   }
-  else
+
+done:
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor != parser.end || self->type == NULL)
+    goto beach;
+
+  if (self->tag == NULL)
   {
-    result = PyTelco_raise (error);
+    Py_INCREF (Py_None);
+    self->tag = Py_None;
   }
 
-beach:
-  g_clear_object (&options);
+  success = TRUE;
 
-  PyMem_Free (name);
-  PyMem_Free (source);
+beach:
+  if (parser.scratch != NULL)
+    g_string_free (parser.scratch, TRUE);
 
-  return result;
+  return success;
 }
 
-static TelcoScriptOptions *
-PySession_parse_script_options (const gchar * name, gconstpointer snapshot_data, gsize snapshot_size, const gchar * runtime_value)
+static gboolean
+PyLazyMessage_scan_tag (PyLazyMessage * self, PyTelcoJsonParser * parser)
 {
-  TelcoScriptOptions * options;
+  const gchar * payload_start;
 
-  options = telco_script_options_new ();
-
-  if (name != NULL)
-    telco_script_options_set_name (options, name);
+  PyTelcoJsonParser_skip_whitespace (parser);
+  payload_start = parser->cursor;
 
-  if (snapshot_data != NULL)
+  if (parser->cursor != parser->end && *parser->cursor == '[')
   {
-    GBytes * snapshot = g_bytes_new (snapshot_data, snapshot_size);
-    telco_script_options_set_snapshot (options, snapshot);
-    g_bytes_unref (snapshot);
+    parser->cursor++;
+    PyTelcoJsonParser_skip_whitespace (parser);
+    if (parser->cursor != parser->end && *parser->cursor != ']')
+    {
+      self->tag = PyTelcoJsonParser_parse_value (parser);
+      if (self->tag == NULL)
+        return FALSE;
+    }
   }
-
-  if (runtime_value != NULL)
+  else if (parser->cursor != parser->end && *parser->cursor == '{')
   {
-    TelcoScriptRuntime runtime;
+    parser->cursor++;
+    PyTelcoJsonParser_skip_whitespace (parser);
 
-    if (!PyGObject_unmarshal_enum (runtime_value, TELCO_TYPE_SCRIPT_RUNTIME, &runtime))
-      goto invalid_argument;
+    while (parser->cursor != parser->end && *parser->cursor == '"')
+    {
+      PyObject * key;
+      gboolean is_type;
 
-    telco_script_options_set_runtime (options, runtime);
+      key = PyTelcoJsonParser_parse_string (parser);
+      if (key == NULL)
+        return FALSE;
+      is_type = PyUnicode_CompareWithASCIIString (key, "type") == 0 || PyUnicode_CompareWithASCIIString (key, "kind") == 0;
+      Py_DECREF (key);
+
+      PyTelcoJsonParser_skip_whitespace (parser);
+      if (parser->cursor == parser->end || *parser->cursor != ':')
+        return FALSE;
+      parser->cursor++;
+
+      if (is_type)
+      {
+        self->tag = PyTelcoJsonParser_parse_value (parser);
+        if (self->tag == NULL)
+          return FALSE;
+        break;
+      }
+
+      if (!PyTelcoJsonParser_skip_value (parser))
+        return FALSE;
+
+      PyTelcoJsonParser_skip_whitespace (parser);
+      if (parser->cursor == parser->end || *parser->cursor != ',')
+        break;
+      parser->cursor++;
+      PyTelcoJsonParser_skip_whitespace (parser);
+    }
   }
 
-  return options;
+  parser->cursor = payload_start;
 
-invalid_argument:
+  return PyTelcoJsonParser_skip_value (parser);
+}
+
+static PyObject *
+PyLazyMessage_materialize (PyLazyMessage * self)
+{
+  if (self->message == NULL)
   {
-    g_object_unref (options);
+    self->message = PyTelco_json_decode (self->json, self->length);
+    if (self->message == NULL)
+    {
+      /* The scan skips values without recursing, so it accepts nesting deeper than our parser goes. */
+      PyErr_Clear ();
+      self->message = PyObject_CallFunction (json_loads, "s#", self->json, (Py_ssize_t) self->length);
+      if (self->message == NULL)
+        return NULL;
+    }
 
-    return NULL;
+    g_clear_pointer (&self->json, g_free);
+    self->length = 0;
   }
+
+  return self->message;
 }
 
 static PyObject *
-PySession_snapshot_script (PySession * self, PyObject * args, PyObject * kw)
+PyLazyMessage_lookup_eager (PyLazyMessage * self, PyObject * key, gboolean * found)
 {
-  PyObject * result = NULL;
-  static char * keywords[] = { "embed_script", "warmup_script", "runtime", NULL };
-  char * embed_script;
-  char * warmup_script = NULL;
-  const char * runtime_value = NULL;
-  TelcoSnapshotOptions * options;
-  GError * error = NULL;
-  GBytes * bytes;
+  PyObject * value;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esz", keywords, "utf-8", &embed_script, "utf-8", &warmup_script, &runtime_value))
+  /*
+   * The envelope scan saw every top-level field, so for the ones it kept we know for
+   * certain whether they are present without having to parse the rest.
+   */
+  if (self->message != NULL || !PyUnicode_Check (key))
     return NULL;
 
-  options = PySession_parse_snapshot_options (warmup_script, runtime_value);
-  if (options == NULL)
-    goto beach;
+  if (PyUnicode_CompareWithASCIIString (key, "type") == 0)
+    value = self->type;
+  else if (PyUnicode_CompareWithASCIIString (key, "level") == 0)
+    value = self->level;
+  else
+    return NULL;
 
-  Py_BEGIN_ALLOW_THREADS
-  bytes = telco_session_snapshot_script_sync (PY_GOBJECT_HANDLE (self), embed_script, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  *found = TRUE;
 
-  if (error == NULL)
-  {
-    result = PyGObject_marshal_bytes_non_nullable (bytes);
+  return value;
+}
 
-    g_bytes_unref (bytes);
-  }
-  else
+static PyObject *
+PyLazyMessage_subscript (PyLazyMessage * self, PyObject * key)
+{
+  PyObject * message, * value;
+  gboolean found = FALSE;
+
+  value = PyLazyMessage_lookup_eager (self, key, &found);
+  if (found)
   {
-    result = PyTelco_raise (error);
-  }
+    if (value == NULL)
+    {
+      PyErr_SetObject (PyExc_KeyError, key);
+      return NULL;
+    }
 
-beach:
-  g_clear_object (&options);
+    Py_INCREF (value);
+    return value;
+  }
 
-  PyMem_Free (warmup_script);
-  PyMem_Free (embed_script);
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return NULL;
 
-  return result;
+  return PyObject_GetItem (message, key);
 }
 
-static TelcoSnapshotOptions *
-PySession_parse_snapshot_options (const gchar * warmup_script, const gchar * runtime_value)
+static int
+PyLazyMessage_ass_subscript (PyLazyMessage * self, PyObject * key, PyObject * value)
 {
-  TelcoSnapshotOptions * options;
+  PyObject * message;
 
-  options = telco_snapshot_options_new ();
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return -1;
 
-  if (warmup_script != NULL)
-    telco_snapshot_options_set_warmup_script (options, warmup_script);
+  if (value == NULL)
+    return PyObject_DelItem (message, key);
 
-  if (runtime_value != NULL)
-  {
-    TelcoScriptRuntime runtime;
+  return PyObject_SetItem (message, key, value);
+}
 
-    if (!PyGObject_unmarshal_enum (runtime_value, TELCO_TYPE_SCRIPT_RUNTIME, &runtime))
-      goto invalid_argument;
+static Py_ssize_t
+PyLazyMessage_length (PyLazyMessage * self)
+{
+  PyObject * message;
 
-    telco_snapshot_options_set_runtime (options, runtime);
-  }
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return -1;
 
-  return options;
+  return PyObject_Size (message);
+}
 
-invalid_argument:
-  {
-    g_object_unref (options);
+static int
+PyLazyMessage_contains (PyLazyMessage * self, PyObject * key)
+{
+  PyObject * message, * value;
+  gboolean found = FALSE;
 
-    return NULL;
-  }
+  value = PyLazyMessage_lookup_eager (self, key, &found);
+  if (found)
+    return value != NULL;
+
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return -1;
+
+  return PyDict_Contains (message, key);
 }
 
 static PyObject *
-PySession_setup_peer_connection (PySession * self, PyObject * args, PyObject * kw)
+PyLazyMessage_iter (PyLazyMessage * self)
 {
-  gboolean success = FALSE;
-  static char * keywords[] = { "stun_server", "relays", NULL };
-  char * stun_server = NULL;
-  PyObject * relays = NULL;
-  TelcoPeerOptions * options = NULL;
-  GError * error = NULL;
+  PyObject * message;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|esO", keywords,
-        "utf-8", &stun_server,
-        &relays))
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
     return NULL;
 
-  options = PySession_parse_peer_options (stun_server, relays);
-  if (options == NULL)
-    goto beach;
-
-  Py_BEGIN_ALLOW_THREADS
-  telco_session_setup_peer_connection_sync (PY_GOBJECT_HANDLE (self), options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-
-  if (error != NULL)
-    goto propagate_error;
-
-  success = TRUE;
-  goto beach;
+  return PyObject_GetIter (message);
+}
 
-propagate_error:
-  {
-    PyTelco_raise (error);
-    goto beach;
-  }
-beach:
-  {
-    g_clear_object (&options);
+static PyObject *
+PyLazyMessage_richcompare (PyLazyMessage * self, PyObject * other, int op)
+{
+  PyObject * message;
 
-    PyMem_Free (stun_server);
+  if (op != Py_EQ && op != Py_NE)
+    Py_RETURN_NOTIMPLEMENTED;
 
-    if (!success)
-      return NULL;
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return NULL;
 
-    Py_RETURN_NONE;
-  }
+  return PyObject_RichCompare (message, other, op);
 }
 
-static TelcoPeerOptions *
-PySession_parse_peer_options (const gchar * stun_server, PyObject * relays)
+static PyObject *
+PyLazyMessage_get (PyLazyMessage * self, PyObject * args)
 {
-  TelcoPeerOptions * options;
-  PyObject * relay;
+  PyObject * key, * default_value = Py_None;
+  PyObject * message, * value;
+  gboolean found = FALSE;
 
-  options = telco_peer_options_new ();
-
-  telco_peer_options_set_stun_server (options, stun_server);
+  if (!PyArg_ParseTuple (args, "O|O", &key, &default_value))
+    return NULL;
 
-  if (relays != NULL)
+  value = PyLazyMessage_lookup_eager (self, key, &found);
+  if (!found)
   {
-    Py_ssize_t n, i;
-
-    n = PySequence_Length (relays);
-    if (n == -1)
-      goto propagate_error;
+    message = PyLazyMessage_materialize (self);
+    if (message == NULL)
+      return NULL;
 
-    for (i = 0; i != n; i++)
-    {
-      relay = PySequence_GetItem (relays, i);
-      if (relay == NULL)
-        goto propagate_error;
+    value = PyDict_GetItemWithError (message, key);
+    if (value == NULL && PyErr_Occurred ())
+      return NULL;
+  }
 
-      if (!PyObject_IsInstance (relay, PYTELCO_TYPE_OBJECT (Relay)))
-        goto expected_relay;
+  if (value == NULL)
+    value = default_value;
 
-      telco_peer_options_add_relay (options, PY_GOBJECT_HANDLE (relay));
+  Py_INCREF (value);
+  return value;
+}
 
-      Py_DECREF (relay);
-    }
-  }
+static PyObject *
+PyLazyMessage_keys (PyLazyMessage * self)
+{
+  PyObject * message;
 
-  return options;
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return NULL;
 
-expected_relay:
-  {
-    Py_DECREF (relay);
+  return PyDict_Keys (message);
+}
 
-    PyErr_SetString (PyExc_TypeError, "expected sequence of Relay objects");
-    goto propagate_error;
-  }
-propagate_error:
-  {
-    g_object_unref (options);
+static PyObject *
+PyLazyMessage_values (PyLazyMessage * self)
+{
+  PyObject * message;
 
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
     return NULL;
-  }
+
+  return PyDict_Values (message);
 }
 
 static PyObject *
-PySession_join_portal (PySession * self, PyObject * args, PyObject * kw)
+PyLazyMessage_items (PyLazyMessage * self)
 {
-  PyObject * result = NULL;
-  static char * keywords[] = { "address", "certificate", "token", "acl", NULL };
-  char * address;
-  char * certificate = NULL;
-  char * token = NULL;
-  PyObject * acl = NULL;
-  TelcoPortalOptions * options;
-  GError * error = NULL;
-  TelcoPortalMembership * handle;
+  PyObject * message;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|esesO", keywords,
-        "utf-8", &address,
-        "utf-8", &certificate,
-        "utf-8", &token,
-        &acl))
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
     return NULL;
 
-  options = PySession_parse_portal_options (certificate, token, acl);
-  if (options == NULL)
-    goto beach;
+  return PyDict_Items (message);
+}
 
-  Py_BEGIN_ALLOW_THREADS
-  handle = telco_session_join_portal_sync (PY_GOBJECT_HANDLE (self), address, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+static PyObject *
+PyLazyMessage_to_dict (PyLazyMessage * self)
+{
+  PyObject * message;
 
-  result = (error == NULL)
-      ? PyPortalMembership_new_take_handle (handle)
-      : PyTelco_raise (error);
+  message = PyLazyMessage_materialize (self);
+  if (message == NULL)
+    return NULL;
 
-beach:
-  g_clear_object (&options);
+  Py_INCREF (message);
+  return message;
+}
 
-  PyMem_Free (token);
-  PyMem_Free (certificate);
-  PyMem_Free (address);
+static PyObject *
+PyLazyMessage_is_materialized (PyLazyMessage * self)
+{
+  return PyBool_FromLong (self->message != NULL);
+}
 
-  return result;
+static void
+PyTelco_object_decref (gpointer obj)
+{
+  PyObject * o = obj;
+  Py_DECREF (o);
 }
 
-static TelcoPortalOptions *
-PySession_parse_portal_options (const gchar * certificate_value, const gchar * token, PyObject * acl_value)
+static gboolean
+PyTelco_unmarshal_post_batch (PyObject * messages, PyObject * datas, gchar *** raw_messages, GBytes *** raw_datas,
+    Py_ssize_t * length)
 {
-  TelcoPortalOptions * options;
+  Py_ssize_t n, i;
+  gchar ** message_values = NULL;
+  GBytes ** data_values = NULL;
 
-  options = telco_portal_options_new ();
+  if (!PyList_Check (messages) && !PyTuple_Check (messages))
+    goto invalid_messages;
 
-  if (certificate_value != NULL)
+  n = PySequence_Size (messages);
+
+  if (datas != Py_None)
   {
-    GTlsCertificate * certificate;
+    if (!PyList_Check (datas) && !PyTuple_Check (datas))
+      goto invalid_datas;
+    if (PySequence_Size (datas) != n)
+      goto length_mismatch;
+  }
 
-    if (!PyGObject_unmarshal_certificate (certificate_value, &certificate))
-      goto propagate_error;
+  message_values = g_new0 (gchar *, n);
+  data_values = g_new0 (GBytes *, n);
 
-    telco_portal_options_set_certificate (options, certificate);
+  for (i = 0; i != n; i++)
+  {
+    PyObject * message;
+    gboolean valid;
 
-    g_object_unref (certificate);
+    message = PySequence_GetItem (messages, i);
+    valid = PyUnicode_Check (message) && PyGObject_unmarshal_string (message, &message_values[i]);
+    Py_DECREF (message);
+    if (!valid)
+      goto invalid_message;
+
+    if (datas != Py_None)
+    {
+      PyObject * data;
+
+      data = PySequence_GetItem (datas, i);
+      valid = PyGObject_unmarshal_data (data, &data_values[i]);
+      Py_DECREF (data);
+      if (!valid)
+        goto propagate_error;
+    }
+  }
+
+  *raw_messages = message_values;
+  *raw_datas = data_values;
+  *length = n;
+
+  return TRUE;
+
+invalid_messages:
+  {
+    PyErr_SetString (PyExc_TypeError, "messages must be a list or tuple");
+    return FALSE;
+  }
+invalid_datas:
+  {
+    PyErr_SetString (PyExc_TypeError, "datas must be a list, tuple or None");
+    return FALSE;
+  }
+length_mismatch:
+  {
+    PyErr_SetString (PyExc_ValueError, "datas must be as long as messages");
+    return FALSE;
   }
+invalid_message:
+  {
+    if (!PyErr_Occurred ())
+      PyErr_SetString (PyExc_TypeError, "each message must be a str");
+    goto propagate_error;
+  }
+propagate_error:
+  {
+    PyTelco_free_post_batch (message_values, data_values, n);
+    return FALSE;
+  }
+}
 
-  if (token != NULL)
-    telco_portal_options_set_token (options, token);
+static void
+PyTelco_free_post_batch (gchar ** raw_messages, GBytes ** raw_datas, Py_ssize_t length)
+{
+  Py_ssize_t i;
 
-  if (acl_value != NULL)
+  for (i = 0; i != length; i++)
   {
-    gchar ** acl;
-    gint acl_length;
+    g_free (raw_messages[i]);
+    if (raw_datas[i] != NULL)
+      g_bytes_unref (raw_datas[i]);
+  }
 
-    if (!PyGObject_unmarshal_strv (acl_value, &acl, &acl_length))
-      goto propagate_error;
+  g_free (raw_messages);
+  g_free (raw_datas);
+}
 
-    telco_portal_options_set_acl (options, acl, acl_length);
+static PyObject *
+PyTelco_raise (GError * error)
+{
+  PyObject * exception;
+  GString * message;
 
-    g_strfreev (acl);
+  if (error->domain == TELCO_ERROR)
+  {
+    exception = g_hash_table_lookup (telco_exception_by_error_code, GINT_TO_POINTER (error->code));
+    g_assert (exception != NULL);
+  }
+  else
+  {
+    g_assert (error->domain == G_IO_ERROR);
+    g_assert (error->code == G_IO_ERROR_CANCELLED);
+    exception = cancelled_exception;
   }
 
-  return options;
+  message = g_string_new ("");
+  g_string_append_unichar (message, g_unichar_tolower (g_utf8_get_char (error->message)));
+  g_string_append (message, g_utf8_offset_to_pointer (error->message, 1));
 
-propagate_error:
-  {
-    g_object_unref (options);
+  PyErr_SetString (exception, message->str);
 
-    return NULL;
-  }
-}
+  g_string_free (message, TRUE);
+  g_error_free (error);
 
+  return NULL;
+}
 
-static PyObject *
-PyScript_new_take_handle (TelcoScript * handle)
+static gboolean
+PyTelco_is_string (PyObject * obj)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (Script));
+  return PyUnicode_Check (obj);
 }
 
-static PyObject *
-PyScript_is_destroyed (PyScript * self)
+static gchar *
+PyTelco_repr (PyObject * obj)
 {
-  gboolean is_destroyed;
-
-  Py_BEGIN_ALLOW_THREADS
-  is_destroyed = telco_script_is_destroyed (PY_GOBJECT_HANDLE (self));
-  Py_END_ALLOW_THREADS
+  gchar * result;
+  PyObject * repr_value;
 
-  return PyBool_FromLong (is_destroyed);
-}
+  repr_value = PyObject_Repr (obj);
 
-static PyObject *
-PyScript_load (PyScript * self)
-{
-  GError * error = NULL;
+  PyGObject_unmarshal_string (repr_value, &result);
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_script_load_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  Py_DECREF (repr_value);
 
-  Py_RETURN_NONE;
+  return result;
 }
 
-static PyObject *
-PyScript_unload (PyScript * self)
+static guint
+PyTelco_get_max_argument_count (PyObject * callable)
 {
-  GError * error = NULL;
+  guint result = G_MAXUINT;
+  PyObject * spec;
+  PyObject * varargs = NULL;
+  PyObject * args = NULL;
+  PyObject * is_method;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_script_unload_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  spec = PyObject_CallFunction (inspect_getargspec, "O", callable);
+  if (spec == NULL)
+  {
+    PyErr_Clear ();
+    goto beach;
+  }
 
-  Py_RETURN_NONE;
-}
+  varargs = PyTuple_GetItem (spec, 1);
+  if (varargs != Py_None)
+    goto beach;
 
-static PyObject *
-PyScript_eternalize (PyScript * self)
-{
-  GError * error = NULL;
+  args = PyTuple_GetItem (spec, 0);
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_script_eternalize_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  result = PyObject_Size (args);
 
-  Py_RETURN_NONE;
+  is_method = PyObject_CallFunction (inspect_ismethod, "O", callable);
+  g_assert (is_method != NULL);
+  if (is_method == Py_True)
+    result--;
+  Py_DECREF (is_method);
+
+beach:
+  Py_XDECREF (spec);
+
+  return result;
 }
 
 static PyObject *
-PyScript_post (PyScript * self, PyObject * args, PyObject * kw)
+PyTelco_json_decode (const gchar * json, gsize length)
 {
-  static char * keywords[] = { "message", "data", NULL };
-  char * message;
-  gconstpointer data_buffer = NULL;
-  Py_ssize_t data_size = 0;
-  GBytes * data;
+  PyTelcoJsonParser parser;
+  PyObject * result;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|z#", keywords, "utf-8", &message, &data_buffer, &data_size))
-    return NULL;
+  parser.start = json;
+  parser.cursor = json;
+  parser.end = json + length;
+  parser.depth = 0;
+  parser.scratch = NULL;
 
-  data = (data_buffer != NULL) ? g_bytes_new (data_buffer, data_size) : NULL;
+  result = PyTelcoJsonParser_parse_value (&parser);
+  if (result == NULL)
+    goto beach;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_script_post (PY_GOBJECT_HANDLE (self), message, data);
-  Py_END_ALLOW_THREADS
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor != parser.end)
+  {
+    Py_CLEAR (result);
+    PyTelcoJsonParser_raise (&parser, "extra data");
+  }
 
-  g_bytes_unref (data);
-  PyMem_Free (message);
+beach:
+  if (parser.scratch != NULL)
+    g_string_free (parser.scratch, TRUE);
 
-  Py_RETURN_NONE;
+  return result;
 }
 
 static PyObject *
-PyScript_enable_debugger (PyScript * self, PyObject * args, PyObject * kw)
+PyTelcoJsonParser_parse_value (PyTelcoJsonParser * self)
 {
-  static char * keywords[] = { "port", NULL };
-  unsigned short int port = 0;
-  GError * error = NULL;
+  PyTelcoJsonParser_skip_whitespace (self);
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|H", keywords, &port))
-    return NULL;
+  if (self->cursor == self->end)
+    return PyTelcoJsonParser_raise (self, "expecting value");
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_script_enable_debugger_sync (PY_GOBJECT_HANDLE (self), port, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  switch (*self->cursor)
+  {
+    case '{':
+      return PyTelcoJsonParser_parse_object (self);
+    case '[':
+      return PyTelcoJsonParser_parse_array (self);
+    case '"':
+      return PyTelcoJsonParser_parse_string (self);
+    case 't':
+      if (!PyTelcoJsonParser_consume_literal (self, "true"))
+        break;
+      Py_RETURN_TRUE;
+    case 'f':
+      if (!PyTelcoJsonParser_consume_literal (self, "false"))
+        break;
+      Py_RETURN_FALSE;
+    case 'n':
+      if (!PyTelcoJsonParser_consume_literal (self, "null"))
+        break;
+      Py_RETURN_NONE;
+    default:
+      return PyTelcoJsonParser_parse_number (self);
+  }
 
-  Py_RETURN_NONE;
+  return PyTelcoJsonParser_raise (self, "expecting value");
 }
 
 static PyObject *
-PyScript_disable_debugger (PyScript * self)
+PyTelcoJsonParser_parse_object (PyTelcoJsonParser * self)
 {
-  GError * error = NULL;
+  PyObject * result;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_script_disable_debugger_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (++self->depth > PYTELCO_JSON_MAX_DEPTH)
+    return PyTelcoJsonParser_raise (self, "nesting too deep");
 
-  Py_RETURN_NONE;
-}
+  self->cursor++;
 
+  result = PyDict_New ();
+  if (result == NULL)
+    return NULL;
 
-static int
-PyRelay_init (PyRelay * self, PyObject * args, PyObject * kw)
-{
-  int result = -1;
-  static char * keywords[] = { "address", "username", "password", "kind", NULL };
-  char * address = NULL;
-  char * username = NULL;
-  char * password = NULL;
-  char * kind_value = NULL;
-  TelcoRelayKind kind;
-  TelcoRelay * handle;
+  PyTelcoJsonParser_skip_whitespace (self);
+  if (self->cursor != self->end && *self->cursor == '}')
+  {
+    self->cursor++;
+    goto beach;
+  }
 
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  while (TRUE)
+  {
+    PyObject * key, * value;
+    int set_result;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "eseseses", keywords,
-        "utf-8", &address,
-        "utf-8", &username,
-        "utf-8", &password,
-        "utf-8", &kind_value))
-    return -1;
+    PyTelcoJsonParser_skip_whitespace (self);
+    if (self->cursor == self->end || *self->cursor != '"')
+      goto expecting_key;
 
-  if (!PyGObject_unmarshal_enum (kind_value, TELCO_TYPE_RELAY_KIND, &kind))
-    goto beach;
+    key = PyTelcoJsonParser_parse_string (self);
+    if (key == NULL)
+      goto propagate_error;
 
-  handle = telco_relay_new (address, username, password, kind);
+    PyTelcoJsonParser_skip_whitespace (self);
+    if (self->cursor == self->end || *self->cursor != ':')
+    {
+      Py_DECREF (key);
+      goto expecting_colon;
+    }
+    self->cursor++;
 
-  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (Relay));
+    value = PyTelcoJsonParser_parse_value (self);
+    if (value == NULL)
+    {
+      Py_DECREF (key);
+      goto propagate_error;
+    }
 
-  PyRelay_init_from_handle (self, handle);
+    set_result = PyDict_SetItem (result, key, value);
+    Py_DECREF (value);
+    Py_DECREF (key);
+    if (set_result == -1)
+      goto propagate_error;
 
-  result = 0;
+    PyTelcoJsonParser_skip_whitespace (self);
+    if (self->cursor == self->end)
+      goto expecting_delimiter;
+    if (*self->cursor == '}')
+    {
+      self->cursor++;
+      break;
+    }
+    if (*self->cursor != ',')
+      goto expecting_delimiter;
+    self->cursor++;
+  }
 
 beach:
-  PyMem_Free (kind_value);
-  PyMem_Free (password);
-  PyMem_Free (username);
-  PyMem_Free (address);
+  self->depth--;
 
   return result;
+
+expecting_key:
+  {
+    PyTelcoJsonParser_raise (self, "expecting property name enclosed in double quotes");
+    goto propagate_error;
+  }
+expecting_colon:
+  {
+    PyTelcoJsonParser_raise (self, "expecting ':' delimiter");
+    goto propagate_error;
+  }
+expecting_delimiter:
+  {
+    PyTelcoJsonParser_raise (self, "expecting ',' delimiter");
+    goto propagate_error;
+  }
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
 }
 
-static void
-PyRelay_init_from_handle (PyRelay * self, TelcoRelay * handle)
-{
-  self->address = PyUnicode_FromUTF8String (telco_relay_get_address (handle));
-  self->username = PyUnicode_FromUTF8String (telco_relay_get_username (handle));
-  self->password = PyUnicode_FromUTF8String (telco_relay_get_password (handle));
-  self->kind = PyGObject_marshal_enum (telco_relay_get_kind (handle), TELCO_TYPE_RELAY_KIND);
-}
+static PyObject *
+PyTelcoJsonParser_parse_array (PyTelcoJsonParser * self)
+{
+  PyObject * result;
+
+  if (++self->depth > PYTELCO_JSON_MAX_DEPTH)
+    return PyTelcoJsonParser_raise (self, "nesting too deep");
+
+  self->cursor++;
+
+  result = PyList_New (0);
+  if (result == NULL)
+    return NULL;
+
+  PyTelcoJsonParser_skip_whitespace (self);
+  if (self->cursor != self->end && *self->cursor == ']')
+  {
+    self->cursor++;
+    goto beach;
+  }
+
+  while (TRUE)
+  {
+    PyObject * element;
+    int append_result;
+
+    element = PyTelcoJsonParser_parse_value (self);
+    if (element == NULL)
+      goto propagate_error;
+
+    append_result = PyList_Append (result, element);
+    Py_DECREF (element);
+    if (append_result == -1)
+      goto propagate_error;
+
+    PyTelcoJsonParser_skip_whitespace (self);
+    if (self->cursor == self->end)
+      goto expecting_delimiter;
+    if (*self->cursor == ']')
+    {
+      self->cursor++;
+      break;
+    }
+    if (*self->cursor != ',')
+      goto expecting_delimiter;
+    self->cursor++;
+  }
 
-static void
-PyRelay_dealloc (PyRelay * self)
-{
-  Py_XDECREF (self->kind);
-  Py_XDECREF (self->password);
-  Py_XDECREF (self->username);
-  Py_XDECREF (self->address);
+beach:
+  self->depth--;
 
-  PyGObject_tp_dealloc ((PyObject *) self);
+  return result;
+
+expecting_delimiter:
+  {
+    PyTelcoJsonParser_raise (self, "expecting ',' delimiter");
+    goto propagate_error;
+  }
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
 }
 
 static PyObject *
-PyRelay_repr (PyRelay * self)
+PyTelcoJsonParser_parse_string (PyTelcoJsonParser * self)
 {
-  PyObject * result, * address_bytes, * username_bytes, * password_bytes, * kind_bytes;
+  const gchar * start, * cursor;
+  GString * scratch;
 
-  address_bytes = PyUnicode_AsUTF8String (self->address);
-  username_bytes = PyUnicode_AsUTF8String (self->username);
-  password_bytes = PyUnicode_AsUTF8String (self->password);
-  kind_bytes = PyUnicode_AsUTF8String (self->kind);
+  start = self->cursor + 1;
 
-  result = PyRepr_FromFormat ("Relay(address=\"%s\", username=\"%s\", password=\"%s\", kind='%s')",
-      PyBytes_AsString (address_bytes),
-      PyBytes_AsString (username_bytes),
-      PyBytes_AsString (password_bytes),
-      PyBytes_AsString (kind_bytes));
+  for (cursor = start; cursor != self->end; cursor++)
+  {
+    guchar ch = *cursor;
 
-  Py_DECREF (kind_bytes);
-  Py_DECREF (password_bytes);
-  Py_DECREF (username_bytes);
-  Py_DECREF (address_bytes);
+    if (ch == '"')
+    {
+      self->cursor = cursor + 1;
+      return PyUnicode_DecodeUTF8 (start, cursor - start, "strict");
+    }
 
-  return result;
-}
+    if (ch == '\\' || ch < 0x20)
+      break;
+  }
 
+  scratch = self->scratch;
+  if (scratch == NULL)
+    scratch = self->scratch = g_string_sized_new (64);
+  g_string_truncate (scratch, 0);
+  g_string_append_len (scratch, start, cursor - start);
 
-static PyObject *
-PyPortalMembership_new_take_handle (TelcoPortalMembership * handle)
-{
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (PortalMembership));
-}
+  self->cursor = cursor;
 
-static PyObject *
-PyPortalMembership_terminate (PyPortalMembership * self)
-{
-  GError * error = NULL;
+  while (self->cursor != self->end)
+  {
+    guchar ch = *self->cursor;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_membership_terminate_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+    if (ch == '"')
+    {
+      self->cursor++;
+      return PyUnicode_DecodeUTF8 (scratch->str, scratch->len, "surrogatepass");
+    }
 
-  Py_RETURN_NONE;
-}
+    if (ch < 0x20)
+      return PyTelcoJsonParser_raise (self, "invalid control character in string");
 
+    if (ch != '\\')
+    {
+      g_string_append_c (scratch, ch);
+      self->cursor++;
+      continue;
+    }
 
-static int
-PyPortalService_init (PyPortalService * self, PyObject * args, PyObject * kw)
-{
-  static char * keywords[] = { "cluster_params", "control_params", NULL };
-  PyEndpointParameters * cluster_params;
-  PyEndpointParameters * control_params = NULL;
-  TelcoPortalService * handle;
+    if (++self->cursor == self->end)
+      break;
 
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+    switch (*self->cursor++)
+    {
+      case '"':  g_string_append_c (scratch, '"');  break;
+      case '\\': g_string_append_c (scratch, '\\'); break;
+      case '/':  g_string_append_c (scratch, '/');  break;
+      case 'b':  g_string_append_c (scratch, '\b'); break;
+      case 'f':  g_string_append_c (scratch, '\f'); break;
+      case 'n':  g_string_append_c (scratch, '\n'); break;
+      case 'r':  g_string_append_c (scratch, '\r'); break;
+      case 't':  g_string_append_c (scratch, '\t'); break;
+      case 'u':
+      {
+        gunichar c, low;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "O!|O!", keywords,
-        PYTELCO_TYPE_OBJECT (EndpointParameters), &cluster_params,
-        PYTELCO_TYPE_OBJECT (EndpointParameters), &control_params))
-    return -1;
+        if (!PyTelcoJsonParser_parse_hex4 (self, &c))
+          return NULL;
 
-  g_atomic_int_inc (&toplevel_objects_alive);
+        if (c >= 0xd800 && c <= 0xdbff && self->end - self->cursor >= 6 && self->cursor[0] == '\\' && self->cursor[1] == 'u')
+        {
+          const gchar * high_end = self->cursor;
 
-  handle = telco_portal_service_new (PY_GOBJECT_HANDLE (cluster_params),
-      (control_params != NULL) ? PY_GOBJECT_HANDLE (control_params) : NULL);
+          self->cursor += 2;
+          if (!PyTelcoJsonParser_parse_hex4 (self, &low))
+            return NULL;
 
-  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (PortalService));
+          if (low >= 0xdc00 && low <= 0xdfff)
+            c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+          else
+            self->cursor = high_end;
+        }
 
-  PyPortalService_init_from_handle (self, handle);
+        g_string_append_unichar (scratch, c);
+        break;
+      }
+      default:
+        return PyTelcoJsonParser_raise (self, "invalid \\escape");
+    }
+  }
 
-  return 0;
+  return PyTelcoJsonParser_raise (self, "unterminated string");
 }
 
-static void
-PyPortalService_init_from_handle (PyPortalService * self, TelcoPortalService * handle)
+static PyObject *
+PyTelcoJsonParser_parse_number (PyTelcoJsonParser * self)
 {
-  self->device = PyDevice_new_take_handle (g_object_ref (telco_portal_service_get_device (handle)));
-}
+  const gchar * start, * cursor, * digits_start;
+  gboolean is_integer = TRUE;
+  gsize num_digits;
+  gchar * text;
+  PyObject * result;
 
-static void
-PyPortalService_dealloc (PyPortalService * self)
-{
-  TelcoPortalService * handle;
+  start = self->cursor;
+  cursor = start;
 
-  g_atomic_int_dec_and_test (&toplevel_objects_alive);
+  if (cursor != self->end && *cursor == '-')
+    cursor++;
 
-  handle = PyGObject_steal_handle (&self->parent);
-  if (handle != NULL)
+  digits_start = cursor;
+  if (cursor != self->end && *cursor == '0')
   {
-    Py_BEGIN_ALLOW_THREADS
-    telco_portal_service_stop_sync (handle, NULL, NULL);
-    telco_unref (handle);
-    Py_END_ALLOW_THREADS
+    cursor++;
+  }
+  else
+  {
+    while (cursor != self->end && g_ascii_isdigit (*cursor))
+      cursor++;
   }
+  num_digits = cursor - digits_start;
+  if (num_digits == 0)
+    return PyTelcoJsonParser_raise (self, "expecting value");
 
-  Py_XDECREF (self->device);
+  if (cursor != self->end && *cursor == '.')
+  {
+    const gchar * fraction_start = ++cursor;
 
-  PyGObject_tp_dealloc ((PyObject *) self);
-}
+    while (cursor != self->end && g_ascii_isdigit (*cursor))
+      cursor++;
+    if (cursor == fraction_start)
+      return PyTelcoJsonParser_raise (self, "invalid number");
 
-static PyObject *
-PyPortalService_start (PyPortalService * self)
-{
-  GError * error = NULL;
+    is_integer = FALSE;
+  }
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_start_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (cursor != self->end && (*cursor == 'e' || *cursor == 'E'))
+  {
+    const gchar * exponent_start;
 
-  Py_RETURN_NONE;
-}
+    cursor++;
+    if (cursor != self->end && (*cursor == '+' || *cursor == '-'))
+      cursor++;
 
-static PyObject *
-PyPortalService_stop (PyPortalService * self)
-{
-  GError * error = NULL;
+    exponent_start = cursor;
+    while (cursor != self->end && g_ascii_isdigit (*cursor))
+      cursor++;
+    if (cursor == exponent_start)
+      return PyTelcoJsonParser_raise (self, "invalid number");
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_stop_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+    is_integer = FALSE;
+  }
 
-  Py_RETURN_NONE;
-}
+  self->cursor = cursor;
 
-static PyObject *
-PyPortalService_kick (PyScript * self, PyObject * args)
-{
-  unsigned int connection_id;
+  if (is_integer && num_digits <= 18)
+  {
+    const gchar * p;
+    gint64 value = 0;
 
-  if (!PyArg_ParseTuple (args, "I", &connection_id))
-    return NULL;
+    for (p = digits_start; p != cursor; p++)
+      value = (value * 10) + (*p - '0');
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_kick (PY_GOBJECT_HANDLE (self), connection_id);
-  Py_END_ALLOW_THREADS
+    return PyLong_FromLongLong ((*start == '-') ? -value : value);
+  }
 
-  Py_RETURN_NONE;
+  text = g_strndup (start, cursor - start);
+  if (is_integer)
+  {
+    result = PyLong_FromString (text, NULL, 10);
+  }
+  else
+  {
+    gdouble value;
+
+    value = PyOS_string_to_double (text, NULL, PyExc_OverflowError);
+    if (value == -1.0 && PyErr_Occurred ())
+    {
+      PyErr_Clear ();
+      value = (*start == '-') ? -Py_HUGE_VAL : Py_HUGE_VAL;
+    }
+
+    result = PyFloat_FromDouble (value);
+  }
+  g_free (text);
+
+  return result;
 }
 
-static PyObject *
-PyPortalService_post (PyScript * self, PyObject * args, PyObject * kw)
+static gboolean
+PyTelcoJsonParser_parse_hex4 (PyTelcoJsonParser * self, gunichar * c)
 {
-  static char * keywords[] = { "connection_id", "message", "data", NULL };
-  unsigned int connection_id;
-  char * message;
-  gconstpointer data_buffer = NULL;
-  Py_ssize_t data_size = 0;
-  GBytes * data;
-
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "Ies|z#", keywords,
-        &connection_id,
-        "utf-8", &message,
-        &data_buffer, &data_size))
-    return NULL;
+  guint i;
 
-  data = (data_buffer != NULL) ? g_bytes_new (data_buffer, data_size) : NULL;
+  if (self->end - self->cursor < 4)
+    goto invalid_escape;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_post (PY_GOBJECT_HANDLE (self), connection_id, message, data);
-  Py_END_ALLOW_THREADS
+  *c = 0;
+  for (i = 0; i != 4; i++)
+  {
+    gint digit = g_ascii_xdigit_value (self->cursor[i]);
+    if (digit == -1)
+      goto invalid_escape;
+    *c = (*c << 4) | digit;
+  }
+  self->cursor += 4;
 
-  g_bytes_unref (data);
-  PyMem_Free (message);
+  return TRUE;
 
-  Py_RETURN_NONE;
+invalid_escape:
+  {
+    PyTelcoJsonParser_raise (self, "invalid \\uXXXX escape");
+    return FALSE;
+  }
 }
 
-static PyObject *
-PyPortalService_narrowcast (PyScript * self, PyObject * args, PyObject * kw)
+static gboolean
+PyTelcoJsonParser_consume_literal (PyTelcoJsonParser * self, const gchar * literal)
 {
-  static char * keywords[] = { "tag", "message", "data", NULL };
-  char * tag, * message;
-  gconstpointer data_buffer = NULL;
-  Py_ssize_t data_size = 0;
-  GBytes * data;
-
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "eses|z#", keywords,
-        "utf-8", &tag,
-        "utf-8", &message,
-        &data_buffer, &data_size))
-    return NULL;
+  gsize length = strlen (literal);
 
-  data = (data_buffer != NULL) ? g_bytes_new (data_buffer, data_size) : NULL;
-
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_narrowcast (PY_GOBJECT_HANDLE (self), tag, message, data);
-  Py_END_ALLOW_THREADS
+  if ((gsize) (self->end - self->cursor) < length || memcmp (self->cursor, literal, length) != 0)
+    return FALSE;
 
-  g_bytes_unref (data);
-  PyMem_Free (message);
-  PyMem_Free (tag);
+  self->cursor += length;
 
-  Py_RETURN_NONE;
+  return TRUE;
 }
 
-static PyObject *
-PyPortalService_broadcast (PyScript * self, PyObject * args, PyObject * kw)
+static void
+PyTelcoJsonParser_skip_whitespace (PyTelcoJsonParser * self)
 {
-  static char * keywords[] = { "message", "data", NULL };
-  char * message;
-  gconstpointer data_buffer = NULL;
-  Py_ssize_t data_size = 0;
-  GBytes * data;
-
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "es|z#", keywords,
-        "utf-8", &message,
-        &data_buffer, &data_size))
-    return NULL;
+  while (self->cursor != self->end)
+  {
+    switch (*self->cursor)
+    {
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        self->cursor++;
+        break;
+      default:
+        return;
+    }
+  }
+}
 
-  data = (data_buffer != NULL) ? g_bytes_new (data_buffer, data_size) : NULL;
+static gboolean
+PyTelcoJsonParser_skip_value (PyTelcoJsonParser * self)
+{
+  guint depth = 0;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_broadcast (PY_GOBJECT_HANDLE (self), message, data);
-  Py_END_ALLOW_THREADS
+  /*
+   * Only finds where the value ends, without validating it. Whatever gets skipped here is
+   * validated properly if it is ever parsed.
+   */
+  do
+  {
+    PyTelcoJsonParser_skip_whitespace (self);
+    if (self->cursor == self->end)
+      return FALSE;
 
-  g_bytes_unref (data);
-  PyMem_Free (message);
+    switch (*self->cursor)
+    {
+      case '"':
+        for (self->cursor++; self->cursor != self->end && *self->cursor != '"'; self->cursor++)
+        {
+          if (*self->cursor == '\\' && ++self->cursor == self->end)
+            return FALSE;
+        }
+        if (self->cursor == self->end)
+          return FALSE;
+        self->cursor++;
+        break;
+      case '{':
+      case '[':
+        depth++;
+        self->cursor++;
+        break;
+      case '}':
+      case ']':
+        if (depth == 0)
+          return FALSE;
+        depth--;
+        self->cursor++;
+        break;
+      case ',':
+      case ':':
+        if (depth == 0)
+          return FALSE;
+        self->cursor++;
+        break;
+      default:
+        while (self->cursor != self->end && strchr (" \t\n\r,:]}", *self->cursor) == NULL)
+          self->cursor++;
+        break;
+    }
+  }
+  while (depth != 0);
 
-  Py_RETURN_NONE;
+  return TRUE;
 }
 
-static PyObject *
-PyPortalService_enumerate_tags (PyScript * self, PyObject * args)
+static gboolean
+PyTelcoJsonParser_scan_plain_string (PyTelcoJsonParser * self, const gchar ** str, gsize * length)
 {
-  PyObject * result;
-  unsigned int connection_id;
-  gchar ** tags;
-  gint tags_length;
+  const gchar * start;
 
-  if (!PyArg_ParseTuple (args, "I", &connection_id))
-    return NULL;
+  /* Strings with escapes are reported as a mismatch, as the caller only gets to see the raw bytes. */
+  PyTelcoJsonParser_skip_whitespace (self);
+  if (self->cursor == self->end || *self->cursor != '"')
+    return FALSE;
+  start = ++self->cursor;
 
-  Py_BEGIN_ALLOW_THREADS
-  tags = telco_portal_service_enumerate_tags (PY_GOBJECT_HANDLE (self), connection_id, &tags_length);
-  Py_END_ALLOW_THREADS
+  while (self->cursor != self->end && *self->cursor != '"')
+  {
+    if (*self->cursor == '\\')
+      return FALSE;
+    self->cursor++;
+  }
+  if (self->cursor == self->end)
+    return FALSE;
 
-  result = PyGObject_marshal_strv (tags, tags_length);
-  g_strfreev (tags);
+  *str = start;
+  *length = self->cursor - start;
+  self->cursor++;
 
-  return result;
+  return TRUE;
 }
 
-static PyObject *
-PyPortalService_tag (PyScript * self, PyObject * args, PyObject * kw)
+static gboolean
+PyTelcoJsonParser_scan_payload_tag (PyTelcoJsonParser * self, const gchar ** tag, gsize * tag_length)
 {
-  static char * keywords[] = { "connection_id", "tag", NULL };
-  unsigned int connection_id;
-  char * tag;
+  const gchar * payload_start;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "Ies", keywords,
-        &connection_id,
-        "utf-8", &tag))
-    return NULL;
+  PyTelcoJsonParser_skip_whitespace (self);
+  payload_start = self->cursor;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_tag (PY_GOBJECT_HANDLE (self), connection_id, tag);
-  Py_END_ALLOW_THREADS
+  if (self->cursor != self->end && *self->cursor == '[')
+  {
+    self->cursor++;
+    PyTelcoJsonParser_scan_plain_string (self, tag, tag_length);
+  }
+  else if (self->cursor != self->end && *self->cursor == '{')
+  {
+    self->cursor++;
 
-  PyMem_Free (tag);
+    while (TRUE)
+    {
+      const gchar * key;
+      gsize key_length;
 
-  Py_RETURN_NONE;
-}
+      if (!PyTelcoJsonParser_scan_plain_string (self, &key, &key_length))
+        break;
 
-static PyObject *
-PyPortalService_untag (PyScript * self, PyObject * args, PyObject * kw)
-{
-  static char * keywords[] = { "connection_id", "tag", NULL };
-  unsigned int connection_id;
-  char * tag;
+      PyTelcoJsonParser_skip_whitespace (self);
+      if (self->cursor == self->end || *self->cursor != ':')
+        break;
+      self->cursor++;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "Ies", keywords,
-        &connection_id,
-        "utf-8", &tag))
-    return NULL;
+      if (key_length == 4 && (memcmp (key, "type", 4) == 0 || memcmp (key, "kind", 4) == 0))
+      {
+        PyTelcoJsonParser_scan_plain_string (self, tag, tag_length);
+        break;
+      }
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_portal_service_untag (PY_GOBJECT_HANDLE (self), connection_id, tag);
-  Py_END_ALLOW_THREADS
+      if (!PyTelcoJsonParser_skip_value (self))
+        break;
 
-  PyMem_Free (tag);
+      PyTelcoJsonParser_skip_whitespace (self);
+      if (self->cursor == self->end || *self->cursor != ',')
+        break;
+      self->cursor++;
+    }
+  }
 
-  Py_RETURN_NONE;
-}
+  self->cursor = payload_start;
 
+  return PyTelcoJsonParser_skip_value (self);
+}
 
-static int
-PyEndpointParameters_init (PyEndpointParameters * self, PyObject * args, PyObject * kw)
+static gboolean
+PyTelco_peek_message_tag (const gchar * json, gboolean * is_send, const gchar ** tag, gsize * tag_length)
 {
-  int result = -1;
-  static char * keywords[] = { "address", "port", "certificate", "origin", "auth_token", "auth_callback", "asset_root", NULL };
-  char * address = NULL;
-  unsigned short int port = 0;
-  char * certificate_value = NULL;
-  char * origin = NULL;
-  char * auth_token = NULL;
-  PyObject * auth_callback = NULL;
-  char * asset_root_value = NULL;
-  GTlsCertificate * certificate = NULL;
-  TelcoAuthenticationService * auth_service = NULL;
-  GFile * asset_root = NULL;
-  TelcoEndpointParameters * handle;
+  PyTelcoJsonParser parser;
 
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  /* Safe to call without the GIL, as it only looks at the raw bytes and never creates any objects. */
+  parser.start = json;
+  parser.cursor = json;
+  parser.end = json + strlen (json);
+  parser.depth = 0;
+  parser.scratch = NULL;
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|esHesesesOes", keywords,
-        "utf-8", &address,
-        &port,
-        "utf-8", &certificate_value,
-        "utf-8", &origin,
-        "utf-8", &auth_token,
-        &auth_callback,
-        "utf-8", &asset_root_value))
-    return -1;
+  *is_send = FALSE;
+  *tag = NULL;
+  *tag_length = 0;
 
-  if (certificate_value != NULL && !PyGObject_unmarshal_certificate (certificate_value, &certificate))
-    goto beach;
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor == parser.end || *parser.cursor != '{')
+    return FALSE;
+  parser.cursor++;
 
-  if (auth_token != NULL)
-    auth_service = TELCO_AUTHENTICATION_SERVICE (telco_static_authentication_service_new (auth_token));
-  else if (auth_callback != NULL)
-    auth_service = TELCO_AUTHENTICATION_SERVICE (telco_python_authentication_service_new (auth_callback));
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor != parser.end && *parser.cursor == '}')
+    return TRUE;
 
-  if (asset_root_value != NULL)
-    asset_root = g_file_new_for_path (asset_root_value);
+  while (TRUE)
+  {
+    const gchar * key, * type;
+    gsize key_length, type_length;
+    gboolean valid;
 
-  handle = telco_endpoint_parameters_new (address, port, certificate, origin, auth_service, asset_root);
+    if (!PyTelcoJsonParser_scan_plain_string (&parser, &key, &key_length))
+      return FALSE;
 
-  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (EndpointParameters));
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end || *parser.cursor != ':')
+      return FALSE;
+    parser.cursor++;
 
-  result = 0;
+    if (key_length == 4 && memcmp (key, "type", 4) == 0)
+    {
+      valid = PyTelcoJsonParser_scan_plain_string (&parser, &type, &type_length);
+      *is_send = valid && type_length == 4 && memcmp (type, "send", 4) == 0;
+    }
+    else if (key_length == 7 && memcmp (key, "payload", 7) == 0)
+    {
+      valid = PyTelcoJsonParser_scan_payload_tag (&parser, tag, tag_length);
+    }
+    else
+    {
+      valid = PyTelcoJsonParser_skip_value (&parser);
+    }
+    if (!valid)
+      return FALSE;
 
-beach:
-  g_clear_object (&asset_root);
-  g_clear_object (&auth_service);
-  g_clear_object (&certificate);
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end)
+      return FALSE;
+    if (*parser.cursor == '}')
+      return TRUE;
+    if (*parser.cursor != ',')
+      return FALSE;
+    parser.cursor++;
+  }
+}
 
-  PyMem_Free (asset_root_value);
-  PyMem_Free (auth_token);
-  PyMem_Free (origin);
-  PyMem_Free (certificate_value);
-  PyMem_Free (address);
+static gboolean
+PyTelco_peek_message_value (const gchar * json, const gchar * key, gchar * value)
+{
+  PyTelcoJsonParser parser;
+  gsize key_length;
 
-  return result;
-}
+  /*
+   * Looks up a top-level key and copies its value, which must be a string of at most
+   * PYTELCO_MAX_FILTER_VALUE_LENGTH bytes, into value. Like peek_message_tag() it never needs the GIL.
+   */
+  parser.start = json;
+  parser.cursor = json;
+  parser.end = json + strlen (json);
+  parser.depth = 0;
+  parser.scratch = NULL;
 
+  key_length = strlen (key);
 
-G_DEFINE_TYPE_EXTENDED (TelcoPythonAuthenticationService, telco_python_authentication_service, G_TYPE_OBJECT, 0,
-    G_IMPLEMENT_INTERFACE (TELCO_TYPE_AUTHENTICATION_SERVICE, telco_python_authentication_service_iface_init))
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor == parser.end || *parser.cursor != '{')
+    return FALSE;
+  parser.cursor++;
 
-static TelcoPythonAuthenticationService *
-telco_python_authentication_service_new (PyObject * callback)
-{
-  TelcoPythonAuthenticationService * service;
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor != parser.end && *parser.cursor == '}')
+    return FALSE;
 
-  service = g_object_new (TELCO_TYPE_PYTHON_AUTHENTICATION_SERVICE, NULL);
-  service->callback = callback;
-  Py_IncRef (callback);
+  while (TRUE)
+  {
+    const gchar * start, * name, * raw_value;
+    gsize name_length, raw_value_length;
 
-  return service;
-}
+    start = parser.cursor;
+    if (!PyTelcoJsonParser_scan_plain_string (&parser, &name, &name_length))
+    {
+      /* Keys with escapes never match, but still have to be stepped over. */
+      parser.cursor = start;
+      name = NULL;
+      name_length = 0;
+      if (!PyTelcoJsonParser_skip_value (&parser))
+        return FALSE;
+    }
 
-static void
-telco_python_authentication_service_class_init (TelcoPythonAuthenticationServiceClass * klass)
-{
-  GObjectClass * object_class = G_OBJECT_CLASS (klass);
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end || *parser.cursor != ':')
+      return FALSE;
+    parser.cursor++;
 
-  object_class->dispose = telco_python_authentication_service_dispose;
-}
+    if (name != NULL && name_length == key_length && memcmp (name, key, key_length) == 0)
+    {
+      GString * str;
+      gboolean valid;
 
-static void
-telco_python_authentication_service_iface_init (gpointer g_iface, gpointer iface_data)
-{
-  TelcoAuthenticationServiceIface * iface = g_iface;
+      start = parser.cursor;
+      if (PyTelcoJsonParser_scan_plain_string (&parser, &raw_value, &raw_value_length))
+      {
+        if (raw_value_length > PYTELCO_MAX_FILTER_VALUE_LENGTH)
+          return FALSE;
+        memcpy (value, raw_value, raw_value_length);
+        value[raw_value_length] = '\0';
+        return TRUE;
+      }
 
-  iface->authenticate = telco_python_authentication_service_authenticate;
-  iface->authenticate_finish = telco_python_authentication_service_authenticate_finish;
-}
+      /* Values with escapes are rare enough to take the slow path. */
+      parser.cursor = start;
+      str = g_string_new (NULL);
+      valid = PyTelcoJsonParser_scan_string (&parser, str) && str->len <= PYTELCO_MAX_FILTER_VALUE_LENGTH;
+      if (valid)
+        memcpy (value, str->str, str->len + 1);
+      g_string_free (str, TRUE);
 
-static void
-telco_python_authentication_service_init (TelcoPythonAuthenticationService * self)
-{
-  self->pool = g_thread_pool_new ((GFunc) telco_python_authentication_service_do_authenticate, self, 1, FALSE, NULL);
+      return valid;
+    }
+
+    if (!PyTelcoJsonParser_skip_value (&parser))
+      return FALSE;
+
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end || *parser.cursor != ',')
+      return FALSE;
+    parser.cursor++;
+  }
 }
 
-static void
-telco_python_authentication_service_dispose (GObject * object)
+static gboolean
+PyTelcoJsonParser_scan_string (PyTelcoJsonParser * self, GString * str)
 {
-  TelcoPythonAuthenticationService * self = TELCO_PYTHON_AUTHENTICATION_SERVICE (object);
+  /* Unlike parse_string() this one doesn't need the GIL. Lone surrogates come out as U+FFFD. */
+  PyTelcoJsonParser_skip_whitespace (self);
+  if (self->cursor == self->end || *self->cursor != '"')
+    return FALSE;
+  self->cursor++;
 
-  if (self->pool != NULL)
+  while (self->cursor != self->end)
   {
-    g_thread_pool_free (self->pool, FALSE, FALSE);
-    self->pool = NULL;
-  }
+    guchar ch = *self->cursor++;
+    gunichar c;
 
-  if (self->callback != NULL)
-  {
-    PyGILState_STATE gstate;
+    if (ch == '"')
+      return TRUE;
 
-    gstate = PyGILState_Ensure ();
+    if (ch < 0x20)
+      return FALSE;
 
-    Py_DECREF (self->callback);
-    self->callback = NULL;
+    if (ch != '\\')
+    {
+      g_string_append_c (str, ch);
+      continue;
+    }
 
-    PyGILState_Release (gstate);
+    if (self->cursor == self->end)
+      return FALSE;
+
+    switch (*self->cursor++)
+    {
+      case '"':  g_string_append_c (str, '"');  break;
+      case '\\': g_string_append_c (str, '\\'); break;
+      case '/':  g_string_append_c (str, '/');  break;
+      case 'b':  g_string_append_c (str, '\b'); break;
+      case 'f':  g_string_append_c (str, '\f'); break;
+      case 'n':  g_string_append_c (str, '\n'); break;
+      case 'r':  g_string_append_c (str, '\r'); break;
+      case 't':  g_string_append_c (str, '\t'); break;
+      case 'u':
+        if (!PyTelcoJsonParser_scan_hex4 (self, &c))
+          return FALSE;
+
+        if (c >= 0xd800 && c <= 0xdbff && self->end - self->cursor >= 6 && self->cursor[0] == '\\' && self->cursor[1] == 'u')
+        {
+          const gchar * high_end = self->cursor;
+          gunichar low;
+
+          self->cursor += 2;
+          if (PyTelcoJsonParser_scan_hex4 (self, &low) && low >= 0xdc00 && low <= 0xdfff)
+            c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+          else
+            self->cursor = high_end;
+        }
+
+        g_string_append_unichar (str, (c >= 0xd800 && c <= 0xdfff) ? 0xfffd : c);
+        break;
+      default:
+        return FALSE;
+    }
   }
 
-  G_OBJECT_CLASS (telco_python_authentication_service_parent_class)->dispose (object);
+  return FALSE;
 }
 
-static void
-telco_python_authentication_service_authenticate (TelcoAuthenticationService * service, const gchar * token, GCancellable * cancellable,
-    GAsyncReadyCallback callback, gpointer user_data)
+static gboolean
+PyTelcoJsonParser_scan_hex4 (PyTelcoJsonParser * self, gunichar * c)
 {
-  TelcoPythonAuthenticationService * self;
-  GTask * task;
+  guint i;
 
-  self = TELCO_PYTHON_AUTHENTICATION_SERVICE (service);
+  if (self->end - self->cursor < 4)
+    return FALSE;
 
-  task = g_task_new (self, cancellable, callback, user_data);
-  g_task_set_task_data (task, g_strdup (token), g_free);
+  *c = 0;
+  for (i = 0; i != 4; i++)
+  {
+    gint digit = g_ascii_xdigit_value (self->cursor[i]);
 
-  g_thread_pool_push (self->pool, task, NULL);
-}
+    if (digit == -1)
+      return FALSE;
+    *c = (*c << 4) | digit;
+  }
+  self->cursor += 4;
 
-static gchar *
-telco_python_authentication_service_authenticate_finish (TelcoAuthenticationService * service, GAsyncResult * result, GError ** error)
-{
-  return g_task_propagate_pointer (G_TASK (result), error);
+  return TRUE;
 }
 
-static void
-telco_python_authentication_service_do_authenticate (GTask * task, TelcoPythonAuthenticationService * self)
+static gboolean
+PyTelco_peek_log_message (const gchar * json, PyTelcoLogLevel * level, GString * text)
 {
-  const gchar * token;
-  PyGILState_STATE gstate;
-  PyObject * result;
-  gchar * session_info = NULL;
-  gchar * message = NULL;
+  PyTelcoJsonParser parser;
+  gboolean is_log = FALSE, has_payload = FALSE;
 
-  token = g_task_get_task_data (task);
+  parser.start = json;
+  parser.cursor = json;
+  parser.end = json + strlen (json);
+  parser.depth = 0;
+  parser.scratch = NULL;
 
-  gstate = PyGILState_Ensure ();
+  *level = PYTELCO_LOG_LEVEL_INFO;
 
-  result = PyObject_CallFunction (self->callback, "s", token);
-  if (result == NULL || !PyGObject_unmarshal_string (result, &session_info))
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor == parser.end || *parser.cursor != '{')
+    return FALSE;
+  parser.cursor++;
+
+  PyTelcoJsonParser_skip_whitespace (&parser);
+  if (parser.cursor != parser.end && *parser.cursor == '}')
+    return FALSE;
+
+  while (TRUE)
   {
-    PyObject * type, * value, * traceback;
+    const gchar * key, * value;
+    gsize key_length, value_length;
+    gboolean valid;
 
-    PyErr_Fetch (&type, &value, &traceback);
+    if (!PyTelcoJsonParser_scan_plain_string (&parser, &key, &key_length))
+      return FALSE;
 
-    if (value != NULL)
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end || *parser.cursor != ':')
+      return FALSE;
+    parser.cursor++;
+
+    if (key_length == 4 && memcmp (key, "type", 4) == 0)
     {
-      PyObject * message_value = PyObject_Str (value);
-      PyGObject_unmarshal_string (message_value, &message);
-      Py_DECREF (message_value);
+      valid = PyTelcoJsonParser_scan_plain_string (&parser, &value, &value_length);
+      is_log = valid && value_length == 3 && memcmp (value, "log", 3) == 0;
+      if (!is_log)
+        return FALSE;
+    }
+    else if (key_length == 5 && memcmp (key, "level", 5) == 0)
+    {
+      valid = PyTelcoJsonParser_scan_plain_string (&parser, &value, &value_length);
+      if (valid && !PyTelco_parse_log_level (value, value_length, level))
+        *level = PYTELCO_LOG_LEVEL_INFO;
+    }
+    else if (key_length == 7 && memcmp (key, "payload", 7) == 0)
+    {
+      valid = has_payload = PyTelcoJsonParser_scan_string (&parser, text);
     }
     else
     {
-      message = g_strdup ("Internal error");
+      valid = PyTelcoJsonParser_skip_value (&parser);
     }
+    if (!valid)
+      return FALSE;
 
-    Py_DECREF (type);
-    Py_XDECREF (value);
-    Py_XDECREF (traceback);
+    PyTelcoJsonParser_skip_whitespace (&parser);
+    if (parser.cursor == parser.end)
+      return FALSE;
+    if (*parser.cursor == '}')
+      break;
+    if (*parser.cursor != ',')
+      return FALSE;
+    parser.cursor++;
   }
 
-  Py_XDECREF (result);
+  return is_log && has_payload;
+}
 
-  PyGILState_Release (gstate);
+static gboolean
+PyTelco_parse_log_level (const gchar * name, gsize length, PyTelcoLogLevel * level)
+{
+  guint i;
 
-  if (session_info != NULL)
-    g_task_return_pointer (task, session_info, g_free);
-  else
-    g_task_return_new_error (task, TELCO_ERROR, TELCO_ERROR_INVALID_ARGUMENT, "%s", message);
+  for (i = 0; i != G_N_ELEMENTS (pytelco_log_level_names); i++)
+  {
+    if (strlen (pytelco_log_level_names[i]) == length && memcmp (pytelco_log_level_names[i], name, length) == 0)
+    {
+      *level = i;
+      return TRUE;
+    }
+  }
 
-  g_free (message);
-  g_object_unref (task);
+  return FALSE;
 }
 
+static PyObject *
+PyTelcoJsonParser_raise (PyTelcoJsonParser * self, const gchar * message)
+{
+  return PyErr_Format (PyExc_ValueError, "%s: char %zd", message, (Py_ssize_t) (self->cursor - self->start));
+}
 
-static int
-PyCompiler_init (PyCompiler * self, PyObject * args, PyObject * kw)
+static PyObject *
+PyTelco_cbor_encode (PyObject * self, PyObject * args)
 {
-  PyDeviceManager * manager;
+  PyObject * value, * result;
+  GByteArray * buffer;
 
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  if (!PyArg_ParseTuple (args, "O", &value))
+    return NULL;
 
-  if (!PyArg_ParseTuple (args, "O!", PYTELCO_TYPE_OBJECT (DeviceManager), &manager))
-    return -1;
+  buffer = g_byte_array_new ();
 
-  PyGObject_take_handle (&self->parent, telco_compiler_new (PY_GOBJECT_HANDLE (manager)), PYTELCO_TYPE (Compiler));
+  if (PyTelco_cbor_encode_value (buffer, value, 0))
+    result = PyBytes_FromStringAndSize ((const char *) buffer->data, buffer->len);
+  else
+    result = NULL;
 
-  return 0;
+  g_byte_array_unref (buffer);
+
+  return result;
 }
 
-static PyObject *
-PyCompiler_build (PyCompiler * self, PyObject * args, PyObject * kw)
+static gboolean
+PyTelco_cbor_encode_value (GByteArray * buffer, PyObject * value, guint depth)
 {
-  PyObject * result;
-  static char * keywords[] = { "entrypoint", "project_root", "source_maps", "compression", NULL };
-  const char * entrypoint;
-  const char * project_root = NULL;
-  const char * source_maps = NULL;
-  const char * compression = NULL;
-  TelcoBuildOptions * options;
-  GError * error = NULL;
-  gchar * bundle;
-
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "s|sss", keywords, &entrypoint, &project_root, &source_maps, &compression))
-    return NULL;
+  if (depth > PYTELCO_CBOR_MAX_DEPTH)
+    goto nesting_too_deep;
 
-  options = telco_build_options_new ();
-  if (!PyCompiler_set_options (TELCO_COMPILER_OPTIONS (options), project_root, source_maps, compression))
-    goto invalid_option_value;
-
-  Py_BEGIN_ALLOW_THREADS
-  bundle = telco_compiler_build_sync (PY_GOBJECT_HANDLE (self), entrypoint, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  if (value == Py_None)
+  {
+    PyTelco_cbor_append_head (buffer, 7, 22);
+  }
+  else if (PyBool_Check (value))
+  {
+    PyTelco_cbor_append_head (buffer, 7, (value == Py_True) ? 21 : 20);
+  }
+  else if (PyLong_Check (value))
+  {
+    return PyTelco_cbor_encode_int (buffer, value);
+  }
+  else if (PyFloat_Check (value))
+  {
+    union
+    {
+      gdouble d;
+      guint64 u;
+    } bits;
+    guint8 head = (7 << 5) | 27;
 
-  g_object_unref (options);
+    bits.d = PyFloat_AsDouble (value);
+    bits.u = GUINT64_TO_BE (bits.u);
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+    g_byte_array_append (buffer, &head, 1);
+    g_byte_array_append (buffer, (const guint8 *) &bits.u, sizeof (bits.u));
+  }
+  else if (PyUnicode_Check (value))
+  {
+    PyObject * utf8;
 
-  result = PyUnicode_FromUTF8String (bundle);
-  g_free (bundle);
+    utf8 = PyUnicode_AsUTF8String (value);
+    if (utf8 == NULL)
+      return FALSE;
 
-  return result;
+    PyTelco_cbor_append_head (buffer, 3, PyBytes_Size (utf8));
+    g_byte_array_append (buffer, (const guint8 *) PyBytes_AsString (utf8), PyBytes_Size (utf8));
 
-invalid_option_value:
+    Py_DECREF (utf8);
+  }
+  else if (PyBytes_Check (value))
   {
-    g_object_unref (options);
-    return NULL;
+    PyTelco_cbor_append_head (buffer, 2, PyBytes_Size (value));
+    g_byte_array_append (buffer, (const guint8 *) PyBytes_AsString (value), PyBytes_Size (value));
   }
-}
+  else if (PyByteArray_Check (value))
+  {
+    PyTelco_cbor_append_head (buffer, 2, PyByteArray_Size (value));
+    g_byte_array_append (buffer, (const guint8 *) PyByteArray_AsString (value), PyByteArray_Size (value));
+  }
+  else if (PyList_Check (value) || PyTuple_Check (value))
+  {
+    Py_ssize_t n, i;
 
-static PyObject *
-PyCompiler_watch (PyCompiler * self, PyObject * args, PyObject * kw)
-{
-  static char * keywords[] = { "entrypoint", "project_root", "source_maps", "compression", NULL };
-  const char * entrypoint;
-  const char * project_root = NULL;
-  const char * source_maps = NULL;
-  const char * compression = NULL;
-  TelcoWatchOptions * options;
-  GError * error = NULL;
+    n = PySequence_Size (value);
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "s|sss", keywords, &entrypoint, &project_root, &source_maps, &compression))
-    return NULL;
+    PyTelco_cbor_append_head (buffer, 4, n);
 
-  options = telco_watch_options_new ();
-  if (!PyCompiler_set_options (TELCO_COMPILER_OPTIONS (options), project_root, source_maps, compression))
-    goto invalid_option_value;
+    for (i = 0; i != n; i++)
+    {
+      PyObject * element;
+      gboolean success;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_compiler_watch_sync (PY_GOBJECT_HANDLE (self), entrypoint, options, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+      element = PySequence_GetItem (value, i);
+      success = PyTelco_cbor_encode_value (buffer, element, depth + 1);
+      Py_DECREF (element);
+      if (!success)
+        return FALSE;
+    }
+  }
+  else if (PyDict_Check (value))
+  {
+    Py_ssize_t pos;
+    PyObject * key, * element;
 
-  g_object_unref (options);
+    PyTelco_cbor_append_head (buffer, 5, PyDict_Size (value));
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+    pos = 0;
+    while (PyDict_Next (value, &pos, &key, &element))
+    {
+      if (!PyTelco_cbor_encode_value (buffer, key, depth + 1) || !PyTelco_cbor_encode_value (buffer, element, depth + 1))
+        return FALSE;
+    }
+  }
+  else
+  {
+    goto unsupported_type;
+  }
 
-  Py_RETURN_NONE;
+  return TRUE;
 
-invalid_option_value:
+nesting_too_deep:
   {
-    g_object_unref (options);
-    return NULL;
+    PyErr_SetString (PyExc_ValueError, "nesting too deep");
+    return FALSE;
+  }
+unsupported_type:
+  {
+    PyErr_SetString (PyExc_TypeError, "unsupported type");
+    return FALSE;
   }
 }
 
 static gboolean
-PyCompiler_set_options (TelcoCompilerOptions * options, const gchar * project_root_value, const gchar * source_maps_value,
-    const gchar * compression_value)
+PyTelco_cbor_encode_int (GByteArray * buffer, PyObject * value)
 {
-  if (project_root_value != NULL)
-    telco_compiler_options_set_project_root (options, project_root_value);
+  PY_LONG_LONG l;
+  unsigned PY_LONG_LONG ul;
+  PyObject * complement;
 
-  if (source_maps_value != NULL)
+  l = PyLong_AsLongLong (value);
+  if (l != -1 || !PyErr_Occurred ())
   {
-    TelcoSourceMaps source_maps;
+    if (l >= 0)
+      PyTelco_cbor_append_head (buffer, 0, l);
+    else
+      PyTelco_cbor_append_head (buffer, 1, (guint64) -(l + 1));
+    return TRUE;
+  }
 
-    if (!PyGObject_unmarshal_enum (source_maps_value, TELCO_TYPE_SOURCE_MAPS, &source_maps))
-      return FALSE;
+  if (!PyErr_ExceptionMatches (PyExc_OverflowError))
+    return FALSE;
+  PyErr_Clear ();
 
-    telco_compiler_options_set_source_maps (options, source_maps);
+  ul = PyLong_AsUnsignedLongLong (value);
+  if (ul != (unsigned PY_LONG_LONG) -1 || !PyErr_Occurred ())
+  {
+    PyTelco_cbor_append_head (buffer, 0, ul);
+    return TRUE;
   }
 
-  if (compression_value != NULL)
-  {
-    TelcoJsCompression compression;
+  if (!PyErr_ExceptionMatches (PyExc_OverflowError))
+    return FALSE;
+  PyErr_Clear ();
 
-    if (!PyGObject_unmarshal_enum (compression_value, TELCO_TYPE_JS_COMPRESSION, &compression))
-      return FALSE;
+  /* Negative integers are encoded as -1 - n, which is exactly what ~n gives us. */
+  complement = PyNumber_Invert (value);
+  if (complement == NULL)
+    return FALSE;
+  ul = PyLong_AsUnsignedLongLong (complement);
+  Py_DECREF (complement);
+  if (ul == (unsigned PY_LONG_LONG) -1 && PyErr_Occurred ())
+    return FALSE;
 
-    telco_compiler_options_set_compression (options, compression);
-  }
+  PyTelco_cbor_append_head (buffer, 1, ul);
 
   return TRUE;
 }
 
-
-static int
-PyFileMonitor_init (PyFileMonitor * self, PyObject * args, PyObject * kw)
+static void
+PyTelco_cbor_append_head (GByteArray * buffer, guint8 major_type, guint64 argument)
 {
-  const char * path;
+  guint8 head[9];
+  guint size, i;
 
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
-
-  if (!PyArg_ParseTuple (args, "s", &path))
-    return -1;
+  if (argument < 24)
+  {
+    head[0] = (major_type << 5) | argument;
+    size = 0;
+  }
+  else if (argument <= G_MAXUINT8)
+  {
+    head[0] = (major_type << 5) | 24;
+    size = 1;
+  }
+  else if (argument <= G_MAXUINT16)
+  {
+    head[0] = (major_type << 5) | 25;
+    size = 2;
+  }
+  else if (argument <= G_MAXUINT32)
+  {
+    head[0] = (major_type << 5) | 26;
+    size = 4;
+  }
+  else
+  {
+    head[0] = (major_type << 5) | 27;
+    size = 8;
+  }
 
-  PyGObject_take_handle (&self->parent, telco_file_monitor_new (path), PYTELCO_TYPE (FileMonitor));
+  for (i = 0; i != size; i++)
+    head[1 + i] = (argument >> (8 * (size - 1 - i))) & 0xff;
 
-  return 0;
+  g_byte_array_append (buffer, head, 1 + size);
 }
 
 static PyObject *
-PyFileMonitor_enable (PyFileMonitor * self)
+PyTelco_cbor_decode (PyObject * self, PyObject * args)
 {
-  GError * error = NULL;
-
-  Py_BEGIN_ALLOW_THREADS
-  telco_file_monitor_enable_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  const char * data;
+  Py_ssize_t size;
+  PyTelcoCborParser parser;
+  PyObject * result;
 
-  Py_RETURN_NONE;
-}
+  if (!PyArg_ParseTuple (args, "y#", &data, &size))
+    return NULL;
 
-static PyObject *
-PyFileMonitor_disable (PyFileMonitor * self)
-{
-  GError * error = NULL;
+  parser.start = (const guint8 *) data;
+  parser.cursor = parser.start;
+  parser.end = parser.start + size;
+  parser.depth = 0;
 
-  Py_BEGIN_ALLOW_THREADS
-  telco_file_monitor_disable_sync (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+  result = PyTelcoCborParser_parse_value (&parser);
+  if (result != NULL && parser.cursor != parser.end)
+  {
+    Py_CLEAR (result);
+    PyTelcoCborParser_raise (&parser, "extra data");
+  }
 
-  Py_RETURN_NONE;
+  return result;
 }
 
-
 static PyObject *
-PyIOStream_new_take_handle (GIOStream * handle)
+PyTelcoCborParser_parse_value (PyTelcoCborParser * self)
 {
-  return PyGObject_new_take_handle (handle, PYTELCO_TYPE (IOStream));
-}
+  guint8 major_type, info;
+  guint64 argument;
+  gsize remaining;
 
-static int
-PyIOStream_init (PyIOStream * self, PyObject * args, PyObject * kw)
-{
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  do
+  {
+    if (self->cursor == self->end)
+      return PyTelcoCborParser_raise (self, "expecting value");
 
-  self->input = NULL;
-  self->output = NULL;
+    major_type = *self->cursor >> 5;
+    info = *self->cursor & 0x1f;
+    self->cursor++;
 
-  return 0;
-}
+    if (major_type == 7)
+      return PyTelcoCborParser_parse_simple (self, info);
 
-static void
-PyIOStream_init_from_handle (PyIOStream * self, GIOStream * handle)
-{
-  self->input = g_io_stream_get_input_stream (handle);
-  self->output = g_io_stream_get_output_stream (handle);
-}
+    if (!PyTelcoCborParser_read_argument (self, info, &argument))
+      return NULL;
+  }
+  while (major_type == 6); /* Tags carry no meaning for us, so just decode what they wrap. */
 
-static PyObject *
-PyIOStream_repr (PyIOStream * self)
-{
-  GIOStream * handle = PY_GOBJECT_HANDLE (self);
+  remaining = self->end - self->cursor;
 
-  return PyRepr_FromFormat ("IOStream(handle=%p, is_closed=%s)",
-      handle,
-      g_io_stream_is_closed (handle) ? "TRUE" : "FALSE");
-}
+  switch (major_type)
+  {
+    case 0:
+      return PyLong_FromUnsignedLongLong (argument);
 
-static PyObject *
-PyIOStream_is_closed (PyIOStream * self)
-{
-  return PyBool_FromLong (g_io_stream_is_closed (PY_GOBJECT_HANDLE (self)));
-}
+    case 1:
+    {
+      PyObject * magnitude, * result;
 
-static PyObject *
-PyIOStream_close (PyIOStream * self)
-{
-  GError * error = NULL;
+      if (argument <= G_MAXINT64)
+        return PyLong_FromLongLong (-1 - (gint64) argument);
 
-  Py_BEGIN_ALLOW_THREADS
-  g_io_stream_close (PY_GOBJECT_HANDLE (self), g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
-  if (error != NULL)
-    return PyTelco_raise (error);
+      magnitude = PyLong_FromUnsignedLongLong (argument);
+      result = PyNumber_Invert (magnitude);
+      Py_DECREF (magnitude);
+
+      return result;
+    }
+
+    case 2:
+    case 3:
+    {
+      const gchar * data = (const gchar *) self->cursor;
 
-  Py_RETURN_NONE;
+      if (argument > remaining)
+        return PyTelcoCborParser_raise (self, "truncated string");
+      self->cursor += argument;
+
+      if (major_type == 2)
+        return PyBytes_FromStringAndSize (data, argument);
+      return PyUnicode_DecodeUTF8 (data, argument, "strict");
+    }
+
+    case 4:
+      return PyTelcoCborParser_parse_array (self, argument);
+
+    default:
+      return PyTelcoCborParser_parse_map (self, argument);
+  }
 }
 
 static PyObject *
-PyIOStream_read (PyIOStream * self, PyObject * args)
+PyTelcoCborParser_parse_array (PyTelcoCborParser * self, guint64 length)
 {
   PyObject * result;
-  unsigned long count;
-  PyObject * buffer;
-  GError * error = NULL;
-  gssize bytes_read;
+  guint64 i;
 
-  if (!PyArg_ParseTuple (args, "k", &count))
-    return NULL;
-
-  buffer = PyBytes_FromStringAndSize (NULL, count);
-  if (buffer == NULL)
-    return NULL;
+  /* Every element takes at least one byte, which bounds what we are willing to allocate. */
+  if (length > (guint64) (self->end - self->cursor))
+    return PyTelcoCborParser_raise (self, "truncated array");
 
-  Py_BEGIN_ALLOW_THREADS
-  bytes_read = g_input_stream_read (self->input, PyBytes_AsString (buffer), count, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  if (++self->depth > PYTELCO_CBOR_MAX_DEPTH)
+    return PyTelcoCborParser_raise (self, "nesting too deep");
 
-  if (error == NULL)
+  result = PyList_New (length);
+  if (result == NULL)
   {
-    if ((unsigned long) bytes_read == count)
-    {
-      result = buffer;
-    }
-    else
-    {
-      result = PyBytes_FromStringAndSize (PyBytes_AsString (buffer), bytes_read);
-
-      Py_DECREF (buffer);
-    }
+    self->depth--;
+    return NULL;
   }
-  else
+
+  for (i = 0; i != length; i++)
   {
-    result = PyTelco_raise (error);
+    PyObject * element;
 
-    Py_DECREF (buffer);
+    element = PyTelcoCborParser_parse_value (self);
+    if (element == NULL)
+      goto propagate_error;
+
+    PyList_SetItem (result, i, element);
   }
 
+  self->depth--;
+
   return result;
+
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
 }
 
 static PyObject *
-PyIOStream_read_all (PyIOStream * self, PyObject * args)
+PyTelcoCborParser_parse_map (PyTelcoCborParser * self, guint64 length)
 {
   PyObject * result;
-  unsigned long count;
-  PyObject * buffer;
-  gsize bytes_read;
-  GError * error = NULL;
-
-  if (!PyArg_ParseTuple (args, "k", &count))
-    return NULL;
+  guint64 i;
 
-  buffer = PyBytes_FromStringAndSize (NULL, count);
-  if (buffer == NULL)
-    return NULL;
+  if (length > (guint64) (self->end - self->cursor) / 2)
+    return PyTelcoCborParser_raise (self, "truncated map");
 
-  Py_BEGIN_ALLOW_THREADS
-  g_input_stream_read_all (self->input, PyBytes_AsString (buffer), count, &bytes_read, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  if (++self->depth > PYTELCO_CBOR_MAX_DEPTH)
+    return PyTelcoCborParser_raise (self, "nesting too deep");
 
-  if (error == NULL)
+  result = PyDict_New ();
+  if (result == NULL)
   {
-    result = buffer;
+    self->depth--;
+    return NULL;
   }
-  else
+
+  for (i = 0; i != length; i++)
   {
-    result = PyTelco_raise (error);
+    PyObject * key, * value;
+    int set_result;
 
-    Py_DECREF (buffer);
+    key = PyTelcoCborParser_parse_value (self);
+    if (key == NULL)
+      goto propagate_error;
+
+    value = PyTelcoCborParser_parse_value (self);
+    if (value == NULL)
+    {
+      Py_DECREF (key);
+      goto propagate_error;
+    }
+
+    set_result = PyDict_SetItem (result, key, value);
+    Py_DECREF (value);
+    Py_DECREF (key);
+    if (set_result == -1)
+      goto propagate_error;
   }
 
+  self->depth--;
+
   return result;
+
+propagate_error:
+  {
+    Py_DECREF (result);
+    return NULL;
+  }
 }
 
 static PyObject *
-PyIOStream_write (PyIOStream * self, PyObject * args)
+PyTelcoCborParser_parse_simple (PyTelcoCborParser * self, guint8 info)
 {
-  const char * data;
-  Py_ssize_t size;
-  GError * error = NULL;
-  gssize bytes_written;
+  guint64 argument;
 
-  if (!PyArg_ParseTuple (args, "y#", &data, &size))
-    return NULL;
+  switch (info)
+  {
+    case 20:
+      Py_RETURN_FALSE;
 
-  Py_BEGIN_ALLOW_THREADS
-  bytes_written = g_output_stream_write (self->output, data, size, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+    case 21:
+      Py_RETURN_TRUE;
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+    case 22:
+    case 23:
+      Py_RETURN_NONE;
 
-  return PyLong_FromSsize_t (bytes_written);
-}
+    case 25:
+    case 26:
+    case 27:
+      break;
 
-static PyObject *
-PyIOStream_write_all (PyIOStream * self, PyObject * args)
-{
-  const char * data;
-  Py_ssize_t size;
-  GError * error = NULL;
+    default:
+      self->cursor--;
+      return PyTelcoCborParser_raise (self, "unsupported simple value");
+  }
 
-  if (!PyArg_ParseTuple (args, "y#", &data, &size))
+  if (!PyTelcoCborParser_read_argument (self, info, &argument))
     return NULL;
 
-  Py_BEGIN_ALLOW_THREADS
-  g_output_stream_write_all (self->output, data, size, NULL, g_cancellable_get_current (), &error);
-  Py_END_ALLOW_THREADS
+  if (info == 25)
+    return PyFloat_FromDouble (PyTelcoCborParser_decode_half (argument));
 
-  if (error != NULL)
-    return PyTelco_raise (error);
+  if (info == 26)
+  {
+    union
+    {
+      gfloat f;
+      guint32 u;
+    } bits;
 
-  Py_RETURN_NONE;
-}
+    bits.u = argument;
 
+    return PyFloat_FromDouble (bits.f);
+  }
 
-static PyObject *
-PyCancellable_new_take_handle (GCancellable * handle)
+  {
+    union
+    {
+      gdouble d;
+      guint64 u;
+    } bits;
+
+    bits.u = argument;
+
+    return PyFloat_FromDouble (bits.d);
+  }
+}
+
+static gboolean
+PyTelcoCborParser_read_argument (PyTelcoCborParser * self, guint8 info, guint64 * argument)
 {
-  PyObject * object;
+  guint size, i;
 
-  object = (handle != NULL) ? PyGObject_try_get_from_handle (handle) : NULL;
-  if (object == NULL)
+  if (info < 24)
   {
-    object = PyObject_CallFunction (PYTELCO_TYPE_OBJECT (Cancellable), "z#", (char *) &handle, (Py_ssize_t) sizeof (handle));
+    *argument = info;
+    return TRUE;
   }
-  else
+
+  if (info > 27)
   {
-    g_object_unref (handle);
-    Py_INCREF (object);
+    PyTelcoCborParser_raise (self, "indefinite-length items are not supported");
+    return FALSE;
   }
 
-  return object;
-}
+  size = 1 << (info - 24);
+  if ((gsize) (self->end - self->cursor) < size)
+  {
+    PyTelcoCborParser_raise (self, "truncated argument");
+    return FALSE;
+  }
 
-static int
-PyCancellable_init (PyCancellable * self, PyObject * args, PyObject * kw)
-{
-  static char * keywords[] = { "handle", NULL };
-  GCancellable ** handle_buffer = NULL;
-  Py_ssize_t handle_size = 0;
-  GCancellable * handle;
+  *argument = 0;
+  for (i = 0; i != size; i++)
+    *argument = (*argument << 8) | self->cursor[i];
+  self->cursor += size;
 
-  if (PyGObject_tp_init ((PyObject *) self, args, kw) < 0)
-    return -1;
+  return TRUE;
+}
 
-  if (!PyArg_ParseTupleAndKeywords (args, kw, "|z#", keywords, &handle_buffer, &handle_size))
-    return -1;
+static gdouble
+PyTelcoCborParser_decode_half (guint16 half)
+{
+  gint exponent = (half >> 10) & 0x1f;
+  gint mantissa = half & 0x3ff;
+  gdouble value;
 
-  if (handle_size == sizeof (gpointer))
-    handle = *handle_buffer;
+  if (exponent == 0)
+    value = ldexp (mantissa, -24);
+  else if (exponent != 31)
+    value = ldexp (mantissa + 1024, exponent - 25);
   else
-    handle = g_cancellable_new ();
-
-  PyGObject_take_handle (&self->parent, handle, PYTELCO_TYPE (Cancellable));
+    value = (mantissa == 0) ? HUGE_VAL : NAN;
 
-  return 0;
+  return ((half & 0x8000) != 0) ? -value : value;
 }
 
 static PyObject *
-PyCancellable_repr (PyCancellable * self)
+PyTelcoCborParser_raise (PyTelcoCborParser * self, const gchar * message)
 {
-  GCancellable * handle = PY_GOBJECT_HANDLE (self);
-
-  return PyRepr_FromFormat ("Cancellable(handle=%p, is_cancelled=%s)",
-      handle,
-      g_cancellable_is_cancelled (handle) ? "TRUE" : "FALSE");
+  return PyErr_Format (PyExc_ValueError, "%s: byte %zd", message, (Py_ssize_t) (self->cursor - self->start));
 }
 
+
 static PyObject *
-PyCancellable_is_cancelled (PyCancellable * self)
+PyTelco_start_dispatcher (PyObject * self, PyObject * args, PyObject * kw)
 {
-  return PyBool_FromLong (g_cancellable_is_cancelled (PY_GOBJECT_HANDLE (self)));
+  static char * keywords[] = { "threads", NULL };
+  int threads = 1;
+  GAsyncQueue ** lanes;
+  int i;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|i", keywords, &threads))
+    return NULL;
+
+  if (threads < 1 || threads > PYTELCO_DISPATCHER_MAX_LANES)
+  {
+    PyErr_Format (PyExc_ValueError, "threads must be between 1 and %d", PYTELCO_DISPATCHER_MAX_LANES);
+    return NULL;
+  }
+
+  /* Lanes are never freed nor resized, as the emitting thread may still be about to push onto one. */
+  if (dispatcher_threads != NULL)
+  {
+    PyErr_SetString (PyExc_RuntimeError, "dispatcher has already been started");
+    return NULL;
+  }
+
+  lanes = g_new (GAsyncQueue *, threads);
+  dispatcher_threads = g_new (GThread *, threads);
+  for (i = 0; i != threads; i++)
+  {
+    lanes[i] = g_async_queue_new ();
+    dispatcher_threads[i] = g_thread_new ("telco-dispatcher", (GThreadFunc) PyTelco_process_dispatcher_lane, lanes[i]);
+  }
+
+  dispatcher_lane_count = threads;
+  g_atomic_pointer_set (&dispatcher_lanes, lanes);
+
+  Py_RETURN_NONE;
 }
 
 static PyObject *
-PyCancellable_raise_if_cancelled (PyCancellable * self)
+PyTelco_stop_dispatcher (PyObject * self)
 {
-  GError * error = NULL;
+  GAsyncQueue ** lanes;
+  guint i;
 
-  g_cancellable_set_error_if_cancelled (PY_GOBJECT_HANDLE (self), &error);
-  if (error != NULL)
-    return PyTelco_raise (error);
+  lanes = g_atomic_pointer_get (&dispatcher_lanes);
+  if (lanes == NULL)
+    Py_RETURN_NONE;
+  g_atomic_pointer_set (&dispatcher_lanes, NULL);
+
+  /* Events without a closure tell the lane to stop once everything ahead of them has been delivered. */
+  for (i = 0; i != dispatcher_lane_count; i++)
+  {
+    PyGObjectSignalEvent * stop_event;
+
+    stop_event = g_slice_new0 (PyGObjectSignalEvent);
+    stop_event->priority = PY_GOBJECT_SIGNAL_PRIORITY_NORMAL;
+    stop_event->serial = G_MAXUINT;
+    g_async_queue_push (lanes[i], stop_event);
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  for (i = 0; i != dispatcher_lane_count; i++)
+    g_thread_join (dispatcher_threads[i]);
+  Py_END_ALLOW_THREADS
+
+  /* Anything that raced past the stop event would otherwise keep its closure alive forever. */
+  for (i = 0; i != dispatcher_lane_count; i++)
+  {
+    PyGObjectSignalEvent * event;
+
+    while ((event = g_async_queue_try_pop (lanes[i])) != NULL)
+      PyGObjectSignalEvent_free (event);
+  }
 
   Py_RETURN_NONE;
 }
 
-static PyObject *
-PyCancellable_get_fd (PyCancellable * self)
+static gpointer
+PyTelco_process_dispatcher_lane (GAsyncQueue * lane)
 {
-  return PyLong_FromLong (g_cancellable_get_fd (PY_GOBJECT_HANDLE (self)));
+  gboolean stopping = FALSE;
+
+  while (!stopping)
+  {
+    PyGObjectSignalEvent * events[PYTELCO_DISPATCHER_MAX_EVENTS_PER_WAKEUP], * event;
+    guint n, i;
+
+    n = 0;
+    event = g_async_queue_pop (lane);
+    do
+    {
+      if (event->closure == NULL)
+      {
+        g_slice_free (PyGObjectSignalEvent, event);
+        stopping = TRUE;
+        break;
+      }
+      events[n++] = event;
+    }
+    while (n != G_N_ELEMENTS (events) && (event = g_async_queue_try_pop (lane)) != NULL);
+
+    if (n == 0)
+      continue;
+
+    if (g_atomic_int_get (&toplevel_objects_alive) != 0)
+    {
+      PyGILState_STATE gstate;
+
+      gstate = PyTelco_ensure_gil (PYTELCO_GIL_SITE_DISPATCHER);
+
+      for (i = 0; i != n; i++)
+      {
+        event = events[i];
+
+        if (!event->closure->parent.is_invalid)
+          PyGObjectSignalClosure_deliver (event->closure, (const GValue *) event->values->data, event->length, event->stride);
+      }
+
+      PyGILState_Release (gstate);
+    }
+
+    for (i = 0; i != n; i++)
+      PyGObjectSignalEvent_free (events[i]);
+  }
+
+  return NULL;
 }
 
 static PyObject *
-PyCancellable_release_fd (PyCancellable * self)
+PyTelco_set_watchdog (PyObject * self, PyObject * args, PyObject * kw)
 {
-  g_cancellable_release_fd (PY_GOBJECT_HANDLE (self));
+  static char * keywords[] = { "threshold", "hook", NULL };
+  double threshold;
+  PyObject * hook = Py_None;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "d|O", keywords, &threshold, &hook))
+    return NULL;
+
+  if (hook != Py_None && !PyCallable_Check (hook))
+  {
+    PyErr_SetString (PyExc_TypeError, "hook must be callable or None");
+    return NULL;
+  }
+
+  Py_CLEAR (watchdog_hook);
+
+  /* A negative threshold stops timing, but keeps the statistics gathered so far around. */
+  if (threshold < 0)
+  {
+    watchdog_threshold = -1;
+    Py_RETURN_NONE;
+  }
+
+  if (watchdog_stats == NULL)
+    watchdog_stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) PyTelcoCallbackStats_free);
+
+  if (hook != Py_None)
+  {
+    Py_INCREF (hook);
+    watchdog_hook = hook;
+  }
+
+  watchdog_threshold = (gint64) (threshold * G_USEC_PER_SEC);
 
   Py_RETURN_NONE;
 }
 
 static PyObject *
-PyCancellable_get_current (PyCancellable * self)
+PyTelco_get_callback_stats (PyObject * self, PyObject * args)
 {
-  GCancellable * handle;
+  PyObject * result;
+  GHashTableIter iter;
+  PyTelcoCallbackStats * stats;
 
-  handle = g_cancellable_get_current ();
+  result = PyList_New (0);
+  if (watchdog_stats == NULL)
+    return result;
 
-  if (handle != NULL)
-    g_object_ref (handle);
+  g_hash_table_iter_init (&iter, watchdog_stats);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &stats))
+  {
+    PyObject * item;
+
+    item = Py_BuildValue ("{s:s,s:N,s:K,s:K,s:d,s:d,s:N}",
+        "signal", stats->signal_name,
+        "callback", PyUnicode_DecodeUTF8 (stats->callback_name, strlen (stats->callback_name), "replace"),
+        "calls", (unsigned long long) stats->calls,
+        "slow", (unsigned long long) stats->slow,
+        "total_time", (double) stats->total_time / G_USEC_PER_SEC,
+        "max_time", (double) stats->max_time / G_USEC_PER_SEC,
+        "histogram", PyTelco_marshal_histogram (stats->histogram));
+    if (item == NULL)
+    {
+      Py_DECREF (result);
+      return NULL;
+    }
+    PyList_Append (result, item);
+    Py_DECREF (item);
+  }
 
-  return PyCancellable_new_take_handle (handle);
+  return result;
 }
 
 static PyObject *
-PyCancellable_push_current (PyCancellable * self)
+PyTelco_reset_callback_stats (PyObject * self, PyObject * args)
 {
-  g_cancellable_push_current (PY_GOBJECT_HANDLE (self));
+  if (watchdog_stats != NULL)
+    g_hash_table_remove_all (watchdog_stats);
 
   Py_RETURN_NONE;
 }
 
 static PyObject *
-PyCancellable_pop_current (PyCancellable * self)
+PyTelco_record_callback_time (PyObject * self, PyObject * args)
 {
-  GCancellable * handle = PY_GOBJECT_HANDLE (self);
+  const char * signal_name;
+  PyObject * callback;
+  double elapsed;
 
-  if (g_cancellable_get_current () != handle)
-    goto invalid_operation;
+  if (!PyArg_ParseTuple (args, "sOd", &signal_name, &callback, &elapsed))
+    return NULL;
 
-  g_cancellable_pop_current (handle);
+  /* Statistics keep the signal name around, so it is interned just like the names of actual signals. */
+  PyTelco_observe_callback (g_intern_string (signal_name), callback, (gint64) (elapsed * G_USEC_PER_SEC));
 
   Py_RETURN_NONE;
-
-invalid_operation:
-  {
-    return PyTelco_raise (g_error_new (
-          TELCO_ERROR,
-          TELCO_ERROR_INVALID_OPERATION,
-          "Cancellable is not on top of the stack"));
-  }
 }
 
-static PyObject *
-PyCancellable_connect (PyCancellable * self, PyObject * args)
+static void
+PyTelco_observe_callback (const gchar * signal_name, PyObject * callback, gint64 elapsed)
 {
-  GCancellable * handle = PY_GOBJECT_HANDLE (self);
-  gulong handler_id;
-  PyObject * callback;
+  gchar * callback_name, * key;
+  PyTelcoCallbackStats * stats;
+  PyObject * hook, * result;
 
-  if (!PyArg_ParseTuple (args, "O", &callback))
-    return NULL;
+  /* The callback may have turned the watchdog off while it was running. */
+  if (watchdog_threshold == -1)
+    return;
 
-  if (!PyCallable_Check (callback))
-    goto not_callable;
+  callback_name = PyTelco_describe_callable (callback);
 
-  if (handle != NULL)
+  key = g_strconcat (signal_name, ":", callback_name, NULL);
+  stats = g_hash_table_lookup (watchdog_stats, key);
+  if (stats == NULL)
   {
-    Py_IncRef (callback);
-
-    Py_BEGIN_ALLOW_THREADS
-    handler_id = g_cancellable_connect (handle, G_CALLBACK (PyCancellable_on_cancelled), callback,
-        (GDestroyNotify) PyCancellable_destroy_callback);
-    Py_END_ALLOW_THREADS
+    stats = g_slice_new0 (PyTelcoCallbackStats);
+    stats->signal_name = signal_name;
+    stats->callback_name = g_strdup (callback_name);
+    g_hash_table_insert (watchdog_stats, key, stats);
   }
   else
   {
-    handler_id = 0;
+    g_free (key);
   }
 
-  return PyLong_FromUnsignedLong (handler_id);
+  stats->histogram[PyTelco_histogram_bucket (elapsed)]++;
+  stats->calls++;
+  stats->total_time += elapsed;
+  stats->max_time = MAX (stats->max_time, elapsed);
 
-not_callable:
+  if (elapsed <= watchdog_threshold)
+    goto beach;
+
+  stats->slow++;
+
+  hook = watchdog_hook;
+  if (hook != NULL)
   {
-    PyErr_SetString (PyExc_TypeError, "object must be callable");
-    return NULL;
+    Py_INCREF (hook);
+    result = PyObject_CallFunction (hook, "ssd", signal_name, callback_name, (double) elapsed / G_USEC_PER_SEC);
+    Py_DECREF (hook);
+  }
+  else
+  {
+    gchar * message;
+
+    message = g_strdup_printf ("'%s' callback %s took %.1f ms", signal_name, callback_name,
+        (double) elapsed / (G_USEC_PER_SEC / 1000));
+    result = (PyErr_WarnEx (PyExc_RuntimeWarning, message, 1) == 0) ? Py_None : NULL;
+    Py_XINCREF (result);
+    g_free (message);
   }
+
+  if (result != NULL)
+    Py_DECREF (result);
+  else
+    PyErr_Print ();
+
+beach:
+  g_free (callback_name);
 }
 
-static PyObject *
-PyCancellable_disconnect (PyCancellable * self, PyObject * args)
+static gchar *
+PyTelco_describe_callable (PyObject * callable)
 {
-  gulong handler_id;
+  PyObject * qualname, * module;
+  gchar * name = NULL, * module_name = NULL, * description;
 
-  if (!PyArg_ParseTuple (args, "k", &handler_id))
-    return NULL;
+  qualname = PyObject_GetAttrString (callable, "__qualname__");
+  if (qualname == NULL)
+  {
+    PyErr_Clear ();
+    qualname = PyObject_GetAttrString ((PyObject *) Py_TYPE (callable), "__qualname__");
+  }
+  if (qualname != NULL && PyUnicode_Check (qualname))
+    PyGObject_unmarshal_string (qualname, &name);
+  Py_XDECREF (qualname);
 
-  Py_BEGIN_ALLOW_THREADS
-  g_cancellable_disconnect (PY_GOBJECT_HANDLE (self), handler_id);
-  Py_END_ALLOW_THREADS
+  module = PyObject_GetAttrString (callable, "__module__");
+  if (module != NULL && PyUnicode_Check (module))
+    PyGObject_unmarshal_string (module, &module_name);
+  Py_XDECREF (module);
 
-  Py_RETURN_NONE;
+  PyErr_Clear ();
+
+  if (module_name != NULL && name != NULL)
+    description = g_strconcat (module_name, ".", name, NULL);
+  else
+    description = g_strdup ((name != NULL) ? name : "<unknown>");
+
+  g_free (module_name);
+  g_free (name);
+
+  return description;
 }
 
 static void
-PyCancellable_on_cancelled (GCancellable * cancellable, PyObject * callback)
+PyTelcoCallbackStats_free (PyTelcoCallbackStats * stats)
+{
+  g_free (stats->callback_name);
+
+  g_slice_free (PyTelcoCallbackStats, stats);
+}
+
+static PyGILState_STATE
+PyTelco_ensure_gil (PyTelcoGilSite site)
 {
   PyGILState_STATE gstate;
-  PyObject * result;
+  gint64 started, waited;
+  PyTelcoGilSiteStats * stats = &gil_site_stats[site];
 
+  started = g_get_monotonic_time ();
   gstate = PyGILState_Ensure ();
+  waited = g_get_monotonic_time () - started;
 
-  result = PyObject_CallObject (callback, NULL);
-  if (result != NULL)
-    Py_DECREF (result);
-  else
-    PyErr_Print ();
+  stats->acquisitions++;
+  stats->total_wait += waited;
+  stats->max_wait = MAX (stats->max_wait, waited);
+  stats->histogram[PyTelco_histogram_bucket (waited)]++;
 
-  PyGILState_Release (gstate);
+  return gstate;
 }
 
-static void
-PyCancellable_destroy_callback (PyObject * callback)
+static PyObject *
+PyTelco_get_gil_stats (PyObject * self, PyObject * args)
 {
-  PyGILState_STATE gstate;
+  PyObject * result;
+  guint i;
 
-  gstate = PyGILState_Ensure ();
-  Py_DecRef (callback);
-  PyGILState_Release (gstate);
+  result = PyDict_New ();
+
+  for (i = 0; i != PYTELCO_N_GIL_SITES; i++)
+  {
+    const PyTelcoGilSiteStats * stats = &gil_site_stats[i];
+    PyObject * item;
+
+    item = Py_BuildValue ("{s:K,s:d,s:d,s:N}",
+        "acquisitions", (unsigned long long) stats->acquisitions,
+        "total_wait", (double) stats->total_wait / G_USEC_PER_SEC,
+        "max_wait", (double) stats->max_wait / G_USEC_PER_SEC,
+        "histogram", PyTelco_marshal_histogram (stats->histogram));
+    if (item == NULL)
+    {
+      Py_DECREF (result);
+      return NULL;
+    }
+    PyDict_SetItemString (result, pytelco_gil_site_names[i], item);
+    Py_DECREF (item);
+  }
+
+  return result;
 }
 
 static PyObject *
-PyCancellable_cancel (PyCancellable * self)
+PyTelco_reset_gil_stats (PyObject * self, PyObject * args)
 {
-  Py_BEGIN_ALLOW_THREADS
-  g_cancellable_cancel (PY_GOBJECT_HANDLE (self));
-  Py_END_ALLOW_THREADS
+  memset (gil_site_stats, 0, sizeof (gil_site_stats));
 
   Py_RETURN_NONE;
 }
 
-
-static void
-PyTelco_object_decref (gpointer obj)
+static guint
+PyTelco_histogram_bucket (gint64 microseconds)
 {
-  PyObject * o = obj;
-  Py_DECREF (o);
+  guint bucket;
+
+  /* Bucket i counts durations below 2^(i + 1) microseconds, the last one everything longer. */
+  bucket = (microseconds > 1) ? g_bit_storage (microseconds) - 1 : 0;
+
+  return MIN (bucket, PYTELCO_N_HISTOGRAM_BUCKETS - 1);
 }
 
 static PyObject *
-PyTelco_raise (GError * error)
+PyTelco_marshal_histogram (const guint64 * histogram)
 {
-  PyObject * exception;
-  GString * message;
+  PyObject * result;
+  guint i;
 
-  if (error->domain == TELCO_ERROR)
+  result = PyList_New (PYTELCO_N_HISTOGRAM_BUCKETS);
+  for (i = 0; i != PYTELCO_N_HISTOGRAM_BUCKETS; i++)
+    PyList_SetItem (result, i, PyLong_FromUnsignedLongLong (histogram[i]));
+
+  return result;
+}
+
+static unsigned long
+PyTelco_capi_add_message_handler (PyObject * object, const char * signal_name, PyTelcoMessageFunc func, void * user_data,
+    PyTelcoDestroyFunc destroy)
+{
+  GObject * handle;
+  guint signal_id;
+  GSignalQuery query;
+  PyTelcoNativeHandler * handler;
+  gulong handler_id;
+  GHashTable * handler_ids;
+
+  handle = PyTelco_capi_resolve_handle (object);
+  if (handle == NULL)
+    return 0;
+
+  if (func == NULL)
+    goto missing_func;
+
+  if (!PyGObject_lookup_signal (signal_name, G_OBJECT_TYPE (handle), &signal_id))
+    return 0;
+
+  g_signal_query (signal_id, &query);
+  if (query.n_params != 2 ||
+      (query.param_types[0] & ~G_SIGNAL_TYPE_STATIC_SCOPE) != G_TYPE_STRING ||
+      (query.param_types[1] & ~G_SIGNAL_TYPE_STATIC_SCOPE) != G_TYPE_BYTES)
+    goto not_a_message_signal;
+
+  handler = g_slice_new (PyTelcoNativeHandler);
+  handler->func = func;
+  handler->user_data = user_data;
+  handler->destroy = destroy;
+
+  handler_id = g_signal_connect_data (handle, signal_name, G_CALLBACK (PyTelco_capi_on_message), handler,
+      (GClosureNotify) PyTelco_capi_free_handler, 0);
+
+  /* Kept on the GObject rather than the wrapper, as the handlers outlive any particular wrapper. */
+  handler_ids = g_object_get_data (handle, "pytelco-capi-handler-ids");
+  if (handler_ids == NULL)
   {
-    exception = g_hash_table_lookup (telco_exception_by_error_code, GINT_TO_POINTER (error->code));
-    g_assert (exception != NULL);
+    handler_ids = g_hash_table_new (NULL, NULL);
+    g_object_set_data_full (handle, "pytelco-capi-handler-ids", handler_ids, (GDestroyNotify) g_hash_table_unref);
   }
-  else
+  g_hash_table_add (handler_ids, GSIZE_TO_POINTER (handler_id));
+
+  return handler_id;
+
+missing_func:
   {
-    g_assert (error->domain == G_IO_ERROR);
-    g_assert (error->code == G_IO_ERROR_CANCELLED);
-    exception = cancelled_exception;
+    PyErr_SetString (PyExc_ValueError, "func must not be NULL");
+    return 0;
+  }
+not_a_message_signal:
+  {
+    PyErr_Format (PyExc_TypeError, "the '%s' signal does not carry messages", signal_name);
+    return 0;
   }
+}
 
-  message = g_string_new ("");
-  g_string_append_unichar (message, g_unichar_tolower (g_utf8_get_char (error->message)));
-  g_string_append (message, g_utf8_offset_to_pointer (error->message, 1));
+static int
+PyTelco_capi_remove_message_handler (PyObject * object, unsigned long handler_id)
+{
+  GObject * handle;
+  GHashTable * handler_ids;
 
-  PyErr_SetString (exception, message->str);
+  handle = PyTelco_capi_resolve_handle (object);
+  if (handle == NULL)
+    return 0;
 
-  g_string_free (message, TRUE);
-  g_error_free (error);
+  /* Only handlers added through this API may be removed through it, never those backing on(). */
+  handler_ids = g_object_get_data (handle, "pytelco-capi-handler-ids");
+  if (handler_ids == NULL || !g_hash_table_remove (handler_ids, GSIZE_TO_POINTER (handler_id)))
+    goto unknown_handler;
 
-  return NULL;
-}
+  if (g_signal_handler_is_connected (handle, handler_id))
+    g_signal_handler_disconnect (handle, handler_id);
 
-static gboolean
-PyTelco_is_string (PyObject * obj)
-{
-  return PyUnicode_Check (obj);
+  return 1;
+
+unknown_handler:
+  {
+    PyErr_SetString (PyExc_ValueError, "unknown handler ID");
+    return 0;
+  }
 }
 
-static gchar *
-PyTelco_repr (PyObject * obj)
+static GObject *
+PyTelco_capi_resolve_handle (PyObject * object)
 {
-  gchar * result;
-  PyObject * repr_value;
+  GObject * handle = NULL;
+  PyObject * impl;
+  int is_gobject, is_script_or_bus;
 
-  repr_value = PyObject_Repr (obj);
+  /* Accept the telco.core wrappers too, which keep the _telco object in _impl. */
+  is_gobject = PyObject_IsInstance (object, PYTELCO_TYPE_OBJECT (GObject));
+  if (is_gobject == -1)
+    return NULL;
 
-  PyGObject_unmarshal_string (repr_value, &result);
+  if (is_gobject)
+  {
+    impl = object;
+    Py_INCREF (impl);
+  }
+  else
+  {
+    impl = PyObject_GetAttrString (object, "_impl");
+    if (impl == NULL)
+    {
+      PyErr_Clear ();
+      goto unsupported_object;
+    }
+  }
 
-  Py_DECREF (repr_value);
+  is_script_or_bus = PyObject_IsInstance (impl, PYTELCO_TYPE_OBJECT (Script));
+  if (is_script_or_bus == 0)
+    is_script_or_bus = PyObject_IsInstance (impl, PYTELCO_TYPE_OBJECT (Bus));
+  if (is_script_or_bus == 1)
+    handle = PY_GOBJECT_HANDLE (impl);
 
-  return result;
-}
+  Py_DECREF (impl);
 
-static guint
-PyTelco_get_max_argument_count (PyObject * callable)
-{
-  guint result = G_MAXUINT;
-  PyObject * spec;
-  PyObject * varargs = NULL;
-  PyObject * args = NULL;
-  PyObject * is_method;
+  if (is_script_or_bus == -1)
+    return NULL;
 
-  spec = PyObject_CallFunction (inspect_getargspec, "O", callable);
-  if (spec == NULL)
+  if (handle == NULL)
+    goto unsupported_object;
+
+  return handle;
+
+unsupported_object:
   {
-    PyErr_Clear ();
-    goto beach;
+    PyErr_SetString (PyExc_TypeError, "expected a Script or a Bus");
+    return NULL;
   }
+}
 
-  varargs = PyTuple_GetItem (spec, 1);
-  if (varargs != Py_None)
-    goto beach;
+static void
+PyTelco_capi_on_message (GObject * instance, const gchar * message, GBytes * data, PyTelcoNativeHandler * handler)
+{
+  handler->func (message, data, handler->user_data);
+}
 
-  args = PyTuple_GetItem (spec, 0);
+static void
+PyTelco_capi_free_handler (PyTelcoNativeHandler * handler, GClosure * closure)
+{
+  if (handler->destroy != NULL)
+    handler->destroy (handler->user_data);
 
-  result = PyObject_Size (args);
+  g_slice_free (PyTelcoNativeHandler, handler);
+}
 
-  is_method = PyObject_CallFunction (inspect_ismethod, "O", callable);
-  g_assert (is_method != NULL);
-  if (is_method == Py_True)
-    result--;
-  Py_DECREF (is_method);
+static const void *
+PyTelco_capi_bytes_get_data (GBytes * bytes, size_t * size)
+{
+  gsize n;
+  gconstpointer data;
 
-beach:
-  Py_XDECREF (spec);
+  data = g_bytes_get_data (bytes, &n);
+  if (size != NULL)
+    *size = n;
 
-  return result;
+  return data;
+}
+
+static GBytes *
+PyTelco_capi_bytes_ref (GBytes * bytes)
+{
+  return g_bytes_ref (bytes);
 }
 
+static void
+PyTelco_capi_bytes_unref (GBytes * bytes)
+{
+  g_bytes_unref (bytes);
+}
 
 MOD_INIT (_telco)
 {
-  PyObject * inspect, * datetime, * module;
+  PyObject * inspect, * datetime, * json, * module, * capi;
 
   inspect = PyImport_ImportModule ("inspect");
   inspect_getargspec = PyObject_GetAttrString (inspect, PYTELCO_GETARGSPEC_FUNCTION);
@@ -5185,11 +12932,15 @@ MOD_INIT (_telco)
   datetime_constructor = PyObject_GetAttrString (datetime, "datetime");
   Py_DECREF (datetime);
 
+  json = PyImport_ImportModule ("json");
+  json_loads = PyObject_GetAttrString (json, "loads");
+  Py_DECREF (json);
+
   telco_init ();
 
   PyGObject_class_init ();
 
-  MOD_DEF (module, "_telco", "Telco", NULL);
+  MOD_DEF (module, "_telco", "Telco", PyTelco_functions);
 
   PyModule_AddStringConstant (module, "__version__", telco_version_string ());
 
@@ -5216,6 +12967,31 @@ MOD_INIT (_telco)
   PYTELCO_REGISTER_TYPE (IOStream, G_TYPE_IO_STREAM);
   PYTELCO_REGISTER_TYPE (Cancellable, G_TYPE_CANCELLABLE);
 
+  PySignalStream_type = PyType_FromSpec (&PySignalStream_spec);
+  if (PySignalStream_type == NULL)
+    goto propagate_error;
+  Py_INCREF (PySignalStream_type);
+  PyModule_AddObject (module, "SignalStream", PySignalStream_type);
+
+  PyLazyMessage_type = PyType_FromSpec (&PyLazyMessage_spec);
+  if (PyLazyMessage_type == NULL)
+    goto propagate_error;
+  Py_INCREF (PyLazyMessage_type);
+  PyModule_AddObject (module, "LazyMessage", PyLazyMessage_type);
+
+#ifdef PYTELCO_HAVE_BUFFER_PROTOCOL
+  PyBytesView_type = PyType_FromSpec (&PyBytesView_spec);
+  if (PyBytesView_type == NULL)
+    goto propagate_error;
+  Py_INCREF (PyBytesView_type);
+  PyModule_AddObject (module, "BytesView", PyBytesView_type);
+#endif
+
+  capi = PyCapsule_New ((void *) &pytelco_capi, PYTELCO_CAPI_NAME, NULL);
+  if (capi == NULL)
+    goto propagate_error;
+  PyModule_AddObject (module, "_C_API", capi);
+
   telco_exception_by_error_code = g_hash_table_new_full (NULL, NULL, NULL, PyTelco_object_decref);
 #define PYTELCO_DECLARE_EXCEPTION(code, name) \
     do \
@@ -5244,4 +13020,10 @@ MOD_INIT (_telco)
   PyModule_AddObject (module, "OperationCancelledError", cancelled_exception);
 
   return MOD_SUCCESS_VAL (module);
+
+propagate_error:
+  {
+    Py_DECREF (module);
+    return MOD_ERROR_VAL;
+  }
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2013-2023 Ole André Vadla Ravnås <oleavr@nowsecure.com>
+ *
+ * Licence: wxWindows Library Licence, Version 3.1
+ */
+
+#ifndef __TELCO_PYTHON_H__
+#define __TELCO_PYTHON_H__
+
+/*
+ * C API exported by the _telco extension module as the capsule
+ * "_telco._C_API", allowing other native extensions to subscribe to messages
+ * emitted by a Script or Bus without involving the interpreter.
+ *
+ * GLib is linked statically into _telco and its symbols are not exported, so
+ * GBytes instances handed to callbacks must only be accessed through the
+ * bytes_* functions below, never through a separately linked GLib.
+ *
+ * Usage:
+ *
+ *   const PyTelcoCApi * api = PyTelco_import_capi ();
+ *   if (api == NULL)
+ *     return NULL;
+ *   id = api->add_message_handler (script, "message", on_message, state, NULL);
+ */
+
+#include <Python.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PYTELCO_CAPI_NAME "_telco._C_API"
+#define PYTELCO_CAPI_VERSION 1
+
+struct _GBytes;
+
+typedef struct _PyTelcoCApi PyTelcoCApi;
+
+/*
+ * Called on the thread emitting the signal, without holding the GIL. Both
+ * message and data are only valid for the duration of the call; data is NULL
+ * when the message has no payload. Use bytes_ref() to keep data around.
+ */
+typedef void (* PyTelcoMessageFunc) (const char * message, struct _GBytes * data, void * user_data);
+
+/*
+ * Called once the handler is removed or the object is destroyed, possibly on
+ * another thread and without holding the GIL.
+ */
+typedef void (* PyTelcoDestroyFunc) (void * user_data);
+
+struct _PyTelcoCApi
+{
+  /* Incremented whenever fields are appended; existing ones never change. */
+  unsigned int version;
+  size_t size;
+
+  /*
+   * Subscribes to a message signal, e.g. "message", on a _telco.Script or
+   * _telco.Bus, or on a telco.core wrapper around one. Must be called with
+   * the GIL held. Returns a handler ID, or 0 with a Python exception set.
+   */
+  unsigned long (* add_message_handler) (PyObject * object, const char * signal_name, PyTelcoMessageFunc func,
+      void * user_data, PyTelcoDestroyFunc destroy);
+  /* Must be called with the GIL held. Returns 0 with a Python exception set on failure. */
+  int (* remove_message_handler) (PyObject * object, unsigned long handler_id);
+
+  /* May be called from any thread. */
+  const void * (* bytes_get_data) (struct _GBytes * bytes, size_t * size);
+  struct _GBytes * (* bytes_ref) (struct _GBytes * bytes);
+  void (* bytes_unref) (struct _GBytes * bytes);
+};
+
+static inline const PyTelcoCApi *
+PyTelco_import_capi (void)
+{
+  const PyTelcoCApi * api;
+
+  api = (const PyTelcoCApi *) PyCapsule_Import (PYTELCO_CAPI_NAME, 0);
+  if (api == NULL)
+    return NULL;
+
+  if (api->version < PYTELCO_CAPI_VERSION)
+  {
+    PyErr_Format (PyExc_ImportError, "_telco C API version %u is too old, at least %u is required", api->version,
+        (unsigned int) PYTELCO_CAPI_VERSION);
+    return NULL;
+  }
+
+  return api;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,3 +1,4 @@
+import atexit
 from typing import Any, Callable, Dict, List, Optional, Tuple, Union
 
 try:
@@ -25,6 +26,8 @@ EndpointParameters = core.EndpointParameters
 Compiler = core.Compiler
 FileMonitor = _telco.FileMonitor
 Cancellable = core.Cancellable
+MessageTapReader = core.MessageTapReader
+MessageRecording = core.MessageRecording
 
 ServerNotRunningError = _telco.ServerNotRunningError
 ExecutableNotFoundError = _telco.ExecutableNotFoundError
@@ -163,10 +166,80 @@ def enumerate_devices() -> List[core.Device]:
     return get_device_manager().enumerate_devices()
 
 
+def start_dispatcher(threads: int = 1) -> None:
+    """
+    Run signal callbacks on a pool of dispatcher threads instead of Telco's main loop,
+    so slow handlers cannot delay other sessions. Callbacks for the same object keep their order.
+    May only be called once, ideally before attaching. The threads are stopped by shutdown() or at exit.
+    """
+
+    _telco.start_dispatcher(threads)
+    atexit.register(stop_dispatcher)
+
+
+def stop_dispatcher() -> None:
+    """
+    Deliver the callbacks already handed to the dispatcher threads, then stop them. Callbacks run on Telco's main loop
+    again afterwards
+    """
+
+    _telco.stop_dispatcher()
+
+
+def set_callback_watchdog(threshold: Optional[float], hook: Optional[Callable[[str, str, float], None]] = None) -> None:
+    """
+    Time every signal callback, gathering per-signal, per-callback statistics for get_callback_stats(),
+    and report callbacks that take longer than the threshold with a RuntimeWarning naming them.
+    :param threshold: how many seconds a callback may take before it is reported, or None to stop timing
+    :param hook: called with the signal name, the callback's qualified name and the seconds it took
+                 instead of warning
+    """
+
+    _telco.set_watchdog(threshold if threshold is not None else -1.0, hook)
+    core._callback_watchdog_enabled = threshold is not None
+
+
+def get_callback_stats() -> List[Dict[str, Any]]:
+    """
+    Get the timing statistics gathered by the callback watchdog, slowest callbacks in total first.
+    Each entry has the signal, callback, calls, slow calls, total_time and max_time in seconds,
+    and a histogram where bucket i counts calls that took less than 2^(i + 1) microseconds
+    """
+
+    return sorted(_telco.get_callback_stats(), key=lambda stats: stats["total_time"], reverse=True)
+
+
+def reset_callback_stats() -> None:
+    """
+    Discard the timing statistics gathered by the callback watchdog
+    """
+
+    _telco.reset_callback_stats()
+
+
+def get_gil_stats() -> Dict[str, Dict[str, Any]]:
+    """
+    Get how long the binding waited for the GIL whenever it took it from one of Telco's threads, keyed by the place
+    that took it, e.g. "signal-emission" or "dispatcher". Each entry has the acquisitions, total_wait and max_wait
+    in seconds, and a histogram where bucket i counts waits shorter than 2^(i + 1) microseconds
+    """
+
+    return _telco.get_gil_stats()
+
+
+def reset_gil_stats() -> None:
+    """
+    Discard the GIL wait statistics
+    """
+
+    _telco.reset_gil_stats()
+
+
 @core.cancellable
 def shutdown() -> None:
     """
     Shutdown the main device manager
     """
 
+    stop_dispatcher()
     get_device_manager()._impl.close()
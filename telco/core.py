@@ -1,21 +1,27 @@
 from __future__ import annotations
 
 import asyncio
-import dataclasses
+import collections
+import collections.abc
 import fnmatch
 import functools
 import json
+import mmap
+import struct
 import sys
-import threading
+import time
 import traceback
 import warnings
+import weakref
 from types import TracebackType
 from typing import (
     Any,
-    AnyStr,
     Awaitable,
     Callable,
+    Deque,
     Dict,
+    Generic,
+    Iterator,
     List,
     Mapping,
     MutableMapping,
@@ -46,13 +52,15 @@ _Cancellable = _telco.Cancellable
 
 ProcessTarget = Union[int, str]
 Spawn = _telco.Spawn
+LazyMessage = _telco.LazyMessage
+collections.abc.Mapping.register(LazyMessage)
+MessageQueuePolicy = Literal["block", "drop-oldest", "drop-newest", "coalesce"]
+MessageStreamPolicy = Literal["drop-oldest", "drop-newest", "coalesce"]
+MessageEncoding = Literal["json", "cbor"]
+LogLevel = Literal["debug", "info", "warning", "error"]
+MessageData = Union[str, bytes, bytearray, memoryview]
 
-
-@dataclasses.dataclass
-class RPCResult:
-    finished: bool = False
-    value: Any = None
-    error: Optional[Exception] = None
+CBOR_MESSAGE_TYPE = "telco:cbor"
 
 
 def get_device_manager() -> "DeviceManager":
@@ -66,6 +74,22 @@ def get_device_manager() -> "DeviceManager":
     return _device_manager
 
 
+_callback_watchdog_enabled = False
+
+
+def _call_callback(signal: str, callback: Callable[..., Any], *args: Any) -> None:
+    # Handlers called from Python are invisible to the native callback watchdog, so they are accounted for here.
+    if not _callback_watchdog_enabled:
+        callback(*args)
+        return
+
+    started = time.perf_counter()
+    try:
+        callback(*args)
+    finally:
+        _telco.record_callback_time(signal, callback, time.perf_counter() - started)
+
+
 def _filter_missing_kwargs(d: MutableMapping[Any, Any]) -> None:
     for key in list(d.keys()):
         if d[key] is None:
@@ -148,6 +172,81 @@ class IOStream:
         self._impl.write_all(data)
 
 
+T = TypeVar("T")
+
+
+class MessageStream(Generic[T]):
+    """
+    Asynchronous iterator over messages, drained from a native queue in bulk each time the event loop wakes up
+    """
+
+    def __init__(self, impl: _telco.SignalStream, transform: Callable[[Tuple[Any, ...]], Optional[T]]) -> None:
+        self._impl = impl
+        self._transform = transform
+        self._pending: Deque[T] = collections.deque()
+
+    def __repr__(self) -> str:
+        return repr(self._impl)
+
+    def __aiter__(self) -> MessageStream[T]:
+        return self
+
+    async def __anext__(self) -> T:
+        while not self._pending:
+            for args in self._impl.drain():
+                item = self._transform(args)
+                if item is not None:
+                    self._pending.append(item)
+
+            if not self._pending:
+                if self._impl.is_closed():
+                    raise StopAsyncIteration
+                await self._wait()
+
+        return self._pending.popleft()
+
+    async def aclose(self) -> None:
+        """
+        Stop receiving messages
+        """
+
+        self.close()
+
+    def close(self) -> None:
+        """
+        Stop receiving messages, those already queued are still delivered
+        """
+
+        self._impl.close()
+
+    def get_stats(self) -> Dict[str, int]:
+        """
+        Get the length, capacity, high-water mark and dropped count of the underlying queue
+        """
+
+        return self._impl.get_stats()
+
+    async def _wait(self) -> None:
+        loop = asyncio.get_running_loop()
+
+        fd = self._impl.fileno()
+        if fd == -1:
+            await loop.run_in_executor(None, self._impl.wait, 0.5)
+            return
+
+        readable: asyncio.Future[None] = loop.create_future()
+
+        def on_readable() -> None:
+            if not readable.done():
+                readable.set_result(None)
+
+        loop.add_reader(fd, on_readable)
+        try:
+            await readable
+        finally:
+            loop.remove_reader(fd)
+
+
 class PortalMembership:
     def __init__(self, impl: _telco.PortalMembership) -> None:
         self._impl = impl
@@ -226,6 +325,7 @@ class ScriptPayloadMessage(TypedDict):
 
 ScriptMessage = Union[ScriptPayloadMessage, ScriptErrorMessage]
 ScriptMessageCallback = Callable[[ScriptMessage, Optional[bytes]], None]
+ScriptMessagesCallback = Callable[[List[Tuple[ScriptMessage, Optional[bytes]]]], None]
 ScriptDestroyedCallback = Callable[[], None]
 
 
@@ -239,23 +339,49 @@ class RPCException(Exception):
 
 
 class Script:
-    def __init__(self, impl: _telco.Script) -> None:
+    def __init__(
+        self,
+        impl: _telco.Script,
+        native_decoding: bool = False,
+        zero_copy_data: bool = False,
+        max_batch_size: int = 0,
+        max_batch_delay: float = 0.0,
+        queue_size: int = 0,
+        queue_policy: MessageQueuePolicy = "drop-oldest",
+        message_encoding: MessageEncoding = "json",
+        lazy_messages: bool = False,
+    ) -> None:
         self.exports_sync = ScriptExportsSync(self)
         self.exports_async = ScriptExportsAsync(self)
 
         self._impl = impl
+        self._native_decoding = native_decoding
+        self._lazy_messages = lazy_messages
+        self._zero_copy_data = zero_copy_data
+        self._message_encoding = message_encoding
 
         self._on_message_callbacks: List[ScriptMessageCallback] = []
+        self._on_messages_callbacks: List[ScriptMessagesCallback] = []
+        self._topic_callbacks: Dict[str, List[ScriptMessageCallback]] = {}
+        self._routing = False
+        self._streams: weakref.WeakSet[MessageStream[Any]] = weakref.WeakSet()
         self._log_handler: Callable[[str, str], None] = self.default_log_handler
 
-        self._pending: Dict[
-            int, Callable[[Optional[Any], Optional[Union[RPCException, _telco.InvalidOperationError]]], None]
-        ] = {}
-        self._next_request_id = 1
-        self._cond = threading.Condition()
+        self._message_handler = self._on_messages if max_batch_size > 0 else self._on_message
 
         impl.on("destroyed", self._on_destroyed)
-        impl.on("message", self._on_message)
+        impl.on(
+            "message",
+            self._message_handler,
+            decode_json=native_decoding,
+            lazy_json=lazy_messages,
+            dispatch_rpc=True,
+            zero_copy=zero_copy_data,
+            max_batch_size=max_batch_size,
+            max_batch_delay=max_batch_delay,
+            queue_size=queue_size,
+            queue_policy=queue_policy,
+        )
 
     @property
     def exports(self) -> ScriptExportsSync:
@@ -305,16 +431,51 @@ class Script:
 
         self._impl.eternalize()
 
-    def post(self, message: Any, data: Optional[AnyStr] = None) -> None:
+    def post(self, message: Any, data: Optional[MessageData] = None) -> None:
         """
-        Post a JSON-encoded message to the script
+        Post a message to the script, JSON-encoded unless the script was created with the "cbor" message encoding.
+        CBOR messages reach the script as {"type": "telco:cbor", "length": n}, with the encoded message in the
+        first n bytes of the data and any data passed here after it.
+        Data may be any bytes-like object. Bytes are handed to Telco without copying, as are other buffers on builds
+        targeting Python 3.11 or later, so those must not be modified until the message has been sent. Other inputs
+        are copied
         """
 
-        raw_message = json.dumps(message)
-        kwargs = {"data": data}
+        raw_message, raw_data = self._encode_post(message, data)
+        kwargs = {"data": raw_data}
         _filter_missing_kwargs(kwargs)
         self._impl.post(raw_message, **kwargs)
 
+    def post_many(self, messages: Sequence[Any], datas: Optional[Sequence[Optional[MessageData]]] = None) -> None:
+        """
+        Post a batch of messages to the script, encoded as by post(), in order and with a single GIL release
+        :param messages: the messages to post
+        :param datas: optional data for each message, or None
+        """
+
+        messages = list(messages)
+        if datas is None:
+            datas = [None] * len(messages)
+        elif len(datas) != len(messages):
+            raise ValueError("datas must be as long as messages")
+
+        raw_messages = []
+        raw_datas = []
+        for message, data in zip(messages, datas):
+            raw_message, raw_data = self._encode_post(message, data)
+            raw_messages.append(raw_message)
+            raw_datas.append(raw_data)
+        self._impl.post_many(raw_messages, raw_datas)
+
+    def _encode_post(self, message: Any, data: Optional[MessageData]) -> Tuple[str, Optional[MessageData]]:
+        if self._message_encoding == "cbor":
+            encoded = _telco.cbor_encode(message)
+            envelope = {"type": CBOR_MESSAGE_TYPE, "length": len(encoded)}
+            if data is not None:
+                encoded += data.encode("utf-8") if isinstance(data, str) else data
+            return (json.dumps(envelope), encoded)
+        return (json.dumps(message), data)
+
     @cancellable
     def enable_debugger(self, port: Optional[int] = None) -> None:
         """
@@ -341,6 +502,10 @@ class Script:
     def on(self, signal: Literal["message"], callback: ScriptMessageCallback) -> None:
         ...
 
+    @overload
+    def on(self, signal: Literal["messages"], callback: ScriptMessagesCallback) -> None:
+        ...
+
     @overload
     def on(self, signal: str, callback: Callable[..., Any]) -> None:
         ...
@@ -352,6 +517,10 @@ class Script:
 
         if signal == "message":
             self._on_message_callbacks.append(callback)
+            self._update_route_fallback()
+        elif signal == "messages":
+            self._on_messages_callbacks.append(callback)
+            self._update_route_fallback()
         else:
             self._impl.on(signal, callback)
 
@@ -363,6 +532,10 @@ class Script:
     def off(self, signal: Literal["message"], callback: ScriptMessageCallback) -> None:
         ...
 
+    @overload
+    def off(self, signal: Literal["messages"], callback: ScriptMessagesCallback) -> None:
+        ...
+
     @overload
     def off(self, signal: str, callback: Callable[..., Any]) -> None:
         ...
@@ -374,9 +547,212 @@ class Script:
 
         if signal == "message":
             self._on_message_callbacks.remove(callback)
+            self._update_route_fallback()
+        elif signal == "messages":
+            self._on_messages_callbacks.remove(callback)
+            self._update_route_fallback()
         else:
             self._impl.off(signal, callback)
 
+    def on_topic(self, tag: str, callback: ScriptMessageCallback) -> None:
+        """
+        Add a handler for "send" messages with the given tag, i.e. the first element of an array payload, or the "type"
+        or "kind" field of an object payload. Tagged messages go to their topic handlers instead of the "message" and
+        "messages" handlers, and when there are none of those, unmatched messages are dropped before reaching Python
+        :param tag: the tag to match, must not start with "telco:"
+        :param callback: a callable that accepts the message and its data
+        """
+
+        callbacks = self._topic_callbacks.get(tag)
+        if callbacks is None:
+            callbacks = []
+            self._impl.set_route("message", self._message_handler, tag, self._make_topic_handler(callbacks))
+            self._topic_callbacks[tag] = callbacks
+            self._routing = True
+            self._update_route_fallback()
+        callbacks.append(callback)
+
+    def off_topic(self, tag: str, callback: ScriptMessageCallback) -> None:
+        """
+        Remove a handler added with on_topic()
+        """
+
+        callbacks = self._topic_callbacks[tag]
+        callbacks.remove(callback)
+        if not callbacks:
+            del self._topic_callbacks[tag]
+            self._impl.set_route("message", self._message_handler, tag, None)
+            self._update_route_fallback()
+
+    def get_topic_stats(self) -> Dict[str, int]:
+        """
+        Get the number of routes, and how many tagged messages were routed, delivered unmatched, or dropped
+        """
+
+        return self._impl.get_route_stats("message", self._message_handler)
+
+    def get_message_queue_stats(self) -> Dict[str, int]:
+        """
+        Get the length, capacity, high-water mark and dropped count of the message queue, along with the length,
+        delivered count, and average and maximum wait in microseconds of its "priority" and "bulk" lanes
+        """
+
+        return self._impl.get_queue_stats("message", self._message_handler)
+
+    def set_priority_tags(self, tags: Sequence[str]) -> None:
+        """
+        Let "send" messages with any of the given tags overtake queued and batched ones, like RPC replies do. Tags are
+        matched the same way as with on_topic(), and a full priority lane follows the queue_policy like the bulk one
+        :param tags: the tags to prioritize, replacing any previous ones
+        """
+
+        self._impl.set_priority_tags("message", self._message_handler, list(tags))
+
+    def set_message_limits(self, sample_every: int = 1, max_rate: float = 0.0, max_burst: int = 0) -> None:
+        """
+        Shed "send" messages before they reach Python, e.g. to survive an agent flooding the host from a hot hook.
+        Logs, errors and RPC replies are never shed
+        :param sample_every: only let one in every N messages through
+        :param max_rate: how many messages per second may go through on average, 0 for no limit
+        :param max_burst: how many messages may go through back to back, defaults to one second's worth
+        """
+
+        self._impl.set_limits("message", self._message_handler, sample_every, max_rate, max_burst)
+
+    def get_message_limit_stats(self) -> Dict[str, int]:
+        """
+        Get how many messages were let through, sampled out, and throttled by set_message_limits()
+        """
+
+        return self._impl.get_limit_stats("message", self._message_handler)
+
+    def messages(
+        self, queue_size: int = 1024, queue_policy: MessageStreamPolicy = "drop-oldest"
+    ) -> MessageStream[Tuple[ScriptMessage, Optional[bytes]]]:
+        """
+        Receive messages with `async for`, many per event loop wakeup. The iteration ends when the script is destroyed
+        :param queue_size: how many messages may be pending before queue_policy kicks in
+        :param queue_policy: what to do when the consumer falls behind, streams never block the emitting thread
+        """
+
+        stream = MessageStream(
+            self._impl.open_stream(
+                "message",
+                decode_json=self._native_decoding,
+                lazy_json=self._lazy_messages,
+                dispatch_rpc=True,
+                zero_copy=self._zero_copy_data,
+                queue_size=queue_size,
+                queue_policy=queue_policy,
+            ),
+            self._decode_stream_message,
+        )
+        self._streams.add(stream)
+        if self.is_destroyed:
+            stream.close()
+        return stream
+
+    def set_log_sink(
+        self,
+        fd: Optional[int] = None,
+        path: Optional[str] = None,
+        max_bytes: int = 0,
+        backup_count: int = 0,
+        buffer_size: int = 0,
+        level: LogLevel = "debug",
+    ) -> None:
+        """
+        Write the script's console output natively instead of passing it to the log handler, so that verbose agents
+        don't keep Python busy. Lines are written buffered and flushed within half a second. Calling it without any
+        outputs hands the logs back to the log handler
+        :param fd: a file descriptor to write each line to, e.g. 1 for stdout
+        :param path: a file to append each line to
+        :param max_bytes: rotate the file before it grows beyond this size, 0 to never rotate it. Only takes effect
+                          with a non-zero backup_count, the file is never truncated
+        :param backup_count: how many rotated files to keep around as path.1, path.2 and so on
+        :param buffer_size: how many of the most recent lines to keep in memory for tail_logs()
+        :param level: the least severe level to keep, lines below it are dropped
+        """
+
+        self._impl.set_log_sink(
+            "message",
+            self._message_handler,
+            fd=fd if fd is not None else -1,
+            path=path,
+            max_bytes=max_bytes,
+            backup_count=backup_count,
+            buffer_size=buffer_size,
+            level=level,
+        )
+
+    def tail_logs(self, count: int = 0) -> List[Tuple[str, str]]:
+        """
+        Get the most recent (level, text) lines kept by the log sink, oldest first
+        :param count: how many lines to get at most, 0 for all of them
+        """
+
+        return self._impl.tail_log_sink("message", self._message_handler, count)
+
+    def get_log_sink_stats(self) -> Dict[str, int]:
+        """
+        Get how many lines the log sink wrote, filtered out by level, overwrote in its buffer, or failed to write
+        """
+
+        return self._impl.get_log_sink_stats("message", self._message_handler)
+
+    def set_message_tap(self, path: Optional[str], size: int = 1 << 20) -> None:
+        """
+        Mirror every raw message and its data into a memory-mapped ring buffer file, written natively as the messages
+        arrive, so that other local processes can follow the stream with a MessageTapReader. The ring never waits for
+        readers, those that fall behind lose the overwritten messages
+        :param path: the file to create, replacing any existing one, or None to stop mirroring
+        :param size: the size of the ring in bytes, rounded up to a power of two
+        """
+
+        self._impl.set_tap("message", self._message_handler, path, size)
+
+    def get_message_tap_stats(self) -> Dict[str, int]:
+        """
+        Get the capacity and write position of the message tap, and how many messages it wrote or skipped for not
+        fitting in the ring
+        """
+
+        return self._impl.get_tap_stats("message", self._message_handler)
+
+    def start_recording(self, path: str) -> None:
+        """
+        Record every raw message the script emits, with its data and a timestamp, into a compact binary file that
+        MessageRecording reads back, e.g. for replay()
+        :param path: the file to create, replacing any existing one
+        """
+
+        self._impl.set_recorder("message", self._message_handler, path)
+
+    def stop_recording(self) -> None:
+        """
+        Stop recording messages and flush the recording to disk
+        """
+
+        self._impl.set_recorder("message", self._message_handler, None)
+
+    def get_recording_stats(self) -> Dict[str, int]:
+        """
+        Get whether the script is being recorded, and how many messages and bytes were recorded or failed to be
+        """
+
+        return self._impl.get_recorder_stats("message", self._message_handler)
+
+    def replay(self, path: str, speed: float = 1.0) -> int:
+        """
+        Feed a recording through the message handlers as if the script had just emitted it, leaving out the RPC
+        replies that were recorded along with it. Returns how many messages the recording held
+        :param path: a file written by start_recording()
+        :param speed: how much faster than recorded to replay, or 0 to replay as fast as possible
+        """
+
+        with MessageRecording(path) as recording:
+            return recording.replay(self._on_replayed_message, speed)
+
     def get_log_handler(self) -> Callable[[str, str], None]:
         """
         Get the method that handles the script logs
@@ -435,17 +811,22 @@ class Script:
         )
         return self.list_exports_sync()
 
+    @property
+    def _pending(self) -> Dict[int, None]:
+        return dict.fromkeys(self._impl.enumerate_pending_rpcs())
+
     def _rpc_request_async(self, *args: Any) -> asyncio.Future[Any]:
         loop = asyncio.get_event_loop()
         future: asyncio.Future[Any] = asyncio.Future()
 
-        def on_complete(value: Any, error: Optional[Union[RPCException, _telco.InvalidOperationError]]) -> None:
+        def on_complete(value: Any, error: Optional[Union[List[Any], _telco.InvalidOperationError]]) -> None:
             if error is not None:
-                loop.call_soon_threadsafe(future.set_exception, error)
+                exception = error if isinstance(error, Exception) else RPCException(*error)
+                loop.call_soon_threadsafe(future.set_exception, exception)
             else:
                 loop.call_soon_threadsafe(future.set_result, value)
 
-        request_id = self._append_pending(on_complete)
+        request_id = self._impl.begin_rpc(on_complete)
 
         if not self.is_destroyed:
             self._send_rpc_call(request_id, *args)
@@ -456,107 +837,319 @@ class Script:
 
     @cancellable
     def _rpc_request(self, *args: Any) -> Any:
-        result = RPCResult()
-
-        def on_complete(value: Any, error: Optional[Union[RPCException, _telco.InvalidOperationError]]) -> None:
-            with self._cond:
-                result.finished = True
-                result.value = value
-                result.error = error
-                self._cond.notify_all()
-
-        def on_cancelled() -> None:
-            self._pending.pop(request_id, None)
-            on_complete(None, None)
-
-        request_id = self._append_pending(on_complete)
+        request_id = self._impl.begin_rpc()
 
         if not self.is_destroyed:
             self._send_rpc_call(request_id, *args)
-
-            cancellable = Cancellable.get_current()
-            cancel_handler = cancellable.connect(on_cancelled)
-            try:
-                with self._cond:
-                    while not result.finished:
-                        self._cond.wait()
-            finally:
-                cancellable.disconnect(cancel_handler)
-
-            cancellable.raise_if_cancelled()
         else:
             self._on_destroyed()
 
-        if result.error is not None:
-            raise result.error
+        value, error = self._impl.wait_for_rpc(request_id)
+        if error is not None:
+            raise RPCException(*error)
 
-        return result.value
-
-    def _append_pending(
-        self, callback: Callable[[Any, Optional[Union[RPCException, _telco.InvalidOperationError]]], None]
-    ) -> int:
-        with self._cond:
-            request_id = self._next_request_id
-            self._next_request_id += 1
-            self._pending[request_id] = callback
-        return request_id
+        return value
 
     def _send_rpc_call(self, request_id: int, *args: Any) -> None:
         message = ["telco:rpc", request_id]
         message.extend(args)
-        self.post(message)
+        self._post_json(message)
 
-    def _on_rpc_message(self, request_id: int, operation: str, params: List[Any], data: Optional[Any]) -> None:
-        if operation in ("ok", "error"):
-            callback = self._pending.pop(request_id, None)
-            if callback is None:
-                return
+    def _post_json(self, message: Any, data: Optional[MessageData] = None) -> None:
+        raw_message = json.dumps(message)
+        kwargs = {"data": data}
+        _filter_missing_kwargs(kwargs)
+        self._impl.post(raw_message, **kwargs)
 
-            value = None
-            error = None
-            if operation == "ok":
-                value = params[0] if data is None else data
-            else:
-                error = RPCException(*params[0:3])
+    def _on_destroyed(self) -> None:
+        self._impl.abort_rpcs()
 
-            callback(value, error)
+        for stream in list(self._streams):
+            stream.close()
 
-    def _on_destroyed(self) -> None:
-        while True:
-            next_pending = None
+    def _decode_stream_message(self, args: Tuple[Any, ...]) -> Optional[Tuple[ScriptMessage, Optional[bytes]]]:
+        message, data = self._decode_message(*args)
+        if message["type"] == "log":
+            return None
+        return (message, data)
 
-            with self._cond:
-                pending_ids = list(self._pending.keys())
-                if len(pending_ids) > 0:
-                    next_pending = self._pending.pop(pending_ids[0])
+    def _decode_message(self, raw_message: Union[str, Dict[str, Any]], data: Optional[bytes]) -> Tuple[Any, Any]:
+        message: Any = json.loads(raw_message) if isinstance(raw_message, str) else raw_message
 
-            if next_pending is None:
-                break
+        if self._message_encoding == "cbor" and data is not None and message["type"] == "send":
+            payload = message.get("payload", None)
+            if isinstance(payload, dict) and payload.get("type") == CBOR_MESSAGE_TYPE:
+                length = payload["length"]
+                view = memoryview(data)
+                message["payload"] = _telco.cbor_decode(view[:length])
+                data = view[length:].tobytes() if len(view) > length else None
 
-            next_pending(None, _telco.InvalidOperationError("script has been destroyed"))
+        return (message, data)
 
-    def _on_message(self, raw_message: str, data: Optional[bytes]) -> None:
-        message = json.loads(raw_message)
+    def _update_route_fallback(self) -> None:
+        if not self._routing:
+            return
 
-        mtype = message["type"]
+        enabled = not self._topic_callbacks or bool(self._on_message_callbacks or self._on_messages_callbacks)
+        self._impl.set_route_fallback("message", self._message_handler, enabled)
+
+    def _make_topic_handler(self, callbacks: List[ScriptMessageCallback]) -> Callable[..., None]:
+        def on_topic_message(raw_message: Union[str, Dict[str, Any]], raw_data: Optional[bytes]) -> None:
+            message, data = self._decode_message(raw_message, raw_data)
+            for callback in callbacks[:]:
+                try:
+                    _call_callback("message", callback, message, data)
+                except:
+                    traceback.print_exc()
+
+        return on_topic_message
+
+    def _find_topic_callbacks(self, message: Any) -> Optional[List[ScriptMessageCallback]]:
+        # CBOR payloads are only visible after decoding, so their topics are matched here rather than natively.
         payload = message.get("payload", None)
-        if mtype == "log":
-            level = message["level"]
-            text = payload
-            self._log_handler(level, text)
-        elif mtype == "send" and isinstance(payload, list) and len(payload) > 0 and payload[0] == "telco:rpc":
-            request_id = payload[1]
-            operation = payload[2]
-            params = payload[3:]
-            self._on_rpc_message(request_id, operation, params, data)
+        if isinstance(payload, list) and payload:
+            tag = payload[0]
+        elif isinstance(payload, dict):
+            tag = payload.get("type", payload.get("kind", None))
         else:
-            for callback in self._on_message_callbacks[:]:
+            return None
+        return self._topic_callbacks.get(tag) if isinstance(tag, str) else None
+
+    def _on_message(self, raw_message: Union[str, Dict[str, Any]], data: Optional[bytes]) -> None:
+        self._on_messages([(raw_message, data)])
+
+    def _on_replayed_message(self, raw_message: str, data: Optional[bytes]) -> None:
+        # RPC replies never reach the message handlers when live, as they are dispatched natively.
+        if '"telco:rpc"' in raw_message:
+            message = json.loads(raw_message)
+            payload = message.get("payload", None)
+            if message["type"] == "send" and isinstance(payload, list) and payload[:1] == ["telco:rpc"]:
+                return
+        self._on_message(raw_message, data)
+
+    def _on_messages(self, raw_messages: List[Tuple[Union[str, Dict[str, Any]], Optional[bytes]]]) -> None:
+        messages = []
+
+        for raw_message, raw_data in raw_messages:
+            message, data = self._decode_message(raw_message, raw_data)
+
+            mtype = message["type"]
+            if mtype == "log":
+                level = message["level"]
+                text = message.get("payload", None)
+                self._log_handler(level, text)
+            else:
+                if self._message_encoding == "cbor" and self._topic_callbacks and mtype == "send":
+                    topic_callbacks = self._find_topic_callbacks(message)
+                    if topic_callbacks is not None:
+                        for callback in topic_callbacks[:]:
+                            try:
+                                _call_callback("message", callback, message, data)
+                            except:
+                                traceback.print_exc()
+                        continue
+
+                for callback in self._on_message_callbacks[:]:
+                    try:
+                        _call_callback("message", callback, message, data)
+                    except:
+                        traceback.print_exc()
+                messages.append((message, data))
+
+        if messages:
+            for batch_callback in self._on_messages_callbacks[:]:
                 try:
-                    callback(message, data)
+                    _call_callback("messages", batch_callback, messages)
                 except:
                     traceback.print_exc()
 
 
+class MessageTapReader:
+    """
+    Follows the raw messages mirrored by Script.set_message_tap(), typically from another process
+    """
+
+    _MAGIC = b"TELCOTAP"
+    _VERSION = 1
+    _HEADER = struct.Struct("=8sIIIII")
+    _RECORD = struct.Struct("=IIII")
+    _POSITION = struct.Struct("=I")
+    _RESERVE_OFFSET = 20
+    _COMMIT_OFFSET = 24
+    _PADDING = 1 << 0
+    _HAS_DATA = 1 << 1
+
+    def __init__(self, path: str, from_start: bool = False) -> None:
+        """
+        :param path: the file passed to Script.set_message_tap()
+        :param from_start: also read the messages still in the ring, instead of only those written from now on
+        """
+
+        with open(path, "rb") as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+        magic, version, self._header_size, self._capacity, _, commit = self._HEADER.unpack_from(self._map, 0)
+        if magic != self._MAGIC or version != self._VERSION:
+            self._map.close()
+            raise ValueError("not a message tap file")
+
+        self._position = 0 if from_start else commit
+        self.overruns = 0
+
+    def __enter__(self) -> MessageTapReader:
+        return self
+
+    def __exit__(
+        self,
+        exc_type: Optional[Type[BaseException]],
+        exc_value: Optional[BaseException],
+        trace: Optional[TracebackType],
+    ) -> None:
+        self.close()
+
+    def close(self) -> None:
+        """
+        Unmap the file
+        """
+
+        self._map.close()
+
+    def read(self, max_count: int = 0) -> List[Tuple[str, Optional[bytes]]]:
+        """
+        Get the (raw message, data) pairs written since the last read, oldest first. Should the reader fall behind by
+        more than the size of the ring, it skips ahead to the newest message and counts an overrun
+        :param max_count: how many messages to get at most, 0 for all of them
+        """
+
+        messages: List[Tuple[str, Optional[bytes]]] = []
+
+        while max_count == 0 or len(messages) < max_count:
+            commit = self._load(self._COMMIT_OFFSET)
+            if self._position == commit:
+                break
+
+            if self._is_overwritten():
+                self._skip_to(commit)
+                continue
+
+            offset = self._header_size + (self._position & (self._capacity - 1))
+            size, flags, message_length, data_length = self._RECORD.unpack_from(self._map, offset)
+            start = offset + self._RECORD.size
+            raw_message = self._map[start : start + message_length]
+            data = self._map[start + message_length : start + message_length + data_length]
+
+            # The producer may have lapped us while we were copying, in which case the record can't be trusted.
+            if self._is_overwritten() or size == 0 or size > self._capacity:
+                self._skip_to(commit)
+                continue
+
+            self._position = (self._position + size) & 0xFFFFFFFF
+            if flags & self._PADDING:
+                continue
+
+            messages.append((raw_message.decode("utf-8", "replace"), data if flags & self._HAS_DATA else None))
+
+        return messages
+
+    def _is_overwritten(self) -> bool:
+        reserve = self._load(self._RESERVE_OFFSET)
+        return ((reserve - self._position) & 0xFFFFFFFF) > self._capacity
+
+    def _skip_to(self, position: int) -> None:
+        self._position = position
+        self.overruns += 1
+
+    def _load(self, offset: int) -> int:
+        return self._POSITION.unpack_from(self._map, offset)[0]
+
+
+class MessageRecording:
+    """
+    Reads the raw messages recorded by Script.start_recording() or Bus.start_recording()
+    """
+
+    _MAGIC = b"TELCOREC"
+    _VERSION = 1
+    _HEADER = struct.Struct("=8sII")
+    _ENTRY = struct.Struct("=QII")
+    _ALIGNMENT = 8
+    _NO_DATA = 0xFFFFFFFF
+
+    def __init__(self, path: str) -> None:
+        """
+        :param path: the recording to read
+        """
+
+        with open(path, "rb") as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+        magic, version, self._header_size = self._HEADER.unpack_from(self._map, 0)
+        if magic != self._MAGIC or version != self._VERSION:
+            self._map.close()
+            raise ValueError("not a message recording")
+
+    def __enter__(self) -> MessageRecording:
+        return self
+
+    def __exit__(
+        self,
+        exc_type: Optional[Type[BaseException]],
+        exc_value: Optional[BaseException],
+        trace: Optional[TracebackType],
+    ) -> None:
+        self.close()
+
+    def __iter__(self) -> Iterator[Tuple[float, str, Optional[bytes]]]:
+        """
+        Iterate over the (seconds since the recording started, raw message, data) of each message, stopping early at a
+        message that is only partially written
+        """
+
+        end = len(self._map)
+        offset = self._header_size
+        while offset + self._ENTRY.size <= end:
+            timestamp, message_length, data_length = self._ENTRY.unpack_from(self._map, offset)
+            has_data = data_length != self._NO_DATA
+            if not has_data:
+                data_length = 0
+
+            start = offset + self._ENTRY.size
+            stop = start + message_length + data_length
+            if stop > end:
+                break
+
+            raw_message = self._map[start : start + message_length].decode("utf-8", "replace")
+            data = self._map[start + message_length : stop] if has_data else None
+            yield (timestamp / 1e6, raw_message, data)
+
+            offset = stop + (-(message_length + data_length) % self._ALIGNMENT)
+
+    def close(self) -> None:
+        """
+        Unmap the file
+        """
+
+        self._map.close()
+
+    def replay(self, callback: Callable[[str, Optional[bytes]], None], speed: float = 1.0) -> int:
+        """
+        Call back with the (raw message, data) of each message in order, returning how many there were
+        :param callback: the function to feed the messages to
+        :param speed: how much faster than recorded to replay, or 0 to replay as fast as possible
+        """
+
+        count = 0
+        started_at = time.monotonic()
+        for timestamp, raw_message, data in self:
+            if speed > 0:
+                delay = timestamp / speed - (time.monotonic() - started_at)
+                if delay > 0:
+                    time.sleep(delay)
+            callback(raw_message, data)
+            count += 1
+        return count
+
+
 SessionDetachedCallback = Callable[
     [
         Literal[
@@ -617,27 +1210,93 @@ class Session:
 
     @cancellable
     def create_script(
-        self, source: str, name: Optional[str] = None, snapshot: Optional[bytes] = None, runtime: Optional[str] = None
+        self,
+        source: str,
+        name: Optional[str] = None,
+        snapshot: Optional[bytes] = None,
+        runtime: Optional[str] = None,
+        native_decoding: bool = False,
+        zero_copy_data: bool = False,
+        max_batch_size: int = 0,
+        max_batch_delay: float = 0.0,
+        queue_size: int = 0,
+        queue_policy: MessageQueuePolicy = "drop-oldest",
+        message_encoding: MessageEncoding = "json",
+        lazy_messages: bool = False,
     ) -> Script:
         """
         Create a new script
+        :param native_decoding: decode messages from the script natively instead of through json.loads
+        :param zero_copy_data: deliver binary data as a read-only BytesView sharing the agent's buffer, where supported
+        :param max_batch_size: when non-zero, collect up to this many messages per wakeup of the message handlers
+        :param max_batch_delay: how many seconds a partial batch may wait for more messages before being delivered
+        :param queue_size: when non-zero, deliver messages from a shared worker thread through a queue of this many
+                           entries
+        :param queue_policy: what to do when the queue is full: "drop-oldest", "drop-newest", "coalesce" into the
+                             newest pending message, or "block" Telco's shared main loop until there is room
+        :param message_encoding: "cbor" to exchange messages as CBOR in the data side channel, see Script.post()
+        :param lazy_messages: deliver messages as LazyMessage objects, which only parse the type, level and payload tag
+                              up front and the rest on first access
         """
 
         kwargs = {"name": name, "snapshot": snapshot, "runtime": runtime}
         _filter_missing_kwargs(kwargs)
-        return Script(self._impl.create_script(source, **kwargs))  # type: ignore
+        return Script(
+            self._impl.create_script(source, **kwargs),  # type: ignore
+            native_decoding,
+            zero_copy_data,
+            max_batch_size,
+            max_batch_delay,
+            queue_size,
+            queue_policy,
+            message_encoding,
+            lazy_messages,
+        )
 
     @cancellable
     def create_script_from_bytes(
-        self, data: bytes, name: Optional[str] = None, snapshot: Optional[bytes] = None, runtime: Optional[str] = None
+        self,
+        data: bytes,
+        name: Optional[str] = None,
+        snapshot: Optional[bytes] = None,
+        runtime: Optional[str] = None,
+        native_decoding: bool = False,
+        zero_copy_data: bool = False,
+        max_batch_size: int = 0,
+        max_batch_delay: float = 0.0,
+        queue_size: int = 0,
+        queue_policy: MessageQueuePolicy = "drop-oldest",
+        message_encoding: MessageEncoding = "json",
+        lazy_messages: bool = False,
     ) -> Script:
         """
         Create a new script from bytecode
+        :param native_decoding: decode messages from the script natively instead of through json.loads
+        :param zero_copy_data: deliver binary data as a read-only BytesView sharing the agent's buffer, where supported
+        :param max_batch_size: when non-zero, collect up to this many messages per wakeup of the message handlers
+        :param max_batch_delay: how many seconds a partial batch may wait for more messages before being delivered
+        :param queue_size: when non-zero, deliver messages from a shared worker thread through a queue of this many
+                           entries
+        :param queue_policy: what to do when the queue is full: "drop-oldest", "drop-newest", "coalesce" into the
+                             newest pending message, or "block" Telco's shared main loop until there is room
+        :param message_encoding: "cbor" to exchange messages as CBOR in the data side channel, see Script.post()
+        :param lazy_messages: deliver messages as LazyMessage objects, which only parse the type, level and payload tag
+                              up front and the rest on first access
         """
 
         kwargs = {"name": name, "snapshot": snapshot, "runtime": runtime}
         _filter_missing_kwargs(kwargs)
-        return Script(self._impl.create_script_from_bytes(data, **kwargs))  # type: ignore
+        return Script(
+            self._impl.create_script_from_bytes(data, **kwargs),  # type: ignore
+            native_decoding,
+            zero_copy_data,
+            max_batch_size,
+            max_batch_delay,
+            queue_size,
+            queue_policy,
+            message_encoding,
+            lazy_messages,
+        )
 
     @cancellable
     def compile_script(self, source: str, name: Optional[str] = None, runtime: Optional[str] = None) -> bytes:
@@ -727,26 +1386,108 @@ class Session:
 
 BusDetachedCallback = Callable[[], None]
 BusMessageCallback = Callable[[Mapping[Any, Any], Optional[bytes]], None]
+BusMessagesCallback = Callable[[List[Tuple[Mapping[Any, Any], Optional[bytes]]]], None]
 
 
 class Bus:
     def __init__(self, impl: _telco.Bus) -> None:
         self._impl = impl
         self._on_message_callbacks: List[Callable[..., Any]] = []
+        self._on_messages_callbacks: List[Callable[..., Any]] = []
+        self._message_handler: Callable[..., None] = self._on_message
+        self._message_filter: Optional[Tuple[str, List[str]]] = None
+        self._streams: weakref.WeakSet[MessageStream[Any]] = weakref.WeakSet()
 
-        impl.on("message", self._on_message)
+        impl.on("detached", self._on_detached)
+        impl.on("message", self._message_handler)
 
     @cancellable
-    def attach(self) -> None:
+    def attach(
+        self,
+        max_batch_size: int = 0,
+        max_batch_delay: float = 0.0,
+        queue_size: int = 0,
+        queue_policy: MessageQueuePolicy = "drop-oldest",
+        native_decoding: bool = False,
+    ) -> None:
         """
         Attach to the bus
-        """
+        :param max_batch_size: when non-zero, collect up to this many messages per wakeup of the message handlers
+        :param max_batch_delay: how many seconds a partial batch may wait for more messages before being delivered
+        :param queue_size: when non-zero, deliver messages from a shared worker thread through a queue of this many
+                           entries
+        :param queue_policy: what to do when the queue is full: "drop-oldest", "drop-newest", "coalesce" into the
+                             newest pending message, or "block" Telco's shared main loop until there is room
+        :param native_decoding: decode messages natively instead of through json.loads
+        """
+
+        # No messages flow before attaching, so the handler can be swapped without losing any.
+        self._impl.off("message", self._message_handler)
+        self._message_handler = self._on_messages if max_batch_size > 0 else self._on_message
+        self._impl.on(
+            "message",
+            self._message_handler,
+            decode_json=native_decoding,
+            max_batch_size=max_batch_size,
+            max_batch_delay=max_batch_delay,
+            queue_size=queue_size,
+            queue_policy=queue_policy,
+        )
+        if self._message_filter is not None:
+            key, values = self._message_filter
+            self._impl.set_filter("message", self._message_handler, key, values)
 
         self._impl.attach()
 
-    def post(self, message: Any, data: Optional[Union[str, bytes]] = None) -> None:
+    def set_message_filter(self, values: Optional[Sequence[str]], key: str = "type") -> None:
+        """
+        Only deliver messages whose top-level key has one of the given string values. The message handlers drop the
+        others natively, before they are decoded or reach Python, while messages() and replay() drop them once decoded
+        :param values: the values to let through, or None to deliver every message again
+        :param key: the top-level key to look at
+        """
+
+        if values is None:
+            self._message_filter = None
+            self._impl.set_filter("message", self._message_handler, None, None)
+        else:
+            self._message_filter = (key, list(values))
+            self._impl.set_filter("message", self._message_handler, key, self._message_filter[1])
+
+    def get_message_filter_stats(self) -> Dict[str, Any]:
+        """
+        Get the filter's key, how many values it lets through, and how many messages passed or were filtered out
+        """
+
+        return self._impl.get_filter_stats("message", self._message_handler)
+
+    def get_message_queue_stats(self) -> Dict[str, int]:
+        """
+        Get the length, capacity, high-water mark and dropped count of the message queue
+        """
+
+        return self._impl.get_queue_stats("message", self._message_handler)
+
+    def messages(
+        self, queue_size: int = 1024, queue_policy: MessageStreamPolicy = "drop-oldest"
+    ) -> MessageStream[Tuple[Mapping[Any, Any], Optional[bytes]]]:
+        """
+        Receive messages with `async for`, many per event loop wakeup. The iteration ends when the bus is detached
+        :param queue_size: how many messages may be pending before queue_policy kicks in
+        :param queue_policy: what to do when the consumer falls behind, streams never block the emitting thread
+        """
+
+        stream = MessageStream(
+            self._impl.open_stream("message", decode_json=True, queue_size=queue_size, queue_policy=queue_policy),
+            self._decode_stream_message,
+        )
+        self._streams.add(stream)
+        return stream
+
+    def post(self, message: Any, data: Optional[MessageData] = None) -> None:
         """
-        Post a JSON-encoded message to the bus
+        Post a JSON-encoded message to the bus. Bytes data is handed to Telco without copying, as are other bytes-like
+        objects on builds targeting Python 3.11 or later, which must then stay unmodified until the message is sent
         """
 
         raw_message = json.dumps(message)
@@ -754,6 +1495,50 @@ class Bus:
         _filter_missing_kwargs(kwargs)
         self._impl.post(raw_message, **kwargs)
 
+    def post_many(self, messages: Sequence[Any], datas: Optional[Sequence[Optional[MessageData]]] = None) -> None:
+        """
+        Post a batch of JSON-encoded messages to the bus, in order and with a single GIL release
+        :param messages: the messages to post
+        :param datas: optional data for each message, or None
+        """
+
+        raw_messages = [json.dumps(message) for message in messages]
+        self._impl.post_many(raw_messages, None if datas is None else list(datas))
+
+    def start_recording(self, path: str) -> None:
+        """
+        Record every raw message on the bus, with its data and a timestamp, into a compact binary file that
+        MessageRecording reads back, e.g. for replay(). Start it after attach(), which replaces the message handler
+        :param path: the file to create, replacing any existing one
+        """
+
+        self._impl.set_recorder("message", self._message_handler, path)
+
+    def stop_recording(self) -> None:
+        """
+        Stop recording messages and flush the recording to disk
+        """
+
+        self._impl.set_recorder("message", self._message_handler, None)
+
+    def get_recording_stats(self) -> Dict[str, int]:
+        """
+        Get whether the bus is being recorded, and how many messages and bytes were recorded or failed to be
+        """
+
+        return self._impl.get_recorder_stats("message", self._message_handler)
+
+    def replay(self, path: str, speed: float = 1.0) -> int:
+        """
+        Feed a recording through the message filter and handlers as if it had just arrived on the bus. Returns how
+        many messages the recording held
+        :param path: a file written by start_recording()
+        :param speed: how much faster than recorded to replay, or 0 to replay as fast as possible
+        """
+
+        with MessageRecording(path) as recording:
+            return recording.replay(self._on_replayed_message, speed)
+
     @overload
     def on(self, signal: Literal["detached"], callback: BusDetachedCallback) -> None:
         ...
@@ -762,6 +1547,10 @@ class Bus:
     def on(self, signal: Literal["message"], callback: BusMessageCallback) -> None:
         ...
 
+    @overload
+    def on(self, signal: Literal["messages"], callback: BusMessagesCallback) -> None:
+        ...
+
     @overload
     def on(self, signal: str, callback: Callable[..., Any]) -> None:
         ...
@@ -773,6 +1562,8 @@ class Bus:
 
         if signal == "message":
             self._on_message_callbacks.append(callback)
+        elif signal == "messages":
+            self._on_messages_callbacks.append(callback)
         else:
             self._impl.on(signal, callback)
 
@@ -784,6 +1575,10 @@ class Bus:
     def off(self, signal: Literal["message"], callback: BusMessageCallback) -> None:
         ...
 
+    @overload
+    def off(self, signal: Literal["messages"], callback: BusMessagesCallback) -> None:
+        ...
+
     @overload
     def off(self, signal: str, callback: Callable[..., Any]) -> None:
         ...
@@ -795,15 +1590,54 @@ class Bus:
 
         if signal == "message":
             self._on_message_callbacks.remove(callback)
+        elif signal == "messages":
+            self._on_messages_callbacks.remove(callback)
         else:
             self._impl.off(signal, callback)
 
-    def _on_message(self, raw_message: str, data: Any) -> None:
+    def _on_detached(self) -> None:
+        for stream in list(self._streams):
+            stream.close()
+
+    def _decode_stream_message(self, args: Tuple[Any, ...]) -> Optional[Tuple[Mapping[Any, Any], Optional[bytes]]]:
+        raw_message, data = args
+        message = json.loads(raw_message) if isinstance(raw_message, str) else raw_message
+        if not self._accepts_message(message):
+            return None
+        return (message, data)
+
+    def _on_replayed_message(self, raw_message: str, data: Optional[bytes]) -> None:
         message = json.loads(raw_message)
+        if self._accepts_message(message):
+            self._on_message(message, data)
 
-        for callback in self._on_message_callbacks[:]:
+    def _accepts_message(self, message: Any) -> bool:
+        # Mirrors the native filter, which only matches top-level string values.
+        if self._message_filter is None:
+            return True
+        key, values = self._message_filter
+        value = message.get(key) if isinstance(message, dict) else None
+        return isinstance(value, str) and value in values
+
+    def _on_message(self, raw_message: Union[str, Dict[str, Any]], data: Any) -> None:
+        self._on_messages([(raw_message, data)])
+
+    def _on_messages(self, raw_messages: List[Tuple[Union[str, Dict[str, Any]], Any]]) -> None:
+        messages = []
+
+        for raw_message, data in raw_messages:
+            message = json.loads(raw_message) if isinstance(raw_message, str) else raw_message
+
+            for callback in self._on_message_callbacks[:]:
+                try:
+                    _call_callback("message", callback, message, data)
+                except:
+                    traceback.print_exc()
+            messages.append((message, data))
+
+        for batch_callback in self._on_messages_callbacks[:]:
             try:
-                callback(message, data)
+                _call_callback("messages", batch_callback, messages)
             except:
                 traceback.print_exc()
 
@@ -1137,6 +1971,13 @@ class Device:
 
         self._impl.off(signal, callback)
 
+    def off_all(self, signal: str) -> None:
+        """
+        Remove all handlers of a signal
+        """
+
+        self._impl.off_all(signal)
+
     def _pid_of(self, target: ProcessTarget) -> int:
         if isinstance(target, str):
             return self.get_process(target).pid
@@ -1284,6 +2125,13 @@ class DeviceManager:
 
         self._impl.off(signal, callback)
 
+    def off_all(self, signal: str) -> None:
+        """
+        Remove all handlers of a signal
+        """
+
+        self._impl.off_all(signal)
+
 
 class EndpointParameters:
     def __init__(
@@ -1342,6 +2190,7 @@ class PortalService:
         self._impl = impl
         self._on_authenticated_callbacks: List[PortalServiceAuthenticatedCallback] = []
         self._on_message_callbacks: List[PortalServiceMessageCallback] = []
+        self._streams: weakref.WeakSet[MessageStream[Any]] = weakref.WeakSet()
 
         impl.on("authenticated", self._on_authenticated)
         impl.on("message", self._on_message)
@@ -1365,7 +2214,10 @@ class PortalService:
 
         self._impl.stop()
 
-    def post(self, connection_id: int, message: Any, data: Optional[Union[str, bytes]] = None) -> None:
+        for stream in list(self._streams):
+            stream.close()
+
+    def post(self, connection_id: int, message: Any, data: Optional[MessageData] = None) -> None:
         """
         Post a message to a specific control channel.
         """
@@ -1375,7 +2227,7 @@ class PortalService:
         _filter_missing_kwargs(kwargs)
         self._impl.post(connection_id, raw_message, **kwargs)
 
-    def narrowcast(self, tag: str, message: Any, data: Optional[Union[str, bytes]] = None) -> None:
+    def narrowcast(self, tag: str, message: Any, data: Optional[MessageData] = None) -> None:
         """
         Post a message to control channels with a specific tag
         """
@@ -1385,7 +2237,7 @@ class PortalService:
         _filter_missing_kwargs(kwargs)
         self._impl.narrowcast(tag, raw_message, **kwargs)
 
-    def broadcast(self, message: Any, data: Optional[Union[str, bytes]] = None) -> None:
+    def broadcast(self, message: Any, data: Optional[MessageData] = None) -> None:
         """
         Broadcast a message to all control channels
         """
@@ -1395,6 +2247,23 @@ class PortalService:
         _filter_missing_kwargs(kwargs)
         self._impl.broadcast(raw_message, **kwargs)
 
+    def messages(
+        self, queue_size: int = 1024, queue_policy: MessageStreamPolicy = "drop-oldest"
+    ) -> MessageStream[Tuple[int, Mapping[Any, Any], Optional[bytes]]]:
+        """
+        Receive messages from control channels with `async for`, many per event loop wakeup. The iteration ends when the
+        service is stopped
+        :param queue_size: how many messages may be pending before queue_policy kicks in
+        :param queue_policy: what to do when the consumer falls behind, streams never block the emitting thread
+        """
+
+        stream = MessageStream(
+            self._impl.open_stream("message", decode_json=True, queue_size=queue_size, queue_policy=queue_policy),
+            self._decode_stream_message,
+        )
+        self._streams.add(stream)
+        return stream
+
     def enumerate_tags(self, connection_id: int) -> List[str]:
         """
         Enumerate tags of a specific connection
@@ -1491,6 +2360,11 @@ class PortalService:
             except:
                 traceback.print_exc()
 
+    @staticmethod
+    def _decode_stream_message(args: Tuple[Any, ...]) -> Tuple[int, Mapping[Any, Any], Optional[bytes]]:
+        connection_id, raw_message, data = args
+        return (connection_id, json.loads(raw_message) if isinstance(raw_message, str) else raw_message, data)
+
     def _on_message(self, connection_id: int, raw_message: str, data: Optional[bytes]) -> None:
         message = json.loads(raw_message)
 
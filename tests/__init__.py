@@ -1,4 +1,5 @@
 from .test_core import TestCore
 from .test_rpc import TestRpc
+from .test_script import TestScript
 
-__all__ = ["TestCore", "TestRpc"]
+__all__ = ["TestCore", "TestRpc", "TestScript"]
@@ -1,3 +1,4 @@
+import sys
 import threading
 import time
 import unittest
@@ -29,6 +30,24 @@ class TestCore(unittest.TestCase):
 
         self.assertRaisesRegex(telco.InvalidArgumentError, "device not found", wait_for_nonexistent)
 
+    def test_signal_handler_registry(self):
+        class Handler:
+            def on_lost(self):
+                pass
+
+        device = telco.get_local_device()
+        handlers = [Handler() for _ in range(100)]
+        for handler in handlers:
+            device.on("lost", handler.on_lost)
+
+        # Bound methods are created anew on each access, so lookups must go by equality.
+        device.off("lost", handlers[0].on_lost)
+        self.assertRaises(ValueError, lambda: device.off("lost", handlers[0].on_lost))
+        self.assertRaises(ValueError, lambda: device.off("spawn-added", handlers[1].on_lost))
+
+        device.off_all("lost")
+        self.assertRaises(ValueError, lambda: device.off("lost", handlers[1].on_lost))
+
     def test_cancel_wait_for_nonexistent_device(self):
         cancellable = telco.Cancellable()
 
@@ -44,6 +63,47 @@ class TestCore(unittest.TestCase):
         threading.Thread(target=cancel_after_100ms).start()
         self.assertRaisesRegex(telco.OperationCancelledError, "operation was cancelled", wait_for_nonexistent)
 
+    def test_spawn_aux_values(self):
+        device = telco.get_local_device()
+        pid = device.spawn(
+            [sys.executable, "-c", "pass"],
+            ratio=0.5,
+            blob=b"\x00\x01",
+            buffer=bytearray(b"\x02"),
+            missing=None,
+            pair=(1, "two"),
+            tags=["a", "b"],
+            mixed=[1, "two", 3.0],
+            empty=[],
+            nested={"level": {"flags": [True, False]}},
+            huge=2**64 - 1,
+        )
+        device.kill(pid)
+
+        deep = []
+        for _ in range(100):
+            deep = [deep]
+        self.assertRaisesRegex(ValueError, "nesting too deep", lambda: device.spawn([sys.executable], deep=deep))
+        self.assertRaisesRegex(
+            TypeError, "dict keys must be strings", lambda: device.spawn([sys.executable], bad={1: 2})
+        )
+        self.assertRaisesRegex(TypeError, "unsupported type", lambda: device.spawn([sys.executable], bad=object()))
+
+    def test_bus_message_filter(self):
+        bus = telco.get_local_device().get_bus()
+        bus.set_message_filter(["ping", "pong"])
+        # Attaching swaps the message handler, which has to pick the filter up again.
+        bus.attach(native_decoding=True)
+        stats = bus.get_message_filter_stats()
+        self.assertEqual((stats["key"], stats["values"], stats["passed"], stats["filtered"]), ("type", 2, 0, 0))
+
+        bus.set_message_filter(["ping"], key="kind")
+        stats = bus.get_message_filter_stats()
+        self.assertEqual((stats["key"], stats["values"]), ("kind", 1))
+
+        bus.set_message_filter(None)
+        self.assertIsNone(bus.get_message_filter_stats()["key"])
+
 
 if __name__ == "__main__":
     unittest.main()
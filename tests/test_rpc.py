@@ -1,8 +1,12 @@
+import asyncio
+import os
 import subprocess
+import tempfile
 import threading
 import time
 import unittest
 
+import _telco
 import telco
 
 from .data import target_program
@@ -146,6 +150,441 @@ rpc.exports = {
         self.assertRaisesOperationCancelled(call_wait_forever_with_cancellable)
         self.assertEqual(script._pending, {})
 
+    def test_native_decoding(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+rpc.exports = {
+    echo: function (value) {
+        return value;
+    },
+};
+send({ text: "h\\u00e9\\"llo\\n", numbers: [0, -1, 1.5, 4294967296], flags: [true, false, null] });
+""",
+            native_decoding=True,
+        )
+        messages = []
+        script.on("message", lambda message, data: messages.append(message))
+        script.load()
+        self.assertEqual(script.exports_sync.echo({"a": [1, "b"]}), {"a": [1, "b"]})
+        self.assertEqual(
+            messages,
+            [
+                {
+                    "type": "send",
+                    "payload": {
+                        "text": 'hé"llo\n',
+                        "numbers": [0, -1, 1.5, 4294967296],
+                        "flags": [True, False, None],
+                    },
+                }
+            ],
+        )
+
+    def test_batched_messages(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+rpc.exports = {
+    ping: function () {
+        return "pong";
+    },
+};
+for (var i = 0; i !== 10; i++)
+  send(i);
+""",
+            max_batch_size=4,
+            max_batch_delay=0.01,
+        )
+        batches = []
+        script.on("messages", lambda messages: batches.append([message["payload"] for message, data in messages]))
+        script.load()
+        self.assertEqual(script.exports_sync.ping(), "pong")
+        time.sleep(0.05)
+        self.assertTrue(all(len(batch) <= 4 for batch in batches))
+        self.assertEqual([payload for batch in batches for payload in batch], list(range(10)))
+
+    def test_message_queue_overflow(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+for (var i = 0; i !== 50; i++)
+  send(i);
+""",
+            queue_size=4,
+            queue_policy="drop-oldest",
+        )
+        received = []
+
+        def on_message(message, data):
+            time.sleep(0.01)
+            received.append(message["payload"])
+
+        script.on("message", on_message)
+        script.load()
+        self._wait_until(lambda: received and received[-1] == 49)
+        stats = script.get_message_queue_stats()
+        self.assertEqual(received[-1], 49)
+        self.assertEqual(received, sorted(received))
+        self.assertEqual(stats["capacity"], 4)
+        self.assertLessEqual(stats["high_water"], 4)
+        self.assertEqual(len(received) + stats["dropped"], 50)
+
+    def test_async_messages(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv("go", function () {
+  for (var i = 0; i !== 10; i++)
+    send(i);
+});
+""",
+        )
+        script.load()
+
+        async def collect():
+            stream = script.messages()
+            script.post({"type": "go"})
+            payloads = []
+            async for message, data in stream:
+                payloads.append(message["payload"])
+                if len(payloads) == 10:
+                    break
+            stream.close()
+            return payloads
+
+        self.assertEqual(asyncio.run(collect()), list(range(10)))
+
+    def test_cbor_messages(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv(function onMessage(message, data) {
+  send(message, data);
+  recv(onMessage);
+});
+""",
+            message_encoding="cbor",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append((message["payload"], data)))
+        script.load()
+        script.post({"numbers": [0, -2, 2**40, 1.5], "blob": b"\x00\xff", "none": None}, data=b"tail")
+        self._wait_until(lambda: received)
+        self.assertEqual(received, [({"numbers": [0, -2, 2**40, 1.5], "blob": b"\x00\xff", "none": None}, b"tail")])
+
+    def test_lazy_messages(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+send(["tick", 1]);
+send({ type: "sample", values: [1, 2, 3] });
+""",
+            lazy_messages=True,
+        )
+        messages = []
+        script.on("message", lambda message, data: messages.append(message))
+        script.load()
+        self._wait_until(lambda: len(messages) == 2)
+        self.assertEqual([message.tag for message in messages], ["tick", "sample"])
+        self.assertEqual(messages[0]["type"], "send")
+        self.assertFalse(messages[0].is_materialized())
+        self.assertEqual(messages[1]["payload"], {"type": "sample", "values": [1, 2, 3]})
+        self.assertTrue(messages[1].is_materialized())
+
+    def test_lazy_deep_messages(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+var value = [];
+for (var i = 0; i !== 600; i++)
+  value = [value];
+send({ type: "deep", value: value });
+""",
+            lazy_messages=True,
+        )
+        messages = []
+        script.on("message", lambda message, data: messages.append(message))
+        script.load()
+        self._wait_until(lambda: messages)
+        message = messages[0]
+        self.assertEqual(message.tag, "deep")
+        # Deeper than the native parser goes, so materializing has to fall back to json.loads.
+        nested = message["payload"]["value"]
+        depth = 0
+        while nested:
+            nested = nested[0]
+            depth += 1
+        self.assertEqual(depth, 600)
+        self.assertTrue(message.is_materialized())
+
+    def test_topic_routing(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+rpc.exports = {
+    ping: function () {
+        return "pong";
+    },
+};
+send(["tick", 1]);
+send({ kind: "sample", values: [1, 2] });
+send(["noise", 2]);
+send({ type: "tick", n: 3 });
+""",
+        )
+        ticks = []
+        samples = []
+        script.on_topic("tick", lambda message, data: ticks.append(message["payload"]))
+        script.on_topic("sample", lambda message, data: samples.append(message["payload"]))
+        script.load()
+        self.assertEqual(script.exports_sync.ping(), "pong")
+        self._wait_until(lambda: len(ticks) + len(samples) == 3)
+        self.assertEqual(ticks, [["tick", 1], {"type": "tick", "n": 3}])
+        self.assertEqual(samples, [{"kind": "sample", "values": [1, 2]}])
+        stats = script.get_topic_stats()
+        self.assertEqual(stats["routes"], 2)
+        self.assertEqual(stats["routed"], 3)
+        self.assertEqual(stats["dropped"], 1)
+
+    def test_message_limits(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv("go", function () {
+  for (var i = 0; i !== 1000; i++)
+    send(i);
+  send("done");
+});
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append(message["payload"]))
+        script.set_message_limits(sample_every=10, max_rate=0.001, max_burst=50)
+        script.load()
+        script.post({"type": "go"})
+
+        def settled():
+            stats = script.get_message_limit_stats()
+            return sum(stats.values()) == 1001 and len(received) == stats["passed"]
+
+        self._wait_until(settled)
+        stats = script.get_message_limit_stats()
+        self.assertEqual(received[:3], [0, 10, 20])
+        self.assertEqual(stats["passed"], 50)
+        self.assertEqual(stats["passed"] + stats["throttled"], 101)
+        self.assertEqual(stats["sampled_out"], 900)
+
+    def test_priority_lanes(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv("go", function () {
+  for (var i = 0; i !== 20; i++)
+    send(["bulk", i]);
+  send(["urgent"]);
+});
+""",
+            queue_size=64,
+        )
+        received = []
+
+        def on_message(message, data):
+            time.sleep(0.01)
+            received.append(message["payload"][0])
+
+        script.on("message", on_message)
+        script.set_priority_tags(["urgent"])
+        script.load()
+        script.post({"type": "go"})
+        self._wait_until(lambda: len(received) == 21)
+        stats = script.get_message_queue_stats()
+        self.assertLess(received.index("urgent"), 20)
+        self.assertEqual(stats["priority_delivered"], 1)
+        self.assertEqual(stats["bulk_delivered"], 20)
+
+    def test_post_many(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv(function onMessage(message, data) {
+  send(message.index, data);
+  recv(onMessage);
+});
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append((message["payload"], data)))
+        script.load()
+        script.post_many([{"index": i} for i in range(100)], datas=[b"x" if i == 42 else None for i in range(100)])
+        self._wait_until(lambda: len(received) == 100)
+        self.assertEqual([payload for payload, data in received], list(range(100)))
+        self.assertEqual(received[42], (42, b"x"))
+        self.assertRaises(ValueError, lambda: script.post_many([{}], datas=[]))
+
+    def test_post_buffer_data(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv(function onMessage(message, data) {
+  send(message, data);
+  recv(onMessage);
+});
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append(bytes(data)))
+        script.load()
+        blob = bytearray(range(256)) * 4096
+        script.post({"type": "blob"}, data=memoryview(blob)[1:])
+        script.post({"type": "blob"}, data=bytearray(b"tail"))
+        self._wait_until(lambda: len(received) == 2)
+        self.assertEqual(received, [bytes(blob[1:]), b"tail"])
+        self.assertRaises(TypeError, lambda: script.post({}, data=42))
+
+    def test_record_and_replay(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+rpc.exports = {
+    ping: function () {
+        send("pinged", [7]);
+        return "pong";
+    },
+};
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append((message["payload"], data)))
+        script.load()
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "messages.rec")
+            script.start_recording(path)
+            self.assertEqual(script.exports_sync.ping(), "pong")
+            self._wait_until(lambda: received)
+            script.stop_recording()
+            self.assertEqual(script.get_recording_stats()["recorded"], 2)
+            self.assertEqual(script.replay(path, speed=0), 2)
+        self.assertEqual(received, [("pinged", b"\x07"), ("pinged", b"\x07")])
+
+    def test_rpc_replies(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+rpc.exports = {
+    fail: function () {
+        throw new Error("No");
+    },
+    speak: function () {
+        var buf = Memory.allocUtf8String("Yo");
+        return Memory.readByteArray(buf, 2);
+    },
+    nest: function (depth) {
+        var value = [];
+        for (var i = 0; i !== depth; i++)
+            value = [value];
+        return value;
+    },
+    waitForever: function () {
+        return new Promise(function () {});
+    },
+};
+""",
+        )
+        script.load()
+        agent = script.exports_sync
+
+        with self.assertRaises(telco.core.RPCException) as cm:
+            agent.fail()
+        self.assertEqual(cm.exception.args[0], "No")
+        self.assertEqual(agent.speak(), b"Yo")
+
+        # Deeper than the native parser goes, so the reply has to be decoded by json.loads instead.
+        nested = agent.nest(600)
+        depth = 0
+        while nested:
+            nested = nested[0]
+            depth += 1
+        self.assertEqual(depth, 600)
+
+        async def call_async():
+            self.assertEqual(await script.exports_async.speak(), b"Yo")
+            pending = asyncio.ensure_future(script.exports_async.wait_forever())
+            await asyncio.sleep(0.1)
+            script.unload()
+            with self.assertRaises(telco.InvalidOperationError):
+                await pending
+
+        asyncio.run(call_async())
+        self.assertEqual(script._pending, {})
+
+    def test_dispatcher(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+recv(function onMessage() {
+  for (var i = 0; i !== 100; i++)
+    send(i);
+  recv(onMessage);
+});
+""",
+        )
+        received = []
+        threads = []
+
+        def on_message(message, data):
+            received.append(message["payload"])
+            threads.append(threading.get_ident())
+
+        script.on("message", on_message)
+        script.load()
+        script.post({"type": "ping"})
+        self._wait_until(lambda: len(received) == 100)
+        main_loop_threads = set(threads)
+
+        del threads[:]
+        telco.start_dispatcher(threads=4)
+        try:
+            script.post({"type": "ping"})
+            self._wait_until(lambda: len(received) == 200)
+        finally:
+            telco.stop_dispatcher()
+        dispatcher_threads = set(threads)
+
+        self.assertEqual(received, list(range(100)) * 2)
+        self.assertEqual(len(dispatcher_threads), 1)
+        self.assertTrue(main_loop_threads.isdisjoint(dispatcher_threads))
+        self.assertRaises(RuntimeError, lambda: telco.start_dispatcher())
+
+    @unittest.skipUnless(hasattr(_telco, "BytesView"), "requires a build against the 3.11+ limited API")
+    def test_zero_copy_data(self):
+        script = self.session.create_script(
+            name="test-rpc",
+            source="""\
+send("blob", [1, 2, 3]);
+""",
+            zero_copy_data=True,
+        )
+        received = []
+        script.on("message", lambda message, data: received.append(data))
+        script.load()
+        self._wait_until(lambda: received)
+        data = received[0]
+        self.assertIsInstance(data, _telco.BytesView)
+        self.assertEqual(len(data), 3)
+        with memoryview(data) as view:
+            self.assertTrue(view.readonly)
+            self.assertEqual(view.tobytes(), b"\x01\x02\x03")
+        self.assertEqual(bytes(data), b"\x01\x02\x03")
+
+    def _wait_until(self, predicate, timeout=5.0):
+        deadline = time.time() + timeout
+        while not predicate():
+            if time.time() >= deadline:
+                return False
+            time.sleep(0.01)
+        return True
+
     def assertRaisesScriptDestroyed(self, operation):
         self.assertRaisesRegex(telco.InvalidOperationError, "script has been destroyed", operation)
 
@@ -0,0 +1,217 @@
+import ctypes
+import os
+import subprocess
+import tempfile
+import time
+import unittest
+
+import _telco
+import telco
+
+from .data import target_program
+
+
+class TestScript(unittest.TestCase):
+    target: subprocess.Popen
+    session: telco.core.Session
+
+    @classmethod
+    def setUp(cls):
+        cls.target = subprocess.Popen([target_program], stdin=subprocess.PIPE)
+        # TODO: improve injectors to handle injection into a process that hasn't yet finished initializing
+        time.sleep(0.05)
+        cls.session = telco.attach(cls.target.pid)
+
+    @classmethod
+    def tearDown(cls):
+        cls.session.detach()
+        cls.target.terminate()
+        cls.target.stdin.close()
+        cls.target.wait()
+
+    def test_log_sink(self):
+        script = self.session.create_script(
+            name="test-script",
+            source="""\
+console.log("hello");
+console.warn("careful\\n");
+console.error("oops");
+send("done");
+""",
+        )
+        handled = []
+        received = []
+        script.set_log_handler(lambda level, text: handled.append(text))
+        script.on("message", lambda message, data: received.append(message["payload"]))
+        script.set_log_sink(buffer_size=2, level="warning")
+        script.load()
+        self._wait_until(lambda: received)
+        self.assertEqual(handled, [])
+        self.assertEqual(script.tail_logs(), [("warning", "careful\n"), ("error", "oops")])
+        self.assertEqual(script.get_log_sink_stats()["filtered"], 1)
+
+    def test_message_tap(self):
+        script = self.session.create_script(
+            name="test-script",
+            source="""\
+send(["tick", 1]);
+send("blob", [1, 2, 3]);
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append(message))
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "messages.tap")
+            script.set_message_tap(path, size=8192)
+            reader = telco.MessageTapReader(path, from_start=True)
+            script.load()
+            self._wait_until(lambda: len(received) == 2)
+            tapped = reader.read()
+            reader.close()
+        self.assertEqual(
+            tapped,
+            [
+                ('{"type":"send","payload":["tick",1]}', None),
+                ('{"type":"send","payload":"blob"}', b"\x01\x02\x03"),
+            ],
+        )
+        self.assertEqual(script.get_message_tap_stats()["written"], 2)
+
+    def test_callback_watchdog(self):
+        script = self.session.create_script(
+            name="test-script",
+            source="""\
+send("slow");
+send("fast");
+""",
+        )
+        received = []
+        reports = []
+
+        def on_message(message, data):
+            if message["payload"] == "slow":
+                time.sleep(0.05)
+            received.append(message["payload"])
+
+        script.on("message", on_message)
+        telco.set_callback_watchdog(0.03, lambda signal, callback, elapsed: reports.append((signal, callback)))
+        try:
+            script.load()
+            self._wait_until(lambda: len(received) == 2)
+            stats = {entry["callback"]: entry for entry in telco.get_callback_stats()}
+        finally:
+            telco.set_callback_watchdog(None)
+            telco.reset_callback_stats()
+        name = __name__ + ".TestRpc.test_callback_watchdog.<locals>.on_message"
+        self.assertIn(("message", name), reports)
+        self.assertEqual(stats[name]["calls"], 2)
+        self.assertEqual(stats[name]["slow"], 1)
+        self.assertGreaterEqual(stats[name]["max_time"], 0.05)
+
+    def test_gil_stats(self):
+        script = self.session.create_script(
+            name="test-script",
+            source="""\
+send("hello");
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append(message["payload"]))
+        telco.reset_gil_stats()
+        script.load()
+        self._wait_until(lambda: received)
+        stats = telco.get_gil_stats()
+        self.assertGreaterEqual(stats["signal-emission"]["acquisitions"], 1)
+        self.assertEqual(sum(stats["signal-emission"]["histogram"]), stats["signal-emission"]["acquisitions"])
+
+    def test_capi(self):
+        message_func = ctypes.CFUNCTYPE(None, ctypes.c_char_p, ctypes.c_void_p, ctypes.c_void_p)
+
+        class CApi(ctypes.Structure):
+            _fields_ = [
+                ("version", ctypes.c_uint),
+                ("size", ctypes.c_size_t),
+                (
+                    "add_message_handler",
+                    ctypes.PYFUNCTYPE(
+                        ctypes.c_ulong,
+                        ctypes.py_object,
+                        ctypes.c_char_p,
+                        message_func,
+                        ctypes.c_void_p,
+                        ctypes.c_void_p,
+                    ),
+                ),
+                ("remove_message_handler", ctypes.PYFUNCTYPE(ctypes.c_int, ctypes.py_object, ctypes.c_ulong)),
+                (
+                    "bytes_get_data",
+                    ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(ctypes.c_size_t)),
+                ),
+            ]
+
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+        api = ctypes.cast(get_pointer(_telco._C_API, b"_telco._C_API"), ctypes.POINTER(CApi)).contents
+        self.assertGreaterEqual(api.version, 1)
+
+        script = self.session.create_script(
+            name="test-script",
+            source="""\
+recv("ping", function () {
+    send("pong", [1, 2]);
+});
+""",
+        )
+        received = []
+
+        def on_message(message, data, user_data):
+            size = ctypes.c_size_t()
+            payload = ctypes.string_at(api.bytes_get_data(data, ctypes.byref(size)), size.value) if data else None
+            received.append((message.decode(), payload))
+
+        callback = message_func(on_message)
+        handler_id = api.add_message_handler(script, b"message", callback, None, None)
+        script.load()
+        script.post({"type": "ping"})
+        self._wait_until(lambda: received)
+        self.assertEqual(api.remove_message_handler(script, handler_id), 1)
+        self.assertRaises(ValueError, lambda: api.remove_message_handler(script, handler_id))
+        self.assertRaises(TypeError, lambda: api.add_message_handler(self.session, b"message", callback, None, None))
+        self.assertEqual(received, [('{"type":"send","payload":"pong"}', b"\x01\x02")])
+
+    def test_message_filter(self):
+        script = self.session.create_script(
+            name="test-script",
+            source="""\
+send("red");
+send("blue");
+send("green");
+""",
+        )
+        received = []
+        script.on("message", lambda message, data: received.append(message["payload"]))
+        bus = telco.get_local_device().get_bus()
+        bus_received = []
+        bus.on("message", lambda message, data: bus_received.append(message["payload"]))
+        bus.set_message_filter(["blue", "green"], key="payload")
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "messages.rec")
+            script.start_recording(path)
+            script.load()
+            self._wait_until(lambda: len(received) == 3)
+            script.stop_recording()
+            self.assertEqual(bus.replay(path, speed=0), 3)
+        self.assertEqual(bus_received, ["blue", "green"])
+
+    def _wait_until(self, predicate, timeout=5.0):
+        deadline = time.time() + timeout
+        while not predicate():
+            if time.time() >= deadline:
+                return False
+            time.sleep(0.01)
+        return True
+
+
+if __name__ == "__main__":
+    unittest.main()